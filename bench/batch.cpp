@@ -0,0 +1,437 @@
+// vivid-onnx-batch - Offline detection over recorded or streamed frames
+//
+// Runs a detector over every frame of a video as fast as the machine
+// allows and writes its results to a track file (see track_file.h), which
+// PoseDetector/FaceDetector replay() instead of running the model, so
+// the show render doesn't pay for inference again:
+//
+//   ffmpeg -v error -i examples/pose-tracking/assets/prom.mp4 -f rawvideo -pix_fmt bgra - |
+//       vivid-onnx-batch --model movenet-multipose --size 1280x720 --out prom.vtrk
+//   vivid-onnx-batch --model blazeface --frames bench/frames/dance_640x360.bgra --format jsonl
+//
+// Frames are raw BGRA8, from a record_frames.sh file (size taken from the
+// name) or from stdin ("--frames -", needs --size).
+//
+// Throughput: a reader thread keeps frames decoded ahead; dynamic-batch
+// models pack --batch frames into one Session::Run (others run one frame
+// at a time), and each run happens on a worker thread while the next
+// batch is preprocessed and the previous one decoded (two buffer sets).
+//
+// Deterministic: every frame is decoded in input order, none are dropped,
+// and timestamps come from --fps instead of the clock. Records are keyed
+// by 0-based input frame number, which is what replay() looks up. Leave
+// smoothing to the replaying chain: the filters run on wall-clock time.
+
+#include "common.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+using namespace vivid;
+using namespace vivid::onnx;
+using namespace vivid::onnx::bench;
+namespace fs = std::filesystem;
+
+// =============================================================================
+// Frames - raw BGRA8 read ahead on a thread
+// =============================================================================
+
+class FrameReader {
+public:
+    ~FrameReader() { stop(); }
+
+    bool open(const std::string& path, int width, int height, size_t prefetch) {
+        if (path == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+#endif
+            m_file = stdin;
+        } else {
+            m_file = std::fopen(path.c_str(), "rb");
+            if (!m_file) {
+                std::cerr << "[batch] Can't open frames: " << path << std::endl;
+                return false;
+            }
+            m_ownsFile = true;
+        }
+        m_width = width;
+        m_height = height;
+        m_capacity = std::max<size_t>(1, prefetch);
+        m_thread = std::thread([this]() { readLoop(); });
+        return true;
+    }
+
+    /// Next frame in order; false at the end of the input
+    bool next(io::ImageData& frame) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() { return !m_ready.empty() || m_finished; });
+        if (m_ready.empty()) return false;
+        std::swap(frame, m_ready.front());   // the caller's old buffer is reused
+        m_free.push_back(std::move(m_ready.front()));
+        m_ready.pop_front();
+        m_changed.notify_all();
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_changed.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+        if (m_ownsFile && m_file) std::fclose(m_file);
+        m_file = nullptr;
+        m_ownsFile = false;
+    }
+
+private:
+    void readLoop() {
+        const size_t bytes = static_cast<size_t>(m_width) * m_height * 4;
+        while (true) {
+            io::ImageData frame;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]() { return m_stop || m_ready.size() < m_capacity; });
+                if (m_stop) break;
+                if (!m_free.empty()) {
+                    frame = std::move(m_free.back());
+                    m_free.pop_back();
+                }
+            }
+
+            frame.width = m_width;
+            frame.height = m_height;
+            frame.channels = 4;
+            frame.pixels.resize(bytes);
+            if (std::fread(frame.pixels.data(), 1, bytes, m_file) != bytes) break;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.push_back(std::move(frame));
+            m_changed.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+        m_changed.notify_all();
+    }
+
+    std::FILE* m_file = nullptr;
+    bool m_ownsFile = false;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_capacity = 1;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<io::ImageData> m_ready;
+    std::vector<io::ImageData> m_free;
+    bool m_finished = false;
+    bool m_stop = false;
+};
+
+// =============================================================================
+// Runner - drives a detector's stages without a Context
+// =============================================================================
+
+static int detectionCount(const FaceDetector& detector) { return detector.faceCount(); }
+static int detectionCount(const PoseDetector& detector) { return detector.poseCount(); }
+
+template <typename Detector>
+class BatchRunner : public Detector {
+public:
+    /// Frames per Session::Run this model allows
+    int batchLimit(int requested) const { return this->m_dynamicBatch ? std::max(1, requested) : 1; }
+
+    /// After load(): one binding per buffer set
+    void setup() { this->cacheInputShapes(2); }
+
+    // One Session::Run worth of frames
+    struct Batch {
+        std::vector<Tensor> inputs;
+        std::vector<Tensor> outputs;
+        std::vector<int64_t> frames;
+    };
+
+    /// Preprocess frames into the batch's input ([N, ...])
+    void fill(Batch& batch, const std::vector<io::ImageData>& frames, size_t count, int64_t firstFrame) {
+        batch.inputs.resize(1);
+        batch.outputs.resize(this->m_outputTensors.size());
+        batch.frames.resize(count);
+
+        Tensor& input = batch.inputs[0];
+        m_item.type = this->m_inputTensors[0].type;
+        for (size_t i = 0; i < count; i++) {
+            prepare(frames[i], m_item);
+            if (i == 0) {
+                std::vector<int64_t> shape = m_item.shape;
+                shape[0] = static_cast<int64_t>(count);
+                if (input.shape != shape || input.type != m_item.type) {
+                    input.shape = shape;
+                    input.type = m_item.type;
+                    resizeStorage(input);
+                }
+            }
+            packBatchItem(m_item, input, i);
+            batch.frames[i] = firstFrame + static_cast<int64_t>(i);
+        }
+    }
+
+    /// Session::Run (worker thread)
+    void run(Batch& batch) { this->runInference(batch.inputs, batch.outputs); }
+
+    /// Decode each item through m_outputTensors, like dispatchOutputs(), and
+    /// record it; returns the detections found
+    int decode(Batch& batch, double fps) {
+        const int64_t n = static_cast<int64_t>(batch.frames.size());
+        m_itemOutputs.resize(batch.outputs.size());
+        int detections = 0;
+        for (int64_t i = 0; i < n; i++) {
+            for (size_t o = 0; o < batch.outputs.size(); o++) {
+                unpackBatchItem(batch.outputs[o], n, static_cast<size_t>(i), m_itemOutputs[o]);
+            }
+            std::swap(this->m_outputTensors, m_itemOutputs);
+            this->processOutputTensor(this->m_outputTensors[0]);
+            std::swap(this->m_outputTensors, m_itemOutputs);
+
+            const int64_t frame = batch.frames[static_cast<size_t>(i)];
+            this->recordResults(frame, static_cast<double>(frame) * 1000.0 / fps);
+            detections += detectionCount(*this);
+        }
+        return detections;
+    }
+
+private:
+    // The CPU path of the detectors' prepareInputTensor(), at inputShape()
+    void prepare(const io::ImageData& frame, Tensor& tensor) {
+        const auto& shape = this->inputShape(0);  // [1, H, W, C]
+        if (tensor.shape != shape) {
+            tensor.shape = shape;
+            resizeStorage(tensor);
+        }
+        this->cpuPixelsToTensor(frame, tensor, static_cast<int>(shape[2]), static_cast<int>(shape[1]));
+    }
+
+    Tensor m_item;
+    std::vector<Tensor> m_itemOutputs;
+};
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+struct Options {
+    std::string model;
+    ModelKind kind = ModelKind::Pose;
+    bool kindSet = false;
+    std::string frames;
+    int width = 0;
+    int height = 0;
+    int batch = 4;
+    int threads = 0;
+    std::vector<ExecutionProvider> providers = {ExecutionProvider::CPU};
+    double fps = 30.0;
+    TrackFormat format = TrackFormat::Binary;
+    std::string out;
+};
+
+static void printUsage() {
+    std::cout <<
+        "Usage: vivid-onnx-batch --model m --frames f [options]\n"
+        "  --model m         blazeface, movenet-singlepose, movenet-multipose, or a .onnx path\n"
+        "  --kind k          pose or face (needed for a .onnx path)\n"
+        "  --frames f        raw BGRA8 frames (<name>_<w>x<h>.bgra), or - for stdin\n"
+        "  --size WxH        frame size (needed for stdin)\n"
+        "  --batch N         frames per run on dynamic-batch models (default 4)\n"
+        "  --ep a,b          execution providers in priority order (default: cpu)\n"
+        "  --threads N       intra-op threads, 0 = one per core (default)\n"
+        "  --fps F           frame rate for record timestamps (default 30)\n"
+        "  --format f        binary (replayable, default) or jsonl\n"
+        "  --out file        track file (default <frames name>.vtrk or .jsonl)\n";
+}
+
+static bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "[batch] Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--model") {
+            opts.model = value;
+        } else if (arg == "--kind") {
+            if (value != "pose" && value != "face") {
+                std::cerr << "[batch] Unknown kind: " << value << std::endl;
+                return false;
+            }
+            opts.kind = value == "face" ? ModelKind::Face : ModelKind::Pose;
+            opts.kindSet = true;
+        } else if (arg == "--frames") {
+            opts.frames = value;
+        } else if (arg == "--size") {
+            if (!parseSize(value, opts.width, opts.height)) {
+                std::cerr << "[batch] Bad frame size: " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--batch") {
+            opts.batch = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--ep") {
+            opts.providers.clear();
+            for (const auto& name : splitList(value)) {
+                ExecutionProvider ep;
+                if (!parseProvider(name, ep)) {
+                    std::cerr << "[batch] Unknown execution provider: " << name << std::endl;
+                    return false;
+                }
+                opts.providers.push_back(ep);
+            }
+        } else if (arg == "--threads") {
+            opts.threads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--fps") {
+            opts.fps = std::atof(value.c_str());
+        } else if (arg == "--format") {
+            if (value != "binary" && value != "jsonl") {
+                std::cerr << "[batch] Unknown format: " << value << std::endl;
+                return false;
+            }
+            opts.format = value == "jsonl" ? TrackFormat::Jsonl : TrackFormat::Binary;
+        } else if (arg == "--out") {
+            opts.out = value;
+        } else {
+            std::cerr << "[batch] Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !opts.model.empty() && !opts.frames.empty() && !opts.providers.empty() && opts.fps > 0.0;
+}
+
+// =============================================================================
+// Run
+// =============================================================================
+
+template <typename Detector>
+static int runBatch(const Options& opts, const std::string& modelPath) {
+    BatchRunner<Detector> detector;
+    ThreadPoolOptions threading;
+    threading.intraOpThreads = opts.threads;
+    detector.model(modelPath);
+    detector.executionProvider(opts.providers).threading(threading);
+    detector.record(opts.out, opts.format);
+
+    if (!detector.load()) {
+        std::cerr << "[batch] Model failed to load: " << modelPath << std::endl;
+        return 1;
+    }
+    detector.setup();
+    const int batchSize = detector.batchLimit(opts.batch);
+    std::cout << "[batch] " << detector.name() << " on " << executionProviderName(detector.activeExecutionProvider())
+              << ", " << batchSize << " frame(s) per run" << std::endl;
+
+    FrameReader reader;
+    if (!reader.open(opts.frames, opts.width, opts.height, static_cast<size_t>(batchSize) * 3)) return 1;
+
+    using Batch = typename BatchRunner<Detector>::Batch;
+    Batch sets[2];
+    std::vector<io::ImageData> frames(static_cast<size_t>(batchSize));
+    std::future<void> running;
+    int current = 0;
+    bool inFlight = false;
+    int64_t nextFrame = 0;
+    int64_t detections = 0;
+
+    const double start = nowMs();
+    while (true) {
+        size_t count = 0;
+        while (count < frames.size() && reader.next(frames[count])) count++;
+
+        // The previous run overlaps this preprocess, and the next run the
+        // previous decode
+        if (count > 0) {
+            detector.fill(sets[current], frames, count, nextFrame);
+            nextFrame += static_cast<int64_t>(count);
+        }
+        if (inFlight) running.get();
+        const int previous = 1 - current;
+        if (count > 0) {
+            Batch& batch = sets[current];
+            running = std::async(std::launch::async, [&detector, &batch]() { detector.run(batch); });
+        }
+        if (inFlight) detections += detector.decode(sets[previous], opts.fps);
+
+        inFlight = count > 0;
+        current = previous;
+        if (!inFlight) break;
+    }
+    const double seconds = (nowMs() - start) / 1000.0;
+    reader.stop();
+
+    if (nextFrame == 0) {
+        std::cerr << "[batch] No frames read from " << opts.frames << std::endl;
+        return 1;
+    }
+    std::printf("[batch] %lld frames in %.1f s (%.1f fps), %.2f detections per frame -> %s\n",
+                static_cast<long long>(nextFrame), seconds, seconds > 0.0 ? nextFrame / seconds : 0.0,
+                static_cast<double>(detections) / static_cast<double>(nextFrame), opts.out.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage();
+        return 1;
+    }
+
+    // Frame size from the file name unless given
+    std::string framesName = "frames";
+    if (opts.frames != "-") {
+        int width = 0, height = 0;
+        if (frameSizeFromName(fs::path(opts.frames).stem().string(), framesName, width, height) && opts.width == 0) {
+            opts.width = width;
+            opts.height = height;
+        }
+    }
+    if (opts.width <= 0 || opts.height <= 0) {
+        std::cerr << "[batch] Frame size unknown, pass --size WxH" << std::endl;
+        return 1;
+    }
+    if (opts.out.empty()) {
+        opts.out = framesName + (opts.format == TrackFormat::Jsonl ? ".jsonl" : ".vtrk");
+    }
+
+    std::string modelPath = opts.model;
+    if (const ModelSpec* spec = findModel(opts.model)) {
+        modelPath = spec->path;
+        if (!opts.kindSet) opts.kind = spec->kind;
+    } else if (!opts.kindSet) {
+        std::cerr << "[batch] --kind pose|face is needed for " << opts.model << std::endl;
+        return 1;
+    }
+    if (!fs::exists(modelPath)) {
+        std::cerr << "[batch] Model not found (run from the repository root): " << modelPath << std::endl;
+        return 1;
+    }
+
+    return opts.kind == ModelKind::Face ? runBatch<FaceDetector>(opts, modelPath)
+                                        : runBatch<PoseDetector>(opts, modelPath);
+}
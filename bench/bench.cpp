@@ -0,0 +1,528 @@
+// vivid-onnx-bench - End-to-end detector throughput and latency
+//
+// Runs the bundled models on recorded frames and times each stage on its
+// own: preprocess (fused CPU resample), inference (Session::Run), decode
+// (processOutputTensor) and the NMS share of decode. Every combination of
+// model, execution provider, thread count and batch size is one result;
+// results are printed as a table and written as JSON for comparing
+// releases on the same machine.
+//
+// Usage (from the repository root):
+//   bench/record_frames.sh                  # once: example mp4s -> raw frames
+//   vivid-onnx-bench --ep cpu,coreml --threads 1,2,4 --batch 1,4 --out bench.json
+//
+// Frames are raw BGRA8 files named <name>_<width>x<height>.bgra (see
+// record_frames.sh); without any, a synthetic frame is used.
+//
+// Batches run as one [N, ...] Session::Run on dynamic-batch models and as
+// N runs otherwise, the same way ONNXModel handles several inputs.
+
+#include "common.h"
+#include <onnxruntime_cxx_api.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef VIVID_ONNX_VERSION
+#define VIVID_ONNX_VERSION "unknown"
+#endif
+
+using namespace vivid;
+using namespace vivid::onnx;
+using namespace vivid::onnx::bench;
+namespace fs = std::filesystem;
+
+// =============================================================================
+// Frames
+// =============================================================================
+
+struct FrameSet {
+    std::string name;
+    std::vector<io::ImageData> frames;
+};
+
+static bool loadFrames(const fs::path& path, FrameSet& set) {
+    // <name>_<width>x<height>.bgra
+    int width = 0, height = 0;
+    if (!frameSizeFromName(path.stem().string(), set.name, width, height)) {
+        std::cerr << "[bench] Can't read frame size from name: " << path << std::endl;
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "[bench] Can't open frames: " << path << std::endl;
+        return false;
+    }
+
+    const size_t frameBytes = static_cast<size_t>(width) * height * 4;
+    for (;;) {
+        io::ImageData frame;
+        frame.width = width;
+        frame.height = height;
+        frame.channels = 4;
+        frame.pixels.resize(frameBytes);
+        if (!file.read(reinterpret_cast<char*>(frame.pixels.data()), frameBytes)) break;
+        set.frames.push_back(std::move(frame));
+    }
+    return !set.frames.empty();
+}
+
+static FrameSet syntheticFrames() {
+    FrameSet set;
+    set.name = "synthetic";
+    io::ImageData frame;
+    frame.width = 640;
+    frame.height = 360;
+    frame.channels = 4;
+    frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+    for (int y = 0; y < frame.height; y++) {
+        for (int x = 0; x < frame.width; x++) {
+            uint8_t* px = &frame.pixels[(static_cast<size_t>(y) * frame.width + x) * 4];
+            px[0] = static_cast<uint8_t>(x * 255 / frame.width);
+            px[1] = static_cast<uint8_t>(y * 255 / frame.height);
+            px[2] = 128;
+            px[3] = 255;
+        }
+    }
+    set.frames.push_back(std::move(frame));
+    return set;
+}
+
+// =============================================================================
+// Harness - drives a detector's stages without a Context
+// =============================================================================
+
+struct StageTimes {
+    double preprocess = 0.0;
+    double inference = 0.0;
+    double decode = 0.0;
+    double nms = 0.0;
+    int detections = 0;
+};
+
+static int detectionCount(const FaceDetector& detector) { return detector.faceCount(); }
+static int detectionCount(const PoseDetector& detector) { return detector.poseCount(); }
+
+template <typename Detector>
+class Harness : public Detector {
+public:
+    bool batched(int batch) const { return batch > 1 && this->m_dynamicBatch; }
+
+    /// Preprocess, run and decode one batch of frames
+    void iterate(const std::vector<const io::ImageData*>& frames, StageTimes& t) {
+        if (batched(static_cast<int>(frames.size()))) {
+            iterateBatched(frames, t);
+            return;
+        }
+        for (const io::ImageData* frame : frames) {
+            double start = nowMs();
+            prepare(*frame, this->m_inputTensors[0]);
+            double prepared = nowMs();
+            this->runInference();
+            double ran = nowMs();
+            decode(this->m_outputTensors[0], t);
+            t.preprocess += prepared - start;
+            t.inference += ran - prepared;
+        }
+    }
+
+private:
+    // The CPU path of the detectors' prepareInputTensor(), at inputShape()
+    void prepare(const io::ImageData& frame, Tensor& tensor) {
+        const auto& shape = this->inputShape(0);  // [1, H, W, C]
+        const int height = static_cast<int>(shape[1]);
+        const int width = static_cast<int>(shape[2]);
+        if (tensor.shape != shape) {
+            tensor.shape = shape;
+            resizeStorage(tensor);
+        }
+        this->cpuPixelsToTensor(frame, tensor, width, height);
+    }
+
+    void decode(const Tensor& output, StageTimes& t) {
+        uint64_t nmsBefore = this->stats().nms.samples;
+        double start = nowMs();
+        this->processOutputTensor(output);
+        t.decode += nowMs() - start;
+
+        StageTiming nms = this->stats().nms;
+        if (nms.samples != nmsBefore) t.nms += nms.lastMs;
+        t.detections += detectionCount(*this);
+    }
+
+    void iterateBatched(const std::vector<const io::ImageData*>& frames, StageTimes& t) {
+        const size_t n = frames.size();
+        m_batchInputs.resize(1);
+        Tensor& batch = m_batchInputs[0];
+
+        double start = nowMs();
+        m_item.type = this->m_inputTensors[0].type;
+        for (size_t i = 0; i < n; i++) {
+            prepare(*frames[i], m_item);
+            if (i == 0) {
+                std::vector<int64_t> shape = m_item.shape;
+                shape[0] = static_cast<int64_t>(n);
+                if (batch.shape != shape || batch.type != m_item.type) {
+                    batch.shape = shape;
+                    batch.type = m_item.type;
+                    resizeStorage(batch);
+                }
+            }
+            packBatchItem(m_item, batch, i);
+        }
+        double prepared = nowMs();
+
+        m_batchOutputs.resize(this->m_outputTensors.size());
+        this->runInference(m_batchInputs, m_batchOutputs);
+        double ran = nowMs();
+
+        // Decode each item's slice through m_outputTensors, like dispatchOutputs()
+        m_itemOutputs.resize(m_batchOutputs.size());
+        for (size_t i = 0; i < n; i++) {
+            for (size_t o = 0; o < m_batchOutputs.size(); o++) {
+                unpackBatchItem(m_batchOutputs[o], static_cast<int64_t>(n), i, m_itemOutputs[o]);
+            }
+            std::swap(this->m_outputTensors, m_itemOutputs);
+            decode(this->m_outputTensors[0], t);
+            std::swap(this->m_outputTensors, m_itemOutputs);
+        }
+
+        t.preprocess += prepared - start;
+        t.inference += ran - prepared;
+    }
+
+    Tensor m_item;
+    std::vector<Tensor> m_batchInputs;
+    std::vector<Tensor> m_batchOutputs;
+    std::vector<Tensor> m_itemOutputs;
+};
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+struct Options {
+    std::vector<std::string> models;
+    std::vector<ExecutionProvider> providers = {ExecutionProvider::CPU};
+    std::vector<int> threads = {1, 2, 4};
+    std::vector<int> batches = {1, 4};
+    std::vector<std::string> frameFiles;
+    int iterations = 200;
+    int warmup = 20;
+    std::string out = "vivid-onnx-bench.json";
+};
+
+static void printUsage() {
+    std::cout <<
+        "Usage: vivid-onnx-bench [options]\n"
+        "  --models a,b      blazeface, movenet-singlepose, movenet-multipose (default: all)\n"
+        "  --ep a,b          cpu, cuda, tensorrt, directml, coreml (default: cpu)\n"
+        "  --threads 1,2,4   intra-op thread counts, 0 = one per core\n"
+        "  --batch 1,4       frames per iteration\n"
+        "  --frames f.bgra   raw frame file (repeatable; default: bench/frames/*.bgra)\n"
+        "  --iterations N    timed iterations per configuration (default 200)\n"
+        "  --warmup N        untimed iterations first (default 20)\n"
+        "  --out file.json   results (default vivid-onnx-bench.json)\n";
+}
+
+static bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "[bench] Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--models") {
+            opts.models = splitList(value);
+        } else if (arg == "--ep") {
+            opts.providers.clear();
+            for (const auto& name : splitList(value)) {
+                ExecutionProvider ep;
+                if (!parseProvider(name, ep)) {
+                    std::cerr << "[bench] Unknown execution provider: " << name << std::endl;
+                    return false;
+                }
+                opts.providers.push_back(ep);
+            }
+        } else if (arg == "--threads" || arg == "--batch") {
+            std::vector<int>& list = (arg == "--threads") ? opts.threads : opts.batches;
+            list.clear();
+            for (const auto& item : splitList(value)) list.push_back(std::max(0, std::atoi(item.c_str())));
+            if (arg == "--batch") {
+                for (int& b : list) b = std::max(b, 1);
+            }
+        } else if (arg == "--frames") {
+            opts.frameFiles.push_back(value);
+        } else if (arg == "--iterations") {
+            opts.iterations = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--warmup") {
+            opts.warmup = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--out") {
+            opts.out = value;
+        } else {
+            std::cerr << "[bench] Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !opts.providers.empty() && !opts.threads.empty() && !opts.batches.empty();
+}
+
+// =============================================================================
+// Runs
+// =============================================================================
+
+struct Result {
+    std::string model;
+    ExecutionProvider requested = ExecutionProvider::CPU;
+    ExecutionProvider active = ExecutionProvider::CPU;
+    int threads = 0;
+    int batch = 1;
+    bool batched = false;
+    bool ran = false;
+    std::string note;
+
+    StageTiming preprocess, inference, decode, nms, total;
+    double framesPerSecond = 0.0;
+    double detectionsPerFrame = 0.0;
+};
+
+template <typename Detector>
+static void runConfig(const ModelSpec& spec, const Options& opts, const std::vector<FrameSet>& sets,
+                      ExecutionProvider ep, int threads, int batch, Result& result) {
+    Harness<Detector> detector;
+    ThreadPoolOptions threading;
+    threading.intraOpThreads = threads;
+    detector.model(spec.path);
+    detector.executionProvider(ep).threading(threading).sharedSession(false);
+
+    if (!detector.load()) {
+        result.note = "model failed to load";
+        return;
+    }
+    result.active = detector.activeExecutionProvider();
+    if (result.active != ep) {
+        result.note = "provider unavailable";
+        return;
+    }
+    result.batched = detector.batched(batch);
+
+    // Round-robin over all frames of all sets
+    std::vector<const io::ImageData*> all;
+    for (const auto& set : sets) {
+        for (const auto& frame : set.frames) all.push_back(&frame);
+    }
+
+    const size_t window = static_cast<size_t>(opts.iterations);
+    RollingStats preprocess(window), inference(window), decode(window), nms(window), total(window);
+    std::vector<const io::ImageData*> frames(static_cast<size_t>(batch));
+    size_t next = 0;
+    int detections = 0;
+
+    for (int i = -opts.warmup; i < opts.iterations; i++) {
+        for (auto& frame : frames) frame = all[next++ % all.size()];
+
+        StageTimes t;
+        detector.iterate(frames, t);
+        if (i < 0) continue;
+
+        preprocess.add(t.preprocess);
+        inference.add(t.inference);
+        decode.add(t.decode);
+        nms.add(t.nms);
+        total.add(t.preprocess + t.inference + t.decode);
+        detections += t.detections;
+    }
+
+    result.ran = true;
+    result.preprocess = preprocess.timing();
+    result.inference = inference.timing();
+    result.decode = decode.timing();
+    result.nms = nms.timing();
+    result.total = total.timing();
+    result.framesPerSecond = total.average() > 0.0 ? batch * 1000.0 / total.average() : 0.0;
+    result.detectionsPerFrame = static_cast<double>(detections) / (static_cast<double>(opts.iterations) * batch);
+}
+
+// =============================================================================
+// Output
+// =============================================================================
+
+static std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeTiming(std::ostream& out, const char* name, const StageTiming& t) {
+    out << jsonString(name) << ": {\"avgMs\": " << t.avgMs << ", \"p95Ms\": " << t.p95Ms
+        << ", \"p99Ms\": " << t.p99Ms << "}";
+}
+
+static const char* hostOs() {
+#if defined(__APPLE__)
+    return "macos";
+#elif defined(_WIN32)
+    return "windows";
+#else
+    return "linux";
+#endif
+}
+
+static const char* hostArch() {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return "arm64";
+#elif defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#else
+    return "unknown";
+#endif
+}
+
+static bool writeJson(const std::string& path, const Options& opts,
+                      const std::vector<FrameSet>& sets, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "[bench] Can't write " << path << std::endl;
+        return false;
+    }
+
+    out << "{\n";
+    out << "  \"version\": " << jsonString(VIVID_ONNX_VERSION) << ",\n";
+    out << "  \"onnxruntime\": " << jsonString(Ort::GetVersionString()) << ",\n";
+    out << "  \"host\": {\"os\": \"" << hostOs() << "\", \"arch\": \"" << hostArch()
+        << "\", \"hardwareThreads\": " << std::thread::hardware_concurrency() << "},\n";
+    out << "  \"iterations\": " << opts.iterations << ",\n";
+    out << "  \"warmup\": " << opts.warmup << ",\n";
+
+    out << "  \"frames\": [";
+    for (size_t i = 0; i < sets.size(); i++) {
+        const auto& f = sets[i].frames.front();
+        out << (i ? ", " : "") << "{\"name\": " << jsonString(sets[i].name) << ", \"width\": " << f.width
+            << ", \"height\": " << f.height << ", \"count\": " << sets[i].frames.size() << "}";
+    }
+    out << "],\n";
+
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"model\": " << jsonString(r.model)
+            << ", \"provider\": \"" << executionProviderName(r.requested) << "\""
+            << ", \"activeProvider\": \"" << executionProviderName(r.active) << "\""
+            << ", \"threads\": " << r.threads << ", \"batch\": " << r.batch
+            << ", \"batched\": " << (r.batched ? "true" : "false");
+        if (!r.ran) {
+            out << ", \"skipped\": " << jsonString(r.note) << "}";
+        } else {
+            out << ", \"framesPerSecond\": " << r.framesPerSecond
+                << ", \"detectionsPerFrame\": " << r.detectionsPerFrame << ",\n     ";
+            writeTiming(out, "preprocess", r.preprocess);
+            out << ", ";
+            writeTiming(out, "inference", r.inference);
+            out << ",\n     ";
+            writeTiming(out, "decode", r.decode);
+            out << ", ";
+            writeTiming(out, "nms", r.nms);
+            out << ",\n     ";
+            writeTiming(out, "total", r.total);
+            out << "}";
+        }
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+static void printResult(const Result& r) {
+    char line[256];
+    if (!r.ran) {
+        std::snprintf(line, sizeof(line), "%-20s %-9s %3d %3d  skipped: %s",
+                      r.model.c_str(), executionProviderName(r.requested), r.threads, r.batch, r.note.c_str());
+    } else {
+        std::snprintf(line, sizeof(line),
+                      "%-20s %-9s %3d %3d%s %8.1f fps | pre %6.2f | run %7.2f (p95 %7.2f) | decode %5.2f | nms %5.2f ms",
+                      r.model.c_str(), executionProviderName(r.active), r.threads, r.batch, r.batched ? "b" : " ",
+                      r.framesPerSecond, r.preprocess.avgMs, r.inference.avgMs, r.inference.p95Ms,
+                      r.decode.avgMs, r.nms.avgMs);
+    }
+    std::cout << line << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage();
+        return 1;
+    }
+
+    // Frames
+    if (opts.frameFiles.empty() && fs::is_directory("bench/frames")) {
+        for (const auto& entry : fs::directory_iterator("bench/frames")) {
+            if (entry.path().extension() == ".bgra") opts.frameFiles.push_back(entry.path().string());
+        }
+        std::sort(opts.frameFiles.begin(), opts.frameFiles.end());
+    }
+    std::vector<FrameSet> sets;
+    for (const auto& file : opts.frameFiles) {
+        FrameSet set;
+        if (loadFrames(file, set)) sets.push_back(std::move(set));
+    }
+    if (sets.empty()) {
+        std::cerr << "[bench] No recorded frames (run bench/record_frames.sh), using a synthetic frame" << std::endl;
+        sets.push_back(syntheticFrames());
+    }
+
+    std::vector<Result> results;
+    for (const ModelSpec& spec : kModels) {
+        if (!opts.models.empty() &&
+            std::find(opts.models.begin(), opts.models.end(), spec.name) == opts.models.end()) {
+            continue;
+        }
+        if (!fs::exists(spec.path)) {
+            std::cerr << "[bench] Model not found (run from the repository root): " << spec.path << std::endl;
+            continue;
+        }
+
+        for (ExecutionProvider ep : opts.providers) {
+            for (int threads : opts.threads) {
+                for (int batch : opts.batches) {
+                    Result result;
+                    result.model = spec.name;
+                    result.requested = ep;
+                    result.threads = threads;
+                    result.batch = batch;
+
+                    if (spec.kind == ModelKind::Face) {
+                        runConfig<FaceDetector>(spec, opts, sets, ep, threads, batch, result);
+                    } else {
+                        runConfig<PoseDetector>(spec, opts, sets, ep, threads, batch, result);
+                    }
+                    printResult(result);
+                    results.push_back(std::move(result));
+                }
+            }
+        }
+    }
+
+    if (!writeJson(opts.out, opts, sets, results)) return 1;
+    std::cout << "[bench] Results written to " << opts.out << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Shared by the bench tools (vivid-onnx-bench, vivid-onnx-batch): bundled
+// model table, option parsing and the raw frame naming of record_frames.sh
+
+#pragma once
+
+#include <vivid/onnx/onnx.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace vivid::onnx::bench {
+
+inline double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+enum class ModelKind { Face, Pose };
+
+struct ModelSpec {
+    const char* name;
+    const char* path;
+    ModelKind kind;
+};
+
+inline const ModelSpec kModels[] = {
+    {"blazeface", "assets/models/blazeface/face_detection_front_128x128_float32.onnx", ModelKind::Face},
+    {"movenet-singlepose", "assets/models/movenet/singlepose-lightning.onnx", ModelKind::Pose},
+    {"movenet-multipose", "assets/models/movenet/multipose-lightning.onnx", ModelKind::Pose},
+};
+
+inline const ModelSpec* findModel(const std::string& name) {
+    for (const ModelSpec& spec : kModels) {
+        if (name == spec.name) return &spec;
+    }
+    return nullptr;
+}
+
+inline std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+inline bool parseProvider(std::string name, ExecutionProvider& ep) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (name == "cpu") ep = ExecutionProvider::CPU;
+    else if (name == "cuda") ep = ExecutionProvider::CUDA;
+    else if (name == "tensorrt") ep = ExecutionProvider::TensorRT;
+    else if (name == "directml") ep = ExecutionProvider::DirectML;
+    else if (name == "coreml") ep = ExecutionProvider::CoreML;
+    else return false;
+    return true;
+}
+
+/// "<width>x<height>"
+inline bool parseSize(const std::string& text, int& width, int& height) {
+    return std::sscanf(text.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+/// Frame size from a record_frames.sh name: <name>_<width>x<height>.bgra
+inline bool frameSizeFromName(const std::string& stem, std::string& name, int& width, int& height) {
+    size_t sep = stem.rfind('_');
+    if (sep == std::string::npos || !parseSize(stem.substr(sep + 1), width, height)) return false;
+    name = stem.substr(0, sep);
+    return true;
+}
+
+} // namespace vivid::onnx::bench
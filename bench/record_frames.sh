@@ -0,0 +1,31 @@
+#!/bin/sh
+# Decode the example videos into raw BGRA frames for vivid-onnx-bench.
+#
+# Usage (from the repository root, needs ffmpeg/ffprobe):
+#   bench/record_frames.sh [frames] [width]
+#
+# Writes bench/frames/<video>_<width>x<height>.bgra (default 120 frames,
+# 640 wide, aspect ratio kept).
+
+set -e
+
+COUNT=${1:-120}
+WIDTH=${2:-640}
+OUT=bench/frames
+
+mkdir -p "$OUT"
+
+for VIDEO in \
+    examples/pose-tracking/assets/prom.mp4 \
+    examples/face-detection/assets/dance.mp4 \
+    examples/face-detection/assets/face-demographics.mp4
+do
+    NAME=$(basename "$VIDEO" .mp4)
+    HEIGHT=$(ffprobe -v error -select_streams v:0 -show_entries stream=width,height -of csv=p=0 "$VIDEO" |
+             awk -F, -v w="$WIDTH" '{ printf "%d", int($2 * w / $1 / 2) * 2 }')
+    FILE="$OUT/${NAME}_${WIDTH}x${HEIGHT}.bgra"
+
+    ffmpeg -v error -y -i "$VIDEO" -frames:v "$COUNT" -vf "scale=${WIDTH}:${HEIGHT}" \
+           -pix_fmt bgra -f rawvideo "$FILE"
+    echo "$FILE"
+done
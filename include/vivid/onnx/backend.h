@@ -0,0 +1,145 @@
+// InferenceBackend - Session creation, tensor binding and Run
+//
+// ONNXModel does preprocessing, scheduling, batching and the async pipeline;
+// everything that talks to an inference runtime sits behind this interface,
+// so operators (PoseDetector, FaceDetector, ...) run unchanged on any of them.
+//
+//   OnnxBackend      ONNX Runtime with execution providers (default, onnx_backend.h)
+//   TensorRTBackend  TensorRT engines with FP16 and CUDA graphs
+//                    (VIVID_ONNX_TENSORRT=ON, tensorrt_backend.h)
+//
+// Usage:
+//   pose.backend(BackendType::TensorRT);   // before init(); falls back to ONNX Runtime
+//   pose.activeBackend();                  // "TensorRT" once loaded
+//
+// Backends work on Tensor storage directly: run() reads the inputs in place
+// and writes Float32 outputs (converting other output types), resizing them
+// to the real output shapes. Per-buffer-set state such as bindings is kept
+// by storage address, so steady-state runs neither allocate nor rebind.
+
+#pragma once
+
+#include "tensor.h"
+#include "model_buffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// Hardware backends ONNX Runtime can run a model on
+enum class ExecutionProvider {
+    CPU = 0,
+    CUDA = 1,       // NVIDIA GPUs (Linux/Windows, GPU package)
+    TensorRT = 2,   // NVIDIA TensorRT (GPU package), falls back to CUDA per node
+    DirectML = 3,   // Any DX12 GPU (Windows, DirectML package)
+    CoreML = 4      // Apple Neural Engine / GPU (macOS)
+};
+
+/// Human-readable provider name ("CPU", "CUDA", ...)
+const char* executionProviderName(ExecutionProvider ep);
+
+/// ONNX Runtime thread pool settings (per session, or for the global pool)
+struct ThreadPoolOptions {
+    int intraOpThreads = 0;     // threads per op, including the caller (0 = one per core)
+    int interOpThreads = 0;     // > 1 runs independent graph branches in parallel (0 = default)
+    bool allowSpinning = true;  // busy-wait for work: lower latency, higher CPU use
+
+    /// Intra-op core affinity in ONNX Runtime's format: one entry per pool
+    /// thread (intraOpThreads - 1), separated by ';', each a comma list or
+    /// range of 1-based logical processors, e.g. "3;4" or "5,6;7-8".
+    /// Empty leaves placement to the OS.
+    std::string affinity;
+};
+
+/// Inference runtimes
+enum class BackendType {
+    OnnxRuntime = 0,
+    TensorRT = 1     // needs a VIVID_ONNX_TENSORRT build
+};
+
+/// "ONNX Runtime", "TensorRT"
+const char* backendTypeName(BackendType type);
+
+/// True if this build includes the backend
+bool isBackendAvailable(BackendType type);
+
+/// Model input or output as the runtime reports it
+struct TensorInfo {
+    std::string name;
+    std::vector<int64_t> shape;   // dynamic dimensions are -1
+    TensorType type = TensorType::Float32;
+    bool supported = true;        // false: element type has no TensorType
+};
+
+/// What ONNXModel asks a backend to load
+struct BackendConfig {
+    std::string modelPath;
+    std::shared_ptr<ModelBuffer> modelData;   // loaded instead of modelPath when set
+    bool memoryMap = false;
+    std::string externalDataPath;
+
+    /// Provider for this attempt (ONNXModel tries its priority list in order)
+    ExecutionProvider provider = ExecutionProvider::CPU;
+
+    bool sharedSession = true;
+    bool modelCache = true;
+    ThreadPoolOptions threading;
+    bool globalThreadPool = false;
+
+    /// Runtime profiler for the first profileFrames runs (0 = off)
+    int profileFrames = 0;
+    std::string profilePrefix;
+
+    /// Pool for tensors the backend allocates
+    std::shared_ptr<TensorPool> tensorPool;
+};
+
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    /// Build a session for config. Returns false (after logging why) so the
+    /// caller can try the next provider; never throws.
+    virtual bool load(const BackendConfig& config) = 0;
+
+    /// Release the session (idle sessions may stay cached for hot reload)
+    virtual void unload() = 0;
+
+    virtual bool isLoaded() const = 0;
+
+    /// Provider the session runs on (valid after load())
+    virtual ExecutionProvider provider() const = 0;
+
+    /// Model I/O (valid after load())
+    virtual const std::vector<TensorInfo>& inputs() const = 0;
+    virtual const std::vector<TensorInfo>& outputs() const = 0;
+
+    /// One inference on inputs into outputs (one per model output). Runs on
+    /// different buffer sets may overlap (async pipeline); false on errors.
+    virtual bool run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) = 0;
+
+    /// Keep per-buffer-set state for up to count buffer sets and input
+    /// shapes (only called while no run is in flight)
+    virtual void reserveBindings(size_t count) {}
+
+    /// Forget all per-buffer-set state
+    virtual void resetBindings() {}
+
+    /// True if load() honours BackendConfig::provider (ONNXModel then tries
+    /// its whole priority list; other backends get one attempt)
+    virtual bool usesExecutionProviders() const { return false; }
+
+    /// True if load() used a cached optimized model or engine
+    virtual bool loadedFromCache() const { return false; }
+
+    /// End the profiling window; returns the trace written (empty if none)
+    virtual std::string endProfiling() { return {}; }
+};
+
+/// New backend of type (nullptr if this build doesn't include it)
+std::unique_ptr<InferenceBackend> createBackend(BackendType type);
+
+} // namespace vivid::onnx
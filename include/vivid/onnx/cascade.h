@@ -0,0 +1,136 @@
+// RoiCascade - Secondary model run on each detection of an upstream detector
+//
+// Crops every box a FaceDetector or PoseDetector found straight from the
+// detector's source into this model's input size, so the full frame is only
+// resampled once (by the detector) and secondary cost scales with the number
+// of detections. On models with a dynamic batch dimension all crops run in
+// one [N, ...] Session::Run; fixed-batch models run once per crop.
+//
+// Usage:
+//   auto& faces = chain.add<FaceDetector>("faces");
+//   faces.input(&webcam).model("assets/models/blazeface/face_detection_front.onnx");
+//
+//   auto& emotion = chain.add<RoiCascade>("emotion");   // after the detector
+//   emotion.from(&faces).model("assets/models/emotion.onnx").roiScale(1.2f);
+//
+//   for (const RoiResult& r : emotion.rois()) {
+//       const Tensor& scores = r.outputs[0];   // this face's output
+//       // r.detection indexes faces.faces(r.source), r.id is its track id
+//   }
+//
+// Crops come from the source's CPU pixels when it has them (already decoded
+// for the detector), otherwise from its texture. Boxes are scaled around
+// their center by roiScale() and squared in source pixels; crops may extend
+// past the frame edges. Frames without detections skip inference and clear
+// rois(). Results of frames the run policy skips stay those of the last run.
+//
+// Fixed-batch models run the crops after the first from processOutputTensor(),
+// synchronously even with async(true); their run time counts as postprocess.
+// With async(true) results belong to the detections of the frame they were
+// prepared on.
+
+#pragma once
+
+#include "onnx_model.h"
+#include <deque>
+#include <vector>
+
+namespace vivid::onnx {
+
+class FaceDetector;
+class PoseDetector;
+
+/// Secondary model results for one detection
+struct RoiResult {
+    /// Index into the upstream detector's results for `source`
+    size_t detection = 0;
+    size_t source = 0;
+
+    /// Upstream track ID (-1 without smoothing)
+    int id = -1;
+
+    /// Source rect (normalized) the crop spans, including the aspect mode
+    SourceRect region;
+
+    /// This detection's slice of every model output
+    std::vector<Tensor> outputs;
+};
+
+class RoiCascade : public ONNXModel {
+public:
+    RoiCascade();
+    ~RoiCascade() override;
+
+    // Configuration
+    RoiCascade& model(const std::string& path);
+
+    /// Upstream detector whose boxes are cropped (must process first)
+    RoiCascade& from(FaceDetector* detector);
+    RoiCascade& from(PoseDetector* detector);
+
+    /// Box scale around its center (default 1.0, e.g. 1.5 for context)
+    RoiCascade& roiScale(float scale);
+
+    /// Square crops in source pixels (default on)
+    RoiCascade& squareRois(bool enabled);
+
+    /// Most detections processed per frame (default 8)
+    RoiCascade& maxRois(int max);
+
+    // Results (valid after process())
+    const std::vector<RoiResult>& rois() const { return m_results; }
+    size_t roiCount() const { return m_results.size(); }
+
+    /// Crop region for a normalized box (x, y, width, height) of a
+    /// sourceWidth x sourceHeight frame (0 sizes: no squaring)
+    SourceRect roiRegion(float x, float y, float width, float height,
+                         int sourceWidth, int sourceHeight) const;
+
+    // Operator interface
+    std::string name() const override { return "RoiCascade"; }
+    void process(Context& ctx) override;
+
+protected:
+    void prepareInputTensor(Context& ctx, Tensor& tensor) override;
+    void processOutputTensor(const Tensor& tensor) override;
+
+    /// Crop one box into a single-item input tensor
+    bool cropToTensor(Context& ctx, const SourceRect& box, Tensor& tensor, SourceRect& region);
+
+    /// Boxes to crop this frame
+    struct Roi {
+        size_t detection = 0;
+        size_t source = 0;
+        int id = -1;
+        SourceRect box;      // detection box (normalized)
+        SourceRect region;   // crop actually sampled
+    };
+    std::vector<Roi> m_pending;     // collected this frame
+
+    /// A prepared frame's ROIs and crops, until its outputs are processed
+    /// (several are in flight with async(true).pipelineDepth(n))
+    struct Submission {
+        int64_t frame = -1;
+        std::vector<Roi> rois;
+        std::vector<Tensor> crops;   // packed into the batch, or run one by one
+    };
+    std::deque<Submission> m_submitted;
+
+private:
+    void collectRois();
+
+    // Copy batch item `item` of the outputs into m_results[index]
+    void storeOutputs(const Roi& roi, size_t index, size_t item, int64_t batchSize);
+
+    FaceDetector* m_faceDetector = nullptr;
+    PoseDetector* m_poseDetector = nullptr;
+    std::vector<Operator*> m_sources;
+
+    float m_roiScale = 1.0f;
+    bool m_squareRois = true;
+    int m_maxRois = 8;
+
+    std::vector<RoiResult> m_results;
+};
+
+} // namespace vivid::onnx
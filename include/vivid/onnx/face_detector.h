@@ -15,10 +15,15 @@
 //           glm::vec2 nose = faces.landmark(i, FaceLandmark::Nose);
 //       }
 //   }
+//
+// NMS modes, smoothing, several cameras and replay are described in
+// README.md.
 
 #pragma once
 
 #include "onnx_model.h"
+#include "nms.h"
+#include "tracker.h"
 #include <glm/glm.hpp>
 #include <array>
 #include <vector>
@@ -46,6 +51,9 @@ struct DetectedFace {
 
     /// Detection confidence (0-1)
     float confidence;
+
+    /// Track ID, stable across frames while smoothing() is on (else -1)
+    int id = -1;
 };
 
 class FaceDetector : public ONNXModel {
@@ -55,9 +63,16 @@ public:
 
     // Configuration
     FaceDetector& input(Operator* op);
+    FaceDetector& inputs(const std::vector<Operator*>& ops);
     FaceDetector& model(const std::string& path);
     FaceDetector& confidenceThreshold(float threshold);
     FaceDetector& maxFaces(int max);
+    FaceDetector& nmsMode(NmsMode mode);
+    FaceDetector& iouThreshold(float threshold);
+
+    /// Track faces across frames: stable IDs, One-Euro smoothed boxes and
+    /// landmarks (default off)
+    FaceDetector& smoothing(bool enabled);
 
     // Detection results
     bool detected() const { return !m_faces.empty(); }
@@ -79,6 +94,9 @@ public:
     /// Get all detected faces
     const std::vector<DetectedFace>& faces() const { return m_faces; }
 
+    /// Faces detected in one source (see inputs())
+    const std::vector<DetectedFace>& faces(size_t source) const;
+
     // Operator interface
     std::string name() const override { return "FaceDetector"; }
 
@@ -86,25 +104,60 @@ protected:
     void onModelLoaded() override;
     void prepareInputTensor(Context& ctx, Tensor& tensor) override;
     void processOutputTensor(const Tensor& tensor) override;
+    void onInferenceSkipped() override;
+
+    // Track files: landmarks as 6 x (x, y)
+    int trackValueCount() const override { return 12; }
+    void appendTrackDetections(TrackFrame& frame) const override;
+    void applyTrackDetections(const TrackFrame& frame) override;
 
 private:
-    void decodeDetections(const float* regressors, const float* scores,
-                          int numAnchors);
+    // Anchor whose raw score passed the threshold (decoded after ranking)
+    struct Candidate {
+        float logit;
+        int anchor;
+        const float* box;
+    };
+
+    void decodeOutputs(const Tensor& tensor);
+
+    // Smooth and store the current source's m_faces (decoded or replayed)
+    void finishSource();
+    void collectCandidates(const float* regressors, int regressorStride,
+                           const float* scores, int scoreStride,
+                           int firstAnchor, int count);
+    void decodeCandidates();
     void nonMaxSuppression();
+    void mapToSource();
+    void trackFaces(DetectionTracker& tracker);
+    static void applyTracks(std::vector<DetectedFace>& faces, const DetectionTracker& tracker);
 
     float m_confidenceThreshold = 0.5f;
+    float m_logitThreshold = 0.0f;  // inverse sigmoid of m_confidenceThreshold
     int m_maxFaces = 10;
 
-    // Detected faces
+    // Detected faces (source 0, or the source being decoded)
     std::vector<DetectedFace> m_faces;
 
+    // Per-source results when several inputs are set
+    std::vector<std::vector<DetectedFace>> m_sourceFaces;
+
     // Model input size (BlazeFace uses 128x128)
     int m_inputWidth = 128;
     int m_inputHeight = 128;
 
-    // Anchor configuration for BlazeFace
-    std::vector<std::array<float, 4>> m_anchors;
+    // BlazeFace anchor centers (SoA; anchor sizes are fixed at 1)
+    std::vector<float> m_anchorX;
+    std::vector<float> m_anchorY;
     void generateAnchors();
+
+    // Decode scratch, reused across frames
+    std::vector<Candidate> m_candidates;
+    NonMaxSuppression m_nms;
+
+    // Smoothing: one tracker per source
+    bool m_smoothing = false;
+    std::vector<DetectionTracker> m_trackers;
 };
 
 } // namespace vivid::onnx
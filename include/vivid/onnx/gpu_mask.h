@@ -0,0 +1,85 @@
+// GpuMask - Segmentation mask to texture on the GPU
+//
+// Counterpart of GpuResampler for model outputs: uploads a model-resolution
+// float mask (e.g. 256x256, one queue write) and expands it into an RGBA8
+// storage texture in a compute shader, so a full-size mask never exists on
+// the CPU. The mask covers a source rect (ONNXModel::inputRegion(), which
+// includes letterboxing); texels outside it are 0.
+//
+// With a guide texture (the frame the mask was computed from) the upsample
+// is a joint bilateral filter: neighbouring mask texels are weighted by
+// distance and by how close their guide color is to the output pixel's, so
+// edges snap to the full-resolution frame instead of the mask's blocks.
+// Without one the mask is sampled bilinearly.
+//
+// Usage:
+//   GpuMaskUpsampler gpu;
+//   gpu.upload(device, queue, mask.data(), 256, 256);     // on new results
+//   gpu.render(device, queue, 1920, 1080, region, camera.outputView(), filter);
+//   WGPUTextureView view = gpu.view();                     // mask in r, g, b and a
+
+#pragma once
+
+#include "preprocess.h"
+#include <webgpu/webgpu.h>
+#include <memory>
+
+namespace vivid::onnx {
+
+/// How mask values become texel values
+struct MaskFilter {
+    /// 0: soft mask (probabilities); otherwise edge center for a smoothstep
+    float threshold = 0.0f;
+    /// Width of the smoothstep around threshold (mask units)
+    float softness = 0.1f;
+
+    /// Joint bilateral upsampling (needs a guide texture)
+    bool bilateral = true;
+    /// Spatial falloff in mask texels (neighbourhood radius is 2 sigma, at most 4)
+    float spatialSigma = 1.0f;
+    /// Guide color falloff (RGB distance, 0-1)
+    float rangeSigma = 0.1f;
+};
+
+class GpuMaskUpsampler {
+public:
+    GpuMaskUpsampler();
+    ~GpuMaskUpsampler();
+
+    GpuMaskUpsampler(const GpuMaskUpsampler&) = delete;
+    GpuMaskUpsampler& operator=(const GpuMaskUpsampler&) = delete;
+
+    /// Copy a row-major width x height mask to the GPU (kept until the next upload)
+    bool upload(WGPUDevice device, WGPUQueue queue, const float* mask, int width, int height);
+
+    /// Write the uploaded mask into the outputWidth x outputHeight texture.
+    /// region is the source rect the mask covers; guide may be null.
+    /// Returns false if the GPU path is unavailable.
+    bool render(WGPUDevice device, WGPUQueue queue, int outputWidth, int outputHeight,
+                const SourceRect& region, WGPUTextureView guide, const MaskFilter& filter);
+
+    /// Texture written by the last successful render() (null before)
+    WGPUTextureView view() const;
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /// True once pipeline creation has failed on this device (no retries)
+    bool failed() const { return m_failed; }
+
+    /// Release all GPU objects (call before the device is destroyed)
+    void release();
+
+private:
+    struct Resources;
+    bool createPipelines(WGPUDevice device);
+
+    std::unique_ptr<Resources> m_gpu;
+    WGPUDevice m_device = nullptr;
+    bool m_failed = false;
+    int m_maskWidth = 0;
+    int m_maskHeight = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,66 @@
+// GpuPreprocess - Texture to tensor on the GPU
+//
+// WebGPU compute-shader counterpart of ImageResampler. Samples the input
+// texture bilinearly at tensor resolution, applies the same per-channel
+// normalization and NHWC/NCHW layout, and reads back only the tensor-sized
+// result (e.g. 192x192x3 floats instead of a full 1080p RGBA frame).
+//
+// An optional source region crops before resizing. The aspect mode maps it
+// like ImageResampler: Fit letterboxes the whole region and pads the rest
+// with black (normalized), Fill center-crops it to the tensor's aspect.
+//
+// Usage:
+//   GpuResampler gpu;
+//   if (!gpu.resample(ctx.device(), ctx.queue(), op->outputView(),
+//                     tensor, 192, 192, Normalization::raw())) {
+//       // fall back to ImageResampler on cpuPixels()
+//   }
+
+#pragma once
+
+#include "tensor.h"
+#include "preprocess.h"
+#include <webgpu/webgpu.h>
+#include <memory>
+
+namespace vivid::onnx {
+
+class GpuResampler {
+public:
+    GpuResampler();
+    ~GpuResampler();
+
+    GpuResampler(const GpuResampler&) = delete;
+    GpuResampler& operator=(const GpuResampler&) = delete;
+
+    /// Resample a texture into tensor (shape, type and storage must already
+    /// match targetWidth x targetHeight). Blocks until the readback is done.
+    /// Returns false if the GPU path is unavailable; the caller should fall
+    /// back to the CPU path.
+    bool resample(WGPUDevice device, WGPUQueue queue, WGPUTextureView source,
+                  Tensor& tensor, int targetWidth, int targetHeight,
+                  const Normalization& norm = Normalization::unit(),
+                  const SourceRect& region = SourceRect{},
+                  AspectMode aspect = AspectMode::Stretch);
+
+    /// Size of the texture sampled by the last successful resample()
+    int sourceWidth() const { return m_sourceWidth; }
+    int sourceHeight() const { return m_sourceHeight; }
+
+    /// True once pipeline creation or a readback has failed on this device
+    /// (no retries)
+    bool failed() const { return m_failed; }
+
+    /// Release all GPU objects (call before the device is destroyed)
+    void release();
+
+private:
+    struct Resources;
+    std::unique_ptr<Resources> m_gpu;
+    WGPUDevice m_device = nullptr;
+    bool m_failed = false;
+    int m_sourceWidth = 0;
+    int m_sourceHeight = 0;
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,52 @@
+// ModelBuffer - Model bytes in memory
+//
+// A read-only memory-mapped model file, or memory the caller owns. ONNXModel
+// builds sessions from it instead of a path (see ONNXModel::memoryMap() and
+// modelData()): mapped pages come from the page cache, so they are shared
+// between processes and nothing is read into a private buffer first. ORT
+// format models (.ort) use the bytes in place for their initializers, which
+// keeps the weights out of the heap altogether.
+//
+// Usage:
+//   auto bytes = ModelBuffer::map("assets/models/movenet/multipose-lightning.onnx");
+//   if (bytes) { bytes->data(); bytes->size(); }
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace vivid::onnx {
+
+class ModelBuffer {
+public:
+    /// Map a file read-only (nullptr if it can't be opened or is empty)
+    static std::shared_ptr<ModelBuffer> map(const std::string& path);
+
+    /// Wrap caller memory (not copied; must outlive every session built from it)
+    static std::shared_ptr<ModelBuffer> wrap(const void* data, size_t size);
+
+    ~ModelBuffer();
+    ModelBuffer(const ModelBuffer&) = delete;
+    ModelBuffer& operator=(const ModelBuffer&) = delete;
+
+    const void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isMapped() const { return m_mapped; }
+
+    /// True for ORT format models (flatbuffer identifier "ORTM")
+    bool isOrtFormat() const;
+
+private:
+    ModelBuffer() = default;
+
+    const void* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;
+#ifdef _WIN32
+    void* m_mapping = nullptr;   // HANDLE of the file mapping
+#endif
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,41 @@
+// ModelCache - On-disk cache of optimized models
+//
+// ONNXModel saves the graph ONNX Runtime produces at the extended
+// optimization level and loads it on the next start, skipping those
+// passes. Only the layout transforms of the full level, which depend on
+// the CPU/GPU, run at load, so an entry copied with an assets folder to
+// another machine is still correct there. Entries are keyed by the model's
+// content hash, the ONNX Runtime version and the execution provider, so
+// editing the model, upgrading ORT or switching providers never picks up
+// a stale graph.
+//
+// Cache files live in a ".vivid-onnx-cache" directory next to the model
+// (i.e. inside the AssetLoader search path it was resolved from), or in
+// the system temp directory when that isn't writable. Deleting the
+// directory is always safe.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace vivid::onnx {
+
+/// 64-bit FNV-1a hash of a file's contents (0 if it can't be read)
+uint64_t hashModelFile(const std::string& path);
+
+/// The same hash over a model held in memory
+uint64_t hashModelBytes(const void* data, size_t size);
+
+/// Cache key: "<model stem>-<content hash>-ort<version>-<provider>-ext"
+/// Returns an empty string if the model can't be read.
+std::string modelCacheKey(const std::string& modelPath, const std::string& ortVersion,
+                          const std::string& provider);
+
+/// Directory for cached artifacts of modelPath, created if needed
+/// (empty path if neither location is writable)
+std::filesystem::path modelCacheDirectory(const std::string& modelPath);
+
+} // namespace vivid::onnx
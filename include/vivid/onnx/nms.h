@@ -0,0 +1,108 @@
+// NMS - Non-maximum suppression for detector outputs
+//
+// Shared by the detectors: boxes are stored as SoA arrays and IoU is
+// computed four boxes at a time (SSE2/NEON). Three modes:
+//   Greedy   - keep the best box, drop everything overlapping it
+//   Weighted - BlazeFace-style: blend each overlapping cluster into one box,
+//              weighted by score (steadier boxes and landmarks)
+//   Soft     - Gaussian Soft-NMS: decay overlapping scores instead of
+//              dropping them, then drop those below minScore()
+//
+// Optional per-box attributes (landmarks, keypoints) travel with the box
+// and are blended too in Weighted mode.
+//
+// Usage:
+//   NonMaxSuppression nms;
+//   nms.mode(NmsMode::Weighted).iouThreshold(0.3f).attributeCount(12);
+//   nms.clear();
+//   for (...) nms.add(bbox, score, landmarks);
+//   for (size_t i = 0, n = nms.run(maxFaces); i < n; i++) {
+//       nms.box(i); nms.score(i); nms.attributes(i);
+//   }
+//
+// Buffers are reused across frames; steady-state run() does not allocate.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::onnx {
+
+enum class NmsMode {
+    Greedy = 0,
+    Weighted = 1,
+    Soft = 2
+};
+
+class NonMaxSuppression {
+public:
+    // Configuration
+    NonMaxSuppression& mode(NmsMode mode);
+    NonMaxSuppression& iouThreshold(float threshold);
+    NonMaxSuppression& softSigma(float sigma);
+    NonMaxSuppression& minScore(float score);
+    NonMaxSuppression& attributeCount(int count);
+
+    NmsMode mode() const { return m_mode; }
+    float iouThreshold() const { return m_iouThreshold; }
+
+    /// Remove all boxes (keeps buffer capacity)
+    void clear();
+
+    /// Add a box (x, y, width, height) with its score and, if
+    /// attributeCount() > 0, that many attribute values
+    void add(const glm::vec4& box, float score, const float* attributes = nullptr);
+
+    size_t size() const { return m_score.size(); }
+
+    /// Suppress and keep at most maxResults boxes, best first
+    size_t run(size_t maxResults);
+
+    // Results of the last run()
+    size_t resultCount() const { return m_resultScore.size(); }
+    const glm::vec4& box(size_t result) const { return m_resultBox[result]; }
+    float score(size_t result) const { return m_resultScore[result]; }
+    /// Index (in add() order) of the box a result came from
+    int sourceIndex(size_t result) const { return m_resultIndex[result]; }
+    const float* attributes(size_t result) const;
+
+    /// Intersection over union of two x, y, width, height boxes
+    static float iou(const glm::vec4& a, const glm::vec4& b);
+
+private:
+    void sortByScore();
+    void computeIou(size_t ref, size_t begin, size_t end);
+    void keep(size_t sorted, const glm::vec4& box, float score);
+
+    size_t runGreedy(size_t maxResults);
+    size_t runWeighted(size_t maxResults);
+    size_t runSoft(size_t maxResults);
+
+    NmsMode m_mode = NmsMode::Greedy;
+    float m_iouThreshold = 0.3f;
+    float m_softSigma = 0.5f;
+    float m_minScore = 0.001f;
+    int m_attributeCount = 0;
+
+    // Input, in add() order
+    std::vector<glm::vec4> m_box;
+    std::vector<float> m_score;
+    std::vector<float> m_attributes;
+
+    // Working set sorted by score (SoA corners and areas)
+    std::vector<int> m_order;
+    std::vector<float> m_x1, m_y1, m_x2, m_y2, m_area, m_sortedScore;
+    std::vector<uint8_t> m_alive;
+    std::vector<float> m_iou;
+
+    // Results
+    std::vector<glm::vec4> m_resultBox;
+    std::vector<float> m_resultScore;
+    std::vector<int> m_resultIndex;
+    std::vector<float> m_resultAttributes;
+};
+
+} // namespace vivid::onnx
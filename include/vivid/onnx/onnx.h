@@ -5,6 +5,12 @@
 //   ONNXModel     - Generic ONNX model inference
 //   PoseDetector  - MoveNet body tracking (17 keypoints)
 //   FaceDetector  - BlazeFace face detection (6 landmarks)
+//   RoiCascade    - Secondary model on each detection's crop
+//   SegmentMask   - Background/person segmentation to a mask texture
+//
+// Shared scheduling across models: InferenceScheduler (scheduler.h)
+// Backends (backend.h): ONNX Runtime (default), TensorRT (VIVID_ONNX_TENSORRT)
+// Recorded results for offline runs and replay: track_file.h
 //
 // Usage:
 //   #include <vivid/onnx/onnx.h>
@@ -12,6 +18,9 @@
 
 #pragma once
 
+#include "backend.h"
 #include "onnx_model.h"
 #include "pose_detector.h"
 #include "face_detector.h"
+#include "cascade.h"
+#include "segment_mask.h"
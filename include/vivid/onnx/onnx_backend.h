@@ -0,0 +1,69 @@
+// OnnxBackend - ONNX Runtime inference backend
+//
+// The default InferenceBackend (see backend.h). Sessions are created on one
+// process-wide Ort::Env and shared through a cache keyed by model and session
+// options; execution providers, thread pools, the optimized-model cache and
+// in-memory models are configured from BackendConfig. Inputs and outputs are
+// bound once per buffer set with Ort::IoBinding.
+//
+// Usage (ONNXModel does this in load()):
+//   OnnxBackend backend;
+//   BackendConfig config;
+//   config.modelPath = "assets/models/movenet/singlepose-lightning.onnx";
+//   if (backend.load(config)) backend.run(inputs, outputs);
+
+#pragma once
+
+#include "backend.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vivid::onnx {
+
+class OnnxBackend : public InferenceBackend {
+public:
+    OnnxBackend();
+    ~OnnxBackend() override;
+
+    const char* name() const override { return "ONNX Runtime"; }
+    bool load(const BackendConfig& config) override;
+    void unload() override;
+    bool isLoaded() const override;
+    ExecutionProvider provider() const override { return m_provider; }
+    const std::vector<TensorInfo>& inputs() const override { return m_inputs; }
+    const std::vector<TensorInfo>& outputs() const override { return m_outputs; }
+    bool run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) override;
+    void reserveBindings(size_t count) override;
+    void resetBindings() override;
+    bool usesExecutionProviders() const override { return true; }
+    bool loadedFromCache() const override { return m_loadedFromCache; }
+    std::string endProfiling() override;
+
+    /// True if the linked ONNX Runtime package includes the provider
+    static bool isProviderAvailable(ExecutionProvider ep);
+
+    /// Set up the process-wide pool (false once the runtime has started)
+    static bool configureGlobalThreadPool(const ThreadPoolOptions& options);
+
+    /// Destroy cached sessions nothing is using
+    static void clearSessionCache();
+    static size_t cachedSessionCount();
+
+private:
+    bool createSession(const BackendConfig& config, bool retryWithoutCache = false);
+    void readModelInfo();
+
+    // ONNX Runtime objects (pimpl to keep ORT headers out)
+    struct OrtObjects;
+    std::unique_ptr<OrtObjects> m_ort;
+
+    ExecutionProvider m_provider = ExecutionProvider::CPU;
+    std::vector<TensorInfo> m_inputs;
+    std::vector<TensorInfo> m_outputs;
+    std::shared_ptr<TensorPool> m_tensorPool;
+    bool m_loadedFromCache = false;
+    bool m_profiling = false;
+};
+
+} // namespace vivid::onnx
@@ -12,50 +12,45 @@
 //   // Access output tensor
 //   auto& model = chain.get<ONNXModel>("model");
 //   auto output = model.outputTensor(0);
+//
+// Providers, async pipelines, batched inputs, scheduling, preloading,
+// replay and profiling are described in README.md.
 
 #pragma once
 
+#include "backend.h"
+#include "tensor.h"
+#include "model_buffer.h"
+#include "preprocess.h"
+#include "gpu_preprocess.h"
+#include "run_policy.h"
+#include "scheduler.h"
+#include "stats.h"
+#include "track_file.h"
 #include <vivid/operator.h>
 #include <vivid/io/image_loader.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
-// Forward declarations for ONNX Runtime
-namespace Ort {
-    struct Env;
-    struct Session;
-    struct SessionOptions;
-    struct MemoryInfo;
-    struct Value;
-}
-
 namespace vivid::onnx {
 
-/// ONNX tensor element types (subset we support)
-enum class TensorType {
-    Float32 = 0,
-    UInt8 = 1,
-    Int32 = 2
-};
-
-/// Tensor data wrapper for model I/O
-struct Tensor {
-    std::vector<float> data;       // For float32 tensors
-    std::vector<uint8_t> dataU8;   // For uint8 tensors
-    std::vector<int32_t> dataI32;  // For int32 tensors
-    std::vector<int64_t> shape;    // e.g., {1, 3, 224, 224} for NCHW
-    TensorType type = TensorType::Float32;
-
-    /// Get total number of elements
-    size_t size() const;
-
-    /// Get value at index (float tensors only)
-    float& operator[](size_t i) { return data[i]; }
-    const float& operator[](size_t i) const { return data[i]; }
-
-    /// Reshape (must have same total elements)
-    void reshape(const std::vector<int64_t>& newShape);
+/// Rolling per-stage timings and frame counters (see ONNXModel::stats())
+struct InferenceStats {
+    StageTiming preprocess;
+    StageTiming run;
+    StageTiming postprocess;
+    StageTiming nms;              // part of postprocess (detectors)
+    uint64_t inferences = 0;
+    uint64_t framesDropped = 0;   // async worker busy
+    uint64_t framesSkipped = 0;   // run policy and scheduler
+    uint64_t framesShed = 0;      // part of framesSkipped: scheduler overload
+    ExecutionProvider provider = ExecutionProvider::CPU;
+    bool gpuPreprocess = false;
 };
 
 class ONNXModel : public Operator {
@@ -67,10 +62,116 @@ public:
     ONNXModel& model(const std::string& path);
     ONNXModel& input(Operator* op);
 
+    /// Load from memory the caller owns instead of a file (not copied; must
+    /// stay valid while the model is loaded). name labels logs and sessions.
+    ONNXModel& modelData(const void* data, size_t size, const std::string& name = "memory");
+
+    /// Build sessions from a read-only mapping of the model file (default off)
+    ONNXModel& memoryMap(bool enabled);
+
+    /// Directory external-data files are loaded from for in-memory models
+    /// (default: the mapped file's directory; needed for modelData())
+    ONNXModel& externalDataPath(const std::string& dir);
+
+    /// Several sources through the same model (batched if the model allows)
+    ONNXModel& inputs(const std::vector<Operator*>& ops);
+
+    /// Inference runtime (default ONNX Runtime; before init())
+    ONNXModel& backend(BackendType type);
+
+    /// Custom runtime (tests, other engines); never falls back
+    ONNXModel& backend(std::unique_ptr<InferenceBackend> backend);
+    BackendType backendType() const { return m_backendType; }
+
+    /// Execution provider priority list (first that loads wins, CPU is the fallback)
+    ONNXModel& executionProvider(ExecutionProvider ep);
+    ONNXModel& executionProvider(const std::vector<ExecutionProvider>& priority);
+
+    /// Share the session with other instances using the same model (default on)
+    ONNXModel& sharedSession(bool enabled);
+
+    /// Cache the optimized graph on disk and load it on the next start (default on)
+    ONNXModel& modelCache(bool enabled);
+
+    /// Thread pool settings for this model's own session
+    ONNXModel& threading(const ThreadPoolOptions& options);
+
+    /// Run on the process-wide pool instead of a per-session pool (default off)
+    ONNXModel& globalThreadPool(bool enabled);
+
+    /// Input pixel normalization for float tensors (default [0, 1])
+    ONNXModel& inputNormalization(const Normalization& norm);
+    const Normalization& inputNormalization() const { return m_inputNormalization; }
+
+    /// How sources with another aspect ratio map onto the input (default
+    /// Stretch); results are remapped to source coordinates either way
+    ONNXModel& aspectMode(AspectMode mode);
+    AspectMode aspectMode() const { return m_aspectMode; }
+
+    /// Run inference on a worker thread instead of inside process()
+    ONNXModel& async(bool enabled);
+
+    /// Frames in flight in async mode (default 1: drop frames while busy)
+    ONNXModel& pipelineDepth(int frames);
+    int pipelineDepth() const { return m_pipelineDepth; }
+
+    /// Run on the process-wide InferenceScheduler pool, competing with other
+    /// scheduled models by priority (implies async; async(false) undoes it)
+    ONNXModel& schedule(int priority, float targetHz = 0.0f, float latencyBudgetMs = 0.0f);
+    ONNXModel& schedule(const SchedulePolicy& policy);
+    bool isScheduled() const { return m_scheduled; }
+    const SchedulePolicy& schedulePolicy() const { return m_schedulePolicy; }
+
+    /// Scheduler counters (zeros until scheduled runs start)
+    ScheduleStats scheduleStats() const;
+
+    /// Write every result to a track file (empty path stops); detectors only
+    ONNXModel& record(const std::string& path, TrackFormat format = TrackFormat::Binary);
+    bool isRecording() const { return !m_recordPath.empty(); }
+
+    /// Apply results from a track file instead of loading and running the
+    /// model (before init(); empty path turns it off)
+    ONNXModel& replay(const std::string& path);
+    bool isReplaying() const { return !m_replayPath.empty(); }
+
+    /// Preprocess the input texture on the GPU when available (default on)
+    ONNXModel& gpuPreprocess(bool enabled);
+
+    // Scheduling (see run_policy.h); conditions combine
+    /// Run at most once every N frames (1 = every frame, the default)
+    ONNXModel& runEvery(int frames);
+    /// Run at most this many times per second (0 = unlimited)
+    ONNXModel& runAtRate(float hz);
+    /// Run only when a source delivers a new frame
+    ONNXModel& runOnNewFrame(bool enabled);
+    /// Run only when a source changed by at least threshold (0-1, 0 = off)
+    ONNXModel& runOnChange(float threshold);
+    ONNXModel& runPolicy(const RunPolicy& policy);
+    const RunPolicy& runPolicy() const { return m_runPolicy; }
+
     // Model info (available after loading)
-    bool isLoaded() const { return m_loaded; }
+    bool isLoaded() const { return m_loaded && !m_preloading; }
     std::string modelPath() const { return m_modelPath; }
 
+    /// Backend the model actually runs on ("ONNX Runtime", "TensorRT", ...)
+    const char* activeBackend() const { return m_backend ? m_backend->name() : "none"; }
+
+    /// Provider the session actually runs on (valid after loading)
+    ExecutionProvider activeExecutionProvider() const { return m_activeProvider; }
+
+    /// True if the session was built from the on-disk optimized-model cache
+    /// (including an entry written by this load)
+    bool loadedFromCache() const { return m_loadedFromCache; }
+
+    /// Number of input sources set with input()/inputs()
+    size_t sourceCount() const { return m_inputOps.size(); }
+
+    /// The sources themselves
+    const std::vector<Operator*>& inputOperators() const { return m_inputOps; }
+
+    /// True if all sources run in one batched Session::Run (dynamic batch models)
+    bool isBatched() const { return m_inputOps.size() > 1 && m_dynamicBatch; }
+
     // Input/output info
     size_t inputCount() const { return m_inputNames.size(); }
     size_t outputCount() const { return m_outputNames.size(); }
@@ -82,6 +183,65 @@ public:
     // Access output tensors (valid after process())
     const Tensor& outputTensor(size_t i = 0) const { return m_outputTensors[i]; }
 
+    /// Pool this model's tensors allocate from
+    const std::shared_ptr<TensorPool>& tensorPool() const { return m_tensorPool; }
+
+    /// True if the last input tensor was produced by the GPU path
+    bool gpuPreprocessActive() const { return m_gpuPreprocessActive; }
+
+    // Result freshness (0 in sync mode unless the run policy skips frames)
+    bool isAsync() const { return m_asyncEnabled; }
+
+    /// Frames since the frame the current results were computed from (-1 if none yet)
+    int64_t resultAgeFrames() const;
+
+    /// Milliseconds since the frame the current results were computed from (-1 if none yet)
+    double resultAgeMs() const;
+
+    /// Frames skipped because the async worker was still busy
+    uint64_t framesDropped() const { return m_framesDropped; }
+
+    /// Frames skipped by the run policy
+    uint64_t framesSkipped() const { return m_framesSkipped; }
+
+    // Timing
+    /// Per-stage timings over the last 120 inferences
+    InferenceStats stats() const;
+    void resetStats();
+
+    /// One line, e.g. "CPU | pre 0.4 ms | run 7.9 ms (p95 9.2) | post 0.1 ms | dropped 0"
+    std::string statsSummary() const;
+
+    /// ORT profile of the first frames runs (0 = off), set before init();
+    /// the trace is written to "<prefix>_<date>.json" (see profileFile())
+    ONNXModel& profiling(int frames, const std::string& prefix = "vivid-onnx-profile");
+
+    /// Trace written by the last profiling() window (empty until it ends)
+    const std::string& profileFile() const { return m_profileFile; }
+
+    // Session cache
+    /// Destroy cached sessions that no instance is currently using
+    static void clearSessionCache();
+    /// Number of sessions in the process-wide cache (in use or idle)
+    static size_t cachedSessionCount();
+
+    // Global thread pool
+    /// Set up the pool shared by globalThreadPool(true) models. Must be called
+    /// before the first model loads; returns false once the runtime has started.
+    static bool configureGlobalThreadPool(const ThreadPoolOptions& options);
+
+    /// Load the model now; init() calls this. Needs no Context, so tools
+    /// (benchmarks, offline jobs) can drive a model without a chain.
+    bool load();
+
+    /// load() and warmup() on a background thread (future = load() result);
+    /// a failed preload is loaded once more by init() or the next process()
+    std::shared_future<bool> preload(int warmupRuns = 3);
+    bool isPreloading() const { return m_preloading; }
+
+    /// Run inferences on placeholder inputs shaped like the model's
+    bool warmup(int runs = 3);
+
     // Operator interface
     std::string name() const override { return "ONNXModel"; }
     void init(Context& ctx) override;
@@ -89,29 +249,115 @@ public:
     void cleanup() override;
 
 protected:
-    // Subclass hooks
+    // Subclass hooks (prepare/process are called once per source)
     virtual void onModelLoaded() {}
     virtual void prepareInputTensor(Context& ctx, Tensor& tensor) {}
     virtual void processOutputTensor(const Tensor& tensor) {}
 
+    /// Called instead of inference on frames the run policy skips
+    virtual void onInferenceSkipped() {}
+
+    // Track files (see track_file.h), called once per source like the hooks
+    // above: values per detection (-1: nothing to record), append the
+    // current source's results, and set them from a recorded frame
+    virtual int trackValueCount() const { return -1; }
+    virtual void appendTrackDetections(TrackFrame& frame) const {}
+    virtual void applyTrackDetections(const TrackFrame& frame) {}
+
+    /// Write the current results as the record of an input frame (process()
+    /// does this while recording; for tools that decode outputs themselves)
+    void recordResults(int64_t frame, double timeMs);
+
+    /// Source the current prepareInputTensor/processOutputTensor call is for
+    size_t currentSource() const { return m_currentSource; }
+
+    /// Frame being prepared, and the frame the outputs being processed were
+    /// prepared on (they differ in async mode)
+    int64_t frameIndex() const { return m_frameCounter; }
+    int64_t resultFrame() const { return m_resultFrame; }
+
     // Helper to run inference
     void runInference();
+    void runInference(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs);
 
-    // Input texture to tensor conversion (via CPU pixels)
+    // Input texture to tensor conversion (GPU compute, falls back to CPU pixels).
+    // region selects the part of the input to sample (default: whole frame).
     bool textureToTensor(Context& ctx, Tensor& tensor,
-                         int targetWidth, int targetHeight);
+                         int targetWidth, int targetHeight,
+                         const SourceRect& region = SourceRect{});
 
-    // CPU pixel data to tensor conversion
+    // CPU pixel data to tensor conversion (fused resize/convert/normalize)
     bool cpuPixelsToTensor(const io::ImageData& pixels, Tensor& tensor,
-                           int targetWidth, int targetHeight);
+                           int targetWidth, int targetHeight,
+                           const SourceRect& region = SourceRect{});
+
+    // Detectors report the NMS share of processOutputTensor() (see stats())
+    void recordNmsTime(double ms) { m_nmsStats.add(ms); }
+
+    /// Session::Run time of the outputs being processed (summed over sources
+    /// for fixed-batch multi-source models)
+    double lastRunMs() const { return m_runStats.last(); }
+
+    /// Keep bindings for up to count input shapes per buffer set so switching
+    /// resolutions doesn't rebind; call from onModelLoaded()
+    void cacheInputShapes(size_t count);
+
+    /// Normalized source rect the current source's input spans (crop and
+    /// aspect mode included): x = region.x + u * region.width
+    const SourceRect& inputRegion() const;
+
+    /// Requested crop, sampled region and frame size of the current source's
+    /// inputs (async frames keep theirs until decoded)
+    struct InputFrame {
+        SourceRect requested;
+        SourceRect region;
+        int width = 0;
+        int height = 0;
+    };
+    const InputFrame& inputFrame() const;
+
+    /// process() without a Context (tools, tests): runs the inputs already in
+    /// m_inputTensors under the run policy, sync or through the async pipeline
+    void processPrepared();
+
+    /// init() without a Context: load, or use (or retry) a finished preload
+    void initModel();
+
+    // Pixel size of the frame last converted by textureToTensor (0 before the first)
+    int lastInputWidth() const { return m_lastInputWidth; }
+    int lastInputHeight() const { return m_lastInputHeight; }
+
+    // Applied by textureToTensor/cpuPixelsToTensor to float inputs
+    Normalization m_inputNormalization = Normalization::unit();
 
     std::string m_modelPath;
-    Operator* m_inputOp = nullptr;
-    bool m_loaded = false;
+    std::shared_ptr<ModelBuffer> m_modelData;   // modelData() bytes, else m_modelPath
+    bool m_memoryMap = false;
+    std::string m_externalDataPath;
+    Operator* m_inputOp = nullptr;              // current source
+    std::vector<Operator*> m_inputOps;          // all sources
+    size_t m_currentSource = 0;
+    bool m_dynamicBatch = false;                // input 0 has a dynamic batch dim
+    bool m_dynamicInputSize = false;            // input 0 has dynamic height and width
+    std::atomic<bool> m_loaded{false};
+    bool m_sharedSession = true;
+
+    // Optimized-model disk cache (see model_cache.h)
+    bool m_modelCache = true;
+    bool m_loadedFromCache = false;
+
+    // Thread pool configuration
+    ThreadPoolOptions m_threading;
+    bool m_globalThreadPool = false;
+
+    // Execution provider selection
+    std::vector<ExecutionProvider> m_executionProviders = {ExecutionProvider::CPU};
+    ExecutionProvider m_activeProvider = ExecutionProvider::CPU;
 
-    // ONNX Runtime objects (pimpl to avoid header pollution)
-    struct OrtObjects;
-    std::unique_ptr<OrtObjects> m_ort;
+    // Inference runtime (created on load)
+    std::unique_ptr<InferenceBackend> m_backend;
+    BackendType m_backendType = BackendType::OnnxRuntime;
+    bool m_customBackend = false;
 
     // Model metadata
     std::vector<std::string> m_inputNames;
@@ -120,8 +366,128 @@ protected:
     std::vector<std::vector<int64_t>> m_outputShapes;
 
     // Tensor storage
+    std::shared_ptr<TensorPool> m_tensorPool = std::make_shared<TensorPool>();
     std::vector<Tensor> m_inputTensors;
     std::vector<Tensor> m_outputTensors;
+
+private:
+    // Load m_backend, trying providers in priority order
+    bool loadBackend();
+
+    // Per-source input preparation and output dispatch (batch aware)
+    bool inputReady(const Operator* op) const;
+    void selectSource(size_t index);
+    void prepareInputs(Context& ctx);
+    void dispatchOutputs();
+    void processFrame(Context* ctx);   // nullptr: inputs already prepared
+    void processSequential(Context& ctx);
+
+    // Run policy: check, and record a run
+    bool shouldRun();
+    void markRun();
+
+    // Scheduler admission (rate spacing, shedding); true if not scheduled
+    bool scheduleAllows();
+
+    // Count a frame the policy or scheduler skips; true if skipped
+    bool skipFrame(bool collect);
+
+    // Profiling: count a finished inference, end the trace after the window
+    void countInference();
+
+    // Recording and replay
+    void recordLatest();   // the newest result, timed from the first record
+    std::string m_recordPath;
+    TrackFormat m_recordFormat = TrackFormat::Binary;
+    double m_recordStartMs = -1.0;   // result time of the first record
+    std::unique_ptr<TrackWriter> m_trackWriter;
+    TrackFrame m_trackFrame;
+    std::string m_replayPath;
+    std::unique_ptr<TrackReader> m_trackReader;
+    bool loadReplay();
+    void processReplay();
+
+    // Background load (preload()); joined before anything else loads
+    std::thread m_preloadThread;
+    std::shared_future<bool> m_preloadResult;
+    std::atomic<bool> m_preloading{false};
+    void joinPreload();
+    // Join a finished preload and load again if it failed; true if loaded
+    bool finishPreload();
+
+    // Size the binding slots for the buffer sets and cacheInputShapes()
+    void reserveBindings();
+    size_t m_inputShapeCache = 1;
+
+    // Batched mode scratch: one source's input, and one source's output slices
+    Tensor m_sourceInput;
+    std::vector<Tensor> m_sourceOutputs;
+
+    // Reusable resize tables for cpuPixelsToTensor
+    ImageResampler m_resampler;
+
+    // Compute-shader preprocessing for texture inputs
+    std::unique_ptr<GpuResampler> m_gpuResampler;
+    bool m_gpuPreprocess = true;
+    bool m_gpuPreprocessActive = false;
+
+    int m_lastInputWidth = 0;
+    int m_lastInputHeight = 0;
+
+    void processAsync(Context* ctx, bool submit = true);
+    void startWorker();
+    void stopWorker();
+
+    // Async worker (pimpl, owns the second input/output buffer set)
+    struct AsyncWorker;
+    std::unique_ptr<AsyncWorker> m_worker;
+    bool m_asyncEnabled = false;
+    int m_pipelineDepth = 1;
+
+    // Run one pipeline slot (worker thread or scheduler pool)
+    void runSlot(AsyncWorker& worker, size_t index);
+
+    // Shared scheduler (see scheduler.h); client id while registered
+    SchedulePolicy m_schedulePolicy;
+    bool m_scheduled = false;
+    int m_scheduleClient = 0;
+    uint64_t m_framesShed = 0;
+
+    // Frame bookkeeping for result age reporting
+    int64_t m_frameCounter = 0;
+    int64_t m_resultFrame = -1;
+    double m_resultTimeMs = 0.0;
+    uint64_t m_framesDropped = 0;
+
+    // Scheduling state
+    struct SourceWatch {
+        uint64_t signature = 0;
+        uint64_t pendingSignature = 0;
+        FrameChangeDetector change;
+    };
+    RunPolicy m_runPolicy;
+    std::vector<SourceWatch> m_sourceWatch;
+    int64_t m_lastRunFrame = -1;
+    double m_lastRunMs = 0.0;
+    uint64_t m_framesSkipped = 0;
+
+    // Aspect mode and the frame each source's input came from
+    AspectMode m_aspectMode = AspectMode::Stretch;
+    std::vector<InputFrame> m_inputFrames;
+    void setInputFrame(const SourceRect& requested, const SourceRect& region);
+
+    // Stage timings
+    RollingStats m_preprocessStats;
+    RollingStats m_runStats;
+    RollingStats m_postprocessStats;
+    RollingStats m_nmsStats;
+    uint64_t m_inferenceCount = 0;
+
+    // ORT profiler window
+    int m_profileFrames = 0;
+    int m_profileRemaining = 0;
+    std::string m_profilePrefix;
+    std::string m_profileFile;
 };
 
 } // namespace vivid::onnx
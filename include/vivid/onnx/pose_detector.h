@@ -15,12 +15,19 @@
 //           float conf = pose.confidence(Keypoint::Nose);
 //       }
 //   }
+//
+// Multipose, ROI tracking, smoothing, several cameras and replay are
+// described in README.md.
 
 #pragma once
 
 #include "onnx_model.h"
+#include "nms.h"
+#include "pose_keypoints.h"
+#include "tracker.h"
 #include <glm/glm.hpp>
 #include <array>
+#include <vector>
 
 namespace vivid::onnx {
 
@@ -78,6 +85,21 @@ static const std::array<BoneConnection, 16> SKELETON_CONNECTIONS = {{
     {Keypoint::RightKnee, Keypoint::RightAnkle},
 }};
 
+/// One detected person
+struct DetectedPose {
+    /// Keypoints: x, y (normalized 0-1), confidence
+    std::array<glm::vec3, 17> keypoints{};
+
+    /// Bounding box (normalized 0-1): x, y, width, height
+    glm::vec4 bbox{0.0f};
+
+    /// Detection score (0-1); singlepose models use the mean keypoint confidence
+    float score = 0.0f;
+
+    /// Track ID, stable across frames while smoothing() is on (else -1)
+    int id = -1;
+};
+
 class PoseDetector : public ONNXModel {
 public:
     PoseDetector();
@@ -85,12 +107,36 @@ public:
 
     // Configuration
     PoseDetector& input(Operator* op);
+    PoseDetector& inputs(const std::vector<Operator*>& ops);
     PoseDetector& model(const std::string& path);
     PoseDetector& confidenceThreshold(float threshold);
     PoseDetector& drawSkeleton(bool draw);
+    PoseDetector& nmsMode(NmsMode mode);
+    PoseDetector& iouThreshold(float threshold);
+
+    /// Track people across frames: stable IDs, One-Euro smoothed keypoints
+    /// and boxes (default off)
+    PoseDetector& smoothing(bool enabled);
+
+    /// Crop each frame around the previous pose (default off)
+    PoseDetector& tracking(bool enabled);
+    bool isTracking() const { return m_tracking; }
+
+    /// Input size for dynamic-size models, rounded to multiples of 32
+    /// (default 256x256); fixed-size models keep their own
+    PoseDetector& inputResolution(int width, int height);
+
+    /// Adapt the input size to keep Session::Run under budgetMs, between
+    /// minSize (longer side) and inputResolution() (0 = off, the default)
+    PoseDetector& latencyBudget(float budgetMs, int minSize = 128);
+
+    /// Input size in use (valid after loading)
+    int inputWidth() const { return m_inputWidth; }
+    int inputHeight() const { return m_inputHeight; }
 
     // Detection results
-    bool detected() const { return m_detected; }
+    bool detected() const { return m_poses[0].detected; }
+    bool detected(size_t source) const;
 
     /// Get keypoint position (normalized 0-1)
     glm::vec2 keypoint(Keypoint kp) const;
@@ -101,7 +147,31 @@ public:
     float confidence(int index) const;
 
     /// Get all keypoints at once
-    const std::array<glm::vec3, 17>& keypoints() const { return m_keypoints; }
+    const std::array<glm::vec3, 17>& keypoints() const { return m_poses[0].keypoints; }
+
+    /// Keypoints for one source (see inputs())
+    const std::array<glm::vec3, 17>& keypoints(size_t source) const;
+
+    /// Input region the current keypoints were detected in (normalized;
+    /// the full frame unless tracking is on and locked)
+    SourceRect cropRegion(size_t source = 0) const;
+
+    /// MoveNet crop for the next frame: a square around the hips covering the
+    /// visible body, or the full frame without a torso (normalized keypoints)
+    static SourceRect cropRegionFor(const std::array<glm::vec3, 17>& keypoints,
+                                    int frameWidth, int frameHeight);
+
+    /// Number of people detected (source 0)
+    int poseCount() const { return static_cast<int>(m_poses[0].poses.size()); }
+
+    /// Get detected person by index (best first)
+    const DetectedPose& pose(int index) const;
+
+    /// All people detected in a source (see inputs())
+    const std::vector<DetectedPose>& poses(size_t source = 0) const;
+
+    /// Keypoints of poses(source) as x/y/confidence arrays, same order
+    const PoseKeypoints& poseKeypoints(size_t source = 0) const;
 
     // Operator interface
     std::string name() const override { return "PoseDetector"; }
@@ -110,18 +180,78 @@ protected:
     void onModelLoaded() override;
     void prepareInputTensor(Context& ctx, Tensor& tensor) override;
     void processOutputTensor(const Tensor& tensor) override;
+    void onInferenceSkipped() override;
+
+    // Track files: keypoints as 17 x (x, y, confidence)
+    int trackValueCount() const override { return 17 * 3; }
+    void appendTrackDetections(TrackFrame& frame) const override;
+    void applyTrackDetections(const TrackFrame& frame) override;
 
 private:
+    // Output layout, settled from the output shape when the model loads
+    enum class OutputFormat {
+        Unknown,      // shape not reported: decided by the first output
+        Singlepose,   // [1, 1, 17, 3]
+        Multipose     // [1, N, 56]
+    };
+
+    // Input resolution: size of a step down from the requested one, apply
+    // m_resolutionLevel, and move it for the latency budget
+    void resolutionForLevel(int level, int& width, int& height) const;
+    void applyResolution();
+    void adaptResolution();
+
     float m_confidenceThreshold = 0.3f;
     bool m_drawSkeleton = true;
-    bool m_detected = false;
+    bool m_tracking = false;
+    bool m_smoothing = false;
+    OutputFormat m_format = OutputFormat::Unknown;
+    size_t m_maxDetections = 6;
 
-    // Keypoints: x, y, confidence for each of 17 points
-    std::array<glm::vec3, 17> m_keypoints;
+    struct SourcePose {
+        bool detected = false;
+        // Keypoints: x, y, confidence for each of 17 points (best pose)
+        std::array<glm::vec3, 17> keypoints{};
+
+        // Every person detected, best first (storage reused across frames),
+        // and their keypoints as arrays
+        std::vector<DetectedPose> poses;
+        PoseKeypoints keypointBuffer;
+
+        // Tracking: region the current keypoints came from, and the one for
+        // the next frame
+        SourceRect crop;
+        SourceRect nextCrop;
+
+        // Smoothing state (a keypointBuffer block per person as values)
+        DetectionTracker tracker;
+    };
+
+    void decodeSinglepose(const Tensor& tensor, SourcePose& pose);
+    void decodeMultipose(const Tensor& tensor, SourcePose& pose);
+    void trackPoses(SourcePose& pose);
+    static void applyTracks(SourcePose& pose);
+
+    // One result per input source (always at least one)
+    std::vector<SourcePose> m_poses;
+
+    // Multipose suppression (keypoint blocks travel as attributes)
+    NonMaxSuppression m_nms;
 
     // Model input size (MoveNet uses 192x192 or 256x256)
     int m_inputWidth = 192;
     int m_inputHeight = 192;
+
+    // Dynamic-size models: requested size and latency-driven step down
+    bool m_resizable = false;
+    int m_requestedWidth = 256;
+    int m_requestedHeight = 256;
+    float m_latencyBudgetMs = 0.0f;
+    int m_minResolution = 128;
+    int m_resolutionLevel = 0;     // steps below the requested size
+    int m_resolutionLevels = 1;
+    int m_levelRuns = 0;           // runs averaged at this level
+    double m_levelRunMs = 0.0;
 };
 
 } // namespace vivid::onnx
@@ -0,0 +1,77 @@
+// PoseKeypoints - Keypoints of several people, structure of arrays
+//
+// PoseDetector decodes MoveNet outputs straight into this buffer. Each
+// person is one block of x[17], y[17] and confidence[17], every array
+// padded to kStride floats (the padding stays zero), so:
+//   - renderers read x(p)/y(p)/confidence(p) as plain float arrays,
+//   - DetectionTracker smooths a whole block as its values (kBlock floats),
+//   - NMS carries and blends blocks as attributes,
+// all in place, without repacking into glm::vec3 per keypoint.
+//
+// Usage:
+//   const PoseKeypoints& kps = pose.poseKeypoints();
+//   for (size_t p = 0; p < kps.count(); p++) {
+//       const float* x = kps.x(p);
+//       const float* conf = kps.confidence(p);
+//   }
+//
+// Storage is allocated for the model's detection count once and reused.
+
+#pragma once
+
+#include "preprocess.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace vivid::onnx {
+
+class PoseKeypoints {
+public:
+    static constexpr int kKeypoints = 17;
+    static constexpr int kStride = 20;            // floats per array (4-float multiple)
+    static constexpr int kBlock = 3 * kStride;    // floats per person
+
+    /// Allocate blocks for up to people (count() is unchanged)
+    void reserve(size_t people);
+
+    /// Number of people in use; grows storage if needed, new blocks are zero
+    void resize(size_t count);
+    void clear() { m_count = 0; }
+
+    size_t count() const { return m_count; }
+    size_t capacity() const { return m_values.size() / kBlock; }
+    bool empty() const { return m_count == 0; }
+
+    /// Arrays of kKeypoints values for one person (source-normalized 0-1)
+    const float* x(size_t pose) const { return block(pose); }
+    const float* y(size_t pose) const { return block(pose) + kStride; }
+    const float* confidence(size_t pose) const { return block(pose) + 2 * kStride; }
+
+    /// The person's whole block: x, then y, then confidence
+    const float* block(size_t pose) const { return m_values.data() + pose * kBlock; }
+    float* block(size_t pose) { return m_values.data() + pose * kBlock; }
+
+    glm::vec3 at(size_t pose, int keypoint) const {
+        return glm::vec3(x(pose)[keypoint], y(pose)[keypoint], confidence(pose)[keypoint]);
+    }
+
+private:
+    std::vector<float> m_values;
+    size_t m_count = 0;
+};
+
+/// Confidence reduction of one decoded person
+struct KeypointSummary {
+    int aboveThreshold = 0;        // keypoints with confidence >= threshold
+    float confidenceSum = 0.0f;
+};
+
+/// MoveNet's 17 (y, x, confidence) triplets into a PoseKeypoints block,
+/// mapped from input-normalized to source coordinates through region, with
+/// the confidence count and sum of the same pass (SSE2/NEON, 4 keypoints at
+/// a time). The block's padding is zeroed.
+KeypointSummary decodeMoveNetKeypoints(const float* triplets, const SourceRect& region,
+                                       float threshold, float* block);
+
+} // namespace vivid::onnx
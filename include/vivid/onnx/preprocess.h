@@ -0,0 +1,152 @@
+// Preprocess - Fused resize + color convert + normalize
+//
+// Converts 8-bit camera pixels (BGRA, BGR or grayscale) into a model input
+// tensor in a single pass: bilinear resize, BGRA->RGB swizzle, NHWC/NCHW
+// layout and per-channel scale/bias normalization.
+//
+// Sources whose aspect ratio differs from the tensor's can be stretched,
+// letterboxed (Fit: padding is written in the same pass) or center-cropped
+// (Fill); aspectLayout() gives the mapping back to source coordinates.
+//
+// Sample positions and weights are precomputed per output column and row,
+// and reused across frames while source and target sizes don't change. The
+// pixel loop is specialized at compile time for each output type and layout,
+// and uses SSE2/AVX2 (x86) or NEON (ARM) for 4-channel sources.
+//
+// Usage:
+//   ImageResampler resampler;
+//   resampler.resample(pixels, tensor, 192, 192, Normalization::raw());
+//   resampler.resample(pixels, tensor, 128, 128, norm, SourceRect{}, AspectMode::Fit);
+
+#pragma once
+
+#include "tensor.h"
+#include <vivid/io/image_loader.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// Memory layout of an image tensor
+enum class TensorLayout {
+    NHWC = 0,   // [batch, height, width, channels] (TFLite/MoveNet/BlazeFace)
+    NCHW = 1    // [batch, channels, height, width] (PyTorch exports)
+};
+
+/// Per-channel normalization of 0-255 pixel values: out = value * scale + bias
+/// Channels are in model order (R, G, B, A).
+struct Normalization {
+    std::array<float, 4> scale = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
+    std::array<float, 4> bias = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    /// [0, 1] (most float models)
+    static Normalization unit() { return {}; }
+
+    /// [0, 255] unchanged pixel values (MoveNet float)
+    static Normalization raw() {
+        return {{1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 0.0f}};
+    }
+
+    /// [-1, 1] (BlazeFace: pixel / 127.5 - 1)
+    static Normalization signedUnit() {
+        const float s = 2.0f / 255.0f;
+        return {{s, s, s, s}, {-1.0f, -1.0f, -1.0f, -1.0f}};
+    }
+};
+
+/// Region of the source image to sample, normalized to source size (0-1).
+/// May extend past the edges; samples outside repeat the border pixels.
+struct SourceRect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+
+    bool operator==(const SourceRect& o) const {
+        return x == o.x && y == o.y && width == o.width && height == o.height;
+    }
+    bool operator!=(const SourceRect& o) const { return !(*this == o); }
+};
+
+/// How a source with a different aspect ratio maps onto the tensor
+enum class AspectMode {
+    Stretch = 0,    // scale each axis to the tensor (distorts)
+    Fit = 1,        // letterbox: whole source visible, padded with black
+    Fill = 2        // center-crop to the tensor's aspect ratio
+};
+
+/// Placement of a source region in a tensor for an aspect mode
+struct AspectLayout {
+    /// Source rect (normalized) the whole tensor spans; tensor coordinates
+    /// u, v in 0-1 map to source x = region.x + u * region.width (same for y).
+    /// Extends past the source edges in Fit mode.
+    SourceRect region;
+
+    /// Tensor pixels showing the source; the rest is padding (Fit only)
+    int contentX = 0;
+    int contentY = 0;
+    int contentWidth = 0;
+    int contentHeight = 0;
+};
+
+/// Layout of region (normalized) of a srcWidth x srcHeight source in a
+/// dstWidth x dstHeight tensor
+AspectLayout aspectLayout(AspectMode mode, const SourceRect& region,
+                          int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+/// Normalization a tensor of this type receives: norm for Float32/Float16,
+/// raw 0-255 for UInt8/Int32/Int64, and 0-255 shifted by -128 for Int8
+/// (the usual zero point of int8-quantized image inputs)
+Normalization tensorNormalization(TensorType type, const Normalization& norm);
+
+/// Detect tensor layout and channel count from a 4D image tensor shape
+TensorLayout detectLayout(const std::vector<int64_t>& shape, int* channels = nullptr);
+
+class ImageResampler {
+public:
+    /// Resample pixels (or the region of them) into tensor. tensor.shape,
+    /// tensor.type and storage must already match targetWidth x targetHeight.
+    /// Normalization applies to float tensors; integer tensors receive raw
+    /// values (see tensorNormalization).
+    bool resample(const io::ImageData& pixels, Tensor& tensor,
+                  int targetWidth, int targetHeight,
+                  const Normalization& norm = Normalization::unit(),
+                  const SourceRect& region = SourceRect{},
+                  AspectMode aspect = AspectMode::Stretch);
+
+    /// Raw-pointer variant (pixels are tightly packed rows)
+    bool resample(const uint8_t* pixels, int srcWidth, int srcHeight, int srcChannels,
+                  Tensor& tensor, int targetWidth, int targetHeight,
+                  const Normalization& norm = Normalization::unit(),
+                  const SourceRect& region = SourceRect{},
+                  AspectMode aspect = AspectMode::Stretch);
+
+    /// Layout of the last resample() (source to tensor mapping)
+    const AspectLayout& layout() const { return m_layout; }
+
+    /// Name of the SIMD path compiled in ("AVX2", "SSE2", "NEON" or "scalar")
+    static const char* simdPath();
+
+private:
+    void buildTables(int srcWidth, int srcHeight, int srcChannels,
+                     int targetWidth, int targetHeight, const SourceRect& region);
+
+    // Precomputed bilinear taps: byte offsets of the two source samples and
+    // the weight of the second one, per output column and per output row
+    std::vector<int32_t> m_colOffset0, m_colOffset1;
+    std::vector<float> m_colWeight;
+    std::vector<int32_t> m_rowOffset0, m_rowOffset1;
+    std::vector<float> m_rowWeight;
+
+    // Geometry the tables were built for
+    int m_srcWidth = 0;
+    int m_srcHeight = 0;
+    int m_srcChannels = 0;
+    int m_dstWidth = 0;
+    int m_dstHeight = 0;
+    SourceRect m_region;
+    AspectLayout m_layout;
+};
+
+} // namespace vivid::onnx
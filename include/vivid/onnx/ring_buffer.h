@@ -0,0 +1,74 @@
+// SpscRing - Lock-free single-producer/single-consumer queue
+//
+// Fixed capacity, preallocated, no locks: one thread push()es, one other
+// thread pop()s. ONNXModel's async pipeline passes buffer-set indices through
+// two of them (render thread -> worker for inference, worker -> render thread
+// for decoding).
+//
+// Usage:
+//   SpscRing<size_t> ring(4);
+//   ring.push(i);              // producer; false when full
+//   size_t j; ring.pop(j);     // consumer; false when empty
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace vivid::onnx {
+
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity = 0) { reset(capacity); }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Empty the ring and set its capacity (not thread-safe)
+    void reset(size_t capacity) {
+        m_items.assign(capacity + 1, T{});
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    /// Producer: append a value (false when full)
+    bool push(const T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = advance(tail);
+        if (next == m_head.load(std::memory_order_acquire)) return false;
+        m_items[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: take the oldest value (false when empty)
+    bool pop(T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        value = m_items[head];
+        m_head.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+    /// Approximate while the other side is active
+    size_t size() const {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + m_items.size() - head;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return m_items.size() - 1; }
+
+private:
+    size_t advance(size_t index) const { return index + 1 == m_items.size() ? 0 : index + 1; }
+
+    std::vector<T> m_items;   // one spare slot tells full from empty
+
+    // Consumer and producer positions on their own cache lines
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,53 @@
+// RunPolicy - When ONNXModel runs inference
+//
+// Every condition that is set must pass for a frame to run:
+//   everyFrames      at most one inference per N process() calls
+//   maxRateHz        at most this many inferences per second
+//   onNewFrame       only when a source delivered a different frame
+//   changeThreshold  only when a source changed by at least this much
+//
+// New-frame and change detection look at cpuPixels(): a hash of a sparse
+// pixel sample, and the mean luma difference of a 32x18 thumbnail against
+// the frame of the last inference (so slow drifts still trigger). Sources
+// with only a texture can't be inspected and always count as changed.
+
+#pragma once
+
+#include <vivid/io/image_loader.h>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::onnx {
+
+struct RunPolicy {
+    int everyFrames = 1;
+    float maxRateHz = 0.0f;        // 0 = unlimited
+    bool onNewFrame = false;
+    float changeThreshold = 0.0f;  // mean absolute luma difference, 0-1 (0 = off)
+};
+
+class FrameChangeDetector {
+public:
+    static constexpr int kThumbWidth = 32;
+    static constexpr int kThumbHeight = 18;
+
+    /// Hash of a sparse pixel sample; differs between frames of live video
+    static uint64_t signature(const io::ImageData& pixels);
+
+    /// Mean absolute luma difference (0-1) between pixels and the reference
+    /// frame; 1 if there is no reference yet
+    float difference(const io::ImageData& pixels);
+
+    /// Make the frame last passed to difference() the reference
+    void commit();
+
+    void reset() { m_hasReference = false; }
+
+private:
+    std::vector<uint8_t> m_reference;
+    std::vector<uint8_t> m_current;
+    bool m_hasCurrent = false;
+    bool m_hasReference = false;
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,145 @@
+// InferenceScheduler - Shared worker pool across ONNXModel instances
+//
+// Without it every model decides on its own when to run and async models
+// each start a worker thread, so a PoseDetector, a FaceDetector and a
+// custom model fire on the same tick and compete for the same cores.
+// Scheduled models instead submit their runs to one pool:
+//
+//   pose.schedule(10, 30.0f, 40.0f);   // priority, target Hz, latency budget (ms)
+//   faces.schedule(5, 15.0f);
+//   depth.schedule(0);                 // best effort
+//   InferenceScheduler::instance().workers(2);   // optional, default 2
+//
+// - Rate: each model runs at most targetHz (0 = every frame it can),
+//   spread evenly instead of firing together.
+// - Order: a free worker takes the highest-priority waiting run, the
+//   earliest deadline (submit time + budget) first within a priority.
+//   Runs of one model never overlap, so results stay in order.
+// - Overload: while a model's submit-to-result latency is over its budget,
+//   every lower-priority model is shed (frames skipped, results extrapolated
+//   by smoothed detectors) until it is back under 80% of the budget or
+//   stops submitting (no run for 100 ms, or its budget or period if longer).
+//
+// Scheduling implies async mode (pipelineDepth() still bounds the frames in
+// flight). Runs still use their session's intra-op threads; cap those with
+// threading() so workers x threads fits the machine.
+
+#pragma once
+
+#include "stats.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// How a model competes for the shared pool
+struct SchedulePolicy {
+    int priority = 0;               // higher runs first
+    float targetHz = 0.0f;          // 0 = as often as frames arrive
+    float latencyBudgetMs = 0.0f;   // submit-to-result target (0 = none)
+};
+
+/// Per-model scheduler counters
+struct ScheduleStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t shed = 0;              // frames refused for higher priorities
+    uint64_t deadlineMisses = 0;    // results later than the budget
+    StageTiming latency;            // submit to result, queue wait included
+    bool overBudget = false;        // currently shedding lower priorities
+};
+
+/// Result of asking whether a model may submit now
+enum class Admission {
+    Run = 0,
+    NotDue = 1,   // targetHz spacing
+    Shed = 2      // a higher-priority model is over its budget
+};
+
+class InferenceScheduler {
+public:
+    /// The process-wide scheduler ONNXModel::schedule() uses
+    static InferenceScheduler& instance();
+
+    explicit InferenceScheduler(int workers = 2);
+    ~InferenceScheduler();
+    InferenceScheduler(const InferenceScheduler&) = delete;
+    InferenceScheduler& operator=(const InferenceScheduler&) = delete;
+
+    /// Worker threads (restarts the pool; waiting runs are kept)
+    void workers(int count);
+    int workers() const;
+
+    /// Returns the client id
+    int registerClient(const std::string& name, const SchedulePolicy& policy);
+    void updatePolicy(int client, const SchedulePolicy& policy);
+
+    /// Drop the client's waiting runs and wait for its running one
+    void unregisterClient(int client);
+
+    /// Whether the client should submit a run now (doesn't change state)
+    Admission admit(int client) const;
+
+    /// Record a frame refused by admit() as shed
+    void countShed(int client);
+
+    /// Queue a run; job is called on a worker thread
+    void submit(int client, std::function<void()> job);
+
+    ScheduleStats stats(int client) const;
+    size_t clientCount() const;
+
+private:
+    struct Client {
+        int id = 0;
+        std::string name;
+        SchedulePolicy policy;
+        bool running = false;
+        double nextDueMs = -1.0;    // targetHz spacing
+        double latencyEmaMs = 0.0;
+        double lastFinishedMs = 0.0;
+        ScheduleStats stats;
+        RollingStats latency;
+    };
+
+    struct Job {
+        int client = 0;
+        std::function<void()> run;
+        double submitMs = 0.0;
+        double deadlineMs = 0.0;
+        uint64_t sequence = 0;
+    };
+
+    Client* find(int id);
+    const Client* find(int id) const;
+
+    // Over budget and still submitting (an idle client stops shedding); needs m_mutex
+    static double idleWindowMs(const Client& client);
+    bool shedding(const Client& client, double now) const;
+
+    // Best runnable job (index into m_queue, or -1); needs m_mutex
+    int nextJob() const;
+    void workerLoop();
+    void startWorkers();
+    void stopWorkers();
+
+    mutable std::mutex m_mutex;
+    std::mutex m_restartMutex;   // serializes starting/stopping the threads
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_jobFinished;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+    int m_workerCount = 0;
+
+    std::vector<Client> m_clients;
+    std::vector<Job> m_queue;
+    int m_nextClientId = 1;
+    uint64_t m_sequence = 0;
+};
+
+} // namespace vivid::onnx
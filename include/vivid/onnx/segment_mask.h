@@ -0,0 +1,125 @@
+// SegmentMask - Background/person segmentation
+//
+// Runs a segmentation model (MediaPipe selfie segmentation, RMBG, MODNet,
+// DeepLab, ...) and writes the foreground mask straight into a GPU texture:
+// the model-resolution mask is uploaded once per inference and expanded to
+// the source resolution in a compute shader (see gpu_mask.h), so there is
+// no full-frame readback or CPU upscale at 1080p.
+//
+// Usage:
+//   auto& mask = chain.add<SegmentMask>("mask");
+//   mask.input(&webcam).model("assets/models/selfie_segmentation.onnx");
+//
+//   blend.input(&mask);                     // texture input: mask in r, g, b and a
+//   float fg = mask.maskAt(0.5f, 0.5f);     // CPU side, source-normalized
+//
+// Outputs may be [1, C, H, W], [1, H, W, C], [1, H, W] or [H, W]; channel()
+// picks the foreground class (default: the last, i.e. "person" for two-class
+// models) and activation() turns logits into probabilities.
+//
+// Upsampling:
+//   mask.upsample(true).bilateral(1.0f, 0.1f);   // default
+//   mask.threshold(0.5f, 0.1f);                  // hard-ish edge
+//
+//   With upsample(true) the texture has the source's resolution and, if the
+//   source exposes a texture, is filtered joint-bilaterally against it so
+//   edges follow the full-resolution frame. The filter reruns every frame
+//   (cheap next to inference), so with runEvery()/async(true) edges track
+//   the current frame between results. upsample(false) keeps the model's
+//   resolution.
+//
+// mask() holds the probabilities before threshold(); maskAt() and
+// coverage() apply it. Only source 0 is segmented.
+
+#pragma once
+
+#include "onnx_model.h"
+#include "gpu_mask.h"
+#include <memory>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// How raw mask outputs become foreground probabilities
+enum class MaskActivation {
+    None = 0,     // already 0-1
+    Sigmoid = 1,  // per-pixel logits
+    Softmax = 2   // per-class logits, probability of channel()
+};
+
+class SegmentMask : public ONNXModel {
+public:
+    SegmentMask();
+    ~SegmentMask() override;
+
+    // Configuration
+    SegmentMask& model(const std::string& path);
+
+    /// Output channel holding the foreground (-1 = the last, the default)
+    SegmentMask& channel(int index);
+
+    /// Applied to the raw output (default None)
+    SegmentMask& activation(MaskActivation activation);
+
+    /// Smoothstep edge around threshold, softness wide (0 = soft mask, the default)
+    SegmentMask& threshold(float threshold, float softness = 0.1f);
+
+    /// Texture at source resolution instead of the model's (default on)
+    SegmentMask& upsample(bool enabled);
+
+    /// Joint bilateral filter sigmas: mask texels and guide RGB distance
+    /// (default 1.0, 0.1; rangeSigma 0 disables the filter)
+    SegmentMask& bilateral(float spatialSigma, float rangeSigma);
+
+    // Results (valid after process())
+    /// Foreground probabilities, maskWidth() x maskHeight(), row-major
+    const std::vector<float>& mask() const { return m_mask; }
+    int maskWidth() const { return m_maskWidth; }
+    int maskHeight() const { return m_maskHeight; }
+
+    /// Source rect (normalized) the mask covers (beyond 0-1 when letterboxed)
+    const SourceRect& maskRegion() const { return m_maskRegion; }
+
+    /// Thresholded mask at source-normalized coordinates (bilinear, 0 outside)
+    float maskAt(float x, float y) const;
+
+    /// Mean thresholded mask value (fraction of the frame that is foreground)
+    float coverage() const;
+
+    /// Mask texture (r = g = b = a = foreground), null until the first result
+    WGPUTextureView outputView() const override;
+    int textureWidth() const { return m_gpuMask ? m_gpuMask->width() : 0; }
+    int textureHeight() const { return m_gpuMask ? m_gpuMask->height() : 0; }
+
+    // Operator interface
+    std::string name() const override { return "SegmentMask"; }
+    void process(Context& ctx) override;
+    void cleanup() override;
+
+protected:
+    void prepareInputTensor(Context& ctx, Tensor& tensor) override;
+    void processOutputTensor(const Tensor& tensor) override;
+
+    /// Probability of the foreground channel of a mask output into m_mask
+    bool decodeMask(const Tensor& tensor);
+
+    std::vector<float> m_mask;
+    int m_maskWidth = 0;
+    int m_maskHeight = 0;
+    SourceRect m_maskRegion;
+    uint64_t m_maskVersion = 0;   // bumped by every decoded result
+
+private:
+    void renderTexture(Context& ctx);
+    float shapeMask(float value) const;
+
+    int m_channel = -1;
+    MaskActivation m_activation = MaskActivation::None;
+    MaskFilter m_filter;
+    bool m_upsample = true;
+
+    std::unique_ptr<GpuMaskUpsampler> m_gpuMask;
+    uint64_t m_uploadedVersion = 0;
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,50 @@
+// Stats - Rolling timing statistics
+//
+// Keeps the last N samples of a duration in a ring buffer and reports the
+// last value, mean and percentiles over that window. ONNXModel keeps one per
+// stage (preprocess, run, postprocess); see ONNXModel::stats().
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// Summary of one stage over the stats window (milliseconds)
+struct StageTiming {
+    double lastMs = 0.0;
+    double avgMs = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    uint64_t samples = 0;   // total recorded, not just the window
+};
+
+class RollingStats {
+public:
+    explicit RollingStats(size_t window = 120);
+
+    void add(double ms);
+    void reset();
+
+    /// Samples currently in the window
+    size_t count() const { return m_size; }
+    double last() const { return m_last; }
+    double average() const;
+
+    /// Nearest-rank percentile (0-100) over the window
+    double percentile(double p) const;
+
+    StageTiming timing() const;
+
+private:
+    std::vector<double> m_samples;
+    size_t m_next = 0;
+    size_t m_size = 0;
+    uint64_t m_total = 0;
+    double m_last = 0.0;
+    mutable std::vector<double> m_sorted;
+};
+
+} // namespace vivid::onnx
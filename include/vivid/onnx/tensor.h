@@ -0,0 +1,204 @@
+// Tensor - Model input/output storage
+//
+// Shape, element type and one 64-byte aligned byte buffer. Tensors are bound
+// to ONNX Runtime in place (see ONNXModel), so storage must not be
+// reallocated between runs unless the shape changes; the buffer only grows.
+//
+// Usage:
+//   Tensor t;
+//   t.shape = {1, 192, 192, 3};
+//   t.type = TensorType::UInt8;
+//   resizeStorage(t);             // from t.buffer's pool, if it has one
+//   auto pixels = t.as<uint8_t>();
+//   pixels[0] = 255;
+//
+// Buffers can come from a TensorPool (ONNXModel keeps one per model, so
+// reshapes and double buffers recycle blocks) or wrap external memory, e.g.
+// an ORT-allocated output, without copying. Float16 elements are IEEE half
+// bits (uint16_t). Detectors always see Float32 outputs: ONNXModel converts
+// other output types after each run.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// ONNX tensor element types (subset we support)
+enum class TensorType {
+    Float32 = 0,
+    UInt8 = 1,
+    Int32 = 2,
+    Int8 = 3,
+    Float16 = 4,
+    Int64 = 5
+};
+
+const char* tensorTypeName(TensorType type);
+
+/// Bytes per element
+size_t elementSize(TensorType type);
+
+/// Non-owning typed view of tensor storage (like std::span)
+template <typename T>
+class TensorSpan {
+public:
+    TensorSpan() = default;
+    TensorSpan(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T& operator[](size_t i) const { return m_data[i]; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/// Recycles aligned blocks between the tensors of one owner. Thread-safe.
+class TensorPool {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    TensorPool() = default;
+    ~TensorPool();
+    TensorPool(const TensorPool&) = delete;
+    TensorPool& operator=(const TensorPool&) = delete;
+
+    /// Block of at least bytes (a cached one up to 2x larger if available);
+    /// capacity receives its real size
+    void* allocate(size_t bytes, size_t& capacity);
+
+    /// Return a block from allocate() for reuse
+    void release(void* block, size_t capacity);
+
+    /// Free all cached blocks
+    void trim();
+
+    size_t cachedBytes() const;
+
+    /// Aligned allocation without a pool
+    static void* allocateAligned(size_t bytes);
+    static void freeAligned(void* block);
+
+private:
+    mutable std::mutex m_mutex;
+    std::multimap<size_t, void*> m_free;
+    size_t m_cachedBytes = 0;
+};
+
+/// 64-byte aligned byte storage: owned (from a pool or the heap) or wrapping
+/// external memory. Copies are deep and owned (a copy-constructed buffer
+/// shares the source's pool, an assigned one keeps its own); moves transfer
+/// the storage.
+class TensorBuffer {
+public:
+    TensorBuffer() = default;
+    explicit TensorBuffer(std::shared_ptr<TensorPool> pool) : m_pool(std::move(pool)) {}
+    ~TensorBuffer();
+
+    TensorBuffer(const TensorBuffer& other);
+    TensorBuffer& operator=(const TensorBuffer& other);
+    TensorBuffer(TensorBuffer&& other) noexcept;
+    TensorBuffer& operator=(TensorBuffer&& other) noexcept;
+
+    /// Set the size; reallocates (keeping contents) only past capacity, and
+    /// bytes past the old size are zeroed. External memory is copied into
+    /// owned storage when it is too small.
+    void resize(size_t bytes);
+
+    /// Use external memory (not owned, must outlive its use here)
+    void wrap(void* data, size_t bytes);
+
+    /// Release the storage
+    void reset();
+
+    /// Pool for future allocations (nullptr: heap)
+    void pool(std::shared_ptr<TensorPool> pool) { m_pool = std::move(pool); }
+    const std::shared_ptr<TensorPool>& pool() const { return m_pool; }
+
+    void* data() { return m_data; }
+    const void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool isExternal() const { return m_external; }
+
+private:
+    void* allocate(size_t bytes, size_t& capacity);
+    void release();
+
+    void* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    bool m_external = false;
+    std::shared_ptr<TensorPool> m_pool;
+};
+
+/// Tensor data wrapper for model I/O
+struct Tensor {
+    std::vector<int64_t> shape;    // e.g., {1, 3, 224, 224} for NCHW
+    TensorType type = TensorType::Float32;
+    TensorBuffer buffer;
+
+    /// Get total number of elements
+    size_t size() const;
+
+    /// Typed view of the storage (T must match type; Float16 is uint16_t)
+    template <typename T>
+    TensorSpan<T> as() {
+        assert(sizeof(T) == elementSize(type));
+        return {static_cast<T*>(buffer.data()), buffer.size() / sizeof(T)};
+    }
+    template <typename T>
+    TensorSpan<const T> as() const {
+        assert(sizeof(T) == elementSize(type));
+        return {static_cast<const T*>(buffer.data()), buffer.size() / sizeof(T)};
+    }
+
+    /// Get value at index (float tensors only)
+    float& operator[](size_t i) { return static_cast<float*>(buffer.data())[i]; }
+    const float& operator[](size_t i) const { return static_cast<const float*>(buffer.data())[i]; }
+
+    /// Reshape (must have same total elements)
+    void reshape(const std::vector<int64_t>& newShape);
+};
+
+/// IEEE 754 half conversion (round to nearest even)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t half);
+
+/// Size the buffer for tensor.shape and tensor.type
+void resizeStorage(Tensor& tensor);
+
+/// The storage and its element count
+void* storageData(Tensor& tensor);
+const void* storageData(const Tensor& tensor);
+size_t storageSize(const Tensor& tensor);
+
+/// Write float values into the typed storage (integers round and saturate)
+void assignFromFloat(Tensor& tensor, const float* values, size_t count);
+
+/// Set every element of the typed storage
+void fillTensor(Tensor& tensor, float value);
+
+/// Float32 copy of source (any type) in dst, sized to match
+void convertToFloat(const Tensor& source, Tensor& dst);
+
+/// Copy a single-item tensor into item `index` of a batched tensor
+void packBatchItem(const Tensor& item, Tensor& batch, size_t index);
+
+/// Extract item `index` of a batched float output; outputs without a
+/// matching batch dimension are passed through whole
+void unpackBatchItem(const Tensor& batch, int64_t batchSize, size_t index, Tensor& item);
+
+} // namespace vivid::onnx
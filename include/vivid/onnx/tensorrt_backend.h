@@ -0,0 +1,70 @@
+// TensorRTBackend - TensorRT engines with FP16 and CUDA graphs
+//
+// Only built with -DVIVID_ONNX_TENSORRT=ON (TensorRT 10 and the CUDA
+// toolkit). Serialized engines (.engine/.plan) load directly; ONNX models
+// are parsed and built once, in FP16 where the GPU supports it, and the
+// engine is saved under .vivid-onnx-cache/ keyed by model hash, TensorRT
+// version, GPU architecture and profile bounds, so later starts skip the
+// build (which can take minutes). In-memory models are built on every load.
+//
+// Usage:
+//   pose.backend(BackendType::TensorRT);   // falls back to ONNX Runtime
+//
+// Runs copy the inputs into device buffers, execute and copy the outputs
+// back on one CUDA stream. From the second run with an input shape on, the
+// execution is replayed from a CUDA graph, which removes the per-layer
+// launch overhead that dominates small models like MoveNet. Runs on one
+// backend are serialized (one execution context).
+//
+// Dynamic dimensions get one optimization profile: batch 1-8, other
+// dimensions 1-1024 (optimized for 512).
+
+#pragma once
+
+#include "backend.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vivid::onnx {
+
+class TensorRTBackend : public InferenceBackend {
+public:
+    TensorRTBackend();
+    ~TensorRTBackend() override;
+
+    const char* name() const override { return "TensorRT"; }
+    bool load(const BackendConfig& config) override;
+    void unload() override;
+    bool isLoaded() const override;
+    ExecutionProvider provider() const override { return ExecutionProvider::TensorRT; }
+    const std::vector<TensorInfo>& inputs() const override { return m_inputs; }
+    const std::vector<TensorInfo>& outputs() const override { return m_outputs; }
+    bool run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) override;
+    void resetBindings() override;
+    bool loadedFromCache() const override { return m_loadedFromCache; }
+
+    /// Build ONNX models with FP16 kernels where supported (default on)
+    TensorRTBackend& fp16(bool enabled);
+
+    /// Replay execution from CUDA graphs (default on)
+    TensorRTBackend& cudaGraphs(bool enabled);
+
+private:
+    bool loadEngine(const BackendConfig& config);
+    bool buildEngine(const BackendConfig& config, const std::string& cachePath);
+    void readModelInfo();
+
+    // TensorRT and CUDA objects (pimpl to keep their headers out)
+    struct TrtObjects;
+    std::unique_ptr<TrtObjects> m_trt;
+
+    std::vector<TensorInfo> m_inputs;
+    std::vector<TensorInfo> m_outputs;
+    std::shared_ptr<TensorPool> m_tensorPool;
+    bool m_loadedFromCache = false;
+    bool m_fp16 = true;
+    bool m_cudaGraphs = true;
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,110 @@
+// TrackFile - Recorded detector results, for offline jobs and replay
+//
+// Detectors write one record per result (every source's detections) and
+// can read them back instead of running the model:
+//
+//   pose.record("prom.vtrk");    // live chain, or offline with vivid-onnx-batch
+//   pose.replay("prom.vtrk");    // no model loaded, no inference
+//
+// Each detection stores its source, track ID, score, box and the detector's
+// per-detection values (PoseDetector: 17 x (x, y, confidence), FaceDetector:
+// 6 x (x, y) landmarks), all source-normalized like the live results.
+//
+// Binary layout (native byte order, no padding):
+//   header: "VTRK", version u32, valueCount u32, sourceCount u32,
+//           kind length u32, kind bytes (the detector's name())
+//   frame:  frame i64, timeMs f64, detection count u32, then per detection
+//           source i32, id i32, score f32, box f32[4], values f32[valueCount]
+//
+// TrackFormat::Jsonl writes the same records, one JSON object per line, for
+// other tools; only the binary format is read back.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace vivid::onnx {
+
+enum class TrackFormat {
+    Binary = 0,
+    Jsonl = 1
+};
+
+/// One recorded detection (values are stored in the TrackFrame)
+struct TrackDetection {
+    int source = 0;
+    int id = -1;
+    float score = 0.0f;
+    glm::vec4 box{0.0f};    // x, y, width, height (normalized 0-1)
+};
+
+/// One result: the detections of every source, valueCount values each
+struct TrackFrame {
+    int64_t frame = 0;      // input frame the result was computed from
+    double timeMs = 0.0;    // since the first record (batch: frame * 1000 / fps)
+    int valueCount = 0;
+    std::vector<TrackDetection> detections;
+    std::vector<float> valueData;
+
+    /// Remove all detections (keeps capacity)
+    void clear();
+
+    /// Append a detection with valueCount values (zeros if values is null)
+    void add(const TrackDetection& detection, const float* values);
+
+    const float* values(size_t detection) const { return valueData.data() + detection * valueCount; }
+};
+
+class TrackWriter {
+public:
+    TrackWriter() = default;
+    ~TrackWriter();
+    TrackWriter(const TrackWriter&) = delete;
+    TrackWriter& operator=(const TrackWriter&) = delete;
+
+    /// Create (truncate) the file; kind names the detector
+    bool open(const std::string& path, const std::string& kind, int valueCount,
+              int sourceCount, TrackFormat format = TrackFormat::Binary);
+
+    /// Append a frame; its valueCount must match the file's
+    bool write(const TrackFrame& frame);
+
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+    uint64_t framesWritten() const { return m_framesWritten; }
+
+private:
+    std::ofstream m_file;
+    std::string m_path;
+    TrackFormat m_format = TrackFormat::Binary;
+    int m_valueCount = 0;
+    uint64_t m_framesWritten = 0;
+};
+
+class TrackReader {
+public:
+    /// Read a whole binary track file
+    bool open(const std::string& path);
+
+    const std::string& kind() const { return m_kind; }
+    int valueCount() const { return m_valueCount; }
+    int sourceCount() const { return m_sourceCount; }
+
+    size_t frameCount() const { return m_frames.size(); }
+    const TrackFrame& frame(size_t index) const { return m_frames[index]; }
+
+    /// Record computed from this input frame (nullptr if there is none)
+    const TrackFrame* find(int64_t frame) const;
+
+private:
+    std::string m_kind;
+    int m_valueCount = 0;
+    int m_sourceCount = 0;
+    std::vector<TrackFrame> m_frames;   // sorted by frame
+};
+
+} // namespace vivid::onnx
@@ -0,0 +1,122 @@
+// Tracker - Stable IDs and One-Euro smoothing across frames
+//
+// Matches each frame's detections to the previous frame's tracks (IoU
+// first, then box-center distance for fast moves), gives every track a
+// stable ID, and smooths its box and per-detection values (landmarks,
+// keypoints) with One-Euro filters. The filters' velocity estimates let
+// predict() extrapolate between inferences, so a detector that runs every
+// 2nd or 3rd frame still moves smoothly every frame.
+//
+// Usage:
+//   DetectionTracker tracker;
+//   tracker.valueCount(12);
+//
+//   // After each inference
+//   tracker.clear();
+//   for (...) tracker.add(bbox, score, landmarks);
+//   tracker.update(timeSeconds);
+//
+//   // Frames without inference
+//   tracker.predict(timeSeconds);
+//
+//   for (const auto& t : tracker.tracks()) { t.id; t.box; t.values; }
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace vivid::onnx {
+
+/// One-Euro filter (Casiez et al. 2012): low jitter at rest, low lag in motion
+struct OneEuroFilter {
+    float minCutoff = 1.0f;  // Hz at rest
+    float beta = 5.0f;       // cutoff increase per unit/s of speed
+    float dCutoff = 1.0f;    // Hz for the velocity estimate
+
+    float value = 0.0f;
+    float velocity = 0.0f;
+    bool initialized = false;
+
+    float filter(float x, float dt);
+    void reset() { initialized = false; velocity = 0.0f; }
+};
+
+class DetectionTracker {
+public:
+    struct Track {
+        int id = -1;
+        glm::vec4 box{0.0f};       // x, y, width, height (smoothed or predicted)
+        float score = 0.0f;
+        std::vector<float> values; // smoothed or predicted per-detection values
+        int missed = 0;            // updates since last matched
+        int hits = 0;              // updates matched in total
+        double lastTime = 0.0;
+
+        // Filters: box (4) then values
+        std::vector<OneEuroFilter> filters;
+    };
+
+    // Configuration
+    DetectionTracker& valueCount(int count);
+    DetectionTracker& smoothing(float minCutoff, float beta);
+    DetectionTracker& iouThreshold(float threshold);
+    DetectionTracker& maxMissed(int updates);
+
+    int valueCount() const { return m_valueCount; }
+
+    /// Drop all tracks (IDs keep counting up)
+    void reset();
+
+    /// Remove pending detections
+    void clear();
+
+    /// Add a detection for the next update()
+    void add(const glm::vec4& box, float score, const float* values = nullptr);
+
+    /// Match pending detections to tracks and filter; time in seconds
+    void update(double time);
+
+    /// Extrapolate tracks matched in the last update() to time
+    void predict(double time);
+
+    const std::vector<Track>& tracks() const { return m_tracks; }
+
+    /// Index into tracks() of the track detection (add() order) went to in
+    /// the last update()
+    int trackFor(size_t detection) const;
+
+private:
+    struct Match {
+        float similarity;
+        int track;
+        int detection;
+    };
+
+    float similarity(const Track& track, const glm::vec4& box) const;
+    void startTrack(size_t detection, double time);
+    void filterTrack(Track& track, size_t detection, double time);
+
+    int m_valueCount = 0;
+    float m_minCutoff = 1.0f;
+    float m_beta = 5.0f;
+    float m_iouThreshold = 0.3f;
+    int m_maxMissed = 3;
+    int m_nextId = 0;
+
+    std::vector<Track> m_tracks;
+
+    // Pending detections
+    std::vector<glm::vec4> m_boxes;
+    std::vector<float> m_scores;
+    std::vector<float> m_values;
+
+    // Update scratch
+    std::vector<Match> m_matches;
+    std::vector<int> m_detectionTrack;
+    std::vector<char> m_trackMatched;
+    std::vector<int> m_remap;
+};
+
+} // namespace vivid::onnx
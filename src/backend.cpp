@@ -0,0 +1,56 @@
+#include <vivid/onnx/backend.h>
+#include <vivid/onnx/onnx_backend.h>
+#ifdef VIVID_ONNX_WITH_TENSORRT
+#include <vivid/onnx/tensorrt_backend.h>
+#endif
+
+namespace vivid::onnx {
+
+const char* executionProviderName(ExecutionProvider ep) {
+    switch (ep) {
+        case ExecutionProvider::CPU:      return "CPU";
+        case ExecutionProvider::CUDA:     return "CUDA";
+        case ExecutionProvider::TensorRT: return "TensorRT";
+        case ExecutionProvider::DirectML: return "DirectML";
+        case ExecutionProvider::CoreML:   return "CoreML";
+    }
+    return "Unknown";
+}
+
+const char* backendTypeName(BackendType type) {
+    switch (type) {
+        case BackendType::OnnxRuntime: return "ONNX Runtime";
+        case BackendType::TensorRT:    return "TensorRT";
+    }
+    return "Unknown";
+}
+
+bool isBackendAvailable(BackendType type) {
+    switch (type) {
+        case BackendType::OnnxRuntime:
+            return true;
+        case BackendType::TensorRT:
+#ifdef VIVID_ONNX_WITH_TENSORRT
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+std::unique_ptr<InferenceBackend> createBackend(BackendType type) {
+    switch (type) {
+        case BackendType::OnnxRuntime:
+            return std::make_unique<OnnxBackend>();
+        case BackendType::TensorRT:
+#ifdef VIVID_ONNX_WITH_TENSORRT
+            return std::make_unique<TensorRTBackend>();
+#else
+            return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+} // namespace vivid::onnx
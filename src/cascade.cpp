@@ -0,0 +1,223 @@
+#include <vivid/onnx/cascade.h>
+#include <vivid/onnx/face_detector.h>
+#include <vivid/onnx/pose_detector.h>
+#include <vivid/context.h>
+#include <algorithm>
+
+namespace vivid::onnx {
+
+RoiCascade::RoiCascade() = default;
+
+RoiCascade::~RoiCascade() = default;
+
+RoiCascade& RoiCascade::model(const std::string& path) {
+    ONNXModel::model(path);
+    return *this;
+}
+
+RoiCascade& RoiCascade::from(FaceDetector* detector) {
+    m_faceDetector = detector;
+    m_poseDetector = nullptr;
+    return *this;
+}
+
+RoiCascade& RoiCascade::from(PoseDetector* detector) {
+    m_poseDetector = detector;
+    m_faceDetector = nullptr;
+    return *this;
+}
+
+RoiCascade& RoiCascade::roiScale(float scale) {
+    m_roiScale = std::max(0.01f, scale);
+    return *this;
+}
+
+RoiCascade& RoiCascade::squareRois(bool enabled) {
+    m_squareRois = enabled;
+    return *this;
+}
+
+RoiCascade& RoiCascade::maxRois(int max) {
+    m_maxRois = std::max(1, max);
+    return *this;
+}
+
+SourceRect RoiCascade::roiRegion(float x, float y, float width, float height,
+                                 int sourceWidth, int sourceHeight) const {
+    float w = width * m_roiScale;
+    float h = height * m_roiScale;
+    if (m_squareRois && sourceWidth > 0 && sourceHeight > 0) {
+        const float side = std::max(w * sourceWidth, h * sourceHeight);
+        w = side / sourceWidth;
+        h = side / sourceHeight;
+    }
+
+    SourceRect region;
+    region.x = x + width * 0.5f - w * 0.5f;
+    region.y = y + height * 0.5f - h * 0.5f;
+    region.width = w;
+    region.height = h;
+    return region;
+}
+
+void RoiCascade::process(Context& ctx) {
+    const ONNXModel* upstream = m_faceDetector ? static_cast<const ONNXModel*>(m_faceDetector)
+                                               : static_cast<const ONNXModel*>(m_poseDetector);
+    if (!upstream || upstream->inputOperators().empty()) return;
+
+    // Follow the detector's sources (they may be set after from()). Only the
+    // first is registered with the base class; crops switch between them.
+    m_sources = upstream->inputOperators();
+    if (m_inputOps.size() != 1 || m_inputOps[0] != m_sources[0]) {
+        ONNXModel::input(m_sources[0]);
+    }
+
+    collectRois();
+    if (m_pending.empty()) {
+        m_results.clear();
+        return;
+    }
+
+    ONNXModel::process(ctx);
+}
+
+void RoiCascade::collectRois() {
+    m_pending.clear();
+    const size_t maxRois = static_cast<size_t>(m_maxRois);
+
+    auto add = [this](size_t source, size_t detection, int id, const glm::vec4& bbox) {
+        if (!(bbox.z > 0.0f) || !(bbox.w > 0.0f)) return;
+        Roi roi;
+        roi.detection = detection;
+        roi.source = source;
+        roi.id = id;
+        roi.box.x = bbox.x;
+        roi.box.y = bbox.y;
+        roi.box.width = bbox.z;
+        roi.box.height = bbox.w;
+        m_pending.push_back(roi);
+    };
+
+    for (size_t s = 0; s < m_sources.size() && m_pending.size() < maxRois; s++) {
+        if (m_faceDetector) {
+            const auto& faces = m_faceDetector->faces(s);
+            for (size_t i = 0; i < faces.size() && m_pending.size() < maxRois; i++) {
+                add(s, i, faces[i].id, faces[i].bbox);
+            }
+        } else {
+            const auto& poses = m_poseDetector->poses(s);
+            for (size_t i = 0; i < poses.size() && m_pending.size() < maxRois; i++) {
+                add(s, i, poses[i].id, poses[i].bbox);
+            }
+        }
+    }
+}
+
+bool RoiCascade::cropToTensor(Context& ctx, const SourceRect& box, Tensor& tensor, SourceRect& region) {
+    if (tensor.shape.size() < 4) return false;
+    const bool nchw = detectLayout(tensor.shape) == TensorLayout::NCHW;
+    const int height = static_cast<int>(nchw ? tensor.shape[2] : tensor.shape[1]);
+    const int width = static_cast<int>(nchw ? tensor.shape[3] : tensor.shape[2]);
+
+    // Already decoded pixels first: every crop reuses them without a readback
+    const io::ImageData* pixels = m_inputOp ? m_inputOp->cpuPixels() : nullptr;
+    const int sourceWidth = pixels ? pixels->width : lastInputWidth();
+    const int sourceHeight = pixels ? pixels->height : lastInputHeight();
+    const SourceRect crop = roiRegion(box.x, box.y, box.width, box.height, sourceWidth, sourceHeight);
+
+    const bool success = pixels ? cpuPixelsToTensor(*pixels, tensor, width, height, crop)
+                                : textureToTensor(ctx, tensor, width, height, crop);
+    region = success ? inputRegion() : crop;
+    return success;
+}
+
+void RoiCascade::prepareInputTensor(Context& ctx, Tensor& tensor) {
+    if (m_pending.empty() || inputCount() == 0) return;
+
+    std::vector<int64_t> itemShape = inputShape(0);
+    if (itemShape.empty()) return;
+    itemShape[0] = 1;
+
+    // Outputs arrive later in async mode, after newer ROIs were collected
+    Submission submission;
+    submission.frame = frameIndex();
+    submission.rois = m_pending;
+    const size_t count = submission.rois.size();
+
+    Operator* current = m_inputOp;
+    submission.crops.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        Roi& roi = submission.rois[i];
+        Tensor& crop = submission.crops[i];
+        crop.buffer.pool(m_tensorPool);
+        crop.shape = itemShape;
+        crop.type = tensor.type;
+        resizeStorage(crop);
+
+        if (roi.source < m_sources.size()) m_inputOp = m_sources[roi.source];
+        if (!cropToTensor(ctx, roi.box, crop, roi.region)) {
+            const Normalization n = tensorNormalization(crop.type, inputNormalization());
+            fillTensor(crop, 127.5f * n.scale[0] + n.bias[0]);
+        }
+    }
+    m_inputOp = current;
+
+    // All crops in one [N, ...] run, or the first of one run per crop
+    std::vector<int64_t> shape = itemShape;
+    shape[0] = m_dynamicBatch ? static_cast<int64_t>(count) : 1;
+    if (tensor.shape != shape) {
+        tensor.shape = shape;
+        resizeStorage(tensor);
+    }
+    const size_t packed = m_dynamicBatch ? count : 1;
+    for (size_t i = 0; i < packed; i++) {
+        packBatchItem(submission.crops[i], tensor, i);
+    }
+
+    m_submitted.push_back(std::move(submission));
+}
+
+void RoiCascade::processOutputTensor(const Tensor& tensor) {
+    // Frames whose results were discarded (async restart) are skipped
+    while (!m_submitted.empty() && m_submitted.front().frame < resultFrame()) {
+        m_submitted.pop_front();
+    }
+    if (m_submitted.empty() || m_submitted.front().frame != resultFrame()) return;
+
+    const Submission submission = std::move(m_submitted.front());
+    m_submitted.pop_front();
+    const size_t count = submission.rois.size();
+    m_results.resize(count);
+
+    if (m_dynamicBatch) {
+        for (size_t i = 0; i < count; i++) {
+            storeOutputs(submission.rois[i], i, i, static_cast<int64_t>(count));
+        }
+        return;
+    }
+
+    // Fixed batch: the first crop just ran, run the rest on the same tensors
+    storeOutputs(submission.rois[0], 0, 0, 1);
+    for (size_t i = 1; i < count; i++) {
+        packBatchItem(submission.crops[i], m_inputTensors[0], 0);
+        runInference();
+        storeOutputs(submission.rois[i], i, 0, 1);
+    }
+}
+
+void RoiCascade::storeOutputs(const Roi& roi, size_t index, size_t item, int64_t batchSize) {
+    RoiResult& result = m_results[index];
+    result.detection = roi.detection;
+    result.source = roi.source;
+    result.id = roi.id;
+    result.region = roi.region;
+
+    result.outputs.resize(m_outputTensors.size());
+    for (size_t o = 0; o < m_outputTensors.size(); o++) {
+        Tensor& output = result.outputs[o];
+        if (!output.buffer.pool()) output.buffer.pool(m_tensorPool);
+        unpackBatchItem(m_outputTensors[o], batchSize, item, output);
+    }
+}
+
+} // namespace vivid::onnx
@@ -2,14 +2,49 @@
 #include <vivid/context.h>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <limits>
 
 namespace vivid::onnx {
 
+// Raw score at which sigmoid(score) == probability
+static float inverseSigmoid(float probability) {
+    if (probability <= 0.0f) return -std::numeric_limits<float>::infinity();
+    if (probability >= 1.0f) return std::numeric_limits<float>::infinity();
+    return std::log(probability / (1.0f - probability));
+}
+
 // Static anchor box used for decoding
 static DetectedFace s_emptyFace = {};
+static const std::vector<DetectedFace> s_noFaces;
+
+static double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void packLandmarks(const DetectedFace& face, float* out) {
+    for (int l = 0; l < 6; l++) {
+        out[l * 2] = face.landmarks[l].x;
+        out[l * 2 + 1] = face.landmarks[l].y;
+    }
+}
+
+static void unpackLandmarks(const float* values, DetectedFace& face) {
+    for (int l = 0; l < 6; l++) {
+        face.landmarks[l] = glm::vec2(values[l * 2], values[l * 2 + 1]);
+    }
+}
 
 FaceDetector::FaceDetector() {
+    // BlazeFace expects pixel / 127.5 - 1.0, i.e. [0,255] -> [-1,1]
+    m_inputNormalization = Normalization::signedUnit();
+    m_logitThreshold = inverseSigmoid(m_confidenceThreshold);
+
+    // Landmarks (6 x, y pairs) are carried through NMS
+    m_nms.attributeCount(12);
+
     generateAnchors();
 }
 
@@ -20,6 +55,12 @@ FaceDetector& FaceDetector::input(Operator* op) {
     return *this;
 }
 
+FaceDetector& FaceDetector::inputs(const std::vector<Operator*>& ops) {
+    ONNXModel::inputs(ops);
+    m_sourceFaces.clear();
+    return *this;
+}
+
 FaceDetector& FaceDetector::model(const std::string& path) {
     ONNXModel::model(path);
     return *this;
@@ -27,6 +68,7 @@ FaceDetector& FaceDetector::model(const std::string& path) {
 
 FaceDetector& FaceDetector::confidenceThreshold(float threshold) {
     m_confidenceThreshold = std::clamp(threshold, 0.0f, 1.0f);
+    m_logitThreshold = inverseSigmoid(m_confidenceThreshold);
     return *this;
 }
 
@@ -35,6 +77,22 @@ FaceDetector& FaceDetector::maxFaces(int max) {
     return *this;
 }
 
+FaceDetector& FaceDetector::nmsMode(NmsMode mode) {
+    m_nms.mode(mode);
+    return *this;
+}
+
+FaceDetector& FaceDetector::iouThreshold(float threshold) {
+    m_nms.iouThreshold(threshold);
+    return *this;
+}
+
+FaceDetector& FaceDetector::smoothing(bool enabled) {
+    m_smoothing = enabled;
+    m_trackers.clear();
+    return *this;
+}
+
 const DetectedFace& FaceDetector::face(int index) const {
     if (index < 0 || index >= static_cast<int>(m_faces.size())) {
         return s_emptyFace;
@@ -73,8 +131,10 @@ void FaceDetector::generateAnchors() {
     // Two feature maps: 16x16 (2 anchors/cell) and 8x8 (6 anchors/cell)
     // Total: 16*16*2 + 8*8*6 = 512 + 384 = 896 anchors
 
-    m_anchors.clear();
-    m_anchors.reserve(896);
+    m_anchorX.clear();
+    m_anchorY.clear();
+    m_anchorX.reserve(896);
+    m_anchorY.reserve(896);
 
     // Feature map 1: 16x16, 2 anchors per cell
     int size1 = 16;
@@ -84,7 +144,8 @@ void FaceDetector::generateAnchors() {
             float cx = (x + 0.5f) / size1;
             float cy = (y + 0.5f) / size1;
             for (int a = 0; a < anchorsPerCell1; a++) {
-                m_anchors.push_back({cx, cy, 1.0f, 1.0f});
+                m_anchorX.push_back(cx);
+                m_anchorY.push_back(cy);
             }
         }
     }
@@ -97,12 +158,15 @@ void FaceDetector::generateAnchors() {
             float cx = (x + 0.5f) / size2;
             float cy = (y + 0.5f) / size2;
             for (int a = 0; a < anchorsPerCell2; a++) {
-                m_anchors.push_back({cx, cy, 1.0f, 1.0f});
+                m_anchorX.push_back(cx);
+                m_anchorY.push_back(cy);
             }
         }
     }
 
-    std::cout << "[FaceDetector] Generated " << m_anchors.size() << " anchors" << std::endl;
+    m_candidates.reserve(m_anchorX.size());
+
+    std::cout << "[FaceDetector] Generated " << m_anchorX.size() << " anchors" << std::endl;
 }
 
 void FaceDetector::onModelLoaded() {
@@ -140,41 +204,109 @@ void FaceDetector::prepareInputTensor(Context& ctx, Tensor& tensor) {
     tensor.shape = {1, m_inputHeight, m_inputWidth, channels};
 
     // Resize tensor buffer
-    size_t tensorSize = tensor.size();
-    if (tensor.type == TensorType::UInt8 && tensor.dataU8.size() != tensorSize) {
-        tensor.dataU8.resize(tensorSize);
-    } else if (tensor.type == TensorType::Int32 && tensor.dataI32.size() != tensorSize) {
-        tensor.dataI32.resize(tensorSize);
-    } else if (tensor.data.size() != tensorSize) {
-        tensor.data.resize(tensorSize);
-    }
+    resizeStorage(tensor);
 
-    // Convert input texture to tensor (gives us 0-1 normalized values for float32)
+    // Convert input texture to tensor (normalized to [-1, 1] in the same pass)
     bool success = textureToTensor(ctx, tensor, m_inputWidth, m_inputHeight);
 
-    // Convert from [0, 1] to [-1, 1] range for BlazeFace
-    // BlazeFace expects: pixel / 127.5 - 1.0 which is [0,255] -> [-1,1]
-    // Since textureToTensor gives us [0, 1], we convert: value * 2.0 - 1.0
-    if (success && tensor.type == TensorType::Float32) {
-        for (float& v : tensor.data) {
-            v = v * 2.0f - 1.0f;
+    if (!success) {
+        // Fill with gray placeholder if conversion fails
+        const Normalization n = tensorNormalization(tensor.type, inputNormalization());
+        fillTensor(tensor, 127.5f * n.scale[0] + n.bias[0]);
+    }
+}
+
+const std::vector<DetectedFace>& FaceDetector::faces(size_t source) const {
+    if (sourceCount() <= 1) {
+        return source == 0 ? m_faces : s_noFaces;
+    }
+    return source < m_sourceFaces.size() ? m_sourceFaces[source] : s_noFaces;
+}
+
+void FaceDetector::processOutputTensor(const Tensor& tensor) {
+    decodeOutputs(tensor);
+    finishSource();
+}
+
+void FaceDetector::appendTrackDetections(TrackFrame& frame) const {
+    for (const DetectedFace& face : faces(currentSource())) {
+        TrackDetection det;
+        det.source = static_cast<int>(currentSource());
+        det.id = face.id;
+        det.score = face.confidence;
+        det.box = face.bbox;
+
+        float landmarks[12];
+        packLandmarks(face, landmarks);
+        frame.add(det, landmarks);
+    }
+}
+
+void FaceDetector::applyTrackDetections(const TrackFrame& frame) {
+    m_faces.clear();
+    for (size_t d = 0; d < frame.detections.size(); d++) {
+        const TrackDetection& det = frame.detections[d];
+        if (det.source != static_cast<int>(currentSource())) continue;
+
+        DetectedFace face;
+        face.bbox = det.box;
+        face.confidence = det.score;
+        face.id = det.id;
+        unpackLandmarks(frame.values(d), face);
+        m_faces.push_back(face);
+    }
+    finishSource();
+}
+
+void FaceDetector::finishSource() {
+    if (m_smoothing) {
+        m_trackers.resize(std::max<size_t>(1, sourceCount()));
+        trackFaces(m_trackers[currentSource() < m_trackers.size() ? currentSource() : 0]);
+    }
+
+    // Several sources: keep each one's faces; the single-source accessors
+    // report source 0 once the last source has been decoded
+    if (sourceCount() > 1) {
+        m_sourceFaces.resize(sourceCount());
+        m_sourceFaces[currentSource()] = m_faces;
+        if (currentSource() + 1 == sourceCount()) {
+            m_faces = m_sourceFaces[0];
         }
     }
+}
 
-    if (!success) {
-        // Fill with gray placeholder if conversion fails
-        if (tensor.type == TensorType::UInt8) {
-            std::fill(tensor.dataU8.begin(), tensor.dataU8.end(), uint8_t(128));
-        } else if (tensor.type == TensorType::Int32) {
-            std::fill(tensor.dataI32.begin(), tensor.dataI32.end(), int32_t(128));
-        } else {
-            std::fill(tensor.data.begin(), tensor.data.end(), 0.0f);  // 0 in [-1,1] range
+void FaceDetector::onInferenceSkipped() {
+    if (!m_smoothing || m_trackers.empty()) return;
+
+    // Extrapolate every source's faces to this frame
+    const double now = nowSeconds();
+    for (size_t s = 0; s < m_trackers.size(); s++) {
+        m_trackers[s].predict(now);
+        if (sourceCount() <= 1) {
+            applyTracks(m_faces, m_trackers[s]);
+        } else if (s < m_sourceFaces.size()) {
+            applyTracks(m_sourceFaces[s], m_trackers[s]);
         }
     }
+    if (sourceCount() > 1 && !m_sourceFaces.empty()) {
+        m_faces = m_sourceFaces[0];
+    }
 }
 
-void FaceDetector::processOutputTensor(const Tensor& tensor) {
+void FaceDetector::applyTracks(std::vector<DetectedFace>& faces, const DetectionTracker& tracker) {
+    for (auto& face : faces) {
+        for (const auto& track : tracker.tracks()) {
+            if (track.id != face.id) continue;
+            face.bbox = track.box;
+            unpackLandmarks(track.values.data(), face);
+            break;
+        }
+    }
+}
+
+void FaceDetector::decodeOutputs(const Tensor& tensor) {
     m_faces.clear();
+    m_candidates.clear();
 
     // BlazeFace model output formats:
     // 2-output: [regressors, scores] combined for all anchors
@@ -183,190 +315,192 @@ void FaceDetector::processOutputTensor(const Tensor& tensor) {
     //   - scores2: [1, 384, 1] for 8x8 feature map (384 anchors)
     //   - regressors1: [1, 512, 16] for 16x16 feature map
     //   - regressors2: [1, 384, 16] for 8x8 feature map
+    // Outputs are read in place; nothing is concatenated.
+
+    const int numAnchors = static_cast<int>(m_anchorX.size());
 
     if (m_outputTensors.size() == 4) {
         // 4-output model: [scores1, scores2, regressors1, regressors2] split by feature map
-        const Tensor& scores1 = m_outputTensors[0];      // [1, 512, 1]
-        const Tensor& scores2 = m_outputTensors[1];      // [1, 384, 1]
-        const Tensor& regressors1 = m_outputTensors[2];  // [1, 512, 16]
-        const Tensor& regressors2 = m_outputTensors[3];  // [1, 384, 16]
-
-        if (scores1.data.empty() || regressors1.data.empty()) return;
-
-        // Concatenate scores: 512 + 384 = 896
-        std::vector<float> allScores;
-        allScores.reserve(scores1.data.size() + scores2.data.size());
-        allScores.insert(allScores.end(), scores1.data.begin(), scores1.data.end());
-        allScores.insert(allScores.end(), scores2.data.begin(), scores2.data.end());
-
-        // Concatenate regressors: 512*16 + 384*16
-        std::vector<float> allRegressors;
-        allRegressors.reserve(regressors1.data.size() + regressors2.data.size());
-        allRegressors.insert(allRegressors.end(), regressors1.data.begin(), regressors1.data.end());
-        allRegressors.insert(allRegressors.end(), regressors2.data.begin(), regressors2.data.end());
-
-        decodeDetections(allRegressors.data(), allScores.data(),
-                        static_cast<int>(m_anchors.size()));
+        const auto scores1 = m_outputTensors[0].as<float>();      // [1, 512, 1]
+        const auto scores2 = m_outputTensors[1].as<float>();      // [1, 384, 1]
+        const auto regressors1 = m_outputTensors[2].as<float>();  // [1, 512, 16]
+        const auto regressors2 = m_outputTensors[3].as<float>();  // [1, 384, 16]
+
+        if (scores1.empty() || regressors1.empty()) return;
+
+        int count1 = static_cast<int>(std::min(scores1.size(), regressors1.size() / 16));
+        int count2 = static_cast<int>(std::min(scores2.size(), regressors2.size() / 16));
+        count1 = std::min(count1, numAnchors);
+        count2 = std::min(count2, numAnchors - count1);
+
+        collectCandidates(regressors1.data(), 16, scores1.data(), 1, 0, count1);
+        collectCandidates(regressors2.data(), 16, scores2.data(), 1, count1, count2);
     } else if (m_outputTensors.size() >= 2) {
         // 2-output model (regressors + classificators)
-        const Tensor& regressors = m_outputTensors[0];
-        const Tensor& scores = m_outputTensors[1];
+        const auto regressors = m_outputTensors[0].as<float>();
+        const auto scores = m_outputTensors[1].as<float>();
 
-        if (regressors.data.empty() || scores.data.empty()) return;
+        if (regressors.empty() || scores.empty()) return;
 
-        decodeDetections(regressors.data.data(), scores.data.data(),
-                        static_cast<int>(m_anchors.size()));
+        int count = static_cast<int>(std::min(scores.size(), regressors.size() / 16));
+        collectCandidates(regressors.data(), 16, scores.data(), 1,
+                          0, std::min(count, numAnchors));
     } else if (m_outputTensors.size() == 1) {
         // Single output model - try to parse as combined format
-        if (tensor.data.empty()) return;
+        const auto values = tensor.as<float>();
+        if (values.empty() || numAnchors == 0) return;
 
         // Some models output [1, 896, 17] with confidence as last value
-        int numAnchors = static_cast<int>(m_anchors.size());
-        int valuesPerAnchor = static_cast<int>(tensor.data.size()) / numAnchors;
+        int valuesPerAnchor = static_cast<int>(values.size()) / numAnchors;
 
         if (valuesPerAnchor >= 17) {
             // Combined format: 16 box values + 1 confidence
-            for (int i = 0; i < numAnchors && static_cast<int>(m_faces.size()) < m_maxFaces; i++) {
-                const float* data = &tensor.data[i * valuesPerAnchor];
-                float score = 1.0f / (1.0f + std::exp(-data[16])); // Sigmoid
-
-                if (score >= m_confidenceThreshold) {
-                    DetectedFace face;
-                    face.confidence = score;
-
-                    // Decode bounding box using BlazeFace formula (scale = 128)
-                    const float scale = 128.0f;
-                    float cx = data[0] / scale + m_anchors[i][0];
-                    float cy = data[1] / scale + m_anchors[i][1];
-                    float w = data[2] / scale;
-                    float h = data[3] / scale;
-
-                    face.bbox = glm::vec4(
-                        std::clamp(cx - w/2, 0.0f, 1.0f),
-                        std::clamp(cy - h/2, 0.0f, 1.0f),
-                        std::clamp(w, 0.0f, 1.0f),
-                        std::clamp(h, 0.0f, 1.0f)
-                    );
-
-                    // Decode landmarks using same scale
-                    for (int l = 0; l < 6; l++) {
-                        float lx = data[4 + l*2] / scale + m_anchors[i][0];
-                        float ly = data[4 + l*2 + 1] / scale + m_anchors[i][1];
-                        face.landmarks[l] = glm::vec2(
-                            std::clamp(lx, 0.0f, 1.0f),
-                            std::clamp(ly, 0.0f, 1.0f)
-                        );
-                    }
-
-                    m_faces.push_back(face);
-                }
-            }
+            collectCandidates(values.data(), valuesPerAnchor,
+                              values.data() + 16, valuesPerAnchor, 0, numAnchors);
         }
     }
 
+    decodeCandidates();
+
     // Apply non-max suppression
     nonMaxSuppression();
-}
-
-void FaceDetector::decodeDetections(const float* regressors, const float* scores,
-                                     int numAnchors) {
-    // Decode all detections above threshold
-    std::vector<DetectedFace> candidates;
 
-    for (int i = 0; i < numAnchors; i++) {
-        // Apply sigmoid to score
-        float score = 1.0f / (1.0f + std::exp(-scores[i]));
-
-        if (score >= m_confidenceThreshold) {
-            DetectedFace face;
-            face.confidence = score;
-
-            const float* box = &regressors[i * 16];
-
-            // Decode bounding box using BlazeFace formula
-            // raw_output / scale * anchor_size + anchor_center
-            // Scale is 128 for front model (same as input size)
-            const float scale = 128.0f;
-            float cx = box[0] / scale + m_anchors[i][0];
-            float cy = box[1] / scale + m_anchors[i][1];
-            float w = box[2] / scale;
-            float h = box[3] / scale;
-
-            // Convert to x,y,w,h format (normalized)
-            face.bbox = glm::vec4(
-                std::clamp(cx - w/2, 0.0f, 1.0f),
-                std::clamp(cy - h/2, 0.0f, 1.0f),
-                std::clamp(w, 0.0f, 1.0f),
-                std::clamp(h, 0.0f, 1.0f)
-            );
+    mapToSource();
+}
 
-            // Decode 6 landmarks using same scale
-            for (int l = 0; l < 6; l++) {
-                float lx = box[4 + l*2] / scale + m_anchors[i][0];
-                float ly = box[4 + l*2 + 1] / scale + m_anchors[i][1];
-                face.landmarks[l] = glm::vec2(
-                    std::clamp(lx, 0.0f, 1.0f),
-                    std::clamp(ly, 0.0f, 1.0f)
-                );
-            }
+void FaceDetector::mapToSource() {
+    const SourceRect& region = inputRegion();
+    if (region == SourceRect{}) return;
+
+    // Input (aspect mode) to source-normalized coordinates; faces centered
+    // in letterbox padding are dropped
+    auto map = [&region](float x, float y) {
+        return glm::vec2(region.x + region.width * x, region.y + region.height * y);
+    };
+    size_t kept = 0;
+    for (size_t i = 0; i < m_faces.size(); i++) {
+        DetectedFace face = m_faces[i];
+        glm::vec2 origin = map(face.bbox.x, face.bbox.y);
+        glm::vec2 size(face.bbox.z * region.width, face.bbox.w * region.height);
+        glm::vec2 center = origin + size * 0.5f;
+        if (center.x < 0.0f || center.x > 1.0f || center.y < 0.0f || center.y > 1.0f) continue;
+
+        glm::vec2 lo = glm::clamp(origin, glm::vec2(0.0f), glm::vec2(1.0f));
+        glm::vec2 hi = glm::clamp(origin + size, glm::vec2(0.0f), glm::vec2(1.0f));
+        face.bbox = glm::vec4(lo.x, lo.y, hi.x - lo.x, hi.y - lo.y);
+        for (auto& lm : face.landmarks) {
+            lm = glm::clamp(map(lm.x, lm.y), glm::vec2(0.0f), glm::vec2(1.0f));
+        }
+        m_faces[kept++] = face;
+    }
+    m_faces.resize(kept);
+}
 
-            candidates.push_back(face);
+void FaceDetector::collectCandidates(const float* regressors, int regressorStride,
+                                     const float* scores, int scoreStride,
+                                     int firstAnchor, int count) {
+    // Compare raw scores against the inverse-sigmoid threshold, so sigmoid
+    // only runs on the few anchors that survive
+    const float threshold = m_logitThreshold;
+    for (int i = 0; i < count; i++) {
+        float logit = scores[i * scoreStride];
+        if (logit >= threshold) {
+            m_candidates.push_back({logit, firstAnchor + i, regressors + i * regressorStride});
         }
     }
+}
 
-    // Sort by confidence
-    std::sort(candidates.begin(), candidates.end(),
-              [](const DetectedFace& a, const DetectedFace& b) {
-                  return a.confidence > b.confidence;
-              });
+void FaceDetector::decodeCandidates() {
+    // Keep the top candidates before NMS (ranking logits == ranking scores)
+    size_t keep = std::min(m_candidates.size(), static_cast<size_t>(m_maxFaces) * 3);
+    std::partial_sort(m_candidates.begin(), m_candidates.begin() + keep, m_candidates.end(),
+                      [](const Candidate& a, const Candidate& b) {
+                          return a.logit > b.logit;
+                      });
+
+    m_faces.resize(keep);
+    for (size_t c = 0; c < keep; c++) {
+        const Candidate& candidate = m_candidates[c];
+        const float* box = candidate.box;
+        const float anchorX = m_anchorX[candidate.anchor];
+        const float anchorY = m_anchorY[candidate.anchor];
+        DetectedFace& face = m_faces[c];
 
-    // Take top candidates before NMS
-    if (static_cast<int>(candidates.size()) > m_maxFaces * 3) {
-        candidates.resize(m_maxFaces * 3);
+        // Apply sigmoid to score
+        face.confidence = 1.0f / (1.0f + std::exp(-candidate.logit));
+        face.id = -1;
+
+        // Decode bounding box using BlazeFace formula
+        // raw_output / scale * anchor_size + anchor_center
+        // Scale is 128 for front model (same as input size)
+        const float scale = 128.0f;
+        float cx = box[0] / scale + anchorX;
+        float cy = box[1] / scale + anchorY;
+        float w = box[2] / scale;
+        float h = box[3] / scale;
+
+        // Convert to x,y,w,h format (normalized)
+        face.bbox = glm::vec4(
+            std::clamp(cx - w/2, 0.0f, 1.0f),
+            std::clamp(cy - h/2, 0.0f, 1.0f),
+            std::clamp(w, 0.0f, 1.0f),
+            std::clamp(h, 0.0f, 1.0f)
+        );
+
+        // Decode 6 landmarks using same scale
+        for (int l = 0; l < 6; l++) {
+            float lx = box[4 + l*2] / scale + anchorX;
+            float ly = box[4 + l*2 + 1] / scale + anchorY;
+            face.landmarks[l] = glm::vec2(
+                std::clamp(lx, 0.0f, 1.0f),
+                std::clamp(ly, 0.0f, 1.0f)
+            );
+        }
     }
-
-    m_faces = std::move(candidates);
 }
 
 void FaceDetector::nonMaxSuppression() {
     if (m_faces.empty()) return;
 
-    const float iouThreshold = 0.3f;
-    std::vector<DetectedFace> kept;
-    std::vector<bool> suppressed(m_faces.size(), false);
-
-    for (size_t i = 0; i < m_faces.size() && static_cast<int>(kept.size()) < m_maxFaces; i++) {
-        if (suppressed[i]) continue;
-
-        kept.push_back(m_faces[i]);
-        const auto& boxA = m_faces[i].bbox;
-
-        // Suppress overlapping detections
-        for (size_t j = i + 1; j < m_faces.size(); j++) {
-            if (suppressed[j]) continue;
-
-            const auto& boxB = m_faces[j].bbox;
-
-            // Calculate IoU
-            float x1 = std::max(boxA.x, boxB.x);
-            float y1 = std::max(boxA.y, boxB.y);
-            float x2 = std::min(boxA.x + boxA.z, boxB.x + boxB.z);
-            float y2 = std::min(boxA.y + boxA.w, boxB.y + boxB.w);
-
-            float intersection = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
-            float areaA = boxA.z * boxA.w;
-            float areaB = boxB.z * boxB.w;
-            float unionArea = areaA + areaB - intersection;
+    m_nms.clear();
+    for (const auto& face : m_faces) {
+        float landmarks[12];
+        packLandmarks(face, landmarks);
+        m_nms.add(face.bbox, face.confidence, landmarks);
+    }
 
-            float iou = (unionArea > 0) ? intersection / unionArea : 0.0f;
+    double start = nowSeconds();
+    size_t count = m_nms.run(static_cast<size_t>(m_maxFaces));
+    recordNmsTime((nowSeconds() - start) * 1000.0);
+    m_faces.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        DetectedFace& face = m_faces[i];
+        face.bbox = m_nms.box(i);
+        face.confidence = m_nms.score(i);
+        unpackLandmarks(m_nms.attributes(i), face);
+    }
+}
 
-            if (iou > iouThreshold) {
-                suppressed[j] = true;
-            }
-        }
+void FaceDetector::trackFaces(DetectionTracker& tracker) {
+    if (tracker.valueCount() != 12) {
+        tracker.valueCount(12);
     }
 
-    m_faces = std::move(kept);
+    tracker.clear();
+    for (const auto& face : m_faces) {
+        float landmarks[12];
+        packLandmarks(face, landmarks);
+        tracker.add(face.bbox, face.confidence, landmarks);
+    }
+    tracker.update(nowSeconds());
+
+    for (size_t i = 0; i < m_faces.size(); i++) {
+        const auto& track = tracker.tracks()[tracker.trackFor(i)];
+        DetectedFace& face = m_faces[i];
+        face.id = track.id;
+        face.bbox = track.box;
+        unpackLandmarks(track.values.data(), face);
+    }
 }
 
 } // namespace vivid::onnx
@@ -0,0 +1,390 @@
+#include <vivid/onnx/gpu_mask.h>
+#include <webgpu/wgpu.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace vivid::onnx {
+
+namespace {
+
+// One invocation per output texel. `main` samples the mask bilinearly,
+// `guided` runs the joint bilateral filter against the guide texture; each
+// pipeline's layout only has the bindings its entry point uses.
+const char* kMaskShader = R"(
+struct Params {
+    region: vec4f,
+    maskSize: vec2u,
+    outSize: vec2u,
+    threshold: f32,
+    softness: f32,
+    spatial: f32,
+    range: f32,
+    radius: i32,
+}
+
+@group(0) @binding(0) var<storage, read> mask: array<f32>;
+@group(0) @binding(1) var guide: texture_2d<f32>;
+@group(0) @binding(2) var guideSampler: sampler;
+@group(0) @binding(3) var dst: texture_storage_2d<rgba8unorm, write>;
+@group(0) @binding(4) var<uniform> params: Params;
+
+fn maskTexel(p: vec2i) -> f32 {
+    let c = clamp(p, vec2i(0), vec2i(params.maskSize) - 1);
+    return mask[u32(c.y) * params.maskSize.x + u32(c.x)];
+}
+
+fn sampleMask(pos: vec2f) -> f32 {
+    let p = pos - 0.5;
+    let base = floor(p);
+    let f = p - base;
+    let i = vec2i(base);
+    let top = mix(maskTexel(i), maskTexel(i + vec2i(1, 0)), f.x);
+    let bottom = mix(maskTexel(i + vec2i(0, 1)), maskTexel(i + vec2i(1, 1)), f.x);
+    return mix(top, bottom, f.y);
+}
+
+fn shapeMask(m: f32) -> f32 {
+    if (params.threshold <= 0.0) {
+        return clamp(m, 0.0, 1.0);
+    }
+    let edge = max(params.softness, 1e-4) * 0.5;
+    return smoothstep(params.threshold - edge, params.threshold + edge, m);
+}
+
+// Output texel to mask texel coordinates (texel centers at +0.5)
+fn maskCoord(id: vec2u) -> vec2f {
+    let uv = (vec2f(id) + 0.5) / vec2f(params.outSize);
+    return (uv - params.region.xy) / params.region.zw * vec2f(params.maskSize);
+}
+
+fn insideMask(pos: vec2f) -> bool {
+    return all(pos >= vec2f(0.0)) && all(pos <= vec2f(params.maskSize));
+}
+
+@compute @workgroup_size(8, 8)
+fn main(@builtin(global_invocation_id) id: vec3u) {
+    if (id.x >= params.outSize.x || id.y >= params.outSize.y) {
+        return;
+    }
+    let pos = maskCoord(id.xy);
+    var m = 0.0;
+    if (insideMask(pos)) {
+        m = shapeMask(sampleMask(pos));
+    }
+    textureStore(dst, id.xy, vec4f(m));
+}
+
+@compute @workgroup_size(8, 8)
+fn guided(@builtin(global_invocation_id) id: vec3u) {
+    if (id.x >= params.outSize.x || id.y >= params.outSize.y) {
+        return;
+    }
+    let pos = maskCoord(id.xy);
+    if (!insideMask(pos)) {
+        textureStore(dst, id.xy, vec4f(0.0));
+        return;
+    }
+
+    let uv = (vec2f(id.xy) + 0.5) / vec2f(params.outSize);
+    let center = textureSampleLevel(guide, guideSampler, uv, 0.0).rgb;
+    let base = vec2i(floor(pos));
+    let maskSize = vec2f(params.maskSize);
+
+    var sum = 0.0;
+    var weights = 0.0;
+    for (var dy = -params.radius; dy <= params.radius; dy++) {
+        for (var dx = -params.radius; dx <= params.radius; dx++) {
+            let texel = base + vec2i(dx, dy);
+            let texelCenter = vec2f(texel) + 0.5;
+            let d = texelCenter - pos;
+            // Guide color where this mask texel was computed
+            let guideUv = params.region.xy + texelCenter / maskSize * params.region.zw;
+            let diff = textureSampleLevel(guide, guideSampler, guideUv, 0.0).rgb - center;
+            let w = exp(dot(d, d) * params.spatial + dot(diff, diff) * params.range);
+            sum += w * maskTexel(texel);
+            weights += w;
+        }
+    }
+    textureStore(dst, id.xy, vec4f(shapeMask(sum / max(weights, 1e-6))));
+}
+)";
+
+// Matches the WGSL Params struct (uniform layout: 64 bytes)
+struct ShaderParams {
+    float region[4];
+    uint32_t maskWidth;
+    uint32_t maskHeight;
+    uint32_t outWidth;
+    uint32_t outHeight;
+    float threshold;
+    float softness;
+    float spatial;
+    float range;
+    int32_t radius;
+    uint32_t pad[3];
+};
+static_assert(sizeof(ShaderParams) == 64, "ShaderParams must match the WGSL layout");
+
+constexpr uint32_t kWorkgroupSize = 8;
+constexpr int kMaxRadius = 4;
+
+WGPUStringView toStringView(const char* str) {
+    return {str, WGPU_STRLEN};
+}
+
+template <typename T, typename Release>
+void releaseHandle(T& handle, Release release) {
+    if (handle) {
+        release(handle);
+        handle = nullptr;
+    }
+}
+
+} // namespace
+
+struct GpuMaskUpsampler::Resources {
+    WGPUShaderModule shader = nullptr;
+    WGPUComputePipeline plain = nullptr;
+    WGPUComputePipeline guided = nullptr;
+    WGPUBindGroupLayout plainLayout = nullptr;
+    WGPUBindGroupLayout guidedLayout = nullptr;
+    WGPUSampler sampler = nullptr;
+    WGPUBuffer params = nullptr;
+
+    // Model-resolution mask, resized on demand
+    WGPUBuffer mask = nullptr;
+    uint64_t maskBytes = 0;
+
+    // Output texture, recreated when the output size changes
+    WGPUTexture texture = nullptr;
+    WGPUTextureView view = nullptr;
+
+    void releaseTexture() {
+        releaseHandle(view, wgpuTextureViewRelease);
+        if (texture) wgpuTextureDestroy(texture);
+        releaseHandle(texture, wgpuTextureRelease);
+    }
+
+    ~Resources() {
+        releaseTexture();
+        releaseHandle(mask, wgpuBufferRelease);
+        releaseHandle(params, wgpuBufferRelease);
+        releaseHandle(sampler, wgpuSamplerRelease);
+        releaseHandle(guidedLayout, wgpuBindGroupLayoutRelease);
+        releaseHandle(plainLayout, wgpuBindGroupLayoutRelease);
+        releaseHandle(guided, wgpuComputePipelineRelease);
+        releaseHandle(plain, wgpuComputePipelineRelease);
+        releaseHandle(shader, wgpuShaderModuleRelease);
+    }
+};
+
+GpuMaskUpsampler::GpuMaskUpsampler() = default;
+
+GpuMaskUpsampler::~GpuMaskUpsampler() {
+    release();
+}
+
+void GpuMaskUpsampler::release() {
+    m_gpu.reset();
+    m_device = nullptr;
+    m_failed = false;
+    m_maskWidth = m_maskHeight = 0;
+    m_width = m_height = 0;
+}
+
+WGPUTextureView GpuMaskUpsampler::view() const {
+    return m_gpu ? m_gpu->view : nullptr;
+}
+
+bool GpuMaskUpsampler::createPipelines(WGPUDevice device) {
+    if (device != m_device) {
+        release();
+        m_device = device;
+    }
+    if (m_failed) return false;
+    if (m_gpu) return true;
+
+    // Pipelines, sampler and uniforms are created once per device
+    auto gpu = std::make_unique<Resources>();
+
+    WGPUShaderSourceWGSL wgsl = {};
+    wgsl.chain.sType = WGPUSType_ShaderSourceWGSL;
+    wgsl.code = toStringView(kMaskShader);
+    WGPUShaderModuleDescriptor shaderDesc = {};
+    shaderDesc.nextInChain = &wgsl.chain;
+    shaderDesc.label = toStringView("vivid-onnx mask");
+    gpu->shader = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+
+    auto createPipeline = [&](const char* entryPoint, WGPUBindGroupLayout& layout) {
+        WGPUComputePipelineDescriptor pipelineDesc = {};
+        pipelineDesc.label = toStringView("vivid-onnx mask");
+        pipelineDesc.compute.module = gpu->shader;
+        pipelineDesc.compute.entryPoint = toStringView(entryPoint);
+        WGPUComputePipeline pipeline = gpu->shader ? wgpuDeviceCreateComputePipeline(device, &pipelineDesc) : nullptr;
+        layout = pipeline ? wgpuComputePipelineGetBindGroupLayout(pipeline, 0) : nullptr;
+        return pipeline;
+    };
+    gpu->plain = createPipeline("main", gpu->plainLayout);
+    gpu->guided = createPipeline("guided", gpu->guidedLayout);
+
+    WGPUSamplerDescriptor samplerDesc = {};
+    samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+    samplerDesc.magFilter = WGPUFilterMode_Linear;
+    samplerDesc.minFilter = WGPUFilterMode_Linear;
+    samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Linear;
+    samplerDesc.lodMaxClamp = 32.0f;
+    samplerDesc.maxAnisotropy = 1;
+    gpu->sampler = wgpuDeviceCreateSampler(device, &samplerDesc);
+
+    WGPUBufferDescriptor paramsDesc = {};
+    paramsDesc.label = toStringView("vivid-onnx mask params");
+    paramsDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+    paramsDesc.size = sizeof(ShaderParams);
+    gpu->params = wgpuDeviceCreateBuffer(device, &paramsDesc);
+
+    if (!gpu->plainLayout || !gpu->guidedLayout || !gpu->sampler || !gpu->params) {
+        std::cerr << "[GpuMaskUpsampler] Failed to create compute pipeline, mask texture disabled" << std::endl;
+        m_failed = true;
+        return false;
+    }
+    m_gpu = std::move(gpu);
+    return true;
+}
+
+bool GpuMaskUpsampler::upload(WGPUDevice device, WGPUQueue queue, const float* mask, int width, int height) {
+    if (!device || !queue || !mask || width <= 0 || height <= 0) return false;
+    if (!createPipelines(device)) return false;
+
+    Resources& gpu = *m_gpu;
+    const uint64_t bytes = static_cast<uint64_t>(width) * height * sizeof(float);
+    if (bytes != gpu.maskBytes) {
+        releaseHandle(gpu.mask, wgpuBufferRelease);
+        gpu.maskBytes = 0;
+
+        WGPUBufferDescriptor maskDesc = {};
+        maskDesc.label = toStringView("vivid-onnx mask");
+        maskDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+        maskDesc.size = bytes;
+        gpu.mask = wgpuDeviceCreateBuffer(device, &maskDesc);
+        if (!gpu.mask) return false;
+        gpu.maskBytes = bytes;
+    }
+
+    wgpuQueueWriteBuffer(queue, gpu.mask, 0, mask, static_cast<size_t>(bytes));
+    m_maskWidth = width;
+    m_maskHeight = height;
+    return true;
+}
+
+bool GpuMaskUpsampler::render(WGPUDevice device, WGPUQueue queue, int outputWidth, int outputHeight,
+                              const SourceRect& region, WGPUTextureView guide, const MaskFilter& filter) {
+    if (!device || !queue || outputWidth <= 0 || outputHeight <= 0 ||
+        !(region.width > 0.0f) || !(region.height > 0.0f)) {
+        return false;
+    }
+    // upload() creates the pipelines; nothing to render before it
+    if (device != m_device || !m_gpu || m_maskWidth <= 0) return false;
+
+    Resources& gpu = *m_gpu;
+    if (!gpu.texture || outputWidth != m_width || outputHeight != m_height) {
+        gpu.releaseTexture();
+        m_width = m_height = 0;
+
+        WGPUTextureDescriptor textureDesc = {};
+        textureDesc.label = toStringView("vivid-onnx mask texture");
+        textureDesc.usage = WGPUTextureUsage_StorageBinding | WGPUTextureUsage_TextureBinding |
+                            WGPUTextureUsage_CopySrc;
+        textureDesc.dimension = WGPUTextureDimension_2D;
+        textureDesc.size = {static_cast<uint32_t>(outputWidth), static_cast<uint32_t>(outputHeight), 1};
+        textureDesc.format = WGPUTextureFormat_RGBA8Unorm;
+        textureDesc.mipLevelCount = 1;
+        textureDesc.sampleCount = 1;
+        gpu.texture = wgpuDeviceCreateTexture(device, &textureDesc);
+        gpu.view = gpu.texture ? wgpuTextureCreateView(gpu.texture, nullptr) : nullptr;
+        if (!gpu.view) {
+            gpu.releaseTexture();
+            return false;
+        }
+        m_width = outputWidth;
+        m_height = outputHeight;
+    }
+
+    // Bound per frame: a guide view freed upstream (e.g. a camera texture
+    // recreated on a resolution change) can come back at the same address
+    const bool guided = guide && filter.bilateral;
+    WGPUBindGroupEntry entries[5] = {};
+    size_t count = 0;
+    entries[count].binding = 0;
+    entries[count].buffer = gpu.mask;
+    entries[count].size = gpu.maskBytes;
+    count++;
+    if (guided) {
+        entries[count].binding = 1;
+        entries[count].textureView = guide;
+        count++;
+        entries[count].binding = 2;
+        entries[count].sampler = gpu.sampler;
+        count++;
+    }
+    entries[count].binding = 3;
+    entries[count].textureView = gpu.view;
+    count++;
+    entries[count].binding = 4;
+    entries[count].buffer = gpu.params;
+    entries[count].size = sizeof(ShaderParams);
+    count++;
+
+    WGPUBindGroupDescriptor bindDesc = {};
+    bindDesc.layout = guided ? gpu.guidedLayout : gpu.plainLayout;
+    bindDesc.entryCount = count;
+    bindDesc.entries = entries;
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindDesc);
+    if (!bindGroup) return false;
+
+    // Gaussian exponents, precomputed: exp(d^2 * spatial + c^2 * range)
+    const float spatialSigma = std::max(filter.spatialSigma, 0.1f);
+    const float rangeSigma = std::max(filter.rangeSigma, 1e-3f);
+    ShaderParams params = {};
+    params.region[0] = region.x;
+    params.region[1] = region.y;
+    params.region[2] = region.width;
+    params.region[3] = region.height;
+    params.maskWidth = static_cast<uint32_t>(m_maskWidth);
+    params.maskHeight = static_cast<uint32_t>(m_maskHeight);
+    params.outWidth = static_cast<uint32_t>(outputWidth);
+    params.outHeight = static_cast<uint32_t>(outputHeight);
+    params.threshold = filter.threshold;
+    params.softness = filter.softness;
+    params.spatial = -1.0f / (2.0f * spatialSigma * spatialSigma);
+    params.range = -1.0f / (2.0f * rangeSigma * rangeSigma);
+    params.radius = std::clamp(static_cast<int>(std::ceil(2.0f * spatialSigma)), 1, kMaxRadius);
+    wgpuQueueWriteBuffer(queue, gpu.params, 0, &params, sizeof(params));
+
+    WGPUCommandEncoderDescriptor encoderDesc = {};
+    encoderDesc.label = toStringView("vivid-onnx mask");
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
+
+    WGPUComputePassDescriptor passDesc = {};
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &passDesc);
+    wgpuComputePassEncoderSetPipeline(pass, guided ? gpu.guided : gpu.plain);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass,
+        (params.outWidth + kWorkgroupSize - 1) / kWorkgroupSize,
+        (params.outHeight + kWorkgroupSize - 1) / kWorkgroupSize, 1);
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+
+    // No readback: the texture is consumed on the GPU by the next operator
+    WGPUCommandBufferDescriptor cmdDesc = {};
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, &cmdDesc);
+    wgpuCommandEncoderRelease(encoder);
+    wgpuQueueSubmit(queue, 1, &commands);
+    wgpuCommandBufferRelease(commands);
+    wgpuBindGroupRelease(bindGroup);   // the submitted commands keep it alive
+    return true;
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,355 @@
+#include <vivid/onnx/gpu_preprocess.h>
+#include <webgpu/wgpu.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace vivid::onnx {
+
+namespace {
+
+// One invocation per output pixel. Sampling happens at tensor resolution, so
+// the full-size source never leaves the GPU. Values are scaled to 0-255
+// before normalization to match ImageResampler exactly. The source size is
+// appended after the tensor so callers learn it from the same readback.
+const char* kResampleShader = R"(
+struct Params {
+    scale: vec4f,
+    bias: vec4f,
+    region: vec4f,
+    size: vec2u,
+    channels: u32,
+    nchw: u32,
+    aspect: u32,
+}
+
+@group(0) @binding(0) var src: texture_2d<f32>;
+@group(0) @binding(1) var srcSampler: sampler;
+@group(0) @binding(2) var<storage, read_write> dst: array<f32>;
+@group(0) @binding(3) var<uniform> params: Params;
+
+@compute @workgroup_size(8, 8)
+fn main(@builtin(global_invocation_id) id: vec3u) {
+    if (id.x >= params.size.x || id.y >= params.size.y) {
+        return;
+    }
+
+    let texSize = textureDimensions(src);
+    let pixel = id.y * params.size.x + id.x;
+    let plane = params.size.x * params.size.y;
+    if (pixel == 0u) {
+        dst[plane * params.channels] = f32(texSize.x);
+        dst[plane * params.channels + 1u] = f32(texSize.y);
+    }
+
+    let dstSize = vec2f(params.size);
+    var uv = (vec2f(id.xy) + 0.5) / dstSize;
+    var inside = true;
+    if (params.aspect != 0u) {
+        // One scale for both axes, centered: Fit (1) shows the whole region
+        // and pads outside the content rect, Fill (2) crops it
+        let srcSize = vec2f(texSize) * params.region.zw;
+        let ratio = dstSize / srcSize;
+        var scale = min(ratio.x, ratio.y);
+        if (params.aspect == 2u) {
+            scale = max(ratio.x, ratio.y);
+        }
+        let content = srcSize * scale / dstSize;
+        uv = (uv - 0.5) / content + 0.5;
+        inside = all(uv >= vec2f(0.0)) && all(uv <= vec2f(1.0));
+    }
+    uv = params.region.xy + uv * params.region.zw;
+
+    var rgba = vec4f(0.0);
+    if (inside) {
+        rgba = textureSampleLevel(src, srcSampler, uv, 0.0) * 255.0;
+    }
+    var v = rgba * params.scale + params.bias;
+
+    for (var c = 0u; c < params.channels; c++) {
+        if (params.nchw != 0u) {
+            dst[c * plane + pixel] = v[c];
+        } else {
+            dst[pixel * params.channels + c] = v[c];
+        }
+    }
+}
+)";
+
+// Matches the WGSL Params struct (uniform layout: 80 bytes)
+struct ShaderParams {
+    float scale[4];
+    float bias[4];
+    float region[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t nchw;
+    uint32_t aspect;
+    uint32_t pad[3];
+};
+static_assert(sizeof(ShaderParams) == 80, "ShaderParams must match the WGSL layout");
+
+constexpr uint32_t kWorkgroupSize = 8;
+
+WGPUStringView toStringView(const char* str) {
+    return {str, WGPU_STRLEN};
+}
+
+template <typename T, typename Release>
+void releaseHandle(T& handle, Release release) {
+    if (handle) {
+        release(handle);
+        handle = nullptr;
+    }
+}
+
+} // namespace
+
+struct GpuResampler::Resources {
+    WGPUShaderModule shader = nullptr;
+    WGPUComputePipeline pipeline = nullptr;
+    WGPUBindGroupLayout layout = nullptr;
+    WGPUSampler sampler = nullptr;
+    WGPUBuffer params = nullptr;
+
+    // Tensor-sized output and its mappable copy, resized on demand
+    WGPUBuffer output = nullptr;
+    WGPUBuffer readback = nullptr;
+    uint64_t outputBytes = 0;
+
+    void releaseBuffers() {
+        releaseHandle(output, wgpuBufferRelease);
+        releaseHandle(readback, wgpuBufferRelease);
+        outputBytes = 0;
+    }
+
+    ~Resources() {
+        releaseBuffers();
+        releaseHandle(params, wgpuBufferRelease);
+        releaseHandle(sampler, wgpuSamplerRelease);
+        releaseHandle(layout, wgpuBindGroupLayoutRelease);
+        releaseHandle(pipeline, wgpuComputePipelineRelease);
+        releaseHandle(shader, wgpuShaderModuleRelease);
+    }
+};
+
+GpuResampler::GpuResampler() = default;
+
+GpuResampler::~GpuResampler() {
+    release();
+}
+
+void GpuResampler::release() {
+    m_gpu.reset();
+    m_device = nullptr;
+    m_failed = false;
+}
+
+bool GpuResampler::resample(WGPUDevice device, WGPUQueue queue, WGPUTextureView source,
+                            Tensor& tensor, int targetWidth, int targetHeight,
+                            const Normalization& norm, const SourceRect& region,
+                            AspectMode aspect) {
+    if (!device || !queue || !source || targetWidth <= 0 || targetHeight <= 0 ||
+        !(region.width > 0.0f) || !(region.height > 0.0f)) {
+        return false;
+    }
+
+    int channels = 3;
+    TensorLayout layout = detectLayout(tensor.shape, &channels);
+    channels = std::clamp(channels, 1, 4);
+
+    const size_t count = static_cast<size_t>(targetWidth) * targetHeight * channels;
+    if (tensor.size() < count || storageSize(tensor) < count) return false;
+
+    if (device != m_device) {
+        release();
+        m_device = device;
+    }
+    if (m_failed) return false;
+
+    // Pipeline, sampler and uniforms are created once per device
+    if (!m_gpu) {
+        auto gpu = std::make_unique<Resources>();
+
+        WGPUShaderSourceWGSL wgsl = {};
+        wgsl.chain.sType = WGPUSType_ShaderSourceWGSL;
+        wgsl.code = toStringView(kResampleShader);
+        WGPUShaderModuleDescriptor shaderDesc = {};
+        shaderDesc.nextInChain = &wgsl.chain;
+        shaderDesc.label = toStringView("vivid-onnx resample");
+        gpu->shader = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+
+        WGPUComputePipelineDescriptor pipelineDesc = {};
+        pipelineDesc.label = toStringView("vivid-onnx resample");
+        pipelineDesc.compute.module = gpu->shader;
+        pipelineDesc.compute.entryPoint = toStringView("main");
+        gpu->pipeline = gpu->shader ? wgpuDeviceCreateComputePipeline(device, &pipelineDesc) : nullptr;
+        gpu->layout = gpu->pipeline ? wgpuComputePipelineGetBindGroupLayout(gpu->pipeline, 0) : nullptr;
+
+        WGPUSamplerDescriptor samplerDesc = {};
+        samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+        samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+        samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+        samplerDesc.magFilter = WGPUFilterMode_Linear;
+        samplerDesc.minFilter = WGPUFilterMode_Linear;
+        samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Linear;
+        samplerDesc.lodMaxClamp = 32.0f;
+        samplerDesc.maxAnisotropy = 1;
+        gpu->sampler = wgpuDeviceCreateSampler(device, &samplerDesc);
+
+        WGPUBufferDescriptor paramsDesc = {};
+        paramsDesc.label = toStringView("vivid-onnx resample params");
+        paramsDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+        paramsDesc.size = sizeof(ShaderParams);
+        gpu->params = wgpuDeviceCreateBuffer(device, &paramsDesc);
+
+        if (!gpu->layout || !gpu->sampler || !gpu->params) {
+            std::cerr << "[GpuResampler] Failed to create compute pipeline, using CPU preprocessing" << std::endl;
+            m_failed = true;
+            return false;
+        }
+        m_gpu = std::move(gpu);
+    }
+
+    Resources& gpu = *m_gpu;
+    // Tensor values, then the source width and height
+    const uint64_t bytes = (count + 2) * sizeof(float);
+
+    if (bytes != gpu.outputBytes) {
+        gpu.releaseBuffers();
+
+        WGPUBufferDescriptor outputDesc = {};
+        outputDesc.label = toStringView("vivid-onnx tensor");
+        outputDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc;
+        outputDesc.size = bytes;
+        gpu.output = wgpuDeviceCreateBuffer(device, &outputDesc);
+
+        WGPUBufferDescriptor readbackDesc = {};
+        readbackDesc.label = toStringView("vivid-onnx tensor readback");
+        readbackDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+        readbackDesc.size = bytes;
+        gpu.readback = wgpuDeviceCreateBuffer(device, &readbackDesc);
+
+        if (!gpu.output || !gpu.readback) {
+            gpu.releaseBuffers();
+            return false;
+        }
+        gpu.outputBytes = bytes;
+    }
+
+    // Built per frame: a view released upstream can come back at the same
+    // address, so a cached bind group could sample a dead texture
+    WGPUBindGroupEntry entries[4] = {};
+    entries[0].binding = 0;
+    entries[0].textureView = source;
+    entries[1].binding = 1;
+    entries[1].sampler = gpu.sampler;
+    entries[2].binding = 2;
+    entries[2].buffer = gpu.output;
+    entries[2].size = bytes;
+    entries[3].binding = 3;
+    entries[3].buffer = gpu.params;
+    entries[3].size = sizeof(ShaderParams);
+
+    WGPUBindGroupDescriptor bindDesc = {};
+    bindDesc.layout = gpu.layout;
+    bindDesc.entryCount = 4;
+    bindDesc.entries = entries;
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindDesc);
+    if (!bindGroup) return false;
+
+    // Integer tensors take raw pixel values (same rule as ImageResampler)
+    const Normalization n = tensorNormalization(tensor.type, norm);
+    ShaderParams params = {};
+    std::copy(n.scale.begin(), n.scale.end(), params.scale);
+    std::copy(n.bias.begin(), n.bias.end(), params.bias);
+    params.region[0] = region.x;
+    params.region[1] = region.y;
+    params.region[2] = region.width;
+    params.region[3] = region.height;
+    params.width = static_cast<uint32_t>(targetWidth);
+    params.height = static_cast<uint32_t>(targetHeight);
+    params.channels = static_cast<uint32_t>(channels);
+    params.nchw = (layout == TensorLayout::NCHW) ? 1u : 0u;
+    params.aspect = static_cast<uint32_t>(aspect);
+    wgpuQueueWriteBuffer(queue, gpu.params, 0, &params, sizeof(params));
+
+    WGPUCommandEncoderDescriptor encoderDesc = {};
+    encoderDesc.label = toStringView("vivid-onnx resample");
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
+
+    WGPUComputePassDescriptor passDesc = {};
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &passDesc);
+    wgpuComputePassEncoderSetPipeline(pass, gpu.pipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass,
+        (params.width + kWorkgroupSize - 1) / kWorkgroupSize,
+        (params.height + kWorkgroupSize - 1) / kWorkgroupSize, 1);
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+
+    wgpuCommandEncoderCopyBufferToBuffer(encoder, gpu.output, 0, gpu.readback, 0, bytes);
+
+    WGPUCommandBufferDescriptor cmdDesc = {};
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, &cmdDesc);
+    wgpuCommandEncoderRelease(encoder);
+    wgpuQueueSubmit(queue, 1, &commands);
+    wgpuCommandBufferRelease(commands);
+    wgpuBindGroupRelease(bindGroup);   // the submitted commands keep it alive
+
+    // Only the tensor-sized buffer is mapped back. The callback holds its own
+    // reference to the state, so a map that completes after we give up
+    // writes to live memory.
+    struct MapState {
+        std::atomic<bool> done{false};
+        std::atomic<bool> ok{false};
+    };
+    auto state = std::make_shared<MapState>();
+
+    WGPUBufferMapCallbackInfo mapInfo = {};
+    mapInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+    mapInfo.callback = [](WGPUMapAsyncStatus status, WGPUStringView, void* userdata, void*) {
+        auto* held = static_cast<std::shared_ptr<MapState>*>(userdata);
+        (*held)->ok = (status == WGPUMapAsyncStatus_Success);
+        (*held)->done = true;
+        delete held;
+    };
+    mapInfo.userdata1 = new std::shared_ptr<MapState>(state);
+    wgpuBufferMapAsync(gpu.readback, WGPUMapMode_Read, 0, static_cast<size_t>(bytes), mapInfo);
+
+    // Block until the map resolves; a device that never answers stops GPU
+    // preprocessing, so no later frame maps the still-pending buffer
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!state->done) {
+        wgpuDevicePoll(device, true, nullptr);
+        if (state->done) break;
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "[GpuResampler] Tensor readback timed out, using CPU preprocessing" << std::endl;
+            m_failed = true;
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    if (!state->ok) {
+        std::cerr << "[GpuResampler] Tensor readback failed" << std::endl;
+        return false;
+    }
+
+    const float* mapped = static_cast<const float*>(
+        wgpuBufferGetConstMappedRange(gpu.readback, 0, static_cast<size_t>(bytes)));
+    if (mapped) {
+        assignFromFloat(tensor, mapped, count);
+        m_sourceWidth = static_cast<int>(mapped[count]);
+        m_sourceHeight = static_cast<int>(mapped[count + 1]);
+    }
+    wgpuBufferUnmap(gpu.readback);
+    return mapped != nullptr;
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,86 @@
+#include <vivid/onnx/model_buffer.h>
+#include <cstring>
+
+#ifdef _WIN32
+#include <filesystem>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vivid::onnx {
+
+std::shared_ptr<ModelBuffer> ModelBuffer::map(const std::string& path) {
+    std::shared_ptr<ModelBuffer> buffer(new ModelBuffer());
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);  // the mapping keeps the file open
+    if (!mapping) return nullptr;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+    buffer->m_mapping = mapping;
+    buffer->m_data = view;
+    buffer->m_size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);  // the mapping keeps the file open
+    if (view == MAP_FAILED) return nullptr;
+
+    buffer->m_data = view;
+    buffer->m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    buffer->m_mapped = true;
+    return buffer;
+}
+
+std::shared_ptr<ModelBuffer> ModelBuffer::wrap(const void* data, size_t size) {
+    if (!data || size == 0) return nullptr;
+    std::shared_ptr<ModelBuffer> buffer(new ModelBuffer());
+    buffer->m_data = data;
+    buffer->m_size = size;
+    return buffer;
+}
+
+ModelBuffer::~ModelBuffer() {
+    if (!m_mapped) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+#else
+    ::munmap(const_cast<void*>(m_data), m_size);
+#endif
+}
+
+bool ModelBuffer::isOrtFormat() const {
+    // Flatbuffer file identifier follows the 4-byte root offset
+    return m_size >= 8 && std::memcmp(static_cast<const char*>(m_data) + 4, "ORTM", 4) == 0;
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,90 @@
+#include <vivid/onnx/model_cache.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace vivid::onnx {
+
+static const char* kCacheDirName = ".vivid-onnx-cache";
+
+static constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;  // FNV prime
+    }
+    return hash;
+}
+
+uint64_t hashModelFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return 0;
+
+    uint64_t hash = kFnvOffset;
+    std::vector<char> buffer(1 << 16);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return hash;
+}
+
+uint64_t hashModelBytes(const void* data, size_t size) {
+    return fnv1a(kFnvOffset, data, size);
+}
+
+std::string modelCacheKey(const std::string& modelPath, const std::string& ortVersion,
+                          const std::string& provider) {
+    uint64_t hash = hashModelFile(modelPath);
+    if (hash == 0) return {};
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+
+    std::string ep = provider;
+    std::transform(ep.begin(), ep.end(), ep.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    // "-ext": saved at the extended level (earlier entries were full-level)
+    return fs::path(modelPath).stem().string() + "-" + hex + "-ort" + ortVersion + "-" + ep + "-ext";
+}
+
+// Create dir and check a file can be written there
+static bool isWritableDirectory(const fs::path& dir) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec || !fs::is_directory(dir, ec)) return false;
+
+    fs::path probe = dir / ".write-test";
+    {
+        std::ofstream file(probe, std::ios::binary);
+        if (!file) return false;
+    }
+    fs::remove(probe, ec);
+    return true;
+}
+
+fs::path modelCacheDirectory(const std::string& modelPath) {
+    std::error_code ec;
+    fs::path modelDir = fs::absolute(modelPath, ec).parent_path();
+    if (!ec && !modelDir.empty()) {
+        fs::path dir = modelDir / kCacheDirName;
+        if (isWritableDirectory(dir)) return dir;
+    }
+
+    // Read-only install: fall back to the system temp directory
+    fs::path temp = fs::temp_directory_path(ec);
+    if (!ec) {
+        fs::path dir = temp / "vivid-onnx-cache";
+        if (isWritableDirectory(dir)) return dir;
+    }
+    return {};
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,253 @@
+#include <vivid/onnx/nms.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include "simd.h"
+
+namespace vivid::onnx {
+
+NonMaxSuppression& NonMaxSuppression::mode(NmsMode mode) {
+    m_mode = mode;
+    return *this;
+}
+
+NonMaxSuppression& NonMaxSuppression::iouThreshold(float threshold) {
+    m_iouThreshold = std::clamp(threshold, 0.0f, 1.0f);
+    return *this;
+}
+
+NonMaxSuppression& NonMaxSuppression::softSigma(float sigma) {
+    m_softSigma = std::max(sigma, 1e-3f);
+    return *this;
+}
+
+NonMaxSuppression& NonMaxSuppression::minScore(float score) {
+    m_minScore = std::max(score, 0.0f);
+    return *this;
+}
+
+NonMaxSuppression& NonMaxSuppression::attributeCount(int count) {
+    m_attributeCount = std::max(count, 0);
+    clear();
+    return *this;
+}
+
+void NonMaxSuppression::clear() {
+    m_box.clear();
+    m_score.clear();
+    m_attributes.clear();
+}
+
+void NonMaxSuppression::add(const glm::vec4& box, float score, const float* attributes) {
+    m_box.push_back(box);
+    m_score.push_back(score);
+    if (m_attributeCount > 0) {
+        if (attributes) {
+            m_attributes.insert(m_attributes.end(), attributes, attributes + m_attributeCount);
+        } else {
+            m_attributes.resize(m_attributes.size() + m_attributeCount, 0.0f);
+        }
+    }
+}
+
+const float* NonMaxSuppression::attributes(size_t result) const {
+    if (m_attributeCount == 0) return nullptr;
+    return &m_resultAttributes[result * m_attributeCount];
+}
+
+float NonMaxSuppression::iou(const glm::vec4& a, const glm::vec4& b) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.z, b.x + b.z);
+    float y2 = std::min(a.y + a.w, b.y + b.w);
+
+    float intersection = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+    float unionArea = a.z * a.w + b.z * b.w - intersection;
+    return (unionArea > 0.0f) ? intersection / unionArea : 0.0f;
+}
+
+size_t NonMaxSuppression::run(size_t maxResults) {
+    m_resultBox.clear();
+    m_resultScore.clear();
+    m_resultIndex.clear();
+    m_resultAttributes.clear();
+    if (m_score.empty() || maxResults == 0) return 0;
+
+    sortByScore();
+
+    switch (m_mode) {
+        case NmsMode::Weighted: return runWeighted(maxResults);
+        case NmsMode::Soft: return runSoft(maxResults);
+        case NmsMode::Greedy:
+        default: return runGreedy(maxResults);
+    }
+}
+
+void NonMaxSuppression::sortByScore() {
+    const size_t n = m_score.size();
+    m_order.resize(n);
+    std::iota(m_order.begin(), m_order.end(), 0);
+    std::sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_score[a] > m_score[b] || (m_score[a] == m_score[b] && a < b);
+    });
+
+    m_x1.resize(n);
+    m_y1.resize(n);
+    m_x2.resize(n);
+    m_y2.resize(n);
+    m_area.resize(n);
+    m_sortedScore.resize(n);
+    m_alive.assign(n, 1);
+    m_iou.resize(n);
+
+    for (size_t i = 0; i < n; i++) {
+        const glm::vec4& b = m_box[m_order[i]];
+        m_x1[i] = b.x;
+        m_y1[i] = b.y;
+        m_x2[i] = b.x + b.z;
+        m_y2[i] = b.y + b.w;
+        m_area[i] = b.z * b.w;
+        m_sortedScore[i] = m_score[m_order[i]];
+    }
+}
+
+void NonMaxSuppression::computeIou(size_t ref, size_t begin, size_t end) {
+    const float rx1 = m_x1[ref], ry1 = m_y1[ref], rx2 = m_x2[ref], ry2 = m_y2[ref];
+    const float rArea = m_area[ref];
+    size_t j = begin;
+
+#if defined(VIVID_ONNX_SSE2)
+    const __m128 vx1 = _mm_set1_ps(rx1), vy1 = _mm_set1_ps(ry1);
+    const __m128 vx2 = _mm_set1_ps(rx2), vy2 = _mm_set1_ps(ry2);
+    const __m128 vArea = _mm_set1_ps(rArea);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 tiny = _mm_set1_ps(FLT_MIN);
+    for (; j + 4 <= end; j += 4) {
+        __m128 w = _mm_sub_ps(_mm_min_ps(vx2, _mm_loadu_ps(&m_x2[j])),
+                              _mm_max_ps(vx1, _mm_loadu_ps(&m_x1[j])));
+        __m128 h = _mm_sub_ps(_mm_min_ps(vy2, _mm_loadu_ps(&m_y2[j])),
+                              _mm_max_ps(vy1, _mm_loadu_ps(&m_y1[j])));
+        __m128 inter = _mm_mul_ps(_mm_max_ps(w, zero), _mm_max_ps(h, zero));
+        __m128 uni = _mm_sub_ps(_mm_add_ps(vArea, _mm_loadu_ps(&m_area[j])), inter);
+        __m128 q = _mm_div_ps(inter, _mm_max_ps(uni, tiny));
+        _mm_storeu_ps(&m_iou[j], _mm_and_ps(_mm_cmpgt_ps(uni, zero), q));
+    }
+#elif defined(VIVID_ONNX_NEON)
+    const float32x4_t vx1 = vdupq_n_f32(rx1), vy1 = vdupq_n_f32(ry1);
+    const float32x4_t vx2 = vdupq_n_f32(rx2), vy2 = vdupq_n_f32(ry2);
+    const float32x4_t vArea = vdupq_n_f32(rArea);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t tiny = vdupq_n_f32(FLT_MIN);
+    for (; j + 4 <= end; j += 4) {
+        float32x4_t w = vsubq_f32(vminq_f32(vx2, vld1q_f32(&m_x2[j])),
+                                  vmaxq_f32(vx1, vld1q_f32(&m_x1[j])));
+        float32x4_t h = vsubq_f32(vminq_f32(vy2, vld1q_f32(&m_y2[j])),
+                                  vmaxq_f32(vy1, vld1q_f32(&m_y1[j])));
+        float32x4_t inter = vmulq_f32(vmaxq_f32(w, zero), vmaxq_f32(h, zero));
+        float32x4_t uni = vsubq_f32(vaddq_f32(vArea, vld1q_f32(&m_area[j])), inter);
+        float32x4_t q = vdivq_f32(inter, vmaxq_f32(uni, tiny));
+        uint32x4_t valid = vcgtq_f32(uni, zero);
+        vst1q_f32(&m_iou[j], vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(q))));
+    }
+#endif
+
+    for (; j < end; j++) {
+        float w = std::min(rx2, m_x2[j]) - std::max(rx1, m_x1[j]);
+        float h = std::min(ry2, m_y2[j]) - std::max(ry1, m_y1[j]);
+        float inter = std::max(w, 0.0f) * std::max(h, 0.0f);
+        float uni = rArea + m_area[j] - inter;
+        m_iou[j] = (uni > 0.0f) ? inter / uni : 0.0f;
+    }
+}
+
+void NonMaxSuppression::keep(size_t sorted, const glm::vec4& box, float score) {
+    const int index = m_order[sorted];
+    m_resultBox.push_back(box);
+    m_resultScore.push_back(score);
+    m_resultIndex.push_back(index);
+    if (m_attributeCount > 0) {
+        const float* attrs = &m_attributes[static_cast<size_t>(index) * m_attributeCount];
+        m_resultAttributes.insert(m_resultAttributes.end(), attrs, attrs + m_attributeCount);
+    }
+}
+
+size_t NonMaxSuppression::runGreedy(size_t maxResults) {
+    const size_t n = m_sortedScore.size();
+    for (size_t i = 0; i < n && m_resultScore.size() < maxResults; i++) {
+        if (!m_alive[i]) continue;
+        keep(i, m_box[m_order[i]], m_sortedScore[i]);
+
+        computeIou(i, i + 1, n);
+        for (size_t j = i + 1; j < n; j++) {
+            if (m_iou[j] > m_iouThreshold) m_alive[j] = 0;
+        }
+    }
+    return m_resultScore.size();
+}
+
+size_t NonMaxSuppression::runWeighted(size_t maxResults) {
+    const size_t n = m_sortedScore.size();
+    const size_t attrCount = static_cast<size_t>(m_attributeCount);
+
+    for (size_t i = 0; i < n && m_resultScore.size() < maxResults; i++) {
+        if (!m_alive[i]) continue;
+
+        // Cluster: the best remaining box and every remaining box overlapping it
+        computeIou(i, i + 1, n);
+        float totalWeight = m_sortedScore[i];
+        glm::vec4 blended = m_box[m_order[i]] * totalWeight;
+        keep(i, m_box[m_order[i]], m_sortedScore[i]);
+        float* attrs = attrCount ? &m_resultAttributes[m_resultAttributes.size() - attrCount] : nullptr;
+        for (size_t a = 0; a < attrCount; a++) attrs[a] *= totalWeight;
+
+        for (size_t j = i + 1; j < n; j++) {
+            if (!m_alive[j] || m_iou[j] <= m_iouThreshold) continue;
+            m_alive[j] = 0;
+
+            const float weight = m_sortedScore[j];
+            const int index = m_order[j];
+            blended += m_box[index] * weight;
+            const float* member = attrCount ? &m_attributes[static_cast<size_t>(index) * attrCount] : nullptr;
+            for (size_t a = 0; a < attrCount; a++) attrs[a] += member[a] * weight;
+            totalWeight += weight;
+        }
+
+        // Score-weighted average; the result keeps the best score
+        if (totalWeight > 0.0f) {
+            const float inv = 1.0f / totalWeight;
+            m_resultBox.back() = blended * inv;
+            for (size_t a = 0; a < attrCount; a++) attrs[a] *= inv;
+        }
+    }
+    return m_resultScore.size();
+}
+
+size_t NonMaxSuppression::runSoft(size_t maxResults) {
+    const size_t n = m_sortedScore.size();
+    const float expScale = -1.0f / m_softSigma;
+
+    while (m_resultScore.size() < maxResults) {
+        // Best remaining (decayed) score
+        size_t best = n;
+        for (size_t i = 0; i < n; i++) {
+            if (m_alive[i] && (best == n || m_sortedScore[i] > m_sortedScore[best])) best = i;
+        }
+        if (best == n || m_sortedScore[best] < m_minScore) break;
+
+        keep(best, m_box[m_order[best]], m_sortedScore[best]);
+        m_alive[best] = 0;
+
+        // Gaussian decay: score *= exp(-iou^2 / sigma)
+        computeIou(best, 0, n);
+        for (size_t j = 0; j < n; j++) {
+            if (!m_alive[j]) continue;
+            const float overlap = m_iou[j];
+            m_sortedScore[j] *= std::exp(overlap * overlap * expScale);
+            if (m_sortedScore[j] < m_minScore) m_alive[j] = 0;
+        }
+    }
+    return m_resultScore.size();
+}
+
+} // namespace vivid::onnx
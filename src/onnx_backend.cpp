@@ -0,0 +1,821 @@
+#include <vivid/onnx/onnx_backend.h>
+#include <vivid/onnx/model_cache.h>
+#include <onnxruntime_cxx_api.h>
+#ifdef VIVID_ONNX_WITH_COREML
+#include <coreml_provider_factory.h>
+#endif
+#ifdef VIVID_ONNX_WITH_DIRECTML
+#include <dml_provider_factory.h>
+#endif
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace vivid::onnx {
+
+// =============================================================================
+// ONNX Runtime process state
+// =============================================================================
+
+// Process-wide runtime state: one Ort::Env (logger, global resources) shared
+// by every OnnxBackend, plus a registry of sessions keyed by model path and
+// session options. Instances on the same model share weights and the
+// optimized graph; idle sessions are kept warm for hot reload.
+//
+// The Env is created on first use so the global thread pool can still be
+// configured before any model loads.
+//
+// Declaration order matters: sessions must be destroyed before the Env.
+class OrtRuntime {
+public:
+    static OrtRuntime& instance() {
+        static OrtRuntime runtime;
+        return runtime;
+    }
+
+    /// The shared Env. If it doesn't exist yet it is created with global
+    /// thread pools when they were configured or wantGlobalPool is set.
+    Ort::Env& env(bool wantGlobalPool = false) {
+        std::lock_guard<std::mutex> lock(m_envMutex);
+        if (!m_env) {
+            if (m_globalPoolConfigured || wantGlobalPool) {
+                const ThreadPoolOptions& pool = m_globalPool;
+                Ort::ThreadingOptions threading;
+                if (pool.intraOpThreads > 0) threading.SetGlobalIntraOpNumThreads(pool.intraOpThreads);
+                if (pool.interOpThreads > 0) threading.SetGlobalInterOpNumThreads(pool.interOpThreads);
+                threading.SetGlobalSpinControl(pool.allowSpinning ? 1 : 0);
+                if (!pool.affinity.empty()) {
+                    Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(threading, pool.affinity.c_str()));
+                }
+                m_env = std::make_unique<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "vivid-onnx");
+                m_hasGlobalPool = true;
+                std::cout << "[OnnxBackend] Global thread pool: "
+                          << (pool.intraOpThreads > 0 ? std::to_string(pool.intraOpThreads) : std::string("default"))
+                          << " intra-op threads" << std::endl;
+            } else {
+                m_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "vivid-onnx");
+            }
+        }
+        return *m_env;
+    }
+
+    /// True if the Env was created with global thread pools
+    bool hasGlobalThreadPool() {
+        std::lock_guard<std::mutex> lock(m_envMutex);
+        return m_hasGlobalPool;
+    }
+
+    /// Store the global pool settings; fails once the Env exists
+    bool configureGlobalThreadPool(const ThreadPoolOptions& options) {
+        std::lock_guard<std::mutex> lock(m_envMutex);
+        if (m_env) return false;
+        m_globalPool = options;
+        m_globalPoolConfigured = true;
+        return true;
+    }
+
+    using SessionFactory = std::function<std::shared_ptr<Ort::Session>()>;
+
+    /// Get the session for key, creating it with factory on first use
+    std::shared_ptr<Ort::Session> acquire(const std::string& key, const SessionFactory& factory) {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& slot = m_entries[key];
+            if (!slot) slot = std::make_shared<Entry>();
+            slot->lastUsed = ++m_tick;
+            entry = slot;
+        }
+
+        // Per-entry lock: concurrent loads of the same model wait for one
+        // build, loads of different models proceed in parallel
+        std::shared_ptr<Ort::Session> session;
+        {
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            if (!entry->session) {
+                entry->session = factory();
+            } else {
+                std::cout << "[OnnxBackend] Reusing cached session: " << key << std::endl;
+            }
+            session = entry->session;
+        }
+
+        trimIdle();
+        return session;
+    }
+
+    /// Drop a session reference; the session stays cached while idle
+    void release(std::shared_ptr<Ort::Session>& session) {
+        session.reset();
+        trimIdle();
+    }
+
+    /// Destroy all sessions that no backend is using
+    void clearIdle() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (isIdle(*it->second)) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t sessionCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        std::shared_ptr<Ort::Session> session;
+        uint64_t lastUsed = 0;
+    };
+
+    OrtRuntime() = default;
+
+    static bool isIdle(Entry& entry) {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        return !entry.session || entry.session.use_count() == 1;
+    }
+
+    // Keep at most kMaxIdleSessions unused sessions, evicting least recently used
+    void trimIdle() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (true) {
+            size_t idleCount = 0;
+            auto oldest = m_entries.end();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                if (!isIdle(*it->second)) continue;
+                idleCount++;
+                if (oldest == m_entries.end() || it->second->lastUsed < oldest->second->lastUsed) {
+                    oldest = it;
+                }
+            }
+            if (idleCount <= kMaxIdleSessions) break;
+            m_entries.erase(oldest);
+        }
+    }
+
+    static constexpr size_t kMaxIdleSessions = 4;
+
+    std::mutex m_envMutex;
+    std::unique_ptr<Ort::Env> m_env;
+    ThreadPoolOptions m_globalPool;
+    bool m_globalPoolConfigured = false;
+    bool m_hasGlobalPool = false;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> m_entries;
+    uint64_t m_tick = 0;
+};
+
+struct OnnxBackend::OrtObjects {
+    std::shared_ptr<Ort::Session> session;
+    std::unique_ptr<Ort::SessionOptions> sessionOptions;
+    Ort::MemoryInfo memoryInfo{nullptr};
+    Ort::RunOptions runOptions;
+
+    // Options signature, part of the session cache key
+    std::string optionsKey;
+
+    // Model cache directory (must outlive the provider options that point at it)
+    std::string cacheDir;
+
+    // Input/output names as Run() takes them
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+
+    // Inputs and outputs bound once to Tensor storage via IoBinding, so a
+    // steady-state Run() allocates nothing and copies nothing. One slot per
+    // buffer set (the async pipeline has one per frame in flight) and input
+    // shape (see ONNXModel::cacheInputShapes()), picked by storage address
+    // and shape. The render and worker threads both run (e.g. RoiCascade's
+    // extra crops while the pipeline runs a frame), so a slot is held for
+    // the whole bind-run-copy sequence.
+    struct BindingSlot {
+        std::unique_ptr<Ort::IoBinding> binding;
+        std::vector<const void*> inputPtrs;
+        std::vector<std::vector<int64_t>> inputShapes;
+        std::vector<const void*> outputPtrs;
+        std::vector<std::vector<int64_t>> outputShapes;  // as bound, restored on reuse
+        std::vector<Tensor> nativeOutputs;  // non-float outputs, converted after each run
+        bool outputsBound = false;  // false: ORT allocates outputs, we copy
+        uint64_t lastUsed = 0;
+        bool inUse = false;         // guarded by slotMutex
+    };
+    std::deque<BindingSlot> slots = std::deque<BindingSlot>(2);   // stable when grown
+    uint64_t tick = 0;
+    std::mutex slotMutex;
+    std::condition_variable slotReleased;
+
+    // Take the slot bound to these inputs (else the least recently used
+    // free one), waiting while every slot is running
+    BindingSlot& acquireSlot(const std::vector<Tensor>& inputs);
+    void releaseSlot(BindingSlot& slot);
+
+    void resetBindings() {
+        for (auto& slot : slots) slot = BindingSlot{};
+    }
+
+    OrtObjects() : memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+    }
+};
+
+// =============================================================================
+// Execution providers
+// =============================================================================
+
+// Name ONNX Runtime reports in GetAvailableProviders()
+static const char* ortProviderName(ExecutionProvider ep) {
+    switch (ep) {
+        case ExecutionProvider::CPU:      return "CPUExecutionProvider";
+        case ExecutionProvider::CUDA:     return "CUDAExecutionProvider";
+        case ExecutionProvider::TensorRT: return "TensorrtExecutionProvider";
+        case ExecutionProvider::DirectML: return "DmlExecutionProvider";
+        case ExecutionProvider::CoreML:   return "CoreMLExecutionProvider";
+    }
+    return "";
+}
+
+// True if the linked ONNX Runtime package was built with this provider.
+// A provider can still fail at session creation (missing driver/CUDA libs).
+bool OnnxBackend::isProviderAvailable(ExecutionProvider ep) {
+    static const std::vector<std::string> available = Ort::GetAvailableProviders();
+    return std::find(available.begin(), available.end(), ortProviderName(ep)) != available.end();
+}
+
+// Register ep on options. Returns false if this build has no support for it;
+// throws Ort::Exception if the provider is present but fails to configure.
+// cacheDir (may be null) holds compiled provider artifacts such as TensorRT engines
+static bool appendExecutionProvider(Ort::SessionOptions& options, ExecutionProvider ep,
+                                    const char* cacheDir) {
+    switch (ep) {
+        case ExecutionProvider::CPU:
+            return true;  // Always registered implicitly
+
+        case ExecutionProvider::CUDA: {
+            OrtCUDAProviderOptions cuda{};
+            cuda.device_id = 0;
+            options.AppendExecutionProvider_CUDA(cuda);
+            return true;
+        }
+
+        case ExecutionProvider::TensorRT: {
+            OrtTensorRTProviderOptions trt{};
+            trt.device_id = 0;
+            if (cacheDir) {
+                // Engines are keyed by model, TensorRT version and GPU
+                trt.trt_engine_cache_enable = 1;
+                trt.trt_engine_cache_path = cacheDir;
+            }
+            options.AppendExecutionProvider_TensorRT(trt);
+            // Nodes TensorRT can't take fall through to CUDA, then CPU
+            OrtCUDAProviderOptions cuda{};
+            cuda.device_id = 0;
+            options.AppendExecutionProvider_CUDA(cuda);
+            return true;
+        }
+
+        case ExecutionProvider::DirectML:
+#ifdef VIVID_ONNX_WITH_DIRECTML
+            // DirectML requires sequential execution without memory patterns
+            options.DisableMemPattern();
+            options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_DML(options, 0));
+            return true;
+#else
+            return false;
+#endif
+
+        case ExecutionProvider::CoreML:
+#ifdef VIVID_ONNX_WITH_COREML
+            Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CoreML(options, 0));
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// =============================================================================
+// Tensor conversion
+// =============================================================================
+
+static bool toTensorType(ONNXTensorElementDataType elemType, TensorType& type) {
+    switch (elemType) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT: type = TensorType::Float32; return true;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8: type = TensorType::UInt8; return true;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32: type = TensorType::Int32; return true;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8: type = TensorType::Int8; return true;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16: type = TensorType::Float16; return true;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64: type = TensorType::Int64; return true;
+        default: return false;
+    }
+}
+
+static ONNXTensorElementDataType toOrtType(TensorType type) {
+    switch (type) {
+        case TensorType::UInt8: return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
+        case TensorType::Int32: return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32;
+        case TensorType::Int8: return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+        case TensorType::Float16: return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+        case TensorType::Int64: return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64;
+        case TensorType::Float32:
+        default: return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    }
+}
+// Apply the thread pool settings; returns the session cache key part
+static std::string applyThreading(const BackendConfig& config, Ort::SessionOptions& options,
+                                  bool globalPoolAvailable) {
+    if (config.globalThreadPool) {
+        if (globalPoolAvailable) {
+            options.DisablePerSessionThreads();
+            return "threads=global";
+        }
+        std::cerr << "[OnnxBackend] Runtime started without a global thread pool, using per-session threads" << std::endl;
+    }
+
+    const ThreadPoolOptions& t = config.threading;
+    if (t.intraOpThreads > 0) {
+        options.SetIntraOpNumThreads(t.intraOpThreads);
+    }
+    if (t.interOpThreads > 1) {
+        options.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+        options.SetInterOpNumThreads(t.interOpThreads);
+    }
+    const char* spin = t.allowSpinning ? "1" : "0";
+    options.AddConfigEntry("session.intra_op.allow_spinning", spin);
+    options.AddConfigEntry("session.inter_op.allow_spinning", spin);
+    if (!t.affinity.empty()) {
+        options.AddConfigEntry("session.intra_op_thread_affinities", t.affinity.c_str());
+    }
+
+    return "intra=" + std::to_string(t.intraOpThreads) +
+           "|inter=" + std::to_string(t.interOpThreads) +
+           "|spin=" + spin + "|aff=" + t.affinity;
+}
+
+// =============================================================================
+// OnnxBackend
+// =============================================================================
+
+OnnxBackend::OnnxBackend() : m_ort(std::make_unique<OrtObjects>()) {
+}
+
+OnnxBackend::~OnnxBackend() {
+    unload();
+}
+
+bool OnnxBackend::isLoaded() const {
+    return m_ort->session != nullptr;
+}
+
+bool OnnxBackend::load(const BackendConfig& config) {
+    unload();
+    m_tensorPool = config.tensorPool;
+    if (!createSession(config)) return false;
+
+    try {
+        readModelInfo();
+    } catch (const Ort::Exception& e) {
+        std::cerr << "[OnnxBackend] Failed to read model info: " << e.what() << std::endl;
+        unload();
+        return false;
+    }
+    return true;
+}
+
+void OnnxBackend::readModelInfo() {
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::Session& session = *m_ort->session;
+
+    auto describe = [](Ort::TypeInfo typeInfo, TensorInfo& info) {
+        auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
+        info.shape = tensorInfo.GetShape();
+        info.type = TensorType::Float32;
+        info.supported = toTensorType(tensorInfo.GetElementType(), info.type);
+    };
+
+    const size_t numInputs = session.GetInputCount();
+    m_inputs.resize(numInputs);
+    m_ort->inputNames.resize(numInputs);
+    for (size_t i = 0; i < numInputs; i++) {
+        m_inputs[i].name = session.GetInputNameAllocated(i, allocator).get();
+        m_ort->inputNames[i] = m_inputs[i].name;
+        describe(session.GetInputTypeInfo(i), m_inputs[i]);
+    }
+
+    const size_t numOutputs = session.GetOutputCount();
+    m_outputs.resize(numOutputs);
+    m_ort->outputNames.resize(numOutputs);
+    for (size_t i = 0; i < numOutputs; i++) {
+        m_outputs[i].name = session.GetOutputNameAllocated(i, allocator).get();
+        m_ort->outputNames[i] = m_outputs[i].name;
+        describe(session.GetOutputTypeInfo(i), m_outputs[i]);
+    }
+}
+
+void OnnxBackend::unload() {
+    m_ort->resetBindings();
+    if (m_ort->session) OrtRuntime::instance().release(m_ort->session);
+    m_inputs.clear();
+    m_outputs.clear();
+    m_loadedFromCache = false;
+    m_profiling = false;
+}
+
+void OnnxBackend::reserveBindings(size_t count) {
+    std::lock_guard<std::mutex> lock(m_ort->slotMutex);
+    if (m_ort->slots.size() < count) m_ort->slots.resize(count);
+}
+
+void OnnxBackend::resetBindings() {
+    m_ort->resetBindings();
+}
+
+std::string OnnxBackend::endProfiling() {
+    if (!m_profiling || !m_ort->session) return {};
+    m_profiling = false;
+    try {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto file = m_ort->session->EndProfilingAllocated(allocator);
+        return file.get();
+    } catch (const Ort::Exception& e) {
+        std::cerr << "[OnnxBackend] Failed to end profiling: " << e.what() << std::endl;
+        return {};
+    }
+}
+
+bool OnnxBackend::configureGlobalThreadPool(const ThreadPoolOptions& options) {
+    return OrtRuntime::instance().configureGlobalThreadPool(options);
+}
+
+void OnnxBackend::clearSessionCache() {
+    OrtRuntime::instance().clearIdle();
+}
+
+size_t OnnxBackend::cachedSessionCount() {
+    return OrtRuntime::instance().sessionCount();
+}
+
+// Save the model optimized to the extended level for the optimized-model
+// cache. Unlike the full level it has no layout transforms (NCHWc, ...)
+// chosen for this machine's CPU or GPU; the session loading it applies them.
+static bool saveOptimizedModel(Ort::Env& env, const BackendConfig& config, ExecutionProvider ep,
+                               bool globalThreadPool, const char* cacheDir, const fs::path& path) {
+    fs::path writePath = path;
+    writePath += ".tmp";  // renamed once complete
+    std::error_code ec;
+    try {
+        Ort::SessionOptions options;
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        options.SetOptimizedModelFilePath(writePath.c_str());
+        applyThreading(config, options, globalThreadPool);
+        if (!appendExecutionProvider(options, ep, cacheDir)) return false;
+        Ort::Session session(env, fs::path(config.modelPath).c_str(), options);
+    } catch (const Ort::Exception& e) {
+        std::cerr << "[OnnxBackend] Could not cache optimized model: " << e.what() << std::endl;
+        fs::remove(writePath, ec);
+        return false;
+    }
+    if (!fs::exists(writePath, ec)) return false;
+    fs::rename(writePath, path, ec);
+    if (ec) {
+        fs::remove(writePath, ec);
+        return false;
+    }
+    std::cout << "[OnnxBackend] Cached optimized model: " << path.string() << std::endl;
+    return true;
+}
+
+bool OnnxBackend::createSession(const BackendConfig& config, bool retryWithoutCache) {
+    const ExecutionProvider ep = config.provider;
+    const char* epName = executionProviderName(ep);
+    if (!isProviderAvailable(ep)) {
+        std::cout << "[OnnxBackend] " << epName << " provider not available in this build, skipping" << std::endl;
+        return false;
+    }
+
+    fs::path loadPath = config.modelPath;
+    fs::path cachedPath;
+
+    try {
+        m_ort->resetBindings();
+        m_ort->sessionOptions = std::make_unique<Ort::SessionOptions>();
+
+        // Enable optimizations
+        m_ort->sessionOptions->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        m_ort->optionsKey = std::string("opt=all|ep=") + epName;
+
+        auto& runtime = OrtRuntime::instance();
+        Ort::Env& env = runtime.env(config.globalThreadPool);
+        m_ort->optionsKey += "|" + applyThreading(config, *m_ort->sessionOptions, runtime.hasGlobalThreadPool());
+
+        // Optimized-model cache. Providers that compile subgraphs can't
+        // serialize them as ONNX: TensorRT keeps its own engine cache in the
+        // same directory, CoreML/DirectML recompile on load.
+        m_loadedFromCache = false;
+        m_ort->cacheDir.clear();
+        if (config.modelCache && !retryWithoutCache && !config.modelData) {
+            fs::path dir = modelCacheDirectory(config.modelPath);
+            if (!dir.empty()) {
+                m_ort->cacheDir = dir.string();
+                if (ep == ExecutionProvider::CPU || ep == ExecutionProvider::CUDA) {
+                    std::string key = modelCacheKey(config.modelPath, Ort::GetVersionString(), epName);
+                    if (!key.empty()) {
+                        // Load the saved graph at the full level: the
+                        // extended passes find nothing left to do, and the
+                        // hardware-specific layout passes run for this host
+                        cachedPath = dir / (key + ".onnx");
+                        std::error_code ec;
+                        if (fs::exists(cachedPath, ec) ||
+                            saveOptimizedModel(env, config, ep, runtime.hasGlobalThreadPool(),
+                                               m_ort->cacheDir.c_str(), cachedPath)) {
+                            loadPath = cachedPath;
+                            m_loadedFromCache = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        // ORT profiler: runs from session creation until EndProfiling
+        const bool profile = config.profileFrames > 0;
+        if (profile) {
+            m_ort->sessionOptions->EnableProfiling(fs::path(config.profilePrefix).c_str());
+        }
+
+        if (!appendExecutionProvider(*m_ort->sessionOptions, ep,
+                                     m_ort->cacheDir.empty() ? nullptr : m_ort->cacheDir.c_str())) {
+            std::cout << "[OnnxBackend] " << epName << " provider not compiled in, skipping" << std::endl;
+            return false;
+        }
+
+        // In-memory sources: the caller's buffer, or a mapping of the file
+        std::shared_ptr<ModelBuffer> bytes = config.modelData;
+        if (!bytes && config.memoryMap) {
+            bytes = ModelBuffer::map(loadPath.string());
+            if (!bytes) {
+                std::cerr << "[OnnxBackend] Could not map " << loadPath.string() << ", loading from file" << std::endl;
+            }
+        }
+        if (bytes) {
+            // Without a path ORT can't locate external data on its own
+            std::string dataDir = config.externalDataPath;
+            if (dataDir.empty() && !config.modelData) dataDir = loadPath.parent_path().string();
+            if (!dataDir.empty()) {
+                m_ort->sessionOptions->AddConfigEntry("session.model_external_initializers_file_folder_path",
+                                                      dataDir.c_str());
+            }
+            // ORT format: initializers stay in the buffer instead of being copied
+            if (bytes->isOrtFormat()) {
+                m_ort->sessionOptions->AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+                m_ort->sessionOptions->AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+            }
+        }
+
+        // fs::path::c_str() is ORTCHAR_T* on every platform (wchar_t on Windows)
+        auto factory = [&]() -> std::shared_ptr<Ort::Session> {
+            if (!bytes) {
+                return std::make_shared<Ort::Session>(env, loadPath.c_str(), *m_ort->sessionOptions);
+            }
+            auto* session = new Ort::Session(env, bytes->data(), bytes->size(), *m_ort->sessionOptions);
+            if (!bytes->isOrtFormat()) {
+                return std::shared_ptr<Ort::Session>(session);  // ONNX format was parsed into a copy
+            }
+            // Used in place: keep the bytes for the session's lifetime
+            return std::shared_ptr<Ort::Session>(session, [bytes](Ort::Session* s) { delete s; });
+        };
+
+        // Load the ONNX model (or reuse a session already built for it).
+        // A profiled session gets its own, so the trace is this model's only.
+        if (config.sharedSession && !profile) {
+            std::string key;
+            if (config.modelData) {
+                // By content: a freed buffer's address can come back holding another model
+                const uint64_t hash = hashModelBytes(config.modelData->data(), config.modelData->size());
+                key = "memory:" + std::to_string(hash) + ":" + std::to_string(config.modelData->size());
+            } else {
+                std::error_code ec;
+                fs::path canonical = fs::weakly_canonical(config.modelPath, ec);
+                key = ec ? config.modelPath : canonical.string();
+            }
+            m_ort->session = runtime.acquire(key + "|" + m_ort->optionsKey, factory);
+        } else {
+            m_ort->session = factory();
+        }
+
+        if (m_loadedFromCache) {
+            std::cout << "[OnnxBackend] Loaded optimized model from cache: " << cachedPath.string() << std::endl;
+        }
+
+        m_provider = ep;
+        m_profiling = profile;
+        return true;
+
+    } catch (const Ort::Exception& e) {
+        m_ort->session.reset();
+        std::error_code ec;
+        if (m_loadedFromCache) {
+            // Corrupt or incompatible cache entry: drop it and build from the original
+            std::cerr << "[OnnxBackend] Cached model failed to load, rebuilding: " << e.what() << std::endl;
+            fs::remove(cachedPath, ec);
+            m_loadedFromCache = false;
+            return createSession(config, true);
+        }
+        std::cerr << "[OnnxBackend] " << epName << " provider failed, falling back: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Wrap tensor storage in an Ort::Value (no copy)
+static Ort::Value wrapTensor(const Ort::MemoryInfo& memoryInfo, Tensor& tensor) {
+    return Ort::Value::CreateTensor(
+        memoryInfo, storageData(tensor), storageSize(tensor) * elementSize(tensor.type),
+        tensor.shape.data(), tensor.shape.size(), toOrtType(tensor.type));
+}
+
+static const void* storagePtr(const Tensor& tensor) {
+    return storageData(tensor);
+}
+
+OnnxBackend::OrtObjects::BindingSlot& OnnxBackend::OrtObjects::acquireSlot(const std::vector<Tensor>& inputs) {
+    std::unique_lock<std::mutex> lock(slotMutex);
+    const void* key = inputs.empty() ? nullptr : storagePtr(inputs[0]);
+    while (true) {
+        BindingSlot* chosen = nullptr;
+        for (auto& slot : slots) {
+            if (slot.inUse) continue;
+            if (slot.binding && !slot.inputPtrs.empty() && slot.inputPtrs[0] == key &&
+                slot.inputShapes[0] == inputs[0].shape) {
+                chosen = &slot;
+                break;
+            }
+            if (!chosen || slot.lastUsed < chosen->lastUsed) chosen = &slot;
+        }
+        if (chosen) {
+            chosen->inUse = true;
+            chosen->lastUsed = ++tick;
+            return *chosen;
+        }
+        slotReleased.wait(lock);
+    }
+}
+
+void OnnxBackend::OrtObjects::releaseSlot(BindingSlot& slot) {
+    {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        slot.inUse = false;
+    }
+    slotReleased.notify_one();
+}
+
+bool OnnxBackend::run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) {
+    if (!isLoaded()) return false;
+
+    auto& slot = m_ort->acquireSlot(inputs);
+    struct Release {
+        OrtObjects& ort;
+        OrtObjects::BindingSlot& held;
+        ~Release() { ort.releaseSlot(held); }
+    } release{*m_ort, slot};
+
+    try {
+        if (!slot.binding) {
+            slot.binding = std::make_unique<Ort::IoBinding>(*m_ort->session);
+        }
+
+        // (Re)bind inputs only when storage or shape changed since last bind
+        bool inputsChanged = slot.inputPtrs.size() != inputs.size();
+        for (size_t i = 0; !inputsChanged && i < inputs.size(); i++) {
+            inputsChanged = slot.inputPtrs[i] != storagePtr(inputs[i]) ||
+                            slot.inputShapes[i] != inputs[i].shape;
+        }
+        if (inputsChanged) {
+            slot.binding->ClearBoundInputs();
+            slot.inputPtrs.resize(inputs.size());
+            slot.inputShapes.resize(inputs.size());
+            for (size_t i = 0; i < inputs.size(); i++) {
+                slot.binding->BindInput(m_ort->inputNames[i].c_str(), wrapTensor(m_ort->memoryInfo, inputs[i]));
+                slot.inputPtrs[i] = storagePtr(inputs[i]);
+                slot.inputShapes[i] = inputs[i].shape;
+            }
+            // Output shapes may depend on input shapes
+            slot.outputsBound = false;
+        }
+
+        // Float32 outputs are bound to `outputs`, other types to the slot's
+        // native tensors
+        auto boundTensor = [&slot, &outputs](size_t i) -> Tensor& {
+            bool native = i < slot.nativeOutputs.size() && !slot.nativeOutputs[i].shape.empty();
+            return native ? slot.nativeOutputs[i] : outputs[i];
+        };
+
+        // Outputs bound to our storage must still point at it (buffers swap in
+        // async mode). Another input shape may have resized them since: take
+        // this binding's shapes back, growing storage moves it and rebinds.
+        if (slot.outputsBound) {
+            for (size_t i = 0; i < outputs.size(); i++) {
+                Tensor& bound = boundTensor(i);
+                if (bound.shape != slot.outputShapes[i]) {
+                    bound.shape = slot.outputShapes[i];
+                    resizeStorage(bound);
+                }
+                if (slot.outputPtrs[i] != storagePtr(bound)) {
+                    slot.outputsBound = false;
+                    break;
+                }
+            }
+        }
+
+        if (!slot.outputsBound) {
+            // Let ORT allocate once to learn the real output shapes
+            slot.binding->ClearBoundOutputs();
+            for (const auto& name : m_ort->outputNames) {
+                slot.binding->BindOutput(name.c_str(), m_ort->memoryInfo);
+            }
+        }
+
+        // Run inference
+        m_ort->session->Run(m_ort->runOptions, *slot.binding);
+
+        if (slot.outputsBound) {
+            // Results already written in place
+            for (size_t i = 0; i < outputs.size(); i++) {
+                Tensor& bound = boundTensor(i);
+                if (&bound != &outputs[i]) convertToFloat(bound, outputs[i]);
+            }
+            return true;
+        }
+
+        // First run for this binding: size our storage from the real shapes
+        // and types, take this result once, then bind outputs straight into it
+        auto values = slot.binding->GetOutputValues();
+        bool allSupported = true;
+        slot.nativeOutputs.resize(outputs.size());
+        for (size_t i = 0; i < values.size() && i < outputs.size(); i++) {
+            auto info = values[i].GetTensorTypeAndShapeInfo();
+            Tensor& native = slot.nativeOutputs[i];
+            native.shape.clear();
+
+            // The ORT-allocated result, wrapped without a copy
+            Tensor result;
+            result.shape = info.GetShape();
+            if (!toTensorType(info.GetElementType(), result.type)) {
+                allSupported = false;
+                outputs[i].shape.clear();
+                outputs[i].buffer.resize(0);
+                continue;
+            }
+            result.buffer.wrap(const_cast<void*>(values[i].GetTensorRawData()),
+                               result.size() * elementSize(result.type));
+
+            if (result.type == TensorType::Float32) {
+                outputs[i].type = TensorType::Float32;
+                outputs[i].shape = result.shape;
+                outputs[i].buffer = result.buffer;
+            } else {
+                native.buffer.pool(m_tensorPool);
+                native.shape = result.shape;
+                native.type = result.type;
+                native.buffer = result.buffer;
+                convertToFloat(native, outputs[i]);
+            }
+        }
+
+        if (allSupported) {
+            slot.binding->ClearBoundOutputs();
+            slot.outputPtrs.resize(outputs.size());
+            slot.outputShapes.resize(outputs.size());
+            for (size_t i = 0; i < outputs.size(); i++) {
+                Tensor& bound = boundTensor(i);
+                slot.binding->BindOutput(m_ort->outputNames[i].c_str(), wrapTensor(m_ort->memoryInfo, bound));
+                slot.outputPtrs[i] = storagePtr(bound);
+                slot.outputShapes[i] = bound.shape;
+            }
+            slot.outputsBound = true;
+        }
+        return true;
+
+    } catch (const Ort::Exception& e) {
+        std::cerr << "[OnnxBackend] Inference error: " << e.what() << std::endl;
+        // Output shape may have changed under us; rebind next run
+        slot.outputsBound = false;
+        slot.inputPtrs.clear();
+        return false;
+    }
+}
+
+} // namespace vivid::onnx
@@ -1,68 +1,72 @@
 #include <vivid/onnx/onnx_model.h>
+#include <vivid/onnx/onnx_backend.h>
+#include <vivid/onnx/ring_buffer.h>
+#include <vivid/onnx/scheduler.h>
 #include <vivid/context.h>
 #include <vivid/asset_loader.h>
-#include <onnxruntime_cxx_api.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace fs = std::filesystem;
 
 namespace vivid::onnx {
 
-// =============================================================================
-// Tensor
-// =============================================================================
-
-size_t Tensor::size() const {
-    if (shape.empty()) return 0;
-    return std::accumulate(shape.begin(), shape.end(), 1LL, std::multiplies<int64_t>());
-}
-
-void Tensor::reshape(const std::vector<int64_t>& newShape) {
-    size_t newSize = std::accumulate(newShape.begin(), newShape.end(), 1LL, std::multiplies<int64_t>());
-    if (newSize != size()) {
-        throw std::runtime_error("Tensor reshape: size mismatch");
-    }
-    shape = newShape;
+static double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
 }
 
-// =============================================================================
-// ONNXModel - ONNX Runtime internals
-// =============================================================================
-
-struct ONNXModel::OrtObjects {
-    std::unique_ptr<Ort::Env> env;
-    std::unique_ptr<Ort::Session> session;
-    std::unique_ptr<Ort::SessionOptions> sessionOptions;
-    Ort::MemoryInfo memoryInfo{nullptr};
-
-    OrtObjects() : memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
-        env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "vivid-onnx");
-        sessionOptions = std::make_unique<Ort::SessionOptions>();
-
-        // Enable optimizations
-        sessionOptions->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-
-        // Use CoreML on macOS for GPU acceleration
-#ifdef __APPLE__
-        // Note: CoreML EP requires additional setup, skip for now
-        // sessionOptions->AppendExecutionProvider_CoreML();
-#endif
-    }
+struct ONNXModel::AsyncWorker {
+    // One frame in flight: its buffers, swapped with m_inputTensors/
+    // m_outputTensors. Only the worker touches a slot between its push to
+    // `pending` and its pop from `done`.
+    struct Slot {
+        std::vector<Tensor> inputs;
+        std::vector<Tensor> outputs;
+        std::vector<InputFrame> inputFrames;   // regions the outputs map back to
+        int64_t submittedFrame = -1;
+        double submittedTimeMs = 0.0;
+        double runMs = 0.0;
+    };
+    std::vector<Slot> slots;
+
+    SpscRing<size_t> pending;   // render thread -> worker
+    SpscRing<size_t> done;      // worker -> render thread, in submission order
+    std::vector<size_t> free;   // render thread only
+
+    // Only for sleeping while `pending` is empty
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> stop{false};
+
+    size_t inFlight() const { return slots.size() - free.size(); }
 };
 
 // =============================================================================
 // ONNXModel
 // =============================================================================
 
-ONNXModel::ONNXModel() : m_ort(std::make_unique<OrtObjects>()) {
-}
+ONNXModel::ONNXModel() = default;
 
-ONNXModel::~ONNXModel() = default;
+ONNXModel::~ONNXModel() {
+    joinPreload();
+    stopWorker();
+}
 
 ONNXModel& ONNXModel::model(const std::string& path) {
     // Try to resolve through AssetLoader (search paths from project and modules)
@@ -72,340 +76,1068 @@ ONNXModel& ONNXModel::model(const std::string& path) {
     } else {
         m_modelPath = path;  // Fall back to literal path
     }
+    m_modelData.reset();
+    return *this;
+}
+
+ONNXModel& ONNXModel::modelData(const void* data, size_t size, const std::string& name) {
+    // No bytes leaves no model, so load() reports it
+    m_modelData = ModelBuffer::wrap(data, size);
+    m_modelPath = m_modelData ? (name.empty() ? "memory" : name) : std::string();
+    return *this;
+}
+
+ONNXModel& ONNXModel::memoryMap(bool enabled) {
+    m_memoryMap = enabled;
+    return *this;
+}
+
+ONNXModel& ONNXModel::externalDataPath(const std::string& dir) {
+    m_externalDataPath = dir;
     return *this;
 }
 
 ONNXModel& ONNXModel::input(Operator* op) {
     m_inputOp = op;
+    m_inputOps = {op};
+    m_currentSource = 0;
+    m_sourceWatch.clear();
+    return *this;
+}
+
+ONNXModel& ONNXModel::inputs(const std::vector<Operator*>& ops) {
+    m_inputOps = ops;
+    m_inputOp = ops.empty() ? nullptr : ops[0];
+    m_currentSource = 0;
+    m_sourceWatch.clear();
+    return *this;
+}
+
+ONNXModel& ONNXModel::backend(BackendType type) {
+    if (m_loaded || m_preloading) {
+        std::cerr << "[ONNXModel] backend() must be set before init()" << std::endl;
+        return *this;
+    }
+    m_backendType = type;
+    m_backend.reset();
+    m_customBackend = false;
+    return *this;
+}
+
+ONNXModel& ONNXModel::backend(std::unique_ptr<InferenceBackend> backend) {
+    if (m_loaded || m_preloading) {
+        std::cerr << "[ONNXModel] backend() must be set before init()" << std::endl;
+        return *this;
+    }
+    m_backend = std::move(backend);
+    m_customBackend = m_backend != nullptr;
+    return *this;
+}
+
+ONNXModel& ONNXModel::executionProvider(ExecutionProvider ep) {
+    m_executionProviders = {ep};
+    return *this;
+}
+
+ONNXModel& ONNXModel::executionProvider(const std::vector<ExecutionProvider>& priority) {
+    m_executionProviders = priority;
+    return *this;
+}
+
+ONNXModel& ONNXModel::sharedSession(bool enabled) {
+    m_sharedSession = enabled;
+    return *this;
+}
+
+ONNXModel& ONNXModel::modelCache(bool enabled) {
+    m_modelCache = enabled;
+    return *this;
+}
+
+ONNXModel& ONNXModel::threading(const ThreadPoolOptions& options) {
+    m_threading = options;
+    return *this;
+}
+
+ONNXModel& ONNXModel::globalThreadPool(bool enabled) {
+    m_globalThreadPool = enabled;
+    return *this;
+}
+
+bool ONNXModel::configureGlobalThreadPool(const ThreadPoolOptions& options) {
+    if (!OnnxBackend::configureGlobalThreadPool(options)) {
+        std::cerr << "[ONNXModel] Global thread pool must be configured before the first model loads" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ONNXModel& ONNXModel::inputNormalization(const Normalization& norm) {
+    m_inputNormalization = norm;
+    return *this;
+}
+
+ONNXModel& ONNXModel::aspectMode(AspectMode mode) {
+    m_aspectMode = mode;
+    return *this;
+}
+
+ONNXModel& ONNXModel::async(bool enabled) {
+    m_asyncEnabled = enabled;
+    if (!enabled) {
+        stopWorker();
+        m_scheduled = false;
+    }
+    return *this;
+}
+
+ONNXModel& ONNXModel::schedule(int priority, float targetHz, float latencyBudgetMs) {
+    SchedulePolicy policy;
+    policy.priority = priority;
+    policy.targetHz = targetHz;
+    policy.latencyBudgetMs = latencyBudgetMs;
+    return schedule(policy);
+}
+
+ONNXModel& ONNXModel::schedule(const SchedulePolicy& policy) {
+    m_schedulePolicy = policy;
+    m_schedulePolicy.targetHz = std::max(0.0f, policy.targetHz);
+    m_schedulePolicy.latencyBudgetMs = std::max(0.0f, policy.latencyBudgetMs);
+    if (m_scheduleClient) {
+        InferenceScheduler::instance().updatePolicy(m_scheduleClient, m_schedulePolicy);
+    } else if (!m_scheduled) {
+        stopWorker();  // restarts on the shared pool
+    }
+    m_scheduled = true;
+    m_asyncEnabled = true;
     return *this;
 }
 
+ScheduleStats ONNXModel::scheduleStats() const {
+    return m_scheduleClient ? InferenceScheduler::instance().stats(m_scheduleClient) : ScheduleStats{};
+}
+
+ONNXModel& ONNXModel::pipelineDepth(int frames) {
+    frames = std::max(1, frames);
+    if (frames != m_pipelineDepth) {
+        stopWorker();  // restarts with the new slot count
+        m_pipelineDepth = frames;
+    }
+    return *this;
+}
+
+ONNXModel& ONNXModel::record(const std::string& path, TrackFormat format) {
+    m_recordPath = path;
+    m_recordFormat = format;
+    m_trackWriter.reset();  // opens with the next result
+    m_recordStartMs = -1.0;
+    return *this;
+}
+
+ONNXModel& ONNXModel::replay(const std::string& path) {
+    if (m_loaded) {
+        std::cerr << "[ONNXModel] replay() must be set before init()" << std::endl;
+        return *this;
+    }
+    m_replayPath = path;
+    m_trackReader.reset();
+    return *this;
+}
+
+ONNXModel& ONNXModel::gpuPreprocess(bool enabled) {
+    m_gpuPreprocess = enabled;
+    return *this;
+}
+
+ONNXModel& ONNXModel::runEvery(int frames) {
+    m_runPolicy.everyFrames = std::max(1, frames);
+    return *this;
+}
+
+ONNXModel& ONNXModel::runAtRate(float hz) {
+    m_runPolicy.maxRateHz = std::max(0.0f, hz);
+    return *this;
+}
+
+ONNXModel& ONNXModel::runOnNewFrame(bool enabled) {
+    m_runPolicy.onNewFrame = enabled;
+    return *this;
+}
+
+ONNXModel& ONNXModel::runOnChange(float threshold) {
+    m_runPolicy.changeThreshold = std::clamp(threshold, 0.0f, 1.0f);
+    return *this;
+}
+
+ONNXModel& ONNXModel::runPolicy(const RunPolicy& policy) {
+    runEvery(policy.everyFrames);
+    runAtRate(policy.maxRateHz);
+    runOnNewFrame(policy.onNewFrame);
+    runOnChange(policy.changeThreshold);
+    return *this;
+}
+
+InferenceStats ONNXModel::stats() const {
+    InferenceStats s;
+    s.preprocess = m_preprocessStats.timing();
+    s.run = m_runStats.timing();
+    s.postprocess = m_postprocessStats.timing();
+    s.nms = m_nmsStats.timing();
+    s.inferences = m_inferenceCount;
+    s.framesDropped = m_framesDropped;
+    s.framesSkipped = m_framesSkipped;
+    s.framesShed = m_framesShed;
+    s.provider = m_activeProvider;
+    s.gpuPreprocess = m_gpuPreprocessActive;
+    return s;
+}
+
+void ONNXModel::resetStats() {
+    m_preprocessStats.reset();
+    m_runStats.reset();
+    m_postprocessStats.reset();
+    m_nmsStats.reset();
+    m_inferenceCount = 0;
+    m_framesDropped = 0;
+    m_framesSkipped = 0;
+    m_framesShed = 0;
+}
+
+std::string ONNXModel::statsSummary() const {
+    char line[192];
+    std::snprintf(line, sizeof(line),
+                  "%s%s | pre %.1f ms | run %.1f ms (p95 %.1f) | post %.1f ms | dropped %llu",
+                  executionProviderName(m_activeProvider), m_gpuPreprocessActive ? "+GPU pre" : "",
+                  m_preprocessStats.average(), m_runStats.average(), m_runStats.percentile(95.0),
+                  m_postprocessStats.average(), static_cast<unsigned long long>(m_framesDropped));
+    return line;
+}
+
+ONNXModel& ONNXModel::profiling(int frames, const std::string& prefix) {
+    m_profileFrames = std::max(0, frames);
+    m_profilePrefix = prefix.empty() ? "vivid-onnx-profile" : prefix;
+    return *this;
+}
+
+void ONNXModel::countInference() {
+    m_inferenceCount++;
+
+    if (m_profileRemaining > 0 && --m_profileRemaining == 0 && m_backend) {
+        m_profileFile = m_backend->endProfiling();
+        if (!m_profileFile.empty()) {
+            std::cout << "[ONNXModel] Profile written: " << m_profileFile << std::endl;
+        }
+    }
+}
+
+int64_t ONNXModel::resultAgeFrames() const {
+    if (m_resultFrame < 0) return -1;
+    return m_frameCounter - m_resultFrame;
+}
+
+double ONNXModel::resultAgeMs() const {
+    if (m_resultFrame < 0) return -1.0;
+    return nowMs() - m_resultTimeMs;
+}
+
 void ONNXModel::init(Context& ctx) {
+    initModel();
+}
+
+void ONNXModel::initModel() {
+    // A preload still running finishes on its thread (process() picks up a
+    // failure); a finished one is used, or retried once if it failed
+    if (m_preloading) return;
+    if (m_preloadThread.joinable()) {
+        finishPreload();
+        return;
+    }
+    load();
+}
+
+bool ONNXModel::finishPreload() {
+    if (m_preloading || !m_preloadThread.joinable()) return isLoaded();
+    m_preloadThread.join();
+    if (m_preloadResult.valid() && m_preloadResult.get()) return true;
+    std::cerr << "[ONNXModel] Preload failed, loading again: " << m_modelPath << std::endl;
+    return load();
+}
+
+std::shared_future<bool> ONNXModel::preload(int warmupRuns) {
+    joinPreload();
+
+    std::promise<bool> promise;
+    m_preloadResult = promise.get_future().share();
+    m_preloading = true;
+    m_preloadThread = std::thread([this, warmupRuns, promise = std::move(promise)]() mutable {
+        bool loaded = load();
+        if (loaded && warmupRuns > 0) {
+            double start = nowMs();
+            warmup(warmupRuns);
+            std::cout << "[ONNXModel] Warmed up in " << (nowMs() - start) << " ms: " << m_modelPath << std::endl;
+        }
+        m_preloading = false;
+        promise.set_value(loaded);
+    });
+    return m_preloadResult;
+}
+
+void ONNXModel::joinPreload() {
+    if (m_preloadThread.joinable() && m_preloadThread.get_id() != std::this_thread::get_id()) {
+        m_preloadThread.join();
+    }
+}
+
+bool ONNXModel::warmup(int runs) {
+    if (!m_loaded || m_inputTensors.empty()) return false;
+
+    // Placeholder gray frames at the size process() will use, which also
+    // binds the real input shapes ahead of time
+    for (size_t i = 0; i < m_inputTensors.size(); i++) {
+        Tensor& tensor = m_inputTensors[i];
+        tensor.shape = m_inputShapes[i];
+        if (i == 0 && isBatched() && !tensor.shape.empty()) {
+            tensor.shape[0] = static_cast<int64_t>(m_inputOps.size());
+        }
+        resizeStorage(tensor);
+        const Normalization n = tensorNormalization(tensor.type, m_inputNormalization);
+        fillTensor(tensor, 127.5f * n.scale[0] + n.bias[0]);
+    }
+    for (int r = 0; r < runs; r++) {
+        runInference();
+    }
+    return true;
+}
+
+bool ONNXModel::load() {
+    // Re-init (hot reload) must not race an in-flight async run
+    stopWorker();
+
+    if (!m_replayPath.empty()) {
+        return loadReplay();
+    }
+
     if (m_modelPath.empty()) {
         std::cerr << "[ONNXModel] No model path specified" << std::endl;
-        return;
+        return false;
     }
 
-    try {
-        // Load the ONNX model
-#ifdef _WIN32
-        std::wstring wpath(m_modelPath.begin(), m_modelPath.end());
-        m_ort->session = std::make_unique<Ort::Session>(*m_ort->env, wpath.c_str(), *m_ort->sessionOptions);
-#else
-        m_ort->session = std::make_unique<Ort::Session>(*m_ort->env, m_modelPath.c_str(), *m_ort->sessionOptions);
-#endif
-
-        Ort::AllocatorWithDefaultOptions allocator;
-
-        // Get input info
-        size_t numInputs = m_ort->session->GetInputCount();
-        m_inputNames.resize(numInputs);
-        m_inputShapes.resize(numInputs);
-        m_inputTensors.resize(numInputs);
-
-        for (size_t i = 0; i < numInputs; i++) {
-            auto namePtr = m_ort->session->GetInputNameAllocated(i, allocator);
-            m_inputNames[i] = namePtr.get();
-
-            auto typeInfo = m_ort->session->GetInputTypeInfo(i);
-            auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-            m_inputShapes[i] = tensorInfo.GetShape();
-
-            // Get element type
-            ONNXTensorElementDataType elemType = tensorInfo.GetElementType();
-            TensorType tensorType = TensorType::Float32;
-            const char* typeStr = "float32";
-            if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8) {
-                tensorType = TensorType::UInt8;
-                typeStr = "uint8";
-            } else if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32) {
-                tensorType = TensorType::Int32;
-                typeStr = "int32";
-            }
+    if (!loadBackend()) {
+        std::cerr << "[ONNXModel] No execution provider could load: " << m_modelPath << std::endl;
+        m_loaded = false;
+        return false;
+    }
+    m_activeProvider = m_backend->provider();
+    m_loadedFromCache = m_backend->loadedFromCache();
+    m_profileRemaining = m_profileFrames;
+    m_profileFile.clear();
+    std::cout << "[ONNXModel] Backend: " << m_backend->name()
+              << ", execution provider: " << executionProviderName(m_activeProvider) << std::endl;
+
+    // Get input info
+    const std::vector<TensorInfo>& inputs = m_backend->inputs();
+    const size_t numInputs = inputs.size();
+    m_inputNames.resize(numInputs);
+    m_inputShapes.resize(numInputs);
+    m_inputTensors.resize(numInputs);
+
+    for (size_t i = 0; i < numInputs; i++) {
+        m_inputNames[i] = inputs[i].name;
+        m_inputShapes[i] = inputs[i].shape;
+
+        // Get element type
+        TensorType tensorType = inputs[i].type;
+        if (!inputs[i].supported) {
+            std::cerr << "[ONNXModel] Input " << i << " has an unsupported element type, using float32" << std::endl;
+            tensorType = TensorType::Float32;
+        }
 
-            // Handle dynamic dimensions (marked as -1)
-            for (auto& dim : m_inputShapes[i]) {
-                if (dim < 0) dim = 1;  // Default batch size
-            }
+        // Single-input models with a dynamic leading dim can be batched;
+        // image inputs with dynamic height and width take any resolution
+        if (i == 0) {
+            m_dynamicBatch = numInputs == 1 && m_inputShapes[i].size() >= 2 && m_inputShapes[i][0] < 0;
+            m_dynamicInputSize = m_inputShapes[i].size() == 4 &&
+                std::count_if(m_inputShapes[i].begin() + 1, m_inputShapes[i].end(),
+                              [](int64_t dim) { return dim < 0; }) >= 2;
+        }
 
-            // Allocate input tensor with correct type
-            m_inputTensors[i].shape = m_inputShapes[i];
-            m_inputTensors[i].type = tensorType;
-            size_t tensorSize = m_inputTensors[i].size();
-            if (tensorType == TensorType::UInt8) {
-                m_inputTensors[i].dataU8.resize(tensorSize);
-            } else if (tensorType == TensorType::Int32) {
-                m_inputTensors[i].dataI32.resize(tensorSize);
-            } else {
-                m_inputTensors[i].data.resize(tensorSize);
-            }
+        // Handle dynamic dimensions (marked as -1)
+        for (auto& dim : m_inputShapes[i]) {
+            if (dim < 0) dim = 1;  // Default batch size
+        }
 
-            std::cout << "  Input " << i << ": " << m_inputNames[i] << " (" << typeStr << ") [";
-            for (size_t j = 0; j < m_inputShapes[i].size(); j++) {
-                if (j > 0) std::cout << "x";
-                std::cout << m_inputShapes[i][j];
-            }
-            std::cout << "]" << std::endl;
+        // Allocate input tensor with correct type
+        m_inputTensors[i].shape = m_inputShapes[i];
+        m_inputTensors[i].type = tensorType;
+        m_inputTensors[i].buffer.pool(m_tensorPool);
+        resizeStorage(m_inputTensors[i]);
+
+        std::cout << "  Input " << i << ": " << m_inputNames[i] << " (" << tensorTypeName(tensorType) << ") [";
+        for (size_t j = 0; j < m_inputShapes[i].size(); j++) {
+            if (j > 0) std::cout << "x";
+            std::cout << m_inputShapes[i][j];
         }
+        std::cout << "]" << std::endl;
+    }
+
+    // Get output info
+    const std::vector<TensorInfo>& outputs = m_backend->outputs();
+    const size_t numOutputs = outputs.size();
+    m_outputNames.resize(numOutputs);
+    m_outputShapes.resize(numOutputs);
+    m_outputTensors.resize(numOutputs);
 
-        // Get output info
-        size_t numOutputs = m_ort->session->GetOutputCount();
-        m_outputNames.resize(numOutputs);
-        m_outputShapes.resize(numOutputs);
-        m_outputTensors.resize(numOutputs);
+    for (size_t i = 0; i < numOutputs; i++) {
+        m_outputNames[i] = outputs[i].name;
+        m_outputShapes[i] = outputs[i].shape;
 
-        for (size_t i = 0; i < numOutputs; i++) {
-            auto namePtr = m_ort->session->GetOutputNameAllocated(i, allocator);
-            m_outputNames[i] = namePtr.get();
+        // Handle dynamic dimensions
+        for (auto& dim : m_outputShapes[i]) {
+            if (dim < 0) dim = 1;
+        }
 
-            auto typeInfo = m_ort->session->GetOutputTypeInfo(i);
-            auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-            m_outputShapes[i] = tensorInfo.GetShape();
+        // Allocate output tensor (always Float32; other types are converted)
+        if (!outputs[i].supported) {
+            std::cerr << "[ONNXModel] Output " << i << " has an unsupported element type" << std::endl;
+        }
+        m_outputTensors[i].shape = m_outputShapes[i];
+        m_outputTensors[i].buffer.pool(m_tensorPool);
+        resizeStorage(m_outputTensors[i]);
+    }
 
-            // Handle dynamic dimensions
-            for (auto& dim : m_outputShapes[i]) {
-                if (dim < 0) dim = 1;
-            }
+    if (!m_inputTensors.empty()) {
+        m_sourceInput = m_inputTensors[0];
+    }
+
+    m_loaded = true;
+    std::cout << "[ONNXModel] Loaded: " << m_modelPath << std::endl;
+    std::cout << "  Inputs: " << numInputs << ", Outputs: " << numOutputs << std::endl;
+    if (m_inputOps.size() > 1) {
+        std::cout << "  Sources: " << m_inputOps.size()
+                  << (m_dynamicBatch ? " (batched)" : " (fixed batch, sequential runs)") << std::endl;
+    }
+
+    // Notify subclass
+    onModelLoaded();
+    return true;
+}
 
-            // Allocate output tensor
-            m_outputTensors[i].shape = m_outputShapes[i];
-            m_outputTensors[i].data.resize(m_outputTensors[i].size());
+bool ONNXModel::loadBackend() {
+    if (!m_backend) {
+        m_backend = createBackend(m_backendType);
+        if (!m_backend) {
+            std::cerr << "[ONNXModel] " << backendTypeName(m_backendType)
+                      << " backend not compiled in, using ONNX Runtime" << std::endl;
+            m_backend = createBackend(BackendType::OnnxRuntime);
         }
+    }
 
-        m_loaded = true;
-        std::cout << "[ONNXModel] Loaded: " << m_modelPath << std::endl;
-        std::cout << "  Inputs: " << numInputs << ", Outputs: " << numOutputs << std::endl;
+    BackendConfig config;
+    config.modelPath = m_modelPath;
+    config.modelData = m_modelData;
+    config.memoryMap = m_memoryMap;
+    config.externalDataPath = m_externalDataPath;
+    config.sharedSession = m_sharedSession;
+    config.modelCache = m_modelCache;
+    config.threading = m_threading;
+    config.globalThreadPool = m_globalThreadPool;
+    config.profileFrames = m_profileFrames;
+    config.profilePrefix = m_profilePrefix;
+    config.tensorPool = m_tensorPool;
+
+    // Try providers in priority order, CPU is always the last resort.
+    // Backends that pick their own device get one attempt.
+    std::vector<ExecutionProvider> candidates = m_executionProviders;
+    if (std::find(candidates.begin(), candidates.end(), ExecutionProvider::CPU) == candidates.end()) {
+        candidates.push_back(ExecutionProvider::CPU);
+    }
+    for (ExecutionProvider ep : candidates) {
+        config.provider = ep;
+        if (m_backend->load(config)) return true;
+        if (!m_backend->usesExecutionProviders()) break;
+    }
 
-        // Notify subclass
-        onModelLoaded();
+    // An engine that can't be built still runs through ONNX Runtime
+    if (!m_customBackend && !m_backend->usesExecutionProviders()) {
+        std::cerr << "[ONNXModel] " << m_backend->name() << " backend failed, falling back to ONNX Runtime" << std::endl;
+        m_backend = createBackend(BackendType::OnnxRuntime);
+        for (ExecutionProvider ep : candidates) {
+            config.provider = ep;
+            if (m_backend->load(config)) return true;
+        }
+    }
+    return false;
+}
 
-    } catch (const Ort::Exception& e) {
-        std::cerr << "[ONNXModel] Failed to load model: " << e.what() << std::endl;
+bool ONNXModel::loadReplay() {
+    m_trackReader = std::make_unique<TrackReader>();
+    if (!m_trackReader->open(m_replayPath)) {
+        m_trackReader.reset();
         m_loaded = false;
+        return false;
+    }
+    if (m_trackReader->kind() != name() || m_trackReader->valueCount() != trackValueCount()) {
+        std::cerr << "[ONNXModel] " << m_replayPath << " holds " << m_trackReader->kind()
+                  << " results, not " << name() << std::endl;
+        m_trackReader.reset();
+        m_loaded = false;
+        return false;
+    }
+    std::cout << "[ONNXModel] Replaying " << m_trackReader->frameCount() << " frames from "
+              << m_replayPath << " (no model loaded)" << std::endl;
+    m_loaded = true;
+    return true;
+}
+
+void ONNXModel::processReplay() {
+    m_frameCounter++;
+
+    // Frames the recording skipped keep (and extrapolate) the last results
+    const TrackFrame* frame = m_trackReader->find(m_frameCounter - 1);
+    if (!frame) {
+        m_framesSkipped++;
+        onInferenceSkipped();
+        return;
+    }
+
+    double start = nowMs();
+    m_resultFrame = m_frameCounter;
+    m_resultTimeMs = start;
+    const size_t sources = std::max<size_t>(1, m_inputOps.size());
+    for (size_t s = 0; s < sources; s++) {
+        m_currentSource = s;
+        applyTrackDetections(*frame);
     }
+    m_currentSource = 0;
+    m_postprocessStats.add(nowMs() - start);
+    m_inferenceCount++;
+
+    if (!m_recordPath.empty()) recordResults(frame->frame, frame->timeMs);
+}
+
+void ONNXModel::recordLatest() {
+    // Timed from the first recorded result, like the frame * 1000 / fps
+    // that vivid-onnx-batch writes; steady_clock's epoch means nothing outside
+    if (m_recordStartMs < 0.0) m_recordStartMs = m_resultTimeMs;
+    recordResults(m_resultFrame - 1, m_resultTimeMs - m_recordStartMs);
+}
+
+void ONNXModel::recordResults(int64_t frame, double timeMs) {
+    if (m_recordPath.empty()) return;
+
+    if (!m_trackWriter) {
+        const int valueCount = trackValueCount();
+        if (valueCount < 0) {
+            std::cerr << "[ONNXModel] " << name() << " has no detections to record" << std::endl;
+            m_recordPath.clear();
+            return;
+        }
+        m_trackWriter = std::make_unique<TrackWriter>();
+        const int sources = static_cast<int>(std::max<size_t>(1, m_inputOps.size()));
+        if (!m_trackWriter->open(m_recordPath, name(), valueCount, sources, m_recordFormat)) {
+            m_trackWriter.reset();
+            m_recordPath.clear();
+            return;
+        }
+        m_trackFrame.valueCount = valueCount;
+        std::cout << "[ONNXModel] Recording " << name() << " results to " << m_recordPath << std::endl;
+    }
+
+    m_trackFrame.clear();
+    m_trackFrame.frame = frame;
+    m_trackFrame.timeMs = timeMs;
+    const size_t current = m_currentSource;
+    const size_t sources = std::max<size_t>(1, m_inputOps.size());
+    for (size_t s = 0; s < sources; s++) {
+        m_currentSource = s;
+        appendTrackDetections(m_trackFrame);
+    }
+    m_currentSource = current;
+    m_trackWriter->write(m_trackFrame);
 }
 
 void ONNXModel::process(Context& ctx) {
-    if (!m_loaded || !m_inputOp) return;
+    if (!isLoaded() && !finishPreload()) return;
+    if (m_trackReader) {
+        processReplay();
+        return;
+    }
+    if (!m_inputOp) return;
 
-    // Check that input provides CPU pixels (required for ML inference)
-    if (!m_inputOp->cpuPixels()) {
-        return;  // Input not ready yet
+    m_frameCounter++;
+
+    for (const Operator* op : m_inputOps) {
+        if (!inputReady(op)) {
+            return;  // Input not ready yet
+        }
     }
 
-    // Prepare input tensor (subclass can override)
-    if (!m_inputTensors.empty()) {
-        prepareInputTensor(ctx, m_inputTensors[0]);
+    // Fixed-batch models can't pack several sources; run them one by one
+    const bool sequential = m_inputOps.size() > 1 && !m_dynamicBatch;
+
+    if (skipFrame(m_asyncEnabled && !sequential)) return;
+
+    if (sequential) {
+        markRun();
+        processSequential(ctx);
+        return;
     }
 
+    processFrame(&ctx);
+}
+
+void ONNXModel::processPrepared() {
+    if ((!isLoaded() && !finishPreload()) || m_trackReader) return;
+    m_frameCounter++;
+    if (skipFrame(m_asyncEnabled)) return;
+    processFrame(nullptr);
+}
+
+bool ONNXModel::skipFrame(bool collect) {
+    if (shouldRun() && scheduleAllows()) return false;
+    m_framesSkipped++;
+    if (collect) processAsync(nullptr, false);  // still pick up a finished result
+    onInferenceSkipped();
+    return true;
+}
+
+void ONNXModel::processFrame(Context* ctx) {
+    if (m_asyncEnabled) {
+        processAsync(ctx);
+        return;
+    }
+
+    markRun();
+
+    // Prepare input tensor (subclass can override)
+    double start = nowMs();
+    if (ctx) prepareInputs(*ctx);
+    double prepared = nowMs();
+    m_preprocessStats.add(prepared - start);
+
     // Run inference
     runInference();
+    m_resultFrame = m_frameCounter;
+    m_resultTimeMs = nowMs();
+    m_runStats.add(m_resultTimeMs - prepared);
 
     // Process output (subclass can override)
-    if (!m_outputTensors.empty()) {
-        processOutputTensor(m_outputTensors[0]);
+    dispatchOutputs();
+    m_postprocessStats.add(nowMs() - m_resultTimeMs);
+    countInference();
+    if (!m_recordPath.empty()) recordLatest();
+}
+
+bool ONNXModel::shouldRun() {
+    const RunPolicy& policy = m_runPolicy;
+
+    if (m_lastRunFrame >= 0) {
+        if (policy.everyFrames > 1 && m_frameCounter - m_lastRunFrame < policy.everyFrames) {
+            return false;
+        }
+        if (policy.maxRateHz > 0.0f && nowMs() - m_lastRunMs < 1000.0 / policy.maxRateHz) {
+            return false;
+        }
+    }
+
+    if (!policy.onNewFrame && policy.changeThreshold <= 0.0f) {
+        return true;
     }
+
+    // Any source with a new (or changed) frame runs them all. Texture-only
+    // sources can't be inspected and always count as new.
+    m_sourceWatch.resize(m_inputOps.size());
+    bool anyNew = false;
+    bool anyChanged = false;
+    for (size_t s = 0; s < m_inputOps.size(); s++) {
+        SourceWatch& watch = m_sourceWatch[s];
+        const io::ImageData* pixels = m_inputOps[s]->cpuPixels();
+        if (!pixels) {
+            anyNew = anyChanged = true;
+            continue;
+        }
+        if (policy.onNewFrame) {
+            watch.pendingSignature = FrameChangeDetector::signature(*pixels);
+            anyNew |= watch.pendingSignature != watch.signature;
+        }
+        if (policy.changeThreshold > 0.0f) {
+            anyChanged |= watch.change.difference(*pixels) >= policy.changeThreshold;
+        }
+    }
+
+    if (policy.onNewFrame && !anyNew) return false;
+    if (policy.changeThreshold > 0.0f && !anyChanged) return false;
+    return true;
 }
 
-void ONNXModel::cleanup() {
-    m_ort->session.reset();
-    m_loaded = false;
+bool ONNXModel::scheduleAllows() {
+    if (!m_scheduleClient) return true;
+
+    auto& scheduler = InferenceScheduler::instance();
+    const Admission admission = scheduler.admit(m_scheduleClient);
+    if (admission == Admission::Shed) {
+        scheduler.countShed(m_scheduleClient);
+        m_framesShed++;
+    }
+    return admission == Admission::Run;
 }
 
-void ONNXModel::runInference() {
-    if (!m_loaded) return;
-
-    try {
-        // Create input tensors
-        std::vector<Ort::Value> inputTensors;
-        std::vector<const char*> inputNames;
-
-        for (size_t i = 0; i < m_inputTensors.size(); i++) {
-            auto& tensor = m_inputTensors[i];
-
-            if (tensor.type == TensorType::UInt8) {
-                inputTensors.push_back(Ort::Value::CreateTensor<uint8_t>(
-                    m_ort->memoryInfo,
-                    tensor.dataU8.data(),
-                    tensor.dataU8.size(),
-                    tensor.shape.data(),
-                    tensor.shape.size()
-                ));
-            } else if (tensor.type == TensorType::Int32) {
-                inputTensors.push_back(Ort::Value::CreateTensor<int32_t>(
-                    m_ort->memoryInfo,
-                    tensor.dataI32.data(),
-                    tensor.dataI32.size(),
-                    tensor.shape.data(),
-                    tensor.shape.size()
-                ));
-            } else {
-                inputTensors.push_back(Ort::Value::CreateTensor<float>(
-                    m_ort->memoryInfo,
-                    tensor.data.data(),
-                    tensor.data.size(),
-                    tensor.shape.data(),
-                    tensor.shape.size()
-                ));
+void ONNXModel::markRun() {
+    m_lastRunFrame = m_frameCounter;
+    m_lastRunMs = nowMs();
+
+    // Frames compared against the next time are the ones run now
+    for (auto& watch : m_sourceWatch) {
+        if (m_runPolicy.onNewFrame) watch.signature = watch.pendingSignature;
+        if (m_runPolicy.changeThreshold > 0.0f) watch.change.commit();
+    }
+}
+
+bool ONNXModel::inputReady(const Operator* op) const {
+    // Input needs CPU pixels, or a texture when GPU preprocessing is on
+    return op && (op->cpuPixels() || (m_gpuPreprocess && op->outputView()));
+}
+
+void ONNXModel::selectSource(size_t index) {
+    m_currentSource = index;
+    if (index < m_inputOps.size()) m_inputOp = m_inputOps[index];  // none with processPrepared()
+}
+
+void ONNXModel::prepareInputs(Context& ctx) {
+    if (m_inputTensors.empty()) return;
+
+    if (!isBatched()) {
+        selectSource(0);
+        prepareInputTensor(ctx, m_inputTensors[0]);
+        return;
+    }
+
+    // Each source is prepared on its own, then packed into [N, ...]
+    Tensor& batch = m_inputTensors[0];
+    for (size_t s = 0; s < m_inputOps.size(); s++) {
+        selectSource(s);
+        prepareInputTensor(ctx, m_sourceInput);
+
+        if (s == 0) {
+            std::vector<int64_t> shape = m_sourceInput.shape;
+            if (shape.empty()) shape = {1};
+            shape[0] = static_cast<int64_t>(m_inputOps.size());
+            if (batch.shape != shape || batch.type != m_sourceInput.type) {
+                batch.shape = shape;
+                batch.type = m_sourceInput.type;
+                resizeStorage(batch);
             }
-            inputNames.push_back(m_inputNames[i].c_str());
         }
+        packBatchItem(m_sourceInput, batch, s);
+    }
+    selectSource(0);
+}
 
-        // Output names
-        std::vector<const char*> outputNames;
-        for (const auto& name : m_outputNames) {
-            outputNames.push_back(name.c_str());
+void ONNXModel::dispatchOutputs() {
+    if (m_outputTensors.empty()) return;
+
+    if (!isBatched()) {
+        selectSource(0);
+        processOutputTensor(m_outputTensors[0]);
+        return;
+    }
+
+    // Hand each source its own slice; m_outputTensors is swapped so hooks
+    // that read several outputs see the slices too
+    const int64_t batchSize = static_cast<int64_t>(m_inputOps.size());
+    m_sourceOutputs.resize(m_outputTensors.size());
+    for (auto& output : m_sourceOutputs) {
+        if (!output.buffer.pool()) output.buffer.pool(m_tensorPool);
+    }
+    for (size_t s = 0; s < m_inputOps.size(); s++) {
+        for (size_t i = 0; i < m_outputTensors.size(); i++) {
+            unpackBatchItem(m_outputTensors[i], batchSize, s, m_sourceOutputs[i]);
         }
+        selectSource(s);
+        std::swap(m_outputTensors, m_sourceOutputs);
+        processOutputTensor(m_outputTensors[0]);
+        std::swap(m_outputTensors, m_sourceOutputs);
+    }
+    selectSource(0);
+}
 
-        // Run inference
-        auto outputTensors = m_ort->session->Run(
-            Ort::RunOptions{nullptr},
-            inputNames.data(),
-            inputTensors.data(),
-            inputTensors.size(),
-            outputNames.data(),
-            outputNames.size()
-        );
-
-        // Copy output data
-        for (size_t i = 0; i < outputTensors.size(); i++) {
-            auto& ortTensor = outputTensors[i];
-            auto* data = ortTensor.GetTensorData<float>();
-            auto shape = ortTensor.GetTensorTypeAndShapeInfo().GetShape();
-
-            m_outputTensors[i].shape = shape;
-            size_t size = std::accumulate(shape.begin(), shape.end(), 1LL, std::multiplies<int64_t>());
-            m_outputTensors[i].data.assign(data, data + size);
+void ONNXModel::processSequential(Context& ctx) {
+    // Same tensors for every source, so bindings stay valid between runs.
+    // Stage timings are summed over the sources.
+    double preprocessMs = 0.0, runMs = 0.0, postprocessMs = 0.0;
+    for (size_t s = 0; s < m_inputOps.size(); s++) {
+        selectSource(s);
+        double t0 = nowMs();
+        if (!m_inputTensors.empty()) {
+            prepareInputTensor(ctx, m_inputTensors[0]);
+        }
+        double t1 = nowMs();
+        runInference();
+        double t2 = nowMs();
+        if (!m_outputTensors.empty()) {
+            processOutputTensor(m_outputTensors[0]);
         }
+        double t3 = nowMs();
+        preprocessMs += t1 - t0;
+        runMs += t2 - t1;
+        postprocessMs += t3 - t2;
+    }
+    selectSource(0);
+    m_resultFrame = m_frameCounter;
+    m_resultTimeMs = nowMs();
+
+    m_preprocessStats.add(preprocessMs);
+    m_runStats.add(runMs);
+    m_postprocessStats.add(postprocessMs);
+    countInference();
+    if (!m_recordPath.empty()) recordLatest();
+}
 
-    } catch (const Ort::Exception& e) {
-        std::cerr << "[ONNXModel] Inference error: " << e.what() << std::endl;
+void ONNXModel::processAsync(Context* ctx, bool submit) {
+    if (!m_worker) {
+        startWorker();
     }
+    auto& worker = *m_worker;
+
+    // Decode every finished frame in order, on the render thread so subclass
+    // results are never touched concurrently with their accessors
+    size_t index = 0;
+    while (worker.done.pop(index)) {
+        auto& slot = worker.slots[index];
+        std::swap(m_outputTensors, slot.outputs);
+        m_resultFrame = slot.submittedFrame;
+        m_resultTimeMs = slot.submittedTimeMs;
+        m_runStats.add(slot.runMs);
+        worker.free.push_back(index);
+
+        // Map back with the regions of the frame that ran, not the newest
+        double start = nowMs();
+        std::swap(m_inputFrames, slot.inputFrames);
+        dispatchOutputs();
+        std::swap(m_inputFrames, slot.inputFrames);
+        m_postprocessStats.add(nowMs() - start);
+        countInference();
+        if (!m_recordPath.empty()) recordLatest();
+    }
+
+    if (!submit) return;
+
+    // Every slot in flight: drop this frame rather than queue it. While
+    // profiling, the window's last runs drain before anything new starts so
+    // EndProfiling never races a pipelined run
+    const bool profileFull = m_profileRemaining > 0 &&
+                             worker.inFlight() >= static_cast<size_t>(m_profileRemaining);
+    if (worker.free.empty() || profileFull) {
+        m_framesDropped++;
+        return;
+    }
+
+    markRun();
+    double start = nowMs();
+    if (ctx) prepareInputs(*ctx);
+    m_preprocessStats.add(nowMs() - start);
+
+    index = worker.free.back();
+    worker.free.pop_back();
+    auto& slot = worker.slots[index];
+    std::swap(m_inputTensors, slot.inputs);
+    slot.inputFrames = m_inputFrames;
+    slot.submittedFrame = m_frameCounter;
+    slot.submittedTimeMs = nowMs();
+    if (m_scheduleClient) {
+        InferenceScheduler::instance().submit(m_scheduleClient, [this, &worker, index]() {
+            runSlot(worker, index);
+        });
+        return;
+    }
+    worker.pending.push(index);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+    }
+    worker.cv.notify_one();
+}
+
+void ONNXModel::runSlot(AsyncWorker& worker, size_t index) {
+    auto& slot = worker.slots[index];
+    double start = nowMs();
+    runInference(slot.inputs, slot.outputs);
+    slot.runMs = nowMs() - start;
+    worker.done.push(index);
+}
+
+void ONNXModel::cacheInputShapes(size_t count) {
+    m_inputShapeCache = std::max<size_t>(1, count);
+    if (!m_worker) reserveBindings();  // else on the next worker start
+}
+
+void ONNXModel::reserveBindings() {
+    // A binding per buffer set (every pipeline slot plus the front buffers)
+    // and input shape
+    const size_t bufferSets = m_asyncEnabled ? static_cast<size_t>(m_pipelineDepth) + 1 : 1;
+    if (m_backend) m_backend->reserveBindings(bufferSets * m_inputShapeCache);
+}
+
+void ONNXModel::startWorker() {
+    m_worker = std::make_unique<AsyncWorker>();
+    auto& worker = *m_worker;
+    const size_t depth = static_cast<size_t>(m_pipelineDepth);
+    worker.slots.resize(depth);
+    for (size_t i = 0; i < depth; i++) {
+        worker.slots[i].inputs = m_inputTensors;
+        worker.slots[i].outputs = m_outputTensors;
+        worker.free.push_back(depth - 1 - i);
+    }
+    worker.pending.reset(depth);
+    worker.done.reset(depth);
+
+    reserveBindings();
+
+    // Scheduled models run on the shared pool instead of their own thread
+    if (m_scheduled) {
+        m_scheduleClient = InferenceScheduler::instance().registerClient(
+            name() + " " + fs::path(m_modelPath).filename().string(), m_schedulePolicy);
+        return;
+    }
+
+    worker.thread = std::thread([this, worker = m_worker.get()]() {
+        while (true) {
+            size_t index = 0;
+            if (!worker->pending.pop(index)) {
+                std::unique_lock<std::mutex> lock(worker->mutex);
+                worker->cv.wait(lock, [worker]() {
+                    return worker->stop.load() || !worker->pending.empty();
+                });
+                if (worker->stop.load()) break;
+                continue;
+            }
+
+            runSlot(*worker, index);
+        }
+    });
+}
+
+void ONNXModel::stopWorker() {
+    if (!m_worker) return;
+    if (m_scheduleClient) {
+        // Drops waiting runs and waits for the running one
+        InferenceScheduler::instance().unregisterClient(m_scheduleClient);
+        m_scheduleClient = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_worker->mutex);
+        m_worker->stop = true;
+    }
+    m_worker->cv.notify_one();
+    if (m_worker->thread.joinable()) {
+        m_worker->thread.join();
+    }
+    m_worker.reset();
+}
+
+void ONNXModel::cleanup() {
+    joinPreload();
+    stopWorker();
+    m_gpuResampler.reset();
+    m_gpuPreprocessActive = false;
+    if (m_backend) m_backend->unload();
+    m_trackWriter.reset();
+    m_trackReader.reset();
+    m_loaded = false;
+}
+
+void ONNXModel::clearSessionCache() {
+    OnnxBackend::clearSessionCache();
+}
+
+size_t ONNXModel::cachedSessionCount() {
+    return OnnxBackend::cachedSessionCount();
+}
+
+void ONNXModel::runInference() {
+    runInference(m_inputTensors, m_outputTensors);
+}
+
+void ONNXModel::runInference(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) {
+    if (!m_loaded || !m_backend) return;
+    m_backend->run(inputs, outputs);
 }
 
 bool ONNXModel::textureToTensor(Context& ctx, Tensor& tensor,
-                                 int targetWidth, int targetHeight) {
+                                 int targetWidth, int targetHeight,
+                                 const SourceRect& region) {
     if (!m_inputOp) return false;
 
-    // Use CPU pixel path (operators that support ML should provide cpuPixels)
+    // GPU path: sample the texture at tensor resolution and read back only
+    // the tensor, instead of reading back the full frame
+    if (m_gpuPreprocess && ctx.device()) {
+        WGPUTextureView view = m_inputOp->outputView();
+        if (view) {
+            if (!m_gpuResampler) {
+                m_gpuResampler = std::make_unique<GpuResampler>();
+            }
+            if (!m_gpuResampler->failed() &&
+                m_gpuResampler->resample(ctx.device(), ctx.queue(), view, tensor,
+                                         targetWidth, targetHeight, m_inputNormalization,
+                                         region, m_aspectMode)) {
+                m_gpuPreprocessActive = true;
+                m_lastInputWidth = m_gpuResampler->sourceWidth();
+                m_lastInputHeight = m_gpuResampler->sourceHeight();
+                setInputFrame(region, aspectLayout(m_aspectMode, region, m_lastInputWidth, m_lastInputHeight,
+                                            targetWidth, targetHeight).region);
+                return true;
+            }
+        }
+    }
+    m_gpuPreprocessActive = false;
+
+    // CPU pixel path (operators that support ML should provide cpuPixels)
     auto pixels = m_inputOp->cpuPixels();
     if (!pixels) {
         std::cerr << "[ONNXModel] Input operator does not provide CPU pixels" << std::endl;
         return false;
     }
 
-    return cpuPixelsToTensor(*pixels, tensor, targetWidth, targetHeight);
+    return cpuPixelsToTensor(*pixels, tensor, targetWidth, targetHeight, region);
 }
 
 bool ONNXModel::cpuPixelsToTensor(const io::ImageData& pixels, Tensor& tensor,
-                                   int targetWidth, int targetHeight) {
+                                   int targetWidth, int targetHeight,
+                                   const SourceRect& region) {
     if (pixels.pixels.empty() || pixels.width <= 0 || pixels.height <= 0) {
         return false;
     }
-
-    int srcWidth = pixels.width;
-    int srcHeight = pixels.height;
-    int srcChannels = pixels.channels;
-    const uint8_t* pixelData = pixels.pixels.data();
-
-    // Determine tensor format from shape (NHWC vs NCHW)
-    bool isNHWC = true;
-    int channels = 3;
-    if (tensor.shape.size() >= 4) {
-        if (tensor.shape[1] <= 4) {
-            isNHWC = false;
-            channels = static_cast<int>(tensor.shape[1]);
-        } else {
-            channels = static_cast<int>(tensor.shape[3]);
-        }
+    m_lastInputWidth = pixels.width;
+    m_lastInputHeight = pixels.height;
+
+    // Resize, BGRA->RGB, layout and normalization in one pass:
+    // - uint8/int32: raw 0-255 values
+    // - float32: m_inputNormalization (default 0-1, subclasses override)
+    if (!m_resampler.resample(pixels, tensor, targetWidth, targetHeight, m_inputNormalization,
+                              region, m_aspectMode)) {
+        return false;
     }
+    setInputFrame(region, m_resampler.layout().region);
+    return true;
+}
 
-    // Resize and convert to tensor using bilinear interpolation
-    float scaleX = static_cast<float>(srcWidth) / targetWidth;
-    float scaleY = static_cast<float>(srcHeight) / targetHeight;
-
-    for (int y = 0; y < targetHeight; y++) {
-        for (int x = 0; x < targetWidth; x++) {
-            float srcX = (x + 0.5f) * scaleX - 0.5f;
-            float srcY = (y + 0.5f) * scaleY - 0.5f;
-
-            int x0 = std::max(0, std::min(static_cast<int>(srcX), srcWidth - 1));
-            int y0 = std::max(0, std::min(static_cast<int>(srcY), srcHeight - 1));
-            int x1 = std::max(0, std::min(x0 + 1, srcWidth - 1));
-            int y1 = std::max(0, std::min(y0 + 1, srcHeight - 1));
-
-            float fx = srcX - std::floor(srcX);
-            float fy = srcY - std::floor(srcY);
-
-            auto getPixel = [&](int px, int py) -> std::array<float, 4> {
-                const uint8_t* p = pixelData + (py * srcWidth + px) * srcChannels;
-                std::array<float, 4> result = {0, 0, 0, 255};
-                // Source is BGRA (from AVFoundation), model expects RGB
-                // Swap B and R channels: BGRA -> RGBA
-                if (srcChannels >= 3) {
-                    result[0] = static_cast<float>(p[2]);  // R from B position
-                    result[1] = static_cast<float>(p[1]);  // G stays
-                    result[2] = static_cast<float>(p[0]);  // B from R position
-                    if (srcChannels >= 4) {
-                        result[3] = static_cast<float>(p[3]);  // A
-                    }
-                } else {
-                    for (int c = 0; c < srcChannels; c++) {
-                        result[c] = static_cast<float>(p[c]);
-                    }
-                }
-                return result;
-            };
-
-            auto p00 = getPixel(x0, y0), p10 = getPixel(x1, y0);
-            auto p01 = getPixel(x0, y1), p11 = getPixel(x1, y1);
-
-            std::array<float, 4> result;
-            for (int c = 0; c < 4; c++) {
-                float v0 = p00[c] * (1 - fx) + p10[c] * fx;
-                float v1 = p01[c] * (1 - fx) + p11[c] * fx;
-                result[c] = v0 * (1 - fy) + v1 * fy;
-            }
+const SourceRect& ONNXModel::inputRegion() const {
+    return inputFrame().region;
+}
 
-            // Store in tensor with appropriate format:
-            // - uint8/int32: raw 0-255 values (result is already 0-255)
-            // - float32: normalized 0-1 (most float models expect this)
-            if (tensor.type == TensorType::UInt8) {
-                if (isNHWC) {
-                    size_t baseIdx = (y * targetWidth + x) * channels;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.dataU8[baseIdx + c] = static_cast<uint8_t>(result[c]);
-                } else {
-                    size_t pixelIdx = y * targetWidth + x;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.dataU8[c * targetWidth * targetHeight + pixelIdx] = static_cast<uint8_t>(result[c]);
-                }
-            } else if (tensor.type == TensorType::Int32) {
-                if (isNHWC) {
-                    size_t baseIdx = (y * targetWidth + x) * channels;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.dataI32[baseIdx + c] = static_cast<int32_t>(result[c]);
-                } else {
-                    size_t pixelIdx = y * targetWidth + x;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.dataI32[c * targetWidth * targetHeight + pixelIdx] = static_cast<int32_t>(result[c]);
-                }
-            } else {
-                // Float32: normalize to 0-1 range (BlazeFace, most float models)
-                if (isNHWC) {
-                    size_t baseIdx = (y * targetWidth + x) * channels;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.data[baseIdx + c] = result[c] / 255.0f;
-                } else {
-                    size_t pixelIdx = y * targetWidth + x;
-                    for (int c = 0; c < channels && c < 4; c++)
-                        tensor.data[c * targetWidth * targetHeight + pixelIdx] = result[c] / 255.0f;
-                }
-            }
-        }
-    }
+const ONNXModel::InputFrame& ONNXModel::inputFrame() const {
+    static const InputFrame s_fullFrame;
+    return m_currentSource < m_inputFrames.size() ? m_inputFrames[m_currentSource] : s_fullFrame;
+}
 
-    return true;
+void ONNXModel::setInputFrame(const SourceRect& requested, const SourceRect& region) {
+    if (m_inputFrames.size() <= m_currentSource) {
+        m_inputFrames.resize(m_currentSource + 1);
+    }
+    InputFrame& frame = m_inputFrames[m_currentSource];
+    frame.requested = requested;
+    frame.region = region;
+    frame.width = m_lastInputWidth;
+    frame.height = m_lastInputHeight;
 }
 
 } // namespace vivid::onnx
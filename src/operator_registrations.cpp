@@ -10,11 +10,15 @@
 #include <vivid/onnx/onnx_model.h>
 #include <vivid/onnx/pose_detector.h>
 #include <vivid/onnx/face_detector.h>
+#include <vivid/onnx/cascade.h>
+#include <vivid/onnx/segment_mask.h>
 
 // Use type aliases to match REGISTER_OPERATOR macro pattern
 using MLONNXModel = vivid::onnx::ONNXModel;
 using MLPoseDetector = vivid::onnx::PoseDetector;
 using MLFaceDetector = vivid::onnx::FaceDetector;
+using MLRoiCascade = vivid::onnx::RoiCascade;
+using MLSegmentMask = vivid::onnx::SegmentMask;
 
 // Register ONNXModel - generic ONNX model inference operator
 REGISTER_OPERATOR(MLONNXModel, "ML", "Run ONNX model inference on input texture", true);
@@ -24,3 +28,9 @@ REGISTER_OPERATOR(MLPoseDetector, "ML", "Detect body poses using MoveNet model",
 
 // Register FaceDetector - BlazeFace face detection
 REGISTER_OPERATOR(MLFaceDetector, "ML", "Detect faces using BlazeFace model", true);
+
+// Register RoiCascade - secondary model on each upstream detection
+REGISTER_OPERATOR(MLRoiCascade, "ML", "Run a model on each face or pose crop of a detector", true);
+
+// Register SegmentMask - background/person segmentation to a mask texture
+REGISTER_OPERATOR(MLSegmentMask, "ML", "Segment people/foreground into a mask texture", true);
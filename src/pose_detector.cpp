@@ -2,14 +2,57 @@
 #include <vivid/context.h>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 
 namespace vivid::onnx {
 
-PoseDetector::PoseDetector() {
-    // Initialize keypoints to invalid positions
-    for (auto& kp : m_keypoints) {
-        kp = glm::vec3(0.0f, 0.0f, 0.0f);
+static const DetectedPose s_emptyPose = {};
+static const std::vector<DetectedPose> s_noPoses;
+static const PoseKeypoints s_noKeypoints;
+
+// Bounding box of a person's keypoints above a confidence threshold
+static glm::vec4 keypointBounds(const PoseKeypoints& kps, size_t pose, float threshold) {
+    const float* xs = kps.x(pose);
+    const float* ys = kps.y(pose);
+    const float* conf = kps.confidence(pose);
+    float minX = 1.0f, minY = 1.0f, maxX = 0.0f, maxY = 0.0f;
+    bool any = false;
+    for (int i = 0; i < PoseKeypoints::kKeypoints; i++) {
+        if (conf[i] < threshold) continue;
+        minX = std::min(minX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxX = std::max(maxX, xs[i]);
+        maxY = std::max(maxY, ys[i]);
+        any = true;
     }
+    return any ? glm::vec4(minX, minY, maxX - minX, maxY - minY) : glm::vec4(0.0f);
+}
+
+// A person's keypoint arrays as the DetectedPose layout
+static void copyKeypoints(const PoseKeypoints& kps, size_t pose, std::array<glm::vec3, 17>& out) {
+    const float* xs = kps.x(pose);
+    const float* ys = kps.y(pose);
+    const float* conf = kps.confidence(pose);
+    for (int i = 0; i < PoseKeypoints::kKeypoints; i++) {
+        out[i] = glm::vec3(xs[i], ys[i], conf[i]);
+    }
+}
+
+static double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+PoseDetector::PoseDetector() {
+    // MoveNet float32 expects 0-255 values (not normalized 0-1)
+    m_inputNormalization = Normalization::raw();
+
+    // Multipose: people overlap more than faces; keypoints ride along
+    m_nms.iouThreshold(0.5f).attributeCount(PoseKeypoints::kBlock);
+
+    // Keypoints start at invalid (zero) positions
+    m_poses.resize(1);
 }
 
 PoseDetector::~PoseDetector() = default;
@@ -19,6 +62,12 @@ PoseDetector& PoseDetector::input(Operator* op) {
     return *this;
 }
 
+PoseDetector& PoseDetector::inputs(const std::vector<Operator*>& ops) {
+    ONNXModel::inputs(ops);
+    m_poses.assign(std::max<size_t>(1, ops.size()), SourcePose{});
+    return *this;
+}
+
 PoseDetector& PoseDetector::model(const std::string& path) {
     ONNXModel::model(path);
     return *this;
@@ -34,6 +83,197 @@ PoseDetector& PoseDetector::drawSkeleton(bool draw) {
     return *this;
 }
 
+PoseDetector& PoseDetector::nmsMode(NmsMode mode) {
+    m_nms.mode(mode);
+    return *this;
+}
+
+PoseDetector& PoseDetector::iouThreshold(float threshold) {
+    m_nms.iouThreshold(threshold);
+    return *this;
+}
+
+const DetectedPose& PoseDetector::pose(int index) const {
+    const auto& all = m_poses[0].poses;
+    if (index < 0 || index >= static_cast<int>(all.size())) {
+        return s_emptyPose;
+    }
+    return all[index];
+}
+
+const std::vector<DetectedPose>& PoseDetector::poses(size_t source) const {
+    return source < m_poses.size() ? m_poses[source].poses : s_noPoses;
+}
+
+const PoseKeypoints& PoseDetector::poseKeypoints(size_t source) const {
+    return source < m_poses.size() ? m_poses[source].keypointBuffer : s_noKeypoints;
+}
+
+PoseDetector& PoseDetector::smoothing(bool enabled) {
+    m_smoothing = enabled;
+    for (auto& pose : m_poses) {
+        pose.tracker.reset();
+    }
+    return *this;
+}
+
+PoseDetector& PoseDetector::tracking(bool enabled) {
+    m_tracking = enabled;
+    for (auto& pose : m_poses) {
+        pose.nextCrop = SourceRect{};
+    }
+    return *this;
+}
+
+static int roundToStep(int size) {
+    return std::max(32, (size + 16) / 32 * 32);
+}
+
+PoseDetector& PoseDetector::inputResolution(int width, int height) {
+    m_requestedWidth = roundToStep(width);
+    m_requestedHeight = roundToStep(height);
+    m_resolutionLevel = 0;
+    if (isLoaded()) {
+        if (m_resizable) {
+            applyResolution();
+        } else {
+            std::cout << "[PoseDetector] Fixed input size, keeping " << m_inputWidth << "x" << m_inputHeight << std::endl;
+        }
+    }
+    return *this;
+}
+
+PoseDetector& PoseDetector::latencyBudget(float budgetMs, int minSize) {
+    m_latencyBudgetMs = std::max(0.0f, budgetMs);
+    m_minResolution = roundToStep(minSize);
+    m_resolutionLevel = 0;
+    if (isLoaded() && m_resizable) {
+        applyResolution();
+    }
+    return *this;
+}
+
+void PoseDetector::resolutionForLevel(int level, int& width, int& height) const {
+    // Both sides shrink by the longer side's 32 px steps
+    const int longSide = std::max(m_requestedWidth, m_requestedHeight);
+    const float scale = static_cast<float>(longSide - 32 * level) / static_cast<float>(longSide);
+    width = roundToStep(static_cast<int>(m_requestedWidth * scale));
+    height = roundToStep(static_cast<int>(m_requestedHeight * scale));
+}
+
+void PoseDetector::applyResolution() {
+    const int longSide = std::max(m_requestedWidth, m_requestedHeight);
+    m_resolutionLevels = m_latencyBudgetMs > 0.0f
+        ? std::max(0, longSide - m_minResolution) / 32 + 1
+        : 1;
+    m_resolutionLevel = std::clamp(m_resolutionLevel, 0, m_resolutionLevels - 1);
+    m_levelRuns = 0;
+    m_levelRunMs = 0.0;
+
+    resolutionForLevel(m_resolutionLevel, m_inputWidth, m_inputHeight);
+    if (!m_inputShapes.empty() && m_inputShapes[0].size() >= 4) {
+        m_inputShapes[0][1] = m_inputHeight;  // inputShape() reports the size in use
+        m_inputShapes[0][2] = m_inputWidth;
+    }
+
+    // Every level, plus room to switch back after an inputResolution() change
+    cacheInputShapes(static_cast<size_t>(m_resolutionLevels) + 1);
+}
+
+void PoseDetector::adaptResolution() {
+    static constexpr int kLevelRuns = 10;
+    if (!m_resizable || m_resolutionLevels <= 1) return;
+
+    m_levelRunMs += lastRunMs();
+    if (++m_levelRuns < kLevelRuns) return;
+
+    const double averageMs = m_levelRunMs / m_levelRuns;
+    int level = m_resolutionLevel;
+    if (averageMs > m_latencyBudgetMs && level + 1 < m_resolutionLevels) {
+        level++;
+    } else if (level > 0) {
+        // Run time scales roughly with the pixel count
+        int width = 0, height = 0;
+        resolutionForLevel(level - 1, width, height);
+        const double predictedMs = averageMs * (width * height) / (m_inputWidth * m_inputHeight);
+        if (predictedMs < m_latencyBudgetMs * 0.85) level--;
+    }
+
+    m_levelRuns = 0;
+    m_levelRunMs = 0.0;
+    if (level == m_resolutionLevel) return;
+
+    m_resolutionLevel = level;
+    applyResolution();
+    // Runs of the previous size still in the async pipeline don't count
+    m_levelRuns = isAsync() ? -pipelineDepth() : 0;
+    std::cout << "[PoseDetector] Run " << averageMs << " ms, input size " << m_inputWidth << "x" << m_inputHeight << std::endl;
+}
+
+SourceRect PoseDetector::cropRegion(size_t source) const {
+    return m_poses[source < m_poses.size() ? source : 0].crop;
+}
+
+SourceRect PoseDetector::cropRegionFor(const std::array<glm::vec3, 17>& keypoints,
+                                       int frameWidth, int frameHeight) {
+    // Constants from the MoveNet reference cropping algorithm
+    constexpr float kMinCropKeypointScore = 0.2f;
+    constexpr float kTorsoExpansion = 1.9f;
+    constexpr float kBodyExpansion = 1.2f;
+
+    if (frameWidth <= 0 || frameHeight <= 0) return SourceRect{};
+
+    auto visible = [&](Keypoint kp) {
+        return keypoints[static_cast<int>(kp)].z > kMinCropKeypointScore;
+    };
+    bool torsoVisible = (visible(Keypoint::LeftHip) || visible(Keypoint::RightHip)) &&
+                        (visible(Keypoint::LeftShoulder) || visible(Keypoint::RightShoulder));
+    if (!torsoVisible) return SourceRect{};
+
+    const float w = static_cast<float>(frameWidth);
+    const float h = static_cast<float>(frameHeight);
+    auto pixel = [&](int i) { return glm::vec2(keypoints[i].x * w, keypoints[i].y * h); };
+
+    const glm::vec2 center = (pixel(static_cast<int>(Keypoint::LeftHip)) +
+                              pixel(static_cast<int>(Keypoint::RightHip))) * 0.5f;
+
+    // Largest distance from the hip center to a torso joint, and to any visible joint
+    float torsoRange = 0.0f;
+    for (Keypoint kp : {Keypoint::LeftShoulder, Keypoint::RightShoulder,
+                        Keypoint::LeftHip, Keypoint::RightHip}) {
+        glm::vec2 d = glm::abs(center - pixel(static_cast<int>(kp)));
+        torsoRange = std::max(torsoRange, std::max(d.x, d.y));
+    }
+    float bodyRange = 0.0f;
+    for (int i = 0; i < 17; i++) {
+        if (keypoints[i].z <= kMinCropKeypointScore) continue;
+        glm::vec2 d = glm::abs(center - pixel(i));
+        bodyRange = std::max(bodyRange, std::max(d.x, d.y));
+    }
+
+    float half = std::max(torsoRange * kTorsoExpansion, bodyRange * kBodyExpansion);
+    float toEdge = std::max(std::max(center.x, w - center.x), std::max(center.y, h - center.y));
+    half = std::min(half, toEdge);
+
+    // Crop as large as the frame (or degenerate): just use the frame
+    if (half > std::max(w, h) * 0.5f || half < 1.0f) return SourceRect{};
+
+    SourceRect crop;
+    crop.x = (center.x - half) / w;
+    crop.y = (center.y - half) / h;
+    crop.width = 2.0f * half / w;
+    crop.height = 2.0f * half / h;
+    return crop;
+}
+
+bool PoseDetector::detected(size_t source) const {
+    return source < m_poses.size() && m_poses[source].detected;
+}
+
+const std::array<glm::vec3, 17>& PoseDetector::keypoints(size_t source) const {
+    return m_poses[source < m_poses.size() ? source : 0].keypoints;
+}
+
 glm::vec2 PoseDetector::keypoint(Keypoint kp) const {
     return keypoint(static_cast<int>(kp));
 }
@@ -42,7 +282,8 @@ glm::vec2 PoseDetector::keypoint(int index) const {
     if (index < 0 || index >= 17) {
         return glm::vec2(0.0f);
     }
-    return glm::vec2(m_keypoints[index].x, m_keypoints[index].y);
+    const auto& kp = m_poses[0].keypoints[index];
+    return glm::vec2(kp.x, kp.y);
 }
 
 float PoseDetector::confidence(Keypoint kp) const {
@@ -53,7 +294,7 @@ float PoseDetector::confidence(int index) const {
     if (index < 0 || index >= 17) {
         return 0.0f;
     }
-    return m_keypoints[index].z;
+    return m_poses[0].keypoints[index].z;
 }
 
 void PoseDetector::onModelLoaded() {
@@ -64,11 +305,12 @@ void PoseDetector::onModelLoaded() {
         int64_t h = m_inputShapes[0][1];
         int64_t w = m_inputShapes[0][2];
 
-        // If dynamic (was -1, converted to 1) or too small, use recommended size
-        // Valid MoveNet sizes are 192, 256, 480, etc.
-        if (h < 32 || w < 32) {
-            m_inputWidth = 256;
-            m_inputHeight = 256;
+        // If dynamic (was -1, converted to 1) or too small, use the requested
+        // size (default 256x256, multiples of 32 like 192, 256, 480)
+        m_resizable = m_dynamicInputSize || h < 32 || w < 32;
+        if (m_resizable) {
+            m_resolutionLevel = 0;
+            applyResolution();
             std::cout << "[PoseDetector] Dynamic input size, using " << m_inputWidth << "x" << m_inputHeight << std::endl;
         } else {
             m_inputWidth = static_cast<int>(w);
@@ -76,47 +318,60 @@ void PoseDetector::onModelLoaded() {
             std::cout << "[PoseDetector] Model input size: " << m_inputWidth << "x" << m_inputHeight << std::endl;
         }
     }
+
+    // Settle the output layout once: multipose is [1, N, 56], singlepose
+    // [1, 1, 17, 3]. ROI tracking only applies to singlepose.
+    m_format = OutputFormat::Unknown;
+    m_maxDetections = 6;
+    if (!m_outputShapes.empty() && !m_outputShapes[0].empty()) {
+        const auto& shape = m_outputShapes[0];
+        const size_t rank = shape.size();
+        if (shape[rank - 1] == 56 || rank == 3) {
+            m_format = OutputFormat::Multipose;
+            if (rank >= 2 && shape[rank - 2] > 0) m_maxDetections = static_cast<size_t>(shape[rank - 2]);
+        } else if (rank >= 2 && shape[rank - 1] == 3 && shape[rank - 2] == 17) {
+            m_format = OutputFormat::Singlepose;
+            m_maxDetections = 1;
+        }
+    }
+    if (m_tracking && m_format == OutputFormat::Multipose) {
+        std::cout << "[PoseDetector] Multipose model, ROI tracking disabled" << std::endl;
+    }
+
+    // Result storage for every person the model can report
+    for (auto& pose : m_poses) {
+        pose.poses.reserve(m_maxDetections);
+        pose.keypointBuffer.reserve(m_maxDetections);
+    }
 }
 
 void PoseDetector::prepareInputTensor(Context& ctx, Tensor& tensor) {
     // MoveNet expects input in NHWC format
     // Shape: [1, height, width, channels]
-    // Values: 0-255 (uint8/int32) or 0-1 (float) depending on model variant
+    // Values: 0-255 (uint8/int32), -128-127 (int8) or 0-1 (float/float16)
+    // depending on model variant
 
     // Update tensor shape for dynamic input models
     int channels = (tensor.shape.size() >= 4) ? static_cast<int>(tensor.shape[3]) : 3;
     tensor.shape = {1, m_inputHeight, m_inputWidth, channels};
 
     // Resize tensor data buffer to match actual dimensions
-    size_t tensorSize = tensor.size();
-    if (tensor.type == TensorType::UInt8 && tensor.dataU8.size() != tensorSize) {
-        tensor.dataU8.resize(tensorSize);
-    } else if (tensor.type == TensorType::Int32 && tensor.dataI32.size() != tensorSize) {
-        tensor.dataI32.resize(tensorSize);
-    } else if (tensor.data.size() != tensorSize) {
-        tensor.data.resize(tensorSize);
-    }
-
-    // Use texture-to-tensor conversion (handles both CPU and GPU paths)
-    bool success = textureToTensor(ctx, tensor, m_inputWidth, m_inputHeight);
-
-    if (success && tensor.type == TensorType::Float32) {
-        // MoveNet float32 expects 0-255 values (not normalized 0-1)
-        // Base class gives us [0, 1], convert to [0, 255]
-        for (float& v : tensor.data) {
-            v = v * 255.0f;
-        }
+    resizeStorage(tensor);
+
+    // Tracking: crop around the previous pose (full frame until locked)
+    if (m_poses.size() < sourceCount()) {
+        m_poses.resize(sourceCount());
     }
+    SourcePose& pose = m_poses[currentSource() < m_poses.size() ? currentSource() : 0];
+    const SourceRect crop = (m_tracking && m_format != OutputFormat::Multipose) ? pose.nextCrop : SourceRect{};
+
+    // Use texture-to-tensor conversion (writes every tensor type directly)
+    bool success = textureToTensor(ctx, tensor, m_inputWidth, m_inputHeight, crop);
 
     if (!success) {
         // If conversion fails, fill with gray placeholder
-        if (tensor.type == TensorType::UInt8) {
-            std::fill(tensor.dataU8.begin(), tensor.dataU8.end(), uint8_t(128));
-        } else if (tensor.type == TensorType::Int32) {
-            std::fill(tensor.dataI32.begin(), tensor.dataI32.end(), int32_t(128));
-        } else {
-            std::fill(tensor.data.begin(), tensor.data.end(), 0.5f);
-        }
+        const Normalization n = tensorNormalization(tensor.type, inputNormalization());
+        fillTensor(tensor, 127.5f * n.scale[0] + n.bias[0]);
     }
 }
 
@@ -125,77 +380,228 @@ void PoseDetector::processOutputTensor(const Tensor& tensor) {
     // Singlepose: [1, 1, 17, 3] - 51 values total
     // Multipose: [1, 6, 56] - 6 detections × 56 values (51 keypoints + 5 bbox)
 
-    m_detected = false;
+    if (m_poses.size() < sourceCount()) {
+        m_poses.resize(sourceCount());
+    }
+    SourcePose& pose = m_poses[currentSource() < m_poses.size() ? currentSource() : 0];
+    pose.detected = false;
+    pose.crop = inputFrame().requested;   // of the frame these outputs ran on
 
-    if (tensor.data.empty()) {
-        return;
+    if (currentSource() == 0 && m_latencyBudgetMs > 0.0f) {
+        adaptResolution();
     }
 
-    // Detect multipose format: shape [1, 6, 56] has size 336
-    bool isMultipose = (tensor.data.size() == 336 || tensor.shape.size() == 3);
-
-    if (isMultipose) {
-        // Multipose: find the detection with highest average keypoint confidence
-        // Each detection has 56 values: 17*3 keypoints + 5 bbox values
-        int bestDetection = -1;
-        float bestAvgConf = 0.0f;
-        int bestValidCount = 0;
-
-        int numDetections = static_cast<int>(tensor.data.size() / 56);
-        for (int d = 0; d < numDetections; d++) {
-            int offset = d * 56;
-            float sumConf = 0.0f;
-            int validCount = 0;
-
-            for (int i = 0; i < 17; i++) {
-                float conf = tensor.data[offset + i * 3 + 2];
-                sumConf += conf;
-                if (conf >= m_confidenceThreshold) {
-                    validCount++;
-                }
-            }
-
-            float avgConf = sumConf / 17.0f;
-            if (validCount > bestValidCount || (validCount == bestValidCount && avgConf > bestAvgConf)) {
-                bestAvgConf = avgConf;
-                bestValidCount = validCount;
-                bestDetection = d;
-            }
-        }
+    const auto values = tensor.as<float>();
+    if (values.empty()) {
+        return;
+    }
 
-        if (bestDetection >= 0 && bestValidCount >= 5) {
-            int offset = bestDetection * 56;
+    // Models that don't report their output shape: detect the layout from
+    // the first output (multipose [1, 6, 56] has 336 values)
+    if (m_format == OutputFormat::Unknown) {
+        m_format = (values.size() == 336 || tensor.shape.size() == 3)
+            ? OutputFormat::Multipose
+            : OutputFormat::Singlepose;
+    }
 
-            for (int i = 0; i < 17; i++) {
-                float y = tensor.data[offset + i * 3 + 0];
-                float x = tensor.data[offset + i * 3 + 1];
-                float conf = tensor.data[offset + i * 3 + 2];
-                m_keypoints[i] = glm::vec3(x, y, conf);
-            }
+    if (m_format == OutputFormat::Multipose) {
+        decodeMultipose(tensor, pose);
 
-            m_detected = true;
+        // Best person doubles as the single-pose result
+        if (!pose.poses.empty()) {
+            pose.keypoints = pose.poses[0].keypoints;
+            pose.detected = true;
         }
     } else {
-        // Singlepose: [1, 1, 17, 3] format
-        if (tensor.data.size() < 51) {
-            return;
+        decodeSinglepose(tensor, pose);
+    }
+
+    if (m_smoothing) {
+        trackPoses(pose);
+    }
+}
+
+void PoseDetector::appendTrackDetections(TrackFrame& frame) const {
+    if (currentSource() >= m_poses.size()) return;
+    for (const DetectedPose& person : m_poses[currentSource()].poses) {
+        TrackDetection det;
+        det.source = static_cast<int>(currentSource());
+        det.id = person.id;
+        det.score = person.score;
+        det.box = person.bbox;
+
+        float values[17 * 3];
+        for (int i = 0; i < 17; i++) {
+            values[i * 3] = person.keypoints[i].x;
+            values[i * 3 + 1] = person.keypoints[i].y;
+            values[i * 3 + 2] = person.keypoints[i].z;
         }
+        frame.add(det, values);
+    }
+}
 
-        int validKeypoints = 0;
+void PoseDetector::applyTrackDetections(const TrackFrame& frame) {
+    if (m_poses.size() <= currentSource()) {
+        m_poses.resize(currentSource() + 1);
+    }
+    SourcePose& pose = m_poses[currentSource()];
+    PoseKeypoints& kps = pose.keypointBuffer;
+    pose.poses.clear();
+    kps.clear();
+
+    // Recorded order is best first already
+    for (size_t d = 0; d < frame.detections.size(); d++) {
+        const TrackDetection& det = frame.detections[d];
+        if (det.source != static_cast<int>(currentSource())) continue;
+
+        const float* values = frame.values(d);
+        DetectedPose person;
+        for (int i = 0; i < 17; i++) {
+            person.keypoints[i] = glm::vec3(values[i * 3], values[i * 3 + 1], values[i * 3 + 2]);
+        }
+        person.bbox = det.box;
+        person.score = det.score;
+        person.id = det.id;
 
+        const size_t p = kps.count();
+        kps.resize(p + 1);
+        float* block = kps.block(p);
         for (int i = 0; i < 17; i++) {
-            float y = tensor.data[i * 3 + 0];
-            float x = tensor.data[i * 3 + 1];
-            float conf = tensor.data[i * 3 + 2];
+            block[i] = values[i * 3];
+            block[PoseKeypoints::kStride + i] = values[i * 3 + 1];
+            block[2 * PoseKeypoints::kStride + i] = values[i * 3 + 2];
+        }
+        pose.poses.push_back(person);
+    }
+
+    pose.detected = !pose.poses.empty();
+    pose.keypoints = pose.detected ? pose.poses[0].keypoints : std::array<glm::vec3, 17>{};
+    if (m_smoothing) {
+        trackPoses(pose);
+    }
+}
+
+void PoseDetector::onInferenceSkipped() {
+    if (!m_smoothing) return;
 
-            m_keypoints[i] = glm::vec3(x, y, conf);
+    // Extrapolate every source's people to this frame
+    const double now = nowSeconds();
+    for (auto& pose : m_poses) {
+        pose.tracker.predict(now);
+        applyTracks(pose);
+    }
+}
 
-            if (conf >= m_confidenceThreshold) {
-                validKeypoints++;
-            }
+void PoseDetector::applyTracks(SourcePose& pose) {
+    PoseKeypoints& kps = pose.keypointBuffer;
+    for (size_t p = 0; p < pose.poses.size(); p++) {
+        DetectedPose& person = pose.poses[p];
+        for (const auto& track : pose.tracker.tracks()) {
+            if (track.id != person.id) continue;
+            person.bbox = track.box;
+            std::memcpy(kps.block(p), track.values.data(), PoseKeypoints::kBlock * sizeof(float));
+            copyKeypoints(kps, p, person.keypoints);
+            break;
         }
+    }
+    if (!pose.poses.empty()) {
+        pose.keypoints = pose.poses[0].keypoints;
+    }
+}
+
+void PoseDetector::trackPoses(SourcePose& pose) {
+    DetectionTracker& tracker = pose.tracker;
+    if (tracker.valueCount() != PoseKeypoints::kBlock) {
+        tracker.valueCount(PoseKeypoints::kBlock);
+    }
+
+    // Keypoint blocks are the tracked values as they are
+    tracker.clear();
+    for (size_t p = 0; p < pose.poses.size(); p++) {
+        const DetectedPose& person = pose.poses[p];
+        tracker.add(person.bbox, person.score, pose.keypointBuffer.block(p));
+    }
+    tracker.update(nowSeconds());
+
+    for (size_t p = 0; p < pose.poses.size(); p++) {
+        pose.poses[p].id = tracker.tracks()[tracker.trackFor(p)].id;
+    }
+    applyTracks(pose);
+}
+
+void PoseDetector::decodeSinglepose(const Tensor& tensor, SourcePose& pose) {
+    // [1, 1, 17, 3]: 17 * (y, x, confidence)
+    PoseKeypoints& kps = pose.keypointBuffer;
+    pose.poses.clear();
+    kps.clear();
+    const auto values = tensor.as<float>();
+    if (values.size() < 51) {
+        return;
+    }
+
+    // Keypoints are relative to the input (crop, aspect mode); map to the full frame
+    kps.resize(1);
+    const KeypointSummary summary =
+        decodeMoveNetKeypoints(values.data(), inputRegion(), m_confidenceThreshold, kps.block(0));
+    copyKeypoints(kps, 0, pose.keypoints);
+
+    pose.detected = summary.aboveThreshold >= 5;
+    if (pose.detected) {
+        pose.poses.resize(1);
+        DetectedPose& person = pose.poses[0];
+        person.keypoints = pose.keypoints;
+        person.bbox = keypointBounds(kps, 0, m_confidenceThreshold);
+        person.score = summary.confidenceSum / 17.0f;
+        person.id = -1;
+    } else {
+        kps.clear();
+    }
+
+    // Next frame's crop; lose the lock as soon as confidence drops
+    pose.nextCrop = (m_tracking && pose.detected)
+        ? cropRegionFor(pose.keypoints, inputFrame().width, inputFrame().height)
+        : SourceRect{};
+}
+
+void PoseDetector::decodeMultipose(const Tensor& tensor, SourcePose& pose) {
+    // Each detection has 56 values: 17 * (y, x, confidence) keypoints, then
+    // the box as ymin, xmin, ymax, xmax and the detection score
+    constexpr int kValuesPerDetection = 56;
+    const auto values = tensor.as<float>();
+    const int numDetections = static_cast<int>(values.size() / kValuesPerDetection);
+
+    // Map to source-normalized coordinates before NMS: IoU doesn't change
+    // under a per-axis scale and offset, and survivors need no second pass
+    const SourceRect& region = inputRegion();
+    alignas(16) float block[PoseKeypoints::kBlock];
+
+    m_nms.clear();
+    for (int d = 0; d < numDetections; d++) {
+        const float* det = &values[d * kValuesPerDetection];
+
+        // Unused slots have near-zero keypoint confidences
+        const KeypointSummary summary = decodeMoveNetKeypoints(det, region, m_confidenceThreshold, block);
+        if (summary.aboveThreshold < 5) continue;
+
+        glm::vec4 bbox(region.x + region.width * det[52], region.y + region.height * det[51],
+                       region.width * (det[54] - det[52]), region.height * (det[53] - det[51]));
+        m_nms.add(bbox, det[55], block);
+    }
 
-        m_detected = validKeypoints >= 5;
+    double start = nowSeconds();
+    size_t count = m_nms.run(static_cast<size_t>(numDetections));
+    recordNmsTime((nowSeconds() - start) * 1000.0);
+
+    PoseKeypoints& kps = pose.keypointBuffer;
+    kps.resize(count);
+    pose.poses.resize(count);
+    for (size_t p = 0; p < count; p++) {
+        DetectedPose& person = pose.poses[p];
+        std::memcpy(kps.block(p), m_nms.attributes(p), PoseKeypoints::kBlock * sizeof(float));
+        copyKeypoints(kps, p, person.keypoints);
+        person.bbox = m_nms.box(p);
+        person.score = m_nms.score(p);
+        person.id = -1;
     }
 }
 
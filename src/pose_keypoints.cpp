@@ -0,0 +1,93 @@
+#include <vivid/onnx/pose_keypoints.h>
+#include "simd.h"
+
+namespace vivid::onnx {
+
+void PoseKeypoints::reserve(size_t people) {
+    if (people > capacity()) m_values.resize(people * kBlock, 0.0f);
+}
+
+void PoseKeypoints::resize(size_t count) {
+    reserve(count);
+    m_count = count;
+}
+
+KeypointSummary decodeMoveNetKeypoints(const float* triplets, const SourceRect& region,
+                                       float threshold, float* block) {
+    constexpr int kStride = PoseKeypoints::kStride;
+    float* outX = block;
+    float* outY = block + kStride;
+    float* outConf = block + 2 * kStride;
+
+    KeypointSummary summary;
+    int k = 0;
+
+#if defined(VIVID_ONNX_SSE2)
+    const __m128 originX = _mm_set1_ps(region.x), scaleX = _mm_set1_ps(region.width);
+    const __m128 originY = _mm_set1_ps(region.y), scaleY = _mm_set1_ps(region.height);
+    const __m128 limit = _mm_set1_ps(threshold);
+    __m128 sum = _mm_setzero_ps();
+    for (; k + 4 <= PoseKeypoints::kKeypoints; k += 4) {
+        // a = y0 x0 c0 y1 | b = x1 c1 y2 x2 | c = c2 y3 x3 c3
+        const float* t = triplets + k * 3;
+        const __m128 a = _mm_loadu_ps(t);
+        const __m128 b = _mm_loadu_ps(t + 4);
+        const __m128 c = _mm_loadu_ps(t + 8);
+
+        const __m128 y01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 3, 0));   // y0 y1 y2 y2
+        const __m128 y23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));   // y2 y2 y3 y3
+        const __m128 y = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 1, 0));
+        const __m128 x01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1));   // x0 y0 x1 x1
+        const __m128 x23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));   // x2 x2 x3 x3
+        const __m128 x = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 c01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));   // c0 c0 c1 c1
+        const __m128 c23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));   // c2 c2 c3 c3
+        const __m128 conf = _mm_shuffle_ps(c01, c23, _MM_SHUFFLE(2, 0, 2, 0));
+
+        _mm_storeu_ps(outX + k, _mm_add_ps(originX, _mm_mul_ps(scaleX, x)));
+        _mm_storeu_ps(outY + k, _mm_add_ps(originY, _mm_mul_ps(scaleY, y)));
+        _mm_storeu_ps(outConf + k, conf);
+
+        const int above = _mm_movemask_ps(_mm_cmpge_ps(conf, limit));
+        summary.aboveThreshold += (above & 1) + ((above >> 1) & 1) + ((above >> 2) & 1) + (above >> 3);
+        sum = _mm_add_ps(sum, conf);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum);
+    summary.confidenceSum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(VIVID_ONNX_NEON)
+    const float32x4_t originX = vdupq_n_f32(region.x), scaleX = vdupq_n_f32(region.width);
+    const float32x4_t originY = vdupq_n_f32(region.y), scaleY = vdupq_n_f32(region.height);
+    const float32x4_t limit = vdupq_n_f32(threshold);
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    uint32x4_t above = vdupq_n_u32(0);
+    for (; k + 4 <= PoseKeypoints::kKeypoints; k += 4) {
+        const float32x4x3_t v = vld3q_f32(triplets + k * 3);   // y, x, confidence
+        vst1q_f32(outX + k, vmlaq_f32(originX, scaleX, v.val[1]));
+        vst1q_f32(outY + k, vmlaq_f32(originY, scaleY, v.val[0]));
+        vst1q_f32(outConf + k, v.val[2]);
+        above = vaddq_u32(above, vshrq_n_u32(vcgeq_f32(v.val[2], limit), 31));
+        sum = vaddq_f32(sum, v.val[2]);
+    }
+    summary.aboveThreshold = static_cast<int>(vgetq_lane_u32(above, 0) + vgetq_lane_u32(above, 1) +
+                                              vgetq_lane_u32(above, 2) + vgetq_lane_u32(above, 3));
+    summary.confidenceSum = (vgetq_lane_f32(sum, 0) + vgetq_lane_f32(sum, 1)) +
+                            (vgetq_lane_f32(sum, 2) + vgetq_lane_f32(sum, 3));
+#endif
+
+    for (; k < PoseKeypoints::kKeypoints; k++) {
+        const float* t = triplets + k * 3;
+        outX[k] = region.x + region.width * t[1];
+        outY[k] = region.y + region.height * t[0];
+        outConf[k] = t[2];
+        summary.aboveThreshold += t[2] >= threshold ? 1 : 0;
+        summary.confidenceSum += t[2];
+    }
+
+    for (int pad = PoseKeypoints::kKeypoints; pad < kStride; pad++) {
+        outX[pad] = outY[pad] = outConf[pad] = 0.0f;
+    }
+    return summary;
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,493 @@
+#include <vivid/onnx/preprocess.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include "simd.h"
+
+namespace vivid::onnx {
+
+TensorLayout detectLayout(const std::vector<int64_t>& shape, int* channels) {
+    TensorLayout layout = TensorLayout::NHWC;
+    int c = 3;
+    if (shape.size() >= 4) {
+        // Channels is the small dimension; if both are small, prefer NHWC
+        // (the TFLite-converted models we ship)
+        if (shape[1] <= 4 && shape[3] > 4) {
+            layout = TensorLayout::NCHW;
+            c = static_cast<int>(shape[1]);
+        } else {
+            c = static_cast<int>(shape[3]);
+        }
+    }
+    if (channels) *channels = c;
+    return layout;
+}
+
+AspectLayout aspectLayout(AspectMode mode, const SourceRect& region,
+                          int srcWidth, int srcHeight, int dstWidth, int dstHeight) {
+    AspectLayout layout;
+    layout.region = region;
+    layout.contentWidth = std::max(dstWidth, 0);
+    layout.contentHeight = std::max(dstHeight, 0);
+    if (mode == AspectMode::Stretch || srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0 ||
+        !(region.width > 0.0f) || !(region.height > 0.0f)) {
+        return layout;
+    }
+
+    // One scale for both axes: the smaller fits the region, the larger fills
+    const float regionWidth = region.width * srcWidth;
+    const float regionHeight = region.height * srcHeight;
+    const float scaleX = dstWidth / regionWidth;
+    const float scaleY = dstHeight / regionHeight;
+    const float scale = (mode == AspectMode::Fit) ? std::min(scaleX, scaleY) : std::max(scaleX, scaleY);
+
+    if (mode == AspectMode::Fit) {
+        // Whole tensor pixels of content, centered; the tensor spans the
+        // region grown so that exactly those pixels sample it
+        layout.contentWidth = std::clamp(static_cast<int>(std::lround(regionWidth * scale)), 1, dstWidth);
+        layout.contentHeight = std::clamp(static_cast<int>(std::lround(regionHeight * scale)), 1, dstHeight);
+        layout.contentX = (dstWidth - layout.contentWidth) / 2;
+        layout.contentY = (dstHeight - layout.contentHeight) / 2;
+
+        layout.region.width = region.width * dstWidth / layout.contentWidth;
+        layout.region.height = region.height * dstHeight / layout.contentHeight;
+        layout.region.x = region.x - region.width * layout.contentX / layout.contentWidth;
+        layout.region.y = region.y - region.height * layout.contentY / layout.contentHeight;
+    } else {
+        // Center crop of the region with the tensor's aspect ratio
+        layout.region.width = region.width * scaleX / scale;
+        layout.region.height = region.height * scaleY / scale;
+        layout.region.x = region.x + (region.width - layout.region.width) * 0.5f;
+        layout.region.y = region.y + (region.height - layout.region.height) * 0.5f;
+    }
+    return layout;
+}
+
+Normalization tensorNormalization(TensorType type, const Normalization& norm) {
+    switch (type) {
+        case TensorType::Float32:
+        case TensorType::Float16:
+            return norm;
+        case TensorType::Int8: {
+            Normalization shifted = Normalization::raw();
+            shifted.bias = {-128.0f, -128.0f, -128.0f, -128.0f};
+            return shifted;
+        }
+        default:
+            return Normalization::raw();
+    }
+}
+
+const char* ImageResampler::simdPath() {
+#if defined(VIVID_ONNX_AVX2)
+    return "AVX2";
+#elif defined(VIVID_ONNX_SSE2)
+    return "SSE2";
+#elif defined(VIVID_ONNX_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+namespace {
+
+// Column/row sample tables for one resample call
+struct Taps {
+    const int32_t* col0;
+    const int32_t* col1;
+    const float* colW;
+    const int32_t* row0;
+    const int32_t* row1;
+    const float* rowW;
+
+    // Content window in output pixels; outside is padding (Fit)
+    int x0, y0, x1, y1;
+};
+
+// -----------------------------------------------------------------------------
+// Output conversion and store (compile-time specialized per type and layout)
+// -----------------------------------------------------------------------------
+
+template <typename T> inline T convertOut(float v);
+
+template <> inline float convertOut<float>(float v) {
+    return v;
+}
+
+template <> inline uint8_t convertOut<uint8_t>(float v) {
+    return static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+}
+
+template <> inline int32_t convertOut<int32_t>(float v) {
+    return static_cast<int32_t>(std::lround(v));
+}
+
+template <> inline int8_t convertOut<int8_t>(float v) {
+    return static_cast<int8_t>(std::lround(std::clamp(v, -128.0f, 127.0f)));
+}
+
+template <> inline int64_t convertOut<int64_t>(float v) {
+    return static_cast<int64_t>(std::llround(v));
+}
+
+// Float16 storage holds half bits
+template <> inline uint16_t convertOut<uint16_t>(float v) {
+    return floatToHalf(v);
+}
+
+// rgba holds normalized values in model channel order
+template <typename T, TensorLayout Layout>
+inline void storePixel(T* dst, const float* rgba, int channels, size_t pixelIdx, size_t plane) {
+    if constexpr (Layout == TensorLayout::NHWC) {
+        T* p = dst + pixelIdx * channels;
+        for (int c = 0; c < channels; c++) p[c] = convertOut<T>(rgba[c]);
+    } else {
+        for (int c = 0; c < channels; c++) dst[c * plane + pixelIdx] = convertOut<T>(rgba[c]);
+    }
+}
+
+// Padding is black, i.e. 0 before normalization (for every channel, like
+// the GPU path)
+template <typename T, TensorLayout Layout>
+inline void storePadding(T* dst, const float* pad, int channels, size_t begin, size_t end, size_t plane) {
+    for (size_t i = begin; i < end; i++) storePixel<T, Layout>(dst, pad, channels, i, plane);
+}
+
+// Pads rows outside the content window and the columns left and right of
+// it; returns false if row y is padding only
+template <typename T, TensorLayout Layout>
+inline bool padRow(T* dst, const float* pad, int channels, const Taps& taps,
+                   int y, int dstWidth, size_t plane) {
+    const size_t rowBase = static_cast<size_t>(y) * dstWidth;
+    if (y < taps.y0 || y >= taps.y1) {
+        storePadding<T, Layout>(dst, pad, channels, rowBase, rowBase + dstWidth, plane);
+        return false;
+    }
+    storePadding<T, Layout>(dst, pad, channels, rowBase, rowBase + taps.x0, plane);
+    storePadding<T, Layout>(dst, pad, channels, rowBase + taps.x1, rowBase + dstWidth, plane);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Generic source (1-4 channels), scalar
+// -----------------------------------------------------------------------------
+
+// Source is BGR(A) (from AVFoundation/Media Foundation), model expects RGB
+inline void fetchPixel(const uint8_t* p, int srcChannels, float* rgba) {
+    rgba[0] = 0.0f; rgba[1] = 0.0f; rgba[2] = 0.0f; rgba[3] = 255.0f;
+    if (srcChannels >= 3) {
+        rgba[0] = p[2];
+        rgba[1] = p[1];
+        rgba[2] = p[0];
+        if (srcChannels >= 4) rgba[3] = p[3];
+    } else {
+        for (int c = 0; c < srcChannels; c++) rgba[c] = p[c];
+    }
+}
+
+template <typename T, TensorLayout Layout>
+void resampleGeneric(const uint8_t* src, int srcChannels, const Taps& taps,
+                     int dstWidth, int dstHeight, int channels,
+                     const Normalization& norm, T* dst) {
+    const size_t plane = static_cast<size_t>(dstWidth) * dstHeight;
+    const float* pad = norm.bias.data();
+    float p00[4], p10[4], p01[4], p11[4], rgba[4];
+
+    for (int y = 0; y < dstHeight; y++) {
+        if (!padRow<T, Layout>(dst, pad, channels, taps, y, dstWidth, plane)) continue;
+        const uint8_t* row0 = src + taps.row0[y];
+        const uint8_t* row1 = src + taps.row1[y];
+        const float fy = taps.rowW[y];
+
+        for (int x = taps.x0; x < taps.x1; x++) {
+            const float fx = taps.colW[x];
+            fetchPixel(row0 + taps.col0[x], srcChannels, p00);
+            fetchPixel(row0 + taps.col1[x], srcChannels, p10);
+            fetchPixel(row1 + taps.col0[x], srcChannels, p01);
+            fetchPixel(row1 + taps.col1[x], srcChannels, p11);
+
+            for (int c = 0; c < 4; c++) {
+                float top = p00[c] + (p10[c] - p00[c]) * fx;
+                float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+                float v = top + (bottom - top) * fy;
+                rgba[c] = v * norm.scale[c] + norm.bias[c];
+            }
+            storePixel<T, Layout>(dst, rgba, channels, static_cast<size_t>(y) * dstWidth + x, plane);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 4-channel BGRA source, SIMD over channels
+// -----------------------------------------------------------------------------
+
+#if defined(VIVID_ONNX_SSE2)
+
+inline __m128 loadBgra(const uint8_t* p) {
+    int32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    __m128i v = _mm_cvtsi32_si128(word);
+    const __m128i zero = _mm_setzero_si128();
+    v = _mm_unpacklo_epi8(v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+// Bilinear sample, BGRA -> RGBA swizzle and scale/bias for one pixel
+inline void sampleBgra(const uint8_t* row0, const uint8_t* row1, int32_t o0, int32_t o1,
+                       float fx, float fy, __m128 scale, __m128 bias, float* rgba) {
+    __m128 p00 = loadBgra(row0 + o0);
+    __m128 p10 = loadBgra(row0 + o1);
+    __m128 p01 = loadBgra(row1 + o0);
+    __m128 p11 = loadBgra(row1 + o1);
+
+    const __m128 wx = _mm_set1_ps(fx);
+    __m128 top = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p10, p00), wx));
+    __m128 bottom = _mm_add_ps(p01, _mm_mul_ps(_mm_sub_ps(p11, p01), wx));
+    __m128 v = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(fy)));
+
+    v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));  // B,G,R,A -> R,G,B,A
+    _mm_storeu_ps(rgba, _mm_add_ps(_mm_mul_ps(v, scale), bias));
+}
+
+#if defined(VIVID_ONNX_AVX2)
+inline __m256 loadBgra2(const uint8_t* a, const uint8_t* b) {
+    int32_t wa, wb;
+    std::memcpy(&wa, a, sizeof(wa));
+    std::memcpy(&wb, b, sizeof(wb));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_set_epi32(0, 0, wb, wa)));
+}
+
+// Two adjacent output pixels per iteration (one per 128-bit lane)
+inline void sampleBgra2(const uint8_t* row0, const uint8_t* row1, const Taps& taps, int x,
+                        float fy, __m256 scale, __m256 bias, float* rgba8) {
+    const int32_t a0 = taps.col0[x], a1 = taps.col1[x];
+    const int32_t b0 = taps.col0[x + 1], b1 = taps.col1[x + 1];
+
+    __m256 p00 = loadBgra2(row0 + a0, row0 + b0);
+    __m256 p10 = loadBgra2(row0 + a1, row0 + b1);
+    __m256 p01 = loadBgra2(row1 + a0, row1 + b0);
+    __m256 p11 = loadBgra2(row1 + a1, row1 + b1);
+
+    const __m256 wx = _mm256_set_m128(_mm_set1_ps(taps.colW[x + 1]), _mm_set1_ps(taps.colW[x]));
+    __m256 top = _mm256_add_ps(p00, _mm256_mul_ps(_mm256_sub_ps(p10, p00), wx));
+    __m256 bottom = _mm256_add_ps(p01, _mm256_mul_ps(_mm256_sub_ps(p11, p01), wx));
+    __m256 v = _mm256_add_ps(top, _mm256_mul_ps(_mm256_sub_ps(bottom, top), _mm256_set1_ps(fy)));
+
+    v = _mm256_permute_ps(v, _MM_SHUFFLE(3, 0, 1, 2));
+    _mm256_storeu_ps(rgba8, _mm256_add_ps(_mm256_mul_ps(v, scale), bias));
+}
+#endif
+
+template <typename T, TensorLayout Layout>
+void resampleBgra(const uint8_t* src, const Taps& taps, int dstWidth, int dstHeight,
+                  int channels, const Normalization& norm, T* dst) {
+    const size_t plane = static_cast<size_t>(dstWidth) * dstHeight;
+    const __m128 scale = _mm_loadu_ps(norm.scale.data());
+    const __m128 bias = _mm_loadu_ps(norm.bias.data());
+#if defined(VIVID_ONNX_AVX2)
+    const __m256 scale2 = _mm256_set_m128(scale, scale);
+    const __m256 bias2 = _mm256_set_m128(bias, bias);
+    alignas(32) float rgba8[8];
+#endif
+    alignas(16) float rgba[4];
+    const float* pad = norm.bias.data();
+
+    for (int y = 0; y < dstHeight; y++) {
+        if (!padRow<T, Layout>(dst, pad, channels, taps, y, dstWidth, plane)) continue;
+        const uint8_t* row0 = src + taps.row0[y];
+        const uint8_t* row1 = src + taps.row1[y];
+        const float fy = taps.rowW[y];
+        const size_t rowBase = static_cast<size_t>(y) * dstWidth;
+        int x = taps.x0;
+
+#if defined(VIVID_ONNX_AVX2)
+        for (; x + 1 < taps.x1; x += 2) {
+            sampleBgra2(row0, row1, taps, x, fy, scale2, bias2, rgba8);
+            storePixel<T, Layout>(dst, rgba8, channels, rowBase + x, plane);
+            storePixel<T, Layout>(dst, rgba8 + 4, channels, rowBase + x + 1, plane);
+        }
+#endif
+        for (; x < taps.x1; x++) {
+            sampleBgra(row0, row1, taps.col0[x], taps.col1[x], taps.colW[x], fy, scale, bias, rgba);
+            storePixel<T, Layout>(dst, rgba, channels, rowBase + x, plane);
+        }
+    }
+}
+
+#elif defined(VIVID_ONNX_NEON)
+
+inline float32x4_t loadBgra(const uint8_t* p) {
+    uint32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    static const uint8_t kSwizzle[8] = {2, 1, 0, 3, 6, 5, 4, 7};  // B,G,R,A -> R,G,B,A
+    uint8x8_t bytes = vtbl1_u8(vreinterpret_u8_u32(vdup_n_u32(word)), vld1_u8(kSwizzle));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+}
+
+template <typename T, TensorLayout Layout>
+void resampleBgra(const uint8_t* src, const Taps& taps, int dstWidth, int dstHeight,
+                  int channels, const Normalization& norm, T* dst) {
+    const size_t plane = static_cast<size_t>(dstWidth) * dstHeight;
+    const float32x4_t scale = vld1q_f32(norm.scale.data());
+    const float32x4_t bias = vld1q_f32(norm.bias.data());
+    float rgba[4];
+    const float* pad = norm.bias.data();
+
+    for (int y = 0; y < dstHeight; y++) {
+        if (!padRow<T, Layout>(dst, pad, channels, taps, y, dstWidth, plane)) continue;
+        const uint8_t* row0 = src + taps.row0[y];
+        const uint8_t* row1 = src + taps.row1[y];
+        const float fy = taps.rowW[y];
+        const size_t rowBase = static_cast<size_t>(y) * dstWidth;
+
+        for (int x = taps.x0; x < taps.x1; x++) {
+            const float fx = taps.colW[x];
+            float32x4_t p00 = loadBgra(row0 + taps.col0[x]);
+            float32x4_t p10 = loadBgra(row0 + taps.col1[x]);
+            float32x4_t p01 = loadBgra(row1 + taps.col0[x]);
+            float32x4_t p11 = loadBgra(row1 + taps.col1[x]);
+
+            float32x4_t top = vmlaq_n_f32(p00, vsubq_f32(p10, p00), fx);
+            float32x4_t bottom = vmlaq_n_f32(p01, vsubq_f32(p11, p01), fx);
+            float32x4_t v = vmlaq_n_f32(top, vsubq_f32(bottom, top), fy);
+
+            vst1q_f32(rgba, vmlaq_f32(bias, v, scale));
+            storePixel<T, Layout>(dst, rgba, channels, rowBase + x, plane);
+        }
+    }
+}
+
+#else
+
+template <typename T, TensorLayout Layout>
+void resampleBgra(const uint8_t* src, const Taps& taps, int dstWidth, int dstHeight,
+                  int channels, const Normalization& norm, T* dst) {
+    resampleGeneric<T, Layout>(src, 4, taps, dstWidth, dstHeight, channels, norm, dst);
+}
+
+#endif
+
+// Select the kernel for a source format once, outside the pixel loop
+template <typename T, TensorLayout Layout>
+void dispatchSource(const uint8_t* src, int srcChannels, const Taps& taps,
+                    int dstWidth, int dstHeight, int channels,
+                    const Normalization& norm, T* dst) {
+    if (srcChannels == 4) {
+        resampleBgra<T, Layout>(src, taps, dstWidth, dstHeight, channels, norm, dst);
+    } else {
+        resampleGeneric<T, Layout>(src, srcChannels, taps, dstWidth, dstHeight, channels, norm, dst);
+    }
+}
+
+template <typename T>
+void dispatchLayout(TensorLayout layout, const uint8_t* src, int srcChannels, const Taps& taps,
+                    int dstWidth, int dstHeight, int channels,
+                    const Normalization& norm, T* dst) {
+    if (layout == TensorLayout::NHWC) {
+        dispatchSource<T, TensorLayout::NHWC>(src, srcChannels, taps, dstWidth, dstHeight, channels, norm, dst);
+    } else {
+        dispatchSource<T, TensorLayout::NCHW>(src, srcChannels, taps, dstWidth, dstHeight, channels, norm, dst);
+    }
+}
+
+} // namespace
+
+void ImageResampler::buildTables(int srcWidth, int srcHeight, int srcChannels,
+                                 int targetWidth, int targetHeight, const SourceRect& region) {
+    if (srcWidth == m_srcWidth && srcHeight == m_srcHeight && srcChannels == m_srcChannels &&
+        targetWidth == m_dstWidth && targetHeight == m_dstHeight && region == m_region) {
+        return;  // Tables still valid
+    }
+
+    // Pixel-center aligned bilinear sampling over [start, start + extent)
+    // of the source (normalized), edges clamped
+    auto build = [](int srcSize, int dstSize, int32_t stride, float start, float extent,
+                    std::vector<int32_t>& off0, std::vector<int32_t>& off1, std::vector<float>& weight) {
+        off0.resize(dstSize);
+        off1.resize(dstSize);
+        weight.resize(dstSize);
+        const float origin = start * srcSize;
+        const float scale = extent * srcSize / dstSize;
+        for (int i = 0; i < dstSize; i++) {
+            float src = origin + (i + 0.5f) * scale - 0.5f;
+            int i0 = static_cast<int>(std::floor(src));
+            float w = src - i0;
+            int i1 = std::clamp(i0 + 1, 0, srcSize - 1);
+            i0 = std::clamp(i0, 0, srcSize - 1);
+            off0[i] = i0 * stride;
+            off1[i] = i1 * stride;
+            weight[i] = w;
+        }
+    };
+
+    build(srcWidth, targetWidth, srcChannels, region.x, region.width,
+          m_colOffset0, m_colOffset1, m_colWeight);
+    build(srcHeight, targetHeight, srcWidth * srcChannels, region.y, region.height,
+          m_rowOffset0, m_rowOffset1, m_rowWeight);
+
+    m_srcWidth = srcWidth;
+    m_srcHeight = srcHeight;
+    m_srcChannels = srcChannels;
+    m_dstWidth = targetWidth;
+    m_dstHeight = targetHeight;
+    m_region = region;
+}
+
+bool ImageResampler::resample(const io::ImageData& pixels, Tensor& tensor,
+                              int targetWidth, int targetHeight,
+                              const Normalization& norm, const SourceRect& region,
+                              AspectMode aspect) {
+    if (pixels.pixels.empty()) return false;
+    return resample(pixels.pixels.data(), pixels.width, pixels.height, pixels.channels,
+                    tensor, targetWidth, targetHeight, norm, region, aspect);
+}
+
+bool ImageResampler::resample(const uint8_t* pixels, int srcWidth, int srcHeight, int srcChannels,
+                              Tensor& tensor, int targetWidth, int targetHeight,
+                              const Normalization& norm, const SourceRect& region,
+                              AspectMode aspect) {
+    if (!pixels || srcWidth <= 0 || srcHeight <= 0 || srcChannels <= 0 || srcChannels > 4 ||
+        targetWidth <= 0 || targetHeight <= 0 || !(region.width > 0.0f) || !(region.height > 0.0f)) {
+        return false;
+    }
+
+    int channels = 3;
+    TensorLayout layout = detectLayout(tensor.shape, &channels);
+    channels = std::clamp(channels, 1, 4);
+
+    const size_t required = static_cast<size_t>(targetWidth) * targetHeight * channels;
+    if (tensor.size() < required) return false;
+
+    // Fit/Fill become a grown/shrunk sample region (plus padding for Fit)
+    m_layout = aspectLayout(aspect, region, srcWidth, srcHeight, targetWidth, targetHeight);
+    buildTables(srcWidth, srcHeight, srcChannels, targetWidth, targetHeight, m_layout.region);
+    const Taps taps = {
+        m_colOffset0.data(), m_colOffset1.data(), m_colWeight.data(),
+        m_rowOffset0.data(), m_rowOffset1.data(), m_rowWeight.data(),
+        m_layout.contentX, m_layout.contentY,
+        m_layout.contentX + m_layout.contentWidth, m_layout.contentY + m_layout.contentHeight
+    };
+
+    // Every type is written directly; integer tensors take raw pixel values
+    if (storageSize(tensor) < required) return false;
+    const Normalization n = tensorNormalization(tensor.type, norm);
+    auto run = [&](auto* dst) {
+        using T = std::remove_pointer_t<decltype(dst)>;
+        dispatchLayout<T>(layout, pixels, srcChannels, taps, targetWidth, targetHeight, channels, n, dst);
+    };
+    switch (tensor.type) {
+        case TensorType::UInt8: run(tensor.as<uint8_t>().data()); break;
+        case TensorType::Int32: run(tensor.as<int32_t>().data()); break;
+        case TensorType::Int8: run(tensor.as<int8_t>().data()); break;
+        case TensorType::Float16: run(tensor.as<uint16_t>().data()); break;
+        case TensorType::Int64: run(tensor.as<int64_t>().data()); break;
+        case TensorType::Float32:
+        default: run(tensor.as<float>().data()); break;
+    }
+    return true;
+}
+
+} // namespace vivid::onnx
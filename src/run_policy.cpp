@@ -0,0 +1,80 @@
+#include <vivid/onnx/run_policy.h>
+#include <cstdlib>
+
+namespace vivid::onnx {
+
+// Rec. 601 luma from an 8-bit pixel in the source's channel order
+static inline uint8_t luma(const uint8_t* px, int channels) {
+    if (channels < 3) return px[0];
+    // BGR(A): 0.114 B + 0.587 G + 0.299 R
+    return static_cast<uint8_t>((29 * px[0] + 150 * px[1] + 77 * px[2]) >> 8);
+}
+
+uint64_t FrameChangeDetector::signature(const io::ImageData& pixels) {
+    const int w = pixels.width;
+    const int h = pixels.height;
+    const int c = pixels.channels;
+    if (w <= 0 || h <= 0 || c <= 0 ||
+        pixels.pixels.size() < static_cast<size_t>(w) * h * c) {
+        return 0;
+    }
+
+    // FNV-1a over an 8x8 grid of whole pixels
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(static_cast<uint64_t>(w) << 32 | static_cast<uint32_t>(h));
+
+    constexpr int kGrid = 8;
+    for (int gy = 0; gy < kGrid; gy++) {
+        const int y = (2 * gy + 1) * h / (2 * kGrid);
+        for (int gx = 0; gx < kGrid; gx++) {
+            const int x = (2 * gx + 1) * w / (2 * kGrid);
+            const uint8_t* px = &pixels.pixels[(static_cast<size_t>(y) * w + x) * c];
+            for (int ch = 0; ch < c; ch++) mix(px[ch]);
+        }
+    }
+    return hash;
+}
+
+float FrameChangeDetector::difference(const io::ImageData& pixels) {
+    const int w = pixels.width;
+    const int h = pixels.height;
+    const int c = pixels.channels;
+    m_hasCurrent = false;
+    if (w <= 0 || h <= 0 || c <= 0 ||
+        pixels.pixels.size() < static_cast<size_t>(w) * h * c) {
+        return 1.0f;
+    }
+
+    // Nearest-sampled luma thumbnail
+    m_current.resize(kThumbWidth * kThumbHeight);
+    for (int ty = 0; ty < kThumbHeight; ty++) {
+        const int y = (2 * ty + 1) * h / (2 * kThumbHeight);
+        const uint8_t* row = &pixels.pixels[static_cast<size_t>(y) * w * c];
+        for (int tx = 0; tx < kThumbWidth; tx++) {
+            const int x = (2 * tx + 1) * w / (2 * kThumbWidth);
+            m_current[ty * kThumbWidth + tx] = luma(row + static_cast<size_t>(x) * c, c);
+        }
+    }
+    m_hasCurrent = true;
+
+    if (!m_hasReference) return 1.0f;
+
+    int sum = 0;
+    for (size_t i = 0; i < m_current.size(); i++) {
+        sum += std::abs(static_cast<int>(m_current[i]) - static_cast<int>(m_reference[i]));
+    }
+    return static_cast<float>(sum) / (255.0f * static_cast<float>(m_current.size()));
+}
+
+void FrameChangeDetector::commit() {
+    if (!m_hasCurrent) return;
+    m_reference.swap(m_current);
+    m_hasReference = true;
+    m_hasCurrent = false;
+}
+
+} // namespace vivid::onnx
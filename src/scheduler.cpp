@@ -0,0 +1,293 @@
+#include <vivid/onnx/scheduler.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace vivid::onnx {
+
+namespace {
+
+// Smoothing of the latency that drives shedding, and the fraction of the
+// budget a model must get back under before lower priorities resume
+constexpr double kLatencyAlpha = 0.2;
+constexpr double kRecoverFraction = 0.8;
+
+// A model with no run for this long (or its budget or target period, if
+// longer) has stopped submitting and no longer sheds anyone; ordinary gaps
+// between render frames stay well under it
+constexpr double kIdleMs = 100.0;
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+InferenceScheduler& InferenceScheduler::instance() {
+    static InferenceScheduler scheduler;
+    return scheduler;
+}
+
+InferenceScheduler::InferenceScheduler(int workers) : m_workerCount(std::max(1, workers)) {
+}
+
+InferenceScheduler::~InferenceScheduler() {
+    stopWorkers();
+}
+
+void InferenceScheduler::workers(int count) {
+    count = std::max(1, count);
+    std::lock_guard<std::mutex> restart(m_restartMutex);
+    bool running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (count == m_workerCount) return;
+        m_workerCount = count;
+        running = !m_threads.empty();
+    }
+    if (running) {
+        stopWorkers();
+        startWorkers();
+    }
+}
+
+int InferenceScheduler::workers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_workerCount;
+}
+
+int InferenceScheduler::registerClient(const std::string& name, const SchedulePolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Client client;
+    client.id = m_nextClientId++;
+    client.name = name;
+    client.policy = policy;
+    m_clients.push_back(std::move(client));
+    return m_clients.back().id;
+}
+
+void InferenceScheduler::updatePolicy(int id, const SchedulePolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Client* client = find(id)) {
+        client->policy = policy;
+        client->nextDueMs = -1.0;
+    }
+}
+
+void InferenceScheduler::unregisterClient(int id) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                 [id](const Job& job) { return job.client == id; }),
+                  m_queue.end());
+    m_jobFinished.wait(lock, [this, id]() {
+        const Client* client = find(id);
+        return !client || !client->running;
+    });
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                   [id](const Client& client) { return client.id == id; }),
+                    m_clients.end());
+}
+
+Admission InferenceScheduler::admit(int id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Client* client = find(id);
+    if (!client) return Admission::Run;
+
+    const double now = nowMs();
+    for (const Client& other : m_clients) {
+        if (other.policy.priority > client->policy.priority && shedding(other, now)) {
+            return Admission::Shed;
+        }
+    }
+    if (client->policy.targetHz > 0.0f && client->nextDueMs >= 0.0 && now < client->nextDueMs) {
+        return Admission::NotDue;
+    }
+    return Admission::Run;
+}
+
+void InferenceScheduler::countShed(int id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Client* client = find(id)) client->stats.shed++;
+}
+
+void InferenceScheduler::submit(int id, std::function<void()> job) {
+    const double now = nowMs();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Client* client = find(id);
+        if (!client) return;
+
+        // Keep the average rate when a frame lands a little late, but don't
+        // let a stall turn into a burst
+        if (client->policy.targetHz > 0.0f) {
+            const double period = 1000.0 / client->policy.targetHz;
+            const bool late = client->nextDueMs < 0.0 || now - client->nextDueMs > period;
+            client->nextDueMs = late ? now + period : client->nextDueMs + period;
+        }
+        client->stats.submitted++;
+
+        Job entry;
+        entry.client = id;
+        entry.run = std::move(job);
+        entry.submitMs = now;
+        entry.deadlineMs = client->policy.latencyBudgetMs > 0.0f
+            ? now + client->policy.latencyBudgetMs
+            : std::numeric_limits<double>::infinity();
+        entry.sequence = m_sequence++;
+        m_queue.push_back(std::move(entry));
+    }
+
+    // Threads start with the first run, so an unused scheduler costs nothing
+    {
+        std::lock_guard<std::mutex> restart(m_restartMutex);
+        bool started = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            started = !m_threads.empty();
+        }
+        if (!started) startWorkers();
+    }
+    m_workAvailable.notify_one();
+}
+
+ScheduleStats InferenceScheduler::stats(int id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Client* client = find(id);
+    if (!client) return {};
+    ScheduleStats s = client->stats;
+    s.overBudget = shedding(*client, nowMs());
+    s.latency = client->latency.timing();
+    return s;
+}
+
+size_t InferenceScheduler::clientCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_clients.size();
+}
+
+InferenceScheduler::Client* InferenceScheduler::find(int id) {
+    for (auto& client : m_clients) {
+        if (client.id == id) return &client;
+    }
+    return nullptr;
+}
+
+const InferenceScheduler::Client* InferenceScheduler::find(int id) const {
+    return const_cast<InferenceScheduler*>(this)->find(id);
+}
+
+double InferenceScheduler::idleWindowMs(const Client& client) {
+    const double period = client.policy.targetHz > 0.0f ? 1000.0 / client.policy.targetHz : 0.0;
+    return std::max({kIdleMs, static_cast<double>(client.policy.latencyBudgetMs), period});
+}
+
+bool InferenceScheduler::shedding(const Client& client, double now) const {
+    if (!client.stats.overBudget) return false;
+    if (client.running || now - client.lastFinishedMs < idleWindowMs(client)) return true;
+    return std::any_of(m_queue.begin(), m_queue.end(),
+                       [&client](const Job& job) { return job.client == client.id; });
+}
+
+int InferenceScheduler::nextJob() const {
+    int best = -1;
+    for (size_t i = 0; i < m_queue.size(); i++) {
+        const Job& job = m_queue[i];
+        const Client* client = find(job.client);
+        if (!client || client->running) continue;   // one run per client at a time
+        if (best < 0) {
+            best = static_cast<int>(i);
+            continue;
+        }
+        const Job& current = m_queue[best];
+        const int priority = client->policy.priority;
+        const int currentPriority = find(current.client)->policy.priority;
+        if (priority != currentPriority) {
+            if (priority > currentPriority) best = static_cast<int>(i);
+        } else if (job.deadlineMs != current.deadlineMs) {
+            if (job.deadlineMs < current.deadlineMs) best = static_cast<int>(i);
+        } else if (job.sequence < current.sequence) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+void InferenceScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        int index = -1;
+        m_workAvailable.wait(lock, [this, &index]() {
+            index = nextJob();
+            return m_stop || index >= 0;
+        });
+        if (m_stop) break;
+
+        Job job = std::move(m_queue[index]);
+        m_queue.erase(m_queue.begin() + index);
+        find(job.client)->running = true;
+
+        lock.unlock();
+        job.run();
+        const double finished = nowMs();
+        lock.lock();
+
+        if (Client* client = find(job.client)) {
+            client->running = false;
+            const double latency = finished - job.submitMs;
+            ScheduleStats& s = client->stats;
+            s.completed++;
+            client->latency.add(latency);
+
+            // Start the average over after an idle spell; the old runs say
+            // nothing about the load now
+            const bool resumed = job.submitMs - client->lastFinishedMs >= idleWindowMs(*client);
+            client->latencyEmaMs = s.completed == 1 || resumed
+                ? latency
+                : client->latencyEmaMs + kLatencyAlpha * (latency - client->latencyEmaMs);
+            client->lastFinishedMs = finished;
+
+            const double budget = client->policy.latencyBudgetMs;
+            if (budget > 0.0) {
+                if (latency > budget) s.deadlineMisses++;
+                if (!s.overBudget && client->latencyEmaMs > budget) {
+                    s.overBudget = true;
+                    std::cout << "[InferenceScheduler] " << client->name << " over its "
+                              << budget << " ms budget, shedding lower priorities" << std::endl;
+                } else if (s.overBudget && client->latencyEmaMs < budget * kRecoverFraction) {
+                    s.overBudget = false;
+                }
+            } else {
+                s.overBudget = false;
+            }
+        }
+
+        // The finished client may have another run waiting
+        m_jobFinished.notify_all();
+        m_workAvailable.notify_all();
+    }
+}
+
+void InferenceScheduler::startWorkers() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = false;
+    for (int i = 0; i < m_workerCount; i++) {
+        m_threads.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+void InferenceScheduler::stopWorkers() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        threads.swap(m_threads);
+    }
+    m_workAvailable.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+} // namespace vivid::onnx
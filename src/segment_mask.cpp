@@ -0,0 +1,224 @@
+#include <vivid/onnx/segment_mask.h>
+#include <vivid/context.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace vivid::onnx {
+
+namespace {
+
+// Input size for models whose height/width are dynamic
+constexpr int64_t kDefaultInputSize = 512;
+
+float smoothstep(float edge0, float edge1, float x) {
+    const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+} // namespace
+
+SegmentMask::SegmentMask() = default;
+
+SegmentMask::~SegmentMask() = default;
+
+SegmentMask& SegmentMask::model(const std::string& path) {
+    ONNXModel::model(path);
+    return *this;
+}
+
+SegmentMask& SegmentMask::channel(int index) {
+    m_channel = std::max(-1, index);
+    return *this;
+}
+
+SegmentMask& SegmentMask::activation(MaskActivation activation) {
+    m_activation = activation;
+    return *this;
+}
+
+SegmentMask& SegmentMask::threshold(float threshold, float softness) {
+    m_filter.threshold = std::clamp(threshold, 0.0f, 1.0f);
+    m_filter.softness = std::max(0.0f, softness);
+    return *this;
+}
+
+SegmentMask& SegmentMask::upsample(bool enabled) {
+    m_upsample = enabled;
+    return *this;
+}
+
+SegmentMask& SegmentMask::bilateral(float spatialSigma, float rangeSigma) {
+    m_filter.spatialSigma = std::max(0.1f, spatialSigma);
+    m_filter.rangeSigma = std::max(0.0f, rangeSigma);
+    m_filter.bilateral = rangeSigma > 0.0f;
+    return *this;
+}
+
+WGPUTextureView SegmentMask::outputView() const {
+    return m_gpuMask ? m_gpuMask->view() : nullptr;
+}
+
+void SegmentMask::process(Context& ctx) {
+    ONNXModel::process(ctx);
+    if (!m_mask.empty()) renderTexture(ctx);
+}
+
+void SegmentMask::cleanup() {
+    m_gpuMask.reset();
+    m_uploadedVersion = 0;
+    ONNXModel::cleanup();
+}
+
+void SegmentMask::prepareInputTensor(Context& ctx, Tensor& tensor) {
+    if (inputCount() == 0) return;
+
+    std::vector<int64_t> shape = inputShape(0);
+    if (shape.size() < 4) return;
+    const bool nchw = detectLayout(shape) == TensorLayout::NCHW;
+    int64_t& channels = nchw ? shape[1] : shape[3];
+    int64_t& height = nchw ? shape[2] : shape[1];
+    int64_t& width = nchw ? shape[3] : shape[2];
+    if (shape[0] <= 0) shape[0] = 1;
+    if (channels <= 0) channels = 3;
+    if (height <= 0) height = kDefaultInputSize;
+    if (width <= 0) width = kDefaultInputSize;
+
+    if (tensor.shape != shape) {
+        tensor.shape = shape;
+        resizeStorage(tensor);
+    }
+
+    if (!textureToTensor(ctx, tensor, static_cast<int>(width), static_cast<int>(height))) {
+        const Normalization n = tensorNormalization(tensor.type, inputNormalization());
+        fillTensor(tensor, 127.5f * n.scale[0] + n.bias[0]);
+    }
+}
+
+void SegmentMask::processOutputTensor(const Tensor& tensor) {
+    if (currentSource() != 0) return;
+    if (decodeMask(tensor)) {
+        m_maskRegion = inputRegion();
+        m_maskVersion++;
+    }
+}
+
+bool SegmentMask::decodeMask(const Tensor& tensor) {
+    const auto& shape = tensor.shape;
+    int64_t channels = 1;
+    int64_t height = 0;
+    int64_t width = 0;
+    bool planar = true;   // channel planes (NCHW) or interleaved (NHWC)
+
+    if (shape.size() == 4) {
+        // Channels is the smaller of dims 1 and 3 (masks are never tiny)
+        planar = shape[1] <= shape[3];
+        channels = planar ? shape[1] : shape[3];
+        height = planar ? shape[2] : shape[1];
+        width = planar ? shape[3] : shape[2];
+    } else if (shape.size() == 3) {
+        height = shape[1];
+        width = shape[2];
+    } else if (shape.size() == 2) {
+        height = shape[0];
+        width = shape[1];
+    }
+    if (channels <= 0 || height <= 0 || width <= 0) return false;
+
+    const size_t plane = static_cast<size_t>(height) * static_cast<size_t>(width);
+    if (tensor.size() < plane * static_cast<size_t>(channels)) return false;
+
+    const int64_t foreground = m_channel < 0 ? channels - 1 : std::min<int64_t>(m_channel, channels - 1);
+    auto at = [&](size_t pixel, int64_t c) {
+        return planar ? tensor[static_cast<size_t>(c) * plane + pixel]
+                      : tensor[pixel * static_cast<size_t>(channels) + static_cast<size_t>(c)];
+    };
+
+    m_mask.resize(plane);
+    for (size_t i = 0; i < plane; i++) {
+        float value = at(i, foreground);
+        if (m_activation == MaskActivation::Sigmoid) {
+            value = 1.0f / (1.0f + std::exp(-value));
+        } else if (m_activation == MaskActivation::Softmax) {
+            float maxLogit = value;
+            for (int64_t c = 0; c < channels; c++) maxLogit = std::max(maxLogit, at(i, c));
+            float sum = 0.0f;
+            for (int64_t c = 0; c < channels; c++) sum += std::exp(at(i, c) - maxLogit);
+            value = std::exp(value - maxLogit) / sum;
+        }
+        m_mask[i] = std::clamp(value, 0.0f, 1.0f);
+    }
+    m_maskWidth = static_cast<int>(width);
+    m_maskHeight = static_cast<int>(height);
+    return true;
+}
+
+float SegmentMask::shapeMask(float value) const {
+    if (m_filter.threshold <= 0.0f) return value;
+    const float edge = std::max(m_filter.softness, 1e-4f) * 0.5f;
+    return smoothstep(m_filter.threshold - edge, m_filter.threshold + edge, value);
+}
+
+float SegmentMask::maskAt(float x, float y) const {
+    if (m_mask.empty() || !(m_maskRegion.width > 0.0f) || !(m_maskRegion.height > 0.0f)) return 0.0f;
+
+    // Source-normalized to mask pixel coordinates (pixel centers at +0.5)
+    const float px = (x - m_maskRegion.x) / m_maskRegion.width * m_maskWidth;
+    const float py = (y - m_maskRegion.y) / m_maskRegion.height * m_maskHeight;
+    if (!(px >= 0.0f && py >= 0.0f && px <= m_maskWidth && py <= m_maskHeight)) return 0.0f;
+
+    const float fx = std::max(px - 0.5f, 0.0f);
+    const float fy = std::max(py - 0.5f, 0.0f);
+    const int x0 = std::min(static_cast<int>(fx), m_maskWidth - 1);
+    const int y0 = std::min(static_cast<int>(fy), m_maskHeight - 1);
+    const int x1 = std::min(x0 + 1, m_maskWidth - 1);
+    const int y1 = std::min(y0 + 1, m_maskHeight - 1);
+    const float wx = std::min(fx - x0, 1.0f);
+    const float wy = std::min(fy - y0, 1.0f);
+
+    auto texel = [this](int tx, int ty) { return m_mask[static_cast<size_t>(ty) * m_maskWidth + tx]; };
+    const float top = texel(x0, y0) + (texel(x1, y0) - texel(x0, y0)) * wx;
+    const float bottom = texel(x0, y1) + (texel(x1, y1) - texel(x0, y1)) * wx;
+    return shapeMask(top + (bottom - top) * wy);
+}
+
+float SegmentMask::coverage() const {
+    if (m_mask.empty()) return 0.0f;
+    double sum = 0.0;
+    for (float value : m_mask) sum += shapeMask(value);
+    return static_cast<float>(sum / m_mask.size());
+}
+
+void SegmentMask::renderTexture(Context& ctx) {
+    if (!ctx.device() || !ctx.queue()) return;
+    if (!m_gpuMask) m_gpuMask = std::make_unique<GpuMaskUpsampler>();
+    if (m_gpuMask->failed()) return;
+
+    // Only new results cross the bus, and only at model resolution
+    if (m_maskVersion != m_uploadedVersion) {
+        if (!m_gpuMask->upload(ctx.device(), ctx.queue(), m_mask.data(), m_maskWidth, m_maskHeight)) {
+            if (m_gpuMask->failed()) {
+                std::cerr << "[SegmentMask] GPU mask unavailable, only mask() is updated" << std::endl;
+            }
+            return;
+        }
+        m_uploadedVersion = m_maskVersion;
+    }
+
+    int width = m_maskWidth;
+    int height = m_maskHeight;
+    WGPUTextureView guide = nullptr;
+    SourceRect region = m_maskRegion;
+    if (m_upsample && lastInputWidth() > 0 && lastInputHeight() > 0) {
+        width = lastInputWidth();
+        height = lastInputHeight();
+        guide = sourceCount() > 0 ? inputOperators()[0]->outputView() : nullptr;
+    } else {
+        // Model resolution: the texture is the mask itself
+        region = SourceRect{};
+    }
+
+    m_gpuMask->render(ctx.device(), ctx.queue(), width, height, region, guide, m_filter);
+}
+
+} // namespace vivid::onnx
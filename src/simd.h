@@ -0,0 +1,20 @@
+// Internal: SIMD instruction sets the kernels in src/ may use
+//
+// VIVID_ONNX_SSE2 on x86-64 (and 32-bit x86 built with SSE2), VIVID_ONNX_NEON
+// on AArch64 only (the kernels use A64 intrinsics such as vdivq_f32; 32-bit
+// ARM takes the scalar paths). VIVID_ONNX_AVX2 additionally when the file is
+// compiled with AVX2 enabled.
+
+#pragma once
+
+#if defined(__AVX2__)
+#define VIVID_ONNX_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIVID_ONNX_SSE2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VIVID_ONNX_NEON 1
+#include <arm_neon.h>
+#endif
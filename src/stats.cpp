@@ -0,0 +1,52 @@
+#include <vivid/onnx/stats.h>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::onnx {
+
+RollingStats::RollingStats(size_t window) : m_samples(std::max<size_t>(window, 1), 0.0) {
+}
+
+void RollingStats::add(double ms) {
+    m_samples[m_next] = ms;
+    m_next = (m_next + 1) % m_samples.size();
+    m_size = std::min(m_size + 1, m_samples.size());
+    m_total++;
+    m_last = ms;
+}
+
+void RollingStats::reset() {
+    m_next = 0;
+    m_size = 0;
+    m_total = 0;
+    m_last = 0.0;
+}
+
+double RollingStats::average() const {
+    if (m_size == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < m_size; i++) sum += m_samples[i];
+    return sum / static_cast<double>(m_size);
+}
+
+double RollingStats::percentile(double p) const {
+    if (m_size == 0) return 0.0;
+    m_sorted.assign(m_samples.begin(), m_samples.begin() + m_size);
+
+    double rank = std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(m_size));
+    size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    std::nth_element(m_sorted.begin(), m_sorted.begin() + index, m_sorted.end());
+    return m_sorted[index];
+}
+
+StageTiming RollingStats::timing() const {
+    StageTiming t;
+    t.lastMs = m_last;
+    t.avgMs = average();
+    t.p95Ms = percentile(95.0);
+    t.p99Ms = percentile(99.0);
+    t.samples = m_total;
+    return t;
+}
+
+} // namespace vivid::onnx
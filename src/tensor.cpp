@@ -0,0 +1,367 @@
+#include <vivid/onnx/tensor.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+
+namespace vivid::onnx {
+
+namespace {
+
+// Calls fn with a typed view of the storage matching tensor.type
+template <typename TensorRef, typename Fn>
+decltype(auto) visitStorage(TensorRef& tensor, Fn&& fn) {
+    switch (tensor.type) {
+        case TensorType::UInt8: return fn(tensor.template as<uint8_t>());
+        case TensorType::Int32: return fn(tensor.template as<int32_t>());
+        case TensorType::Int8: return fn(tensor.template as<int8_t>());
+        case TensorType::Float16: return fn(tensor.template as<uint16_t>());
+        case TensorType::Int64: return fn(tensor.template as<int64_t>());
+        case TensorType::Float32:
+        default: return fn(tensor.template as<float>());
+    }
+}
+
+template <typename T>
+inline T fromFloat(float v) {
+    if constexpr (std::is_same_v<T, float>) {
+        return v;
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
+        return floatToHalf(v);
+    } else if constexpr (sizeof(T) == 8) {
+        // float(INT64_MAX) rounds up out of range
+        return static_cast<T>(std::nearbyint(std::clamp(v, -9.2e18f, 9.2e18f)));
+    } else {
+        const float lo = static_cast<float>(std::numeric_limits<T>::lowest());
+        const float hi = static_cast<float>(std::numeric_limits<T>::max());
+        return static_cast<T>(std::nearbyint(std::clamp(v, lo, hi)));
+    }
+}
+
+template <typename T>
+inline float toFloat(T v) {
+    if constexpr (std::is_same_v<T, uint16_t>) {
+        return halfToFloat(v);
+    } else {
+        return static_cast<float>(v);
+    }
+}
+
+// Sizes are kept in whole alignment units
+inline size_t roundUp(size_t bytes) {
+    return (bytes + TensorPool::kAlignment - 1) / TensorPool::kAlignment * TensorPool::kAlignment;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// TensorPool
+// -----------------------------------------------------------------------------
+
+TensorPool::~TensorPool() {
+    trim();
+}
+
+void* TensorPool::allocateAligned(size_t bytes) {
+    return ::operator new(roundUp(std::max<size_t>(bytes, 1)), std::align_val_t(kAlignment));
+}
+
+void TensorPool::freeAligned(void* block) {
+    ::operator delete(block, std::align_val_t(kAlignment));
+}
+
+void* TensorPool::allocate(size_t bytes, size_t& capacity) {
+    bytes = roundUp(std::max<size_t>(bytes, 1));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_free.lower_bound(bytes);
+        if (it != m_free.end() && it->first <= bytes * 2) {
+            void* block = it->second;
+            capacity = it->first;
+            m_cachedBytes -= it->first;
+            m_free.erase(it);
+            return block;
+        }
+    }
+    capacity = bytes;
+    return allocateAligned(bytes);
+}
+
+void TensorPool::release(void* block, size_t capacity) {
+    if (!block) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.emplace(capacity, block);
+    m_cachedBytes += capacity;
+}
+
+void TensorPool::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [capacity, block] : m_free) freeAligned(block);
+    m_free.clear();
+    m_cachedBytes = 0;
+}
+
+size_t TensorPool::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cachedBytes;
+}
+
+// -----------------------------------------------------------------------------
+// TensorBuffer
+// -----------------------------------------------------------------------------
+
+TensorBuffer::~TensorBuffer() {
+    release();
+}
+
+TensorBuffer::TensorBuffer(const TensorBuffer& other) : m_pool(other.m_pool) {
+    resize(other.m_size);
+    if (m_size) std::memcpy(m_data, other.m_data, m_size);
+}
+
+// Assignment reuses this buffer's storage and keeps its pool
+TensorBuffer& TensorBuffer::operator=(const TensorBuffer& other) {
+    if (this == &other) return *this;
+    if (m_external) release();
+    m_size = std::min(m_size, other.m_size);
+    resize(other.m_size);
+    if (m_size) std::memcpy(m_data, other.m_data, m_size);
+    return *this;
+}
+
+TensorBuffer::TensorBuffer(TensorBuffer&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_capacity(other.m_capacity),
+      m_external(other.m_external), m_pool(std::move(other.m_pool)) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+    other.m_external = false;
+}
+
+TensorBuffer& TensorBuffer::operator=(TensorBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_capacity = other.m_capacity;
+    m_external = other.m_external;
+    m_pool = std::move(other.m_pool);
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+    other.m_external = false;
+    return *this;
+}
+
+void* TensorBuffer::allocate(size_t bytes, size_t& capacity) {
+    if (m_pool) return m_pool->allocate(bytes, capacity);
+    capacity = roundUp(std::max<size_t>(bytes, 1));
+    return TensorPool::allocateAligned(capacity);
+}
+
+void TensorBuffer::release() {
+    if (m_data && !m_external) {
+        if (m_pool) m_pool->release(m_data, m_capacity);
+        else TensorPool::freeAligned(m_data);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+    m_external = false;
+}
+
+void TensorBuffer::resize(size_t bytes) {
+    if (bytes <= m_capacity) {
+        if (bytes > m_size) std::memset(static_cast<uint8_t*>(m_data) + m_size, 0, bytes - m_size);
+        m_size = bytes;
+        return;
+    }
+
+    size_t capacity = 0;
+    void* block = allocate(bytes, capacity);
+    if (m_size) std::memcpy(block, m_data, m_size);
+    std::memset(static_cast<uint8_t*>(block) + m_size, 0, bytes - m_size);
+    release();
+    m_data = block;
+    m_size = bytes;
+    m_capacity = capacity;
+}
+
+void TensorBuffer::wrap(void* data, size_t bytes) {
+    release();
+    m_data = data;
+    m_size = bytes;
+    m_capacity = bytes;
+    m_external = true;
+}
+
+void TensorBuffer::reset() {
+    release();
+}
+
+// -----------------------------------------------------------------------------
+// Tensor
+// -----------------------------------------------------------------------------
+
+const char* tensorTypeName(TensorType type) {
+    switch (type) {
+        case TensorType::Float32: return "float32";
+        case TensorType::UInt8: return "uint8";
+        case TensorType::Int32: return "int32";
+        case TensorType::Int8: return "int8";
+        case TensorType::Float16: return "float16";
+        case TensorType::Int64: return "int64";
+    }
+    return "unknown";
+}
+
+size_t elementSize(TensorType type) {
+    switch (type) {
+        case TensorType::UInt8:
+        case TensorType::Int8: return 1;
+        case TensorType::Float16: return 2;
+        case TensorType::Int64: return 8;
+        case TensorType::Float32:
+        case TensorType::Int32:
+        default: return 4;
+    }
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+
+    uint16_t half;
+    if (x >= 0x47800000u) {
+        // >= 65536, inf or NaN
+        half = static_cast<uint16_t>(x > 0x7f800000u ? 0x7e00u : 0x7c00u);
+    } else if (x < 0x38800000u) {
+        // Half subnormal or zero: let the FPU round by adding 0.5
+        float f;
+        std::memcpy(&f, &x, sizeof(f));
+        f += 0.5f;
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        half = static_cast<uint16_t>(bits - 0x3f000000u);
+    } else {
+        // Normal: rebias the exponent and round the mantissa to nearest even
+        const uint32_t odd = (x >> 13) & 1u;
+        x += 0xc8000fffu + odd;
+        half = static_cast<uint16_t>(x >> 13);
+    }
+    return static_cast<uint16_t>(half | sign);
+}
+
+float halfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1fu;
+    const uint32_t mantissa = half & 0x3ffu;
+
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else if (exponent == 0) {
+        // Zero or subnormal: mantissa * 2^-24
+        float f = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+        std::memcpy(&bits, &f, sizeof(bits));
+        bits |= sign;
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+size_t Tensor::size() const {
+    if (shape.empty()) return 0;
+    return std::accumulate(shape.begin(), shape.end(), 1LL, std::multiplies<int64_t>());
+}
+
+void Tensor::reshape(const std::vector<int64_t>& newShape) {
+    size_t newSize = std::accumulate(newShape.begin(), newShape.end(), 1LL, std::multiplies<int64_t>());
+    if (newSize != size()) {
+        throw std::runtime_error("Tensor reshape: size mismatch");
+    }
+    shape = newShape;
+}
+
+void resizeStorage(Tensor& tensor) {
+    tensor.buffer.resize(tensor.size() * elementSize(tensor.type));
+}
+
+void* storageData(Tensor& tensor) {
+    return tensor.buffer.data();
+}
+
+const void* storageData(const Tensor& tensor) {
+    return tensor.buffer.data();
+}
+
+size_t storageSize(const Tensor& tensor) {
+    return tensor.buffer.size() / elementSize(tensor.type);
+}
+
+void assignFromFloat(Tensor& tensor, const float* values, size_t count) {
+    visitStorage(tensor, [values, count](auto storage) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(storage.data())>>;
+        const size_t n = std::min(count, storage.size());
+        if constexpr (std::is_same_v<T, float>) {
+            std::copy(values, values + n, storage.begin());
+        } else {
+            for (size_t i = 0; i < n; i++) storage[i] = fromFloat<T>(values[i]);
+        }
+    });
+}
+
+void fillTensor(Tensor& tensor, float value) {
+    visitStorage(tensor, [value](auto storage) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(storage.data())>>;
+        std::fill(storage.begin(), storage.end(), fromFloat<T>(value));
+    });
+}
+
+void convertToFloat(const Tensor& source, Tensor& dst) {
+    dst.shape = source.shape;
+    dst.type = TensorType::Float32;
+    dst.buffer.resize(storageSize(source) * sizeof(float));
+    float* out = static_cast<float*>(dst.buffer.data());
+    visitStorage(source, [out](auto storage) {
+        for (size_t i = 0; i < storage.size(); i++) out[i] = toFloat(storage[i]);
+    });
+}
+
+void packBatchItem(const Tensor& item, Tensor& batch, size_t index) {
+    if (item.type != batch.type) return;
+    const size_t bytes = item.buffer.size();
+    const size_t offset = index * bytes;
+    if (bytes && offset + bytes <= batch.buffer.size()) {
+        std::memcpy(static_cast<uint8_t*>(batch.buffer.data()) + offset, item.buffer.data(), bytes);
+    }
+}
+
+void unpackBatchItem(const Tensor& batch, int64_t batchSize, size_t index, Tensor& item) {
+    item.shape = batch.shape;
+    item.type = batch.type;
+    if (batch.shape.empty() || batch.shape[0] != batchSize || batchSize <= 0) {
+        item.buffer.resize(batch.buffer.size());
+        if (batch.buffer.size()) std::memcpy(item.buffer.data(), batch.buffer.data(), batch.buffer.size());
+        return;
+    }
+    const size_t itemBytes = batch.buffer.size() / static_cast<size_t>(batchSize);
+    item.shape[0] = 1;
+    item.buffer.resize(itemBytes);
+    if (itemBytes) {
+        std::memcpy(item.buffer.data(),
+                    static_cast<const uint8_t*>(batch.buffer.data()) + index * itemBytes, itemBytes);
+    }
+}
+
+} // namespace vivid::onnx
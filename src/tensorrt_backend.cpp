@@ -0,0 +1,485 @@
+#include <vivid/onnx/tensorrt_backend.h>
+#include <vivid/onnx/model_cache.h>
+#include <NvInfer.h>
+#include <NvOnnxParser.h>
+#include <cuda_runtime_api.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+namespace vivid::onnx {
+
+namespace {
+
+// Optimization profile for dynamic dimensions
+constexpr int64_t kMaxBatch = 8;
+constexpr int64_t kMinSize = 1;   // ONNXModel binds unknown dims as 1 until resized
+constexpr int64_t kOptSize = 512;
+constexpr int64_t kMaxSize = 1024;
+
+class TrtLogger : public nvinfer1::ILogger {
+public:
+    void log(Severity severity, const char* msg) noexcept override {
+        if (severity <= Severity::kWARNING) {
+            std::cerr << "[TensorRTBackend] " << msg << std::endl;
+        }
+    }
+};
+
+TrtLogger& trtLogger() {
+    static TrtLogger logger;
+    return logger;
+}
+
+bool toTensorType(nvinfer1::DataType type, TensorType& out) {
+    switch (type) {
+        case nvinfer1::DataType::kFLOAT: out = TensorType::Float32; return true;
+        case nvinfer1::DataType::kHALF:  out = TensorType::Float16; return true;
+        case nvinfer1::DataType::kUINT8: out = TensorType::UInt8;   return true;
+        case nvinfer1::DataType::kINT8:  out = TensorType::Int8;    return true;
+        case nvinfer1::DataType::kINT32: out = TensorType::Int32;   return true;
+        case nvinfer1::DataType::kINT64: out = TensorType::Int64;   return true;
+        default:                         return false;
+    }
+}
+
+nvinfer1::Dims toDims(const std::vector<int64_t>& shape) {
+    nvinfer1::Dims dims{};
+    dims.nbDims = static_cast<int32_t>(std::min<size_t>(shape.size(), nvinfer1::Dims::MAX_DIMS));
+    for (int32_t i = 0; i < dims.nbDims; i++) dims.d[i] = shape[i];
+    return dims;
+}
+
+std::vector<int64_t> toShape(const nvinfer1::Dims& dims) {
+    if (dims.nbDims < 0) return {};
+    return std::vector<int64_t>(dims.d, dims.d + dims.nbDims);
+}
+
+bool isEnginePath(const std::string& path) {
+    const std::string ext = fs::path(path).extension().string();
+    return ext == ".engine" || ext == ".plan" || ext == ".trt";
+}
+
+bool cudaCheck(cudaError_t result, const char* what) {
+    if (result == cudaSuccess) return true;
+    std::cerr << "[TensorRTBackend] " << what << ": " << cudaGetErrorString(result) << std::endl;
+    return false;
+}
+
+} // namespace
+
+struct TensorRTBackend::TrtObjects {
+    struct DeviceBuffer {
+        void* ptr = nullptr;
+        size_t bytes = 0;
+    };
+
+    // Execution captured for one set of input shapes
+    struct Graph {
+        std::vector<std::vector<int64_t>> inputShapes;
+        cudaGraphExec_t exec = nullptr;
+    };
+
+    std::unique_ptr<nvinfer1::IRuntime> runtime;
+    std::unique_ptr<nvinfer1::ICudaEngine> engine;
+    std::unique_ptr<nvinfer1::IExecutionContext> context;
+    cudaStream_t stream = nullptr;
+
+    std::vector<DeviceBuffer> inputBuffers;
+    std::vector<DeviceBuffer> outputBuffers;
+    std::vector<std::vector<int64_t>> inputShapes;    // set on the context
+    std::vector<std::vector<int64_t>> outputShapes;   // for inputShapes
+    std::vector<Tensor> nativeOutputs;                // host staging for non-float outputs
+
+    std::vector<Graph> graphs;
+    bool warm = false;   // plain run done since the last shape or address change
+
+    std::mutex runMutex;
+
+    void destroyGraphs() {
+        for (auto& graph : graphs) {
+            if (graph.exec) cudaGraphExecDestroy(graph.exec);
+        }
+        graphs.clear();
+        warm = false;
+    }
+
+    // Grow a device buffer; sets reallocated if its address changed
+    bool reserve(DeviceBuffer& buffer, size_t bytes, bool& reallocated) {
+        bytes = std::max<size_t>(bytes, 4);
+        if (buffer.ptr && buffer.bytes >= bytes) return true;
+        if (buffer.ptr) cudaFree(buffer.ptr);
+        buffer = DeviceBuffer{};
+        if (!cudaCheck(cudaMalloc(&buffer.ptr, bytes), "Device allocation failed")) {
+            buffer.ptr = nullptr;
+            return false;
+        }
+        buffer.bytes = bytes;
+        reallocated = true;
+        return true;
+    }
+
+    void freeBuffers() {
+        for (auto* buffers : {&inputBuffers, &outputBuffers}) {
+            for (auto& buffer : *buffers) {
+                if (buffer.ptr) cudaFree(buffer.ptr);
+            }
+            buffers->clear();
+        }
+    }
+};
+
+TensorRTBackend::TensorRTBackend() : m_trt(std::make_unique<TrtObjects>()) {
+}
+
+TensorRTBackend::~TensorRTBackend() {
+    unload();
+}
+
+TensorRTBackend& TensorRTBackend::fp16(bool enabled) {
+    m_fp16 = enabled;
+    return *this;
+}
+
+TensorRTBackend& TensorRTBackend::cudaGraphs(bool enabled) {
+    m_cudaGraphs = enabled;
+    return *this;
+}
+
+bool TensorRTBackend::isLoaded() const {
+    return m_trt->context != nullptr;
+}
+
+bool TensorRTBackend::load(const BackendConfig& config) {
+    unload();
+    m_tensorPool = config.tensorPool;
+
+    int deviceCount = 0;
+    if (cudaGetDeviceCount(&deviceCount) != cudaSuccess || deviceCount == 0) {
+        std::cerr << "[TensorRTBackend] No CUDA device" << std::endl;
+        return false;
+    }
+
+    m_trt->runtime.reset(nvinfer1::createInferRuntime(trtLogger()));
+    if (!m_trt->runtime || !loadEngine(config)) {
+        unload();
+        return false;
+    }
+
+    m_trt->context.reset(m_trt->engine->createExecutionContext());
+    if (!m_trt->context || !cudaCheck(cudaStreamCreate(&m_trt->stream), "Stream creation failed")) {
+        std::cerr << "[TensorRTBackend] Failed to create execution context" << std::endl;
+        unload();
+        return false;
+    }
+
+    readModelInfo();
+    return true;
+}
+
+bool TensorRTBackend::loadEngine(const BackendConfig& config) {
+    // Prebuilt engines
+    if (isEnginePath(config.modelPath)) {
+        std::shared_ptr<ModelBuffer> bytes = config.modelData ? config.modelData : ModelBuffer::map(config.modelPath);
+        if (!bytes) {
+            std::cerr << "[TensorRTBackend] Failed to read engine: " << config.modelPath << std::endl;
+            return false;
+        }
+        m_trt->engine.reset(m_trt->runtime->deserializeCudaEngine(bytes->data(), bytes->size()));
+        if (!m_trt->engine) {
+            std::cerr << "[TensorRTBackend] Engine doesn't match this TensorRT/GPU: " << config.modelPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Engines built from files are cached per GPU architecture and profile
+    std::string cachePath;
+    if (config.modelCache && !config.modelData) {
+        fs::path dir = modelCacheDirectory(config.modelPath);
+        uint64_t hash = hashModelFile(config.modelPath);
+        int device = 0;
+        cudaDeviceProp props{};
+        if (!dir.empty() && hash != 0 && cudaGetDevice(&device) == cudaSuccess &&
+            cudaGetDeviceProperties(&props, device) == cudaSuccess) {
+            char name[128];
+            std::snprintf(name, sizeof(name), "-%016llx-trt%d-sm%d%d-b%lld-d%lld-%lld-%lld%s.engine",
+                          static_cast<unsigned long long>(hash), getInferLibVersion(),
+                          props.major, props.minor, static_cast<long long>(kMaxBatch),
+                          static_cast<long long>(kMinSize), static_cast<long long>(kOptSize),
+                          static_cast<long long>(kMaxSize), m_fp16 ? "-fp16" : "");
+            cachePath = (dir / (fs::path(config.modelPath).stem().string() + name)).string();
+        }
+    }
+
+    std::error_code ec;
+    if (!cachePath.empty() && fs::exists(cachePath, ec)) {
+        if (auto bytes = ModelBuffer::map(cachePath)) {
+            m_trt->engine.reset(m_trt->runtime->deserializeCudaEngine(bytes->data(), bytes->size()));
+        }
+        if (m_trt->engine) {
+            m_loadedFromCache = true;
+            std::cout << "[TensorRTBackend] Engine loaded from cache: " << cachePath << std::endl;
+            return true;
+        }
+        // Stale or truncated entry: rebuild over it
+        std::cerr << "[TensorRTBackend] Cached engine unusable, rebuilding" << std::endl;
+    }
+
+    return buildEngine(config, cachePath);
+}
+
+bool TensorRTBackend::buildEngine(const BackendConfig& config, const std::string& cachePath) {
+    std::shared_ptr<ModelBuffer> bytes = config.modelData ? config.modelData : ModelBuffer::map(config.modelPath);
+    if (!bytes) {
+        std::cerr << "[TensorRTBackend] Failed to read model: " << config.modelPath << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<nvinfer1::IBuilder> builder(nvinfer1::createInferBuilder(trtLogger()));
+    if (!builder) return false;
+    std::unique_ptr<nvinfer1::INetworkDefinition> network(builder->createNetworkV2(0));
+    std::unique_ptr<nvonnxparser::IParser> parser(nvonnxparser::createParser(*network, trtLogger()));
+    if (!network || !parser) return false;
+
+    if (!parser->parse(bytes->data(), bytes->size())) {
+        for (int32_t i = 0; i < parser->getNbErrors(); i++) {
+            std::cerr << "[TensorRTBackend] " << parser->getError(i)->desc() << std::endl;
+        }
+        std::cerr << "[TensorRTBackend] Failed to parse: " << config.modelPath << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<nvinfer1::IBuilderConfig> buildConfig(builder->createBuilderConfig());
+    if (!buildConfig) return false;
+    const bool fp16 = m_fp16 && builder->platformHasFastFp16();
+    if (fp16) buildConfig->setFlag(nvinfer1::BuilderFlag::kFP16);
+
+    // Dynamic batch and resolution need a profile (owned by the builder)
+    nvinfer1::IOptimizationProfile* profile = builder->createOptimizationProfile();
+    bool dynamic = false;
+    for (int32_t i = 0; i < network->getNbInputs(); i++) {
+        nvinfer1::ITensor* input = network->getInput(i);
+        const nvinfer1::Dims dims = input->getDimensions();
+        nvinfer1::Dims minDims = dims;
+        nvinfer1::Dims optDims = dims;
+        nvinfer1::Dims maxDims = dims;
+        for (int32_t d = 0; d < dims.nbDims; d++) {
+            if (dims.d[d] >= 0) continue;
+            dynamic = true;
+            minDims.d[d] = d == 0 ? 1 : kMinSize;
+            optDims.d[d] = d == 0 ? 1 : kOptSize;
+            maxDims.d[d] = d == 0 ? kMaxBatch : kMaxSize;
+        }
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, minDims);
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, optDims);
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, maxDims);
+    }
+    if (dynamic) buildConfig->addOptimizationProfile(profile);
+
+    std::cout << "[TensorRTBackend] Building " << (fp16 ? "FP16" : "FP32") << " engine for "
+              << config.modelPath << " (once per GPU, can take minutes)" << std::endl;
+    std::unique_ptr<nvinfer1::IHostMemory> plan(builder->buildSerializedNetwork(*network, *buildConfig));
+    if (!plan) {
+        std::cerr << "[TensorRTBackend] Engine build failed: " << config.modelPath << std::endl;
+        return false;
+    }
+
+    m_trt->engine.reset(m_trt->runtime->deserializeCudaEngine(plan->data(), plan->size()));
+    if (!m_trt->engine) return false;
+
+    // Written next to the model, renamed once complete
+    if (!cachePath.empty()) {
+        const std::string writePath = cachePath + ".tmp";
+        std::ofstream file(writePath, std::ios::binary);
+        file.write(static_cast<const char*>(plan->data()), static_cast<std::streamsize>(plan->size()));
+        file.close();
+        std::error_code ec;
+        if (file) fs::rename(writePath, cachePath, ec);
+        if (!file || ec) {
+            fs::remove(writePath, ec);
+            std::cerr << "[TensorRTBackend] Failed to cache engine: " << cachePath << std::endl;
+        } else {
+            std::cout << "[TensorRTBackend] Engine cached: " << cachePath << std::endl;
+        }
+    }
+    return true;
+}
+
+void TensorRTBackend::readModelInfo() {
+    const nvinfer1::ICudaEngine& engine = *m_trt->engine;
+    for (int32_t i = 0; i < engine.getNbIOTensors(); i++) {
+        const char* tensorName = engine.getIOTensorName(i);
+        TensorInfo info;
+        info.name = tensorName;
+        info.shape = toShape(engine.getTensorShape(tensorName));
+        info.supported = toTensorType(engine.getTensorDataType(tensorName), info.type);
+
+        if (engine.getTensorIOMode(tensorName) == nvinfer1::TensorIOMode::kINPUT) {
+            m_inputs.push_back(std::move(info));
+        } else {
+            m_outputs.push_back(std::move(info));
+        }
+    }
+
+    m_trt->inputBuffers.resize(m_inputs.size());
+    m_trt->outputBuffers.resize(m_outputs.size());
+    m_trt->inputShapes.resize(m_inputs.size());
+    m_trt->outputShapes.resize(m_outputs.size());
+    m_trt->nativeOutputs.resize(m_outputs.size());
+}
+
+void TensorRTBackend::unload() {
+    std::lock_guard<std::mutex> lock(m_trt->runMutex);
+    m_trt->destroyGraphs();
+    m_trt->freeBuffers();
+    if (m_trt->stream) {
+        cudaStreamDestroy(m_trt->stream);
+        m_trt->stream = nullptr;
+    }
+    m_trt->context.reset();
+    m_trt->engine.reset();
+    m_trt->runtime.reset();
+    m_trt->inputShapes.clear();
+    m_trt->outputShapes.clear();
+    m_trt->nativeOutputs.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+    m_loadedFromCache = false;
+}
+
+void TensorRTBackend::resetBindings() {
+    std::lock_guard<std::mutex> lock(m_trt->runMutex);
+    m_trt->destroyGraphs();
+}
+
+bool TensorRTBackend::run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) {
+    if (!isLoaded()) return false;
+    if (inputs.size() != m_inputs.size() || outputs.size() < m_outputs.size()) {
+        std::cerr << "[TensorRTBackend] Expected " << m_inputs.size() << " inputs and "
+                  << m_outputs.size() << " outputs" << std::endl;
+        return false;
+    }
+
+    // One execution context: overlapping pipeline runs take turns
+    std::lock_guard<std::mutex> lock(m_trt->runMutex);
+    TrtObjects& trt = *m_trt;
+
+    bool shapesChanged = false;
+    bool reallocated = false;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (inputs[i].type != m_inputs[i].type) {
+            std::cerr << "[TensorRTBackend] Input " << i << " must be " << tensorTypeName(m_inputs[i].type) << std::endl;
+            return false;
+        }
+        if (trt.inputShapes[i] != inputs[i].shape) {
+            if (!trt.context->setInputShape(m_inputs[i].name.c_str(), toDims(inputs[i].shape))) {
+                std::cerr << "[TensorRTBackend] Input " << i << " shape is outside the engine's profile" << std::endl;
+                trt.inputShapes[i].clear();
+                return false;
+            }
+            trt.inputShapes[i] = inputs[i].shape;
+            shapesChanged = true;
+        }
+        if (!trt.reserve(trt.inputBuffers[i], storageSize(inputs[i]) * elementSize(inputs[i].type), reallocated)) {
+            return false;
+        }
+    }
+
+    // Output shapes follow the input shapes
+    if (shapesChanged) {
+        for (size_t i = 0; i < m_outputs.size(); i++) {
+            auto& shape = trt.outputShapes[i];
+            shape = toShape(trt.context->getTensorShape(m_outputs[i].name.c_str()));
+            size_t count = 1;
+            for (int64_t dim : shape) count *= static_cast<size_t>(std::max<int64_t>(dim, 0));
+            if (!trt.reserve(trt.outputBuffers[i], count * elementSize(m_outputs[i].type), reallocated)) {
+                return false;
+            }
+        }
+    }
+
+    // Captured graphs hold the buffer addresses
+    if (reallocated) {
+        trt.destroyGraphs();
+        for (size_t i = 0; i < m_inputs.size(); i++) {
+            trt.context->setTensorAddress(m_inputs[i].name.c_str(), trt.inputBuffers[i].ptr);
+        }
+        for (size_t i = 0; i < m_outputs.size(); i++) {
+            trt.context->setTensorAddress(m_outputs[i].name.c_str(), trt.outputBuffers[i].ptr);
+        }
+    }
+    if (shapesChanged) trt.warm = false;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!cudaCheck(cudaMemcpyAsync(trt.inputBuffers[i].ptr, storageData(inputs[i]),
+                                       storageSize(inputs[i]) * elementSize(inputs[i].type),
+                                       cudaMemcpyHostToDevice, trt.stream), "Input upload failed")) {
+            return false;
+        }
+    }
+
+    // Replay a graph for these shapes, or run plainly once (TensorRT finishes
+    // lazy setup on the first enqueue after a shape change) and capture next
+    auto graph = std::find_if(trt.graphs.begin(), trt.graphs.end(),
+                              [&trt](const TrtObjects::Graph& g) { return g.inputShapes == trt.inputShapes; });
+    bool executed = false;
+    if (graph != trt.graphs.end()) {
+        executed = cudaCheck(cudaGraphLaunch(graph->exec, trt.stream), "Graph launch failed");
+    } else if (m_cudaGraphs && trt.warm) {
+        cudaGraph_t captured = nullptr;
+        cudaGraphExec_t exec = nullptr;
+        bool captureOk = cudaStreamBeginCapture(trt.stream, cudaStreamCaptureModeThreadLocal) == cudaSuccess;
+        captureOk = captureOk && trt.context->enqueueV3(trt.stream);
+        captureOk = cudaStreamEndCapture(trt.stream, &captured) == cudaSuccess && captureOk;
+        captureOk = captureOk && cudaGraphInstantiate(&exec, captured, 0) == cudaSuccess;
+        if (captured) cudaGraphDestroy(captured);
+        if (captureOk) {
+            trt.graphs.push_back({trt.inputShapes, exec});
+            executed = cudaCheck(cudaGraphLaunch(exec, trt.stream), "Graph launch failed");
+        } else {
+            std::cerr << "[TensorRTBackend] CUDA graph capture failed, running without graphs" << std::endl;
+            if (exec) cudaGraphExecDestroy(exec);
+            cudaGetLastError();
+            m_cudaGraphs = false;
+        }
+    }
+    if (!executed && graph == trt.graphs.end()) {
+        executed = trt.context->enqueueV3(trt.stream);
+        trt.warm = executed;
+    }
+    if (!executed) {
+        std::cerr << "[TensorRTBackend] Inference error" << std::endl;
+        return false;
+    }
+
+    // Float32 outputs land in place, other types are staged and converted
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        const bool native = m_outputs[i].type != TensorType::Float32;
+        Tensor& dst = native ? trt.nativeOutputs[i] : outputs[i];
+        if (native && !dst.buffer.pool()) dst.buffer.pool(m_tensorPool);
+        dst.type = m_outputs[i].type;
+        if (dst.shape != trt.outputShapes[i] || storageSize(dst) != dst.size()) {
+            dst.shape = trt.outputShapes[i];
+            resizeStorage(dst);
+        }
+        if (!cudaCheck(cudaMemcpyAsync(storageData(dst), trt.outputBuffers[i].ptr,
+                                       storageSize(dst) * elementSize(dst.type),
+                                       cudaMemcpyDeviceToHost, trt.stream), "Output download failed")) {
+            return false;
+        }
+    }
+    if (!cudaCheck(cudaStreamSynchronize(trt.stream), "Inference error")) return false;
+
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        if (m_outputs[i].type != TensorType::Float32) convertToFloat(trt.nativeOutputs[i], outputs[i]);
+    }
+    return true;
+}
+
+} // namespace vivid::onnx
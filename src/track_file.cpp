@@ -0,0 +1,236 @@
+#include <vivid/onnx/track_file.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+
+namespace vivid::onnx {
+
+namespace {
+
+constexpr char kMagic[4] = {'V', 'T', 'R', 'K'};
+constexpr uint32_t kVersion = 1;
+
+// Bytes per detection before its values: source, id, score, box
+constexpr size_t kDetectionBytes = 2 * sizeof(int32_t) + 5 * sizeof(float);
+
+template <typename T>
+void put(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Bounds-checked reads from the loaded file
+class Cursor {
+public:
+    Cursor(const std::vector<char>& bytes) : m_bytes(bytes) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (remaining() < sizeof(T)) return false;
+        std::memcpy(&value, m_bytes.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool get(void* out, size_t size) {
+        if (remaining() < size) return false;
+        std::memcpy(out, m_bytes.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    size_t remaining() const { return m_bytes.size() - m_offset; }
+
+private:
+    const std::vector<char>& m_bytes;
+    size_t m_offset = 0;
+};
+
+} // namespace
+
+// =============================================================================
+// TrackFrame
+// =============================================================================
+
+void TrackFrame::clear() {
+    detections.clear();
+    valueData.clear();
+}
+
+void TrackFrame::add(const TrackDetection& detection, const float* values) {
+    detections.push_back(detection);
+    if (values) {
+        valueData.insert(valueData.end(), values, values + valueCount);
+    } else {
+        valueData.resize(valueData.size() + valueCount, 0.0f);
+    }
+}
+
+// =============================================================================
+// TrackWriter
+// =============================================================================
+
+TrackWriter::~TrackWriter() {
+    close();
+}
+
+bool TrackWriter::open(const std::string& path, const std::string& kind, int valueCount,
+                       int sourceCount, TrackFormat format) {
+    close();
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        std::cerr << "[TrackWriter] Can't create " << path << std::endl;
+        return false;
+    }
+    m_path = path;
+    m_format = format;
+    m_valueCount = std::max(0, valueCount);
+    m_framesWritten = 0;
+
+    if (format == TrackFormat::Jsonl) {
+        m_file << "{\"kind\": \"" << kind << "\", \"valueCount\": " << m_valueCount
+               << ", \"sourceCount\": " << sourceCount << "}\n";
+    } else {
+        m_file.write(kMagic, sizeof(kMagic));
+        put<uint32_t>(m_file, kVersion);
+        put<uint32_t>(m_file, static_cast<uint32_t>(m_valueCount));
+        put<uint32_t>(m_file, static_cast<uint32_t>(std::max(1, sourceCount)));
+        put<uint32_t>(m_file, static_cast<uint32_t>(kind.size()));
+        m_file.write(kind.data(), static_cast<std::streamsize>(kind.size()));
+    }
+    return static_cast<bool>(m_file);
+}
+
+bool TrackWriter::write(const TrackFrame& frame) {
+    if (!m_file.is_open()) return false;
+    if (frame.valueCount != m_valueCount ||
+        frame.valueData.size() != frame.detections.size() * static_cast<size_t>(m_valueCount)) {
+        std::cerr << "[TrackWriter] Frame " << frame.frame << " has " << frame.valueCount
+                  << " values per detection, file has " << m_valueCount << std::endl;
+        return false;
+    }
+
+    if (m_format == TrackFormat::Jsonl) {
+        // Fixed microseconds: the default 6 digits merge neighbouring frames
+        const std::streamsize precision = m_file.precision();
+        m_file << "{\"frame\": " << frame.frame << ", \"timeMs\": " << std::fixed << std::setprecision(3)
+               << frame.timeMs << std::defaultfloat << std::setprecision(precision) << ", \"detections\": [";
+        for (size_t d = 0; d < frame.detections.size(); d++) {
+            const TrackDetection& det = frame.detections[d];
+            m_file << (d ? ", " : "") << "{\"source\": " << det.source << ", \"id\": " << det.id
+                   << ", \"score\": " << det.score << ", \"box\": [" << det.box.x << ", " << det.box.y
+                   << ", " << det.box.z << ", " << det.box.w << "], \"values\": [";
+            const float* values = frame.values(d);
+            for (int v = 0; v < m_valueCount; v++) {
+                m_file << (v ? ", " : "") << values[v];
+            }
+            m_file << "]}";
+        }
+        m_file << "]}\n";
+    } else {
+        put<int64_t>(m_file, frame.frame);
+        put<double>(m_file, frame.timeMs);
+        put<uint32_t>(m_file, static_cast<uint32_t>(frame.detections.size()));
+        for (size_t d = 0; d < frame.detections.size(); d++) {
+            const TrackDetection& det = frame.detections[d];
+            put<int32_t>(m_file, det.source);
+            put<int32_t>(m_file, det.id);
+            put<float>(m_file, det.score);
+            const float box[4] = {det.box.x, det.box.y, det.box.z, det.box.w};
+            m_file.write(reinterpret_cast<const char*>(box), sizeof(box));
+            m_file.write(reinterpret_cast<const char*>(frame.values(d)),
+                         static_cast<std::streamsize>(m_valueCount * sizeof(float)));
+        }
+    }
+
+    if (!m_file) {
+        std::cerr << "[TrackWriter] Write failed: " << m_path << std::endl;
+        return false;
+    }
+    m_framesWritten++;
+    return true;
+}
+
+void TrackWriter::close() {
+    if (m_file.is_open()) m_file.close();
+}
+
+// =============================================================================
+// TrackReader
+// =============================================================================
+
+bool TrackReader::open(const std::string& path) {
+    m_kind.clear();
+    m_valueCount = 0;
+    m_sourceCount = 0;
+    m_frames.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "[TrackReader] Can't open " << path << std::endl;
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    Cursor in(bytes);
+
+    char magic[4] = {};
+    uint32_t version = 0, valueCount = 0, sourceCount = 0, kindLength = 0;
+    if (!in.get(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "[TrackReader] Not a binary track file: " << path << std::endl;
+        return false;
+    }
+    if (!in.get(version) || version != kVersion) {
+        std::cerr << "[TrackReader] Unsupported track file version " << version << ": " << path << std::endl;
+        return false;
+    }
+    if (!in.get(valueCount) || !in.get(sourceCount) || !in.get(kindLength) || kindLength > in.remaining()) {
+        std::cerr << "[TrackReader] Truncated header: " << path << std::endl;
+        return false;
+    }
+    m_kind.resize(kindLength);
+    in.get(m_kind.data(), kindLength);
+    m_valueCount = static_cast<int>(valueCount);
+    m_sourceCount = static_cast<int>(sourceCount);
+
+    const size_t detectionBytes = kDetectionBytes + valueCount * sizeof(float);
+    while (in.remaining() > 0) {
+        TrackFrame frame;
+        frame.valueCount = m_valueCount;
+        uint32_t count = 0;
+        if (!in.get(frame.frame) || !in.get(frame.timeMs) || !in.get(count) ||
+            count > in.remaining() / detectionBytes) {
+            std::cerr << "[TrackReader] Truncated frame after " << m_frames.size() << " frames: " << path << std::endl;
+            break;
+        }
+
+        frame.detections.resize(count);
+        frame.valueData.resize(static_cast<size_t>(count) * valueCount);
+        for (uint32_t d = 0; d < count; d++) {
+            TrackDetection& det = frame.detections[d];
+            int32_t source = 0, id = 0;
+            in.get(source);
+            in.get(id);
+            in.get(det.score);
+            float box[4] = {};
+            in.get(box, sizeof(box));
+            in.get(frame.valueData.data() + static_cast<size_t>(d) * valueCount, valueCount * sizeof(float));
+            det.source = source;
+            det.id = id;
+            det.box = glm::vec4(box[0], box[1], box[2], box[3]);
+        }
+        m_frames.push_back(std::move(frame));
+    }
+
+    std::stable_sort(m_frames.begin(), m_frames.end(),
+                     [](const TrackFrame& a, const TrackFrame& b) { return a.frame < b.frame; });
+    return true;
+}
+
+const TrackFrame* TrackReader::find(int64_t frame) const {
+    auto it = std::lower_bound(m_frames.begin(), m_frames.end(), frame,
+                               [](const TrackFrame& f, int64_t value) { return f.frame < value; });
+    return (it != m_frames.end() && it->frame == frame) ? &*it : nullptr;
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,210 @@
+#include <vivid/onnx/tracker.h>
+#include <vivid/onnx/nms.h>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::onnx {
+
+// Longest extrapolation; past this the tracks hold still
+static constexpr double kMaxPredictSeconds = 0.25;
+
+// Step used when timestamps don't advance (60 fps)
+static constexpr double kDefaultStepSeconds = 1.0 / 60.0;
+
+static float smoothingFactor(float cutoff, float dt) {
+    const float tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+float OneEuroFilter::filter(float x, float dt) {
+    if (!initialized) {
+        value = x;
+        velocity = 0.0f;
+        initialized = true;
+        return value;
+    }
+    if (dt <= 0.0f) return value;
+
+    velocity += smoothingFactor(dCutoff, dt) * ((x - value) / dt - velocity);
+    const float cutoff = minCutoff + beta * std::fabs(velocity);
+    value += smoothingFactor(cutoff, dt) * (x - value);
+    return value;
+}
+
+DetectionTracker& DetectionTracker::valueCount(int count) {
+    m_valueCount = std::max(count, 0);
+    reset();
+    return *this;
+}
+
+DetectionTracker& DetectionTracker::smoothing(float minCutoff, float beta) {
+    m_minCutoff = std::max(minCutoff, 1e-3f);
+    m_beta = std::max(beta, 0.0f);
+    for (auto& track : m_tracks) {
+        for (auto& f : track.filters) {
+            f.minCutoff = m_minCutoff;
+            f.beta = m_beta;
+        }
+    }
+    return *this;
+}
+
+DetectionTracker& DetectionTracker::iouThreshold(float threshold) {
+    m_iouThreshold = std::clamp(threshold, 0.0f, 1.0f);
+    return *this;
+}
+
+DetectionTracker& DetectionTracker::maxMissed(int updates) {
+    m_maxMissed = std::max(updates, 0);
+    return *this;
+}
+
+void DetectionTracker::reset() {
+    m_tracks.clear();
+    m_detectionTrack.clear();
+    clear();
+}
+
+void DetectionTracker::clear() {
+    m_boxes.clear();
+    m_scores.clear();
+    m_values.clear();
+}
+
+void DetectionTracker::add(const glm::vec4& box, float score, const float* values) {
+    m_boxes.push_back(box);
+    m_scores.push_back(score);
+    if (m_valueCount > 0) {
+        if (values) {
+            m_values.insert(m_values.end(), values, values + m_valueCount);
+        } else {
+            m_values.resize(m_values.size() + m_valueCount, 0.0f);
+        }
+    }
+}
+
+int DetectionTracker::trackFor(size_t detection) const {
+    return detection < m_detectionTrack.size() ? m_detectionTrack[detection] : -1;
+}
+
+float DetectionTracker::similarity(const Track& track, const glm::vec4& box) const {
+    // Overlapping boxes always rank above center-distance matches
+    const float overlap = NonMaxSuppression::iou(track.box, box);
+    if (overlap >= m_iouThreshold && overlap > 0.0f) return 1.0f + overlap;
+
+    // Fast moves: center within half the track's larger side
+    const glm::vec2 a(track.box.x + track.box.z * 0.5f, track.box.y + track.box.w * 0.5f);
+    const glm::vec2 b(box.x + box.z * 0.5f, box.y + box.w * 0.5f);
+    const float reach = 0.5f * std::max(track.box.z, track.box.w);
+    const float distance = glm::length(a - b);
+    if (reach > 0.0f && distance < reach) return 1.0f - distance / reach;
+    return 0.0f;
+}
+
+void DetectionTracker::startTrack(size_t detection, double time) {
+    Track track;
+    track.id = m_nextId++;
+    track.filters.resize(4 + m_valueCount);
+    for (auto& f : track.filters) {
+        f.minCutoff = m_minCutoff;
+        f.beta = m_beta;
+    }
+    track.values.resize(m_valueCount);
+    track.lastTime = time;
+    filterTrack(track, detection, time);
+    m_tracks.push_back(std::move(track));
+}
+
+void DetectionTracker::filterTrack(Track& track, size_t detection, double time) {
+    double step = time - track.lastTime;
+    if (step <= 0.0) step = kDefaultStepSeconds;
+    const float dt = static_cast<float>(step);
+
+    const glm::vec4& box = m_boxes[detection];
+    track.box = glm::vec4(track.filters[0].filter(box.x, dt),
+                          track.filters[1].filter(box.y, dt),
+                          track.filters[2].filter(box.z, dt),
+                          track.filters[3].filter(box.w, dt));
+
+    const float* values = m_valueCount ? &m_values[detection * m_valueCount] : nullptr;
+    for (int v = 0; v < m_valueCount; v++) {
+        track.values[v] = track.filters[4 + v].filter(values[v], dt);
+    }
+
+    track.score = m_scores[detection];
+    track.missed = 0;
+    track.hits++;
+    track.lastTime = time;
+}
+
+void DetectionTracker::update(double time) {
+    const size_t detections = m_scores.size();
+    const size_t existing = m_tracks.size();
+
+    m_detectionTrack.assign(detections, -1);
+    m_trackMatched.assign(existing, 0);
+
+    // Greedy assignment, most similar pairs first
+    m_matches.clear();
+    for (size_t t = 0; t < existing; t++) {
+        for (size_t d = 0; d < detections; d++) {
+            float s = similarity(m_tracks[t], m_boxes[d]);
+            if (s > 0.0f) {
+                m_matches.push_back({s, static_cast<int>(t), static_cast<int>(d)});
+            }
+        }
+    }
+    std::sort(m_matches.begin(), m_matches.end(), [](const Match& a, const Match& b) {
+        return a.similarity > b.similarity;
+    });
+    for (const Match& m : m_matches) {
+        if (m_trackMatched[m.track] || m_detectionTrack[m.detection] >= 0) continue;
+        m_trackMatched[m.track] = 1;
+        m_detectionTrack[m.detection] = m.track;
+        filterTrack(m_tracks[m.track], m.detection, time);
+    }
+
+    // Unmatched tracks coast; unmatched detections start new tracks
+    for (size_t t = 0; t < existing; t++) {
+        if (!m_trackMatched[t]) m_tracks[t].missed++;
+    }
+    for (size_t d = 0; d < detections; d++) {
+        if (m_detectionTrack[d] < 0) {
+            m_detectionTrack[d] = static_cast<int>(m_tracks.size());
+            startTrack(d, time);
+        }
+    }
+
+    // Drop tracks missing for too long, keeping trackFor() valid
+    m_remap.resize(m_tracks.size());
+    size_t kept = 0;
+    for (size_t t = 0; t < m_tracks.size(); t++) {
+        if (m_tracks[t].missed > m_maxMissed) {
+            m_remap[t] = -1;
+            continue;
+        }
+        if (kept != t) m_tracks[kept] = std::move(m_tracks[t]);
+        m_remap[t] = static_cast<int>(kept++);
+    }
+    m_tracks.resize(kept);
+    for (auto& index : m_detectionTrack) {
+        index = m_remap[index];
+    }
+}
+
+void DetectionTracker::predict(double time) {
+    for (auto& track : m_tracks) {
+        if (track.missed > 0) continue;
+
+        const float dt = static_cast<float>(std::clamp(time - track.lastTime, 0.0, kMaxPredictSeconds));
+        auto extrapolate = [dt](const OneEuroFilter& f) { return f.value + f.velocity * dt; };
+
+        track.box = glm::vec4(extrapolate(track.filters[0]), extrapolate(track.filters[1]),
+                              extrapolate(track.filters[2]), extrapolate(track.filters[3]));
+        for (int v = 0; v < m_valueCount; v++) {
+            track.values[v] = extrapolate(track.filters[4 + v]);
+        }
+    }
+}
+
+} // namespace vivid::onnx
@@ -0,0 +1,60 @@
+// Runtime-free backend for tests: a MoveNet singlepose signature whose
+// output puts every keypoint at the center with full confidence. Runs are
+// counted (from the worker thread in async mode) and can be slowed down.
+
+#pragma once
+
+#include <vivid/onnx/backend.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace vivid::onnx::test {
+
+class FakeBackend : public InferenceBackend {
+public:
+    explicit FakeBackend(std::atomic<int>* runs, int runMs = 0) : m_runs(runs), m_runMs(runMs) {
+        m_inputs.push_back({"input", {1, 192, 192, 3}, TensorType::Int32, true});
+        m_outputs.push_back({"output_0", {1, 1, 17, 3}, TensorType::Float32, true});
+    }
+
+    const char* name() const override { return "Fake"; }
+    bool load(const BackendConfig& config) override {
+        m_loaded = true;
+        m_lastConfig = config;
+        return true;
+    }
+    void unload() override { m_loaded = false; }
+    bool isLoaded() const override { return m_loaded; }
+    ExecutionProvider provider() const override { return ExecutionProvider::CUDA; }
+    const std::vector<TensorInfo>& inputs() const override { return m_inputs; }
+    const std::vector<TensorInfo>& outputs() const override { return m_outputs; }
+
+    bool run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) override {
+        if (m_runMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(m_runMs));
+        (*m_runs)++;
+        m_lastInputShape = inputs[0].shape;
+        outputs[0].shape = m_outputs[0].shape;
+        resizeStorage(outputs[0]);
+        for (size_t k = 0; k < 17; k++) {
+            outputs[0][k * 3 + 0] = 0.5f;
+            outputs[0][k * 3 + 1] = 0.5f;
+            outputs[0][k * 3 + 2] = 1.0f;
+        }
+        return true;
+    }
+
+    static BackendConfig& lastConfig() { return m_lastConfig; }
+    static std::vector<int64_t>& lastInputShape() { return m_lastInputShape; }
+
+private:
+    std::atomic<int>* m_runs;
+    int m_runMs;
+    bool m_loaded = false;
+    std::vector<TensorInfo> m_inputs;
+    std::vector<TensorInfo> m_outputs;
+    static inline BackendConfig m_lastConfig;
+    static inline std::vector<int64_t> m_lastInputShape;
+};
+
+} // namespace vivid::onnx::test
@@ -0,0 +1,65 @@
+// Context-free access to an operator's protected hooks for tests: decode
+// synthetic outputs, step prepared frames through process(), fake a loaded
+// model and read or apply track records. Works for ONNXModel and any
+// detector built on it.
+
+#pragma once
+
+#include <vivid/onnx/onnx_model.h>
+#include <vivid/io/image_loader.h>
+#include <utility>
+#include <vector>
+
+namespace vivid::onnx::test {
+
+template <typename Op>
+class Harness : public Op {
+public:
+    /// Decode one output tensor
+    void decode(const Tensor& output) { this->processOutputTensor(output); }
+
+    /// Decode a full set of outputs (hooks that read several see them all)
+    void decodeOutputs(std::vector<Tensor> outputs) {
+        this->m_outputTensors = std::move(outputs);
+        this->processOutputTensor(this->m_outputTensors[0]);
+    }
+
+    /// Decode the outputs of the last run again
+    void decodeOutputs() { this->processOutputTensor(this->outputTensor(0)); }
+
+    /// init() and process() on inputs prepared by the test
+    void initialize() { this->initModel(); }
+    void frame() { this->processPrepared(); }
+
+    /// Prepare input 0 from pixels (cropped) and run it through process()
+    void step(const vivid::io::ImageData& pixels, const SourceRect& crop = SourceRect{}) {
+        Tensor& input = this->m_inputTensors[0];
+        const auto& shape = this->inputShape(0);
+        if (input.shape != shape) {
+            input.shape = shape;
+            resizeStorage(input);
+        }
+        this->cpuPixelsToTensor(pixels, input, static_cast<int>(shape[2]), static_cast<int>(shape[1]), crop);
+        this->processPrepared();
+    }
+
+    int64_t submitted() const { return this->frameIndex(); }
+    int64_t result() const { return this->resultFrame(); }
+
+    /// Pretend a model with these shapes was loaded
+    void fakeLoad(const std::vector<int64_t>& inputShape, const std::vector<int64_t>& outputShape,
+                  bool dynamicSize = false) {
+        this->m_inputShapes = {inputShape};
+        this->m_outputShapes = {outputShape};
+        this->m_dynamicInputSize = dynamicSize;
+        this->m_loaded = true;
+        this->onModelLoaded();
+    }
+
+    /// Track file hooks
+    int values() const { return this->trackValueCount(); }
+    void append(TrackFrame& record) const { this->appendTrackDetections(record); }
+    void apply(const TrackFrame& record) { this->applyTrackDetections(record); }
+};
+
+} // namespace vivid::onnx::test
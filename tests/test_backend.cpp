@@ -0,0 +1,72 @@
+/**
+ * @file test_backend.cpp
+ * @brief Tests for the InferenceBackend interface and backend selection
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/backend.h>
+#include <vivid/onnx/onnx_model.h>
+#include <vivid/onnx/pose_detector.h>
+#include "fake_backend.h"
+#include "harness.h"
+
+using namespace vivid::onnx;
+using vivid::onnx::test::FakeBackend;
+using vivid::onnx::test::Harness;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Backend availability", "[ml][backend]") {
+    REQUIRE(isBackendAvailable(BackendType::OnnxRuntime));
+    REQUIRE(createBackend(BackendType::OnnxRuntime) != nullptr);
+    REQUIRE(std::string(backendTypeName(BackendType::TensorRT)) == "TensorRT");
+
+#ifndef VIVID_ONNX_WITH_TENSORRT
+    REQUIRE_FALSE(isBackendAvailable(BackendType::TensorRT));
+    REQUIRE(createBackend(BackendType::TensorRT) == nullptr);
+#endif
+}
+
+TEST_CASE("ONNXModel runs through a custom backend", "[ml][backend]") {
+    std::atomic<int> runs{0};
+    ONNXModel model;
+    model.model("fake.onnx").backend(std::make_unique<FakeBackend>(&runs));
+
+    REQUIRE(std::string(model.activeBackend()) == "Fake");
+    REQUIRE(model.load());
+    REQUIRE(model.isLoaded());
+    REQUIRE(model.activeExecutionProvider() == ExecutionProvider::CUDA);
+
+    // Model metadata comes from the backend
+    REQUIRE(model.inputCount() == 1);
+    REQUIRE(model.inputShape(0) == std::vector<int64_t>{1, 192, 192, 3});
+    REQUIRE(model.outputShape(0) == std::vector<int64_t>{1, 1, 17, 3});
+    REQUIRE(FakeBackend::lastConfig().modelPath.find("fake.onnx") != std::string::npos);
+
+    REQUIRE(model.warmup(2));
+    REQUIRE(runs == 2);
+    REQUIRE(FakeBackend::lastInputShape() == std::vector<int64_t>{1, 192, 192, 3});
+    REQUIRE(model.outputTensor(0).size() == 51);
+
+    SECTION("backend can't change once loaded") {
+        model.backend(BackendType::OnnxRuntime);
+        REQUIRE(std::string(model.activeBackend()) == "Fake");
+        REQUIRE(model.backendType() == BackendType::OnnxRuntime);
+    }
+}
+
+TEST_CASE("PoseDetector runs unchanged on another backend", "[ml][backend][pose]") {
+    std::atomic<int> runs{0};
+    Harness<PoseDetector> detector;
+    detector.model("fake.onnx");
+    detector.backend(std::make_unique<FakeBackend>(&runs));
+
+    REQUIRE(detector.load());
+    REQUIRE(detector.warmup(1));
+    detector.decodeOutputs();
+
+    REQUIRE(runs == 1);
+    REQUIRE(detector.detected());
+    REQUIRE_THAT(detector.keypoints()[0].x, WithinAbs(0.5f, 1e-4f));
+    REQUIRE_THAT(detector.keypoints()[0].y, WithinAbs(0.5f, 1e-4f));
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_cascade.cpp
+ * @brief Unit tests for RoiCascade
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/cascade.h>
+#include <vivid/onnx/face_detector.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("RoiCascade defaults", "[ml][cascade]") {
+    RoiCascade cascade;
+    FaceDetector faces;
+
+    REQUIRE(cascade.name() == "RoiCascade");
+    REQUIRE(cascade.isLoaded() == false);
+    REQUIRE(cascade.roiCount() == 0);
+
+    // Configuration chains and needs no upstream sources yet
+    cascade.from(&faces).roiScale(1.5f).squareRois(false).maxRois(4);
+    REQUIRE(cascade.sourceCount() == 0);
+    REQUIRE(cascade.rois().empty());
+}
+
+TEST_CASE("RoiCascade crop regions", "[ml][cascade]") {
+    RoiCascade cascade;
+
+    SECTION("square in source pixels, centered on the box") {
+        // 0.1 x 0.2 of a 1280x720 frame is 128x144 px -> 144x144 px
+        SourceRect r = cascade.roiRegion(0.4f, 0.3f, 0.1f, 0.2f, 1280, 720);
+        REQUIRE_THAT(r.width * 1280.0f, WithinAbs(144.0f, 0.01f));
+        REQUIRE_THAT(r.height * 720.0f, WithinAbs(144.0f, 0.01f));
+        REQUIRE_THAT(r.x + r.width * 0.5f, WithinAbs(0.45f, 1e-5f));
+        REQUIRE_THAT(r.y + r.height * 0.5f, WithinAbs(0.4f, 1e-5f));
+    }
+
+    SECTION("scaled around the center, may leave the frame") {
+        cascade.squareRois(false).roiScale(2.0f);
+        SourceRect r = cascade.roiRegion(0.0f, 0.0f, 0.2f, 0.1f, 640, 480);
+        REQUIRE_THAT(r.x, WithinAbs(-0.1f, 1e-5f));
+        REQUIRE_THAT(r.y, WithinAbs(-0.05f, 1e-5f));
+        REQUIRE_THAT(r.width, WithinAbs(0.4f, 1e-5f));
+        REQUIRE_THAT(r.height, WithinAbs(0.2f, 1e-5f));
+    }
+
+    SECTION("unknown source size skips squaring") {
+        SourceRect r = cascade.roiRegion(0.2f, 0.2f, 0.1f, 0.3f, 0, 0);
+        REQUIRE_THAT(r.width, WithinAbs(0.1f, 1e-5f));
+        REQUIRE_THAT(r.height, WithinAbs(0.3f, 1e-5f));
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_face_detector.cpp
+ * @brief Unit tests for FaceDetector output decoding
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/face_detector.h>
+#include "harness.h"
+
+using namespace vivid::onnx;
+using vivid::onnx::test::Harness;
+using Catch::Matchers::WithinAbs;
+
+static Tensor makeOutput(std::vector<int64_t> shape, float fill) {
+    Tensor t;
+    t.shape = shape;
+    resizeStorage(t);
+    fillTensor(t, fill);
+    return t;
+}
+
+// 2-output BlazeFace layout: regressors [1, 896, 16], scores [1, 896, 1]
+static void setAnchor(Tensor& regressors, Tensor& scores, int anchor,
+                      float logit, float dx, float size) {
+    scores[anchor] = logit;
+    float* box = &regressors[anchor * 16];
+    box[0] = dx;
+    box[2] = size;
+    box[3] = size;
+}
+
+TEST_CASE("FaceDetector decoding", "[ml][face]") {
+    Harness<FaceDetector> detector;
+    auto regressors = makeOutput({1, 896, 16}, 0.0f);
+    auto scores = makeOutput({1, 896, 1}, -10.0f);
+
+    SECTION("nothing above threshold") {
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.detected() == false);
+    }
+
+    SECTION("threshold is applied on raw scores") {
+        setAnchor(regressors, scores, 100, 0.5f, 0.0f, 20.0f);   // sigmoid ~0.62
+        setAnchor(regressors, scores, 700, -0.5f, 0.0f, 20.0f);  // sigmoid ~0.38
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.faceCount() == 1);
+        REQUIRE_THAT(detector.confidence(0), WithinAbs(0.6225f, 1e-3));
+    }
+
+    SECTION("overlapping boxes are suppressed, best first") {
+        // Anchors 0 and 1 share a cell; 300 is elsewhere in the 16x16 map
+        setAnchor(regressors, scores, 0, 2.0f, 0.0f, 16.0f);
+        setAnchor(regressors, scores, 1, 4.0f, 1.0f, 16.0f);
+        setAnchor(regressors, scores, 300, 3.0f, 0.0f, 16.0f);
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.faceCount() == 2);
+        REQUIRE(detector.confidence(0) > detector.confidence(1));
+        REQUIRE_THAT(detector.confidence(0), WithinAbs(0.982f, 1e-3));
+    }
+
+    SECTION("maxFaces limits the result") {
+        detector.maxFaces(1);
+        setAnchor(regressors, scores, 0, 2.0f, 0.0f, 8.0f);
+        setAnchor(regressors, scores, 300, 3.0f, 0.0f, 8.0f);
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.faceCount() == 1);
+    }
+}
+
+TEST_CASE("FaceDetector smoothing", "[ml][face]") {
+    Harness<FaceDetector> detector;
+    auto regressors = makeOutput({1, 896, 16}, 0.0f);
+    auto scores = makeOutput({1, 896, 1}, -10.0f);
+    setAnchor(regressors, scores, 100, 2.0f, 0.0f, 20.0f);
+
+    SECTION("faces get no ID by default") {
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.face(0).id == -1);
+    }
+
+    SECTION("IDs are stable across frames") {
+        REQUIRE(&detector.smoothing(true) == &detector);
+        detector.decodeOutputs({regressors, scores});
+        int id = detector.face(0).id;
+        REQUIRE(id >= 0);
+
+        regressors[100 * 16] = 0.5f;  // moves slightly
+        detector.decodeOutputs({regressors, scores});
+        REQUIRE(detector.faceCount() == 1);
+        REQUIRE(detector.face(0).id == id);
+    }
+}
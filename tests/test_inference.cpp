@@ -7,10 +7,16 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <vivid/onnx/onnx_model.h>
 #include <vivid/onnx/pose_detector.h>
+#include "fake_backend.h"
+#include "harness.h"
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <thread>
 
 using namespace vivid::onnx;
+using vivid::onnx::test::FakeBackend;
+using vivid::onnx::test::Harness;
 using Catch::Matchers::WithinAbs;
 
 // Check if model file exists
@@ -56,10 +62,174 @@ TEST_CASE("PoseDetector configuration with model", "[ml][integration]") {
     REQUIRE(detector.detected() == false);
 }
 
+TEST_CASE("ONNXModel setters return self", "[ml]") {
+    ThreadPoolOptions options;
+    options.intraOpThreads = 2;
+    options.allowSpinning = false;
+
+    const std::vector<std::pair<const char*, std::function<ONNXModel&(ONNXModel&)>>> setters = {
+        {"async", [](ONNXModel& m) -> ONNXModel& { return m.async(true); }},
+        {"pipelineDepth", [](ONNXModel& m) -> ONNXModel& { return m.pipelineDepth(2); }},
+        {"gpuPreprocess", [](ONNXModel& m) -> ONNXModel& { return m.gpuPreprocess(false); }},
+        {"aspectMode", [](ONNXModel& m) -> ONNXModel& { return m.aspectMode(AspectMode::Fit); }},
+        {"threading", [&](ONNXModel& m) -> ONNXModel& { return m.threading(options); }},
+        {"globalThreadPool", [](ONNXModel& m) -> ONNXModel& { return m.globalThreadPool(true); }},
+        {"profiling", [](ONNXModel& m) -> ONNXModel& { return m.profiling(50); }},
+        {"sharedSession", [](ONNXModel& m) -> ONNXModel& { return m.sharedSession(false); }},
+        {"modelCache", [](ONNXModel& m) -> ONNXModel& { return m.modelCache(false); }},
+        {"runEvery", [](ONNXModel& m) -> ONNXModel& { return m.runEvery(2); }},
+        {"runAtRate", [](ONNXModel& m) -> ONNXModel& { return m.runAtRate(30.0f); }},
+        {"runOnNewFrame", [](ONNXModel& m) -> ONNXModel& { return m.runOnNewFrame(true); }},
+        {"runOnChange", [](ONNXModel& m) -> ONNXModel& { return m.runOnChange(0.1f); }},
+    };
+
+    for (const auto& [name, set] : setters) {
+        ONNXModel model;
+        INFO(name);
+        REQUIRE(&set(model) == &model);
+    }
+}
+
+TEST_CASE("ONNXModel configuration defaults", "[ml]") {
+    ONNXModel model;
+
+    SECTION("sync, unscheduled and unloaded") {
+        REQUIRE(model.isAsync() == false);
+        REQUIRE(model.pipelineDepth() == 1);
+        REQUIRE(model.aspectMode() == AspectMode::Stretch);
+        REQUIRE(model.gpuPreprocessActive() == false);
+        REQUIRE(model.loadedFromCache() == false);
+        REQUIRE(model.runPolicy().everyFrames == 1);
+        REQUIRE(model.runPolicy().onNewFrame == false);
+        REQUIRE(model.framesSkipped() == 0);
+    }
+
+    SECTION("no result age before first inference") {
+        model.async(true);
+        REQUIRE(model.resultAgeFrames() == -1);
+        REQUIRE(model.resultAgeMs() < 0.0);
+        REQUIRE(model.framesDropped() == 0);
+    }
+
+    SECTION("async can be disabled again") {
+        model.async(true).async(false);
+        REQUIRE(model.isAsync() == false);
+    }
+
+    SECTION("pipeline depth is at least one frame") {
+        model.async(true).pipelineDepth(3);
+        REQUIRE(model.pipelineDepth() == 3);
+        model.pipelineDepth(0);
+        REQUIRE(model.pipelineDepth() == 1);
+    }
+
+    SECTION("aspect mode is kept") {
+        model.aspectMode(AspectMode::Fit);
+        REQUIRE(model.aspectMode() == AspectMode::Fit);
+    }
+
+    SECTION("run policy setters clamp") {
+        model.runEvery(0).runAtRate(-5.0f).runOnNewFrame(true).runOnChange(2.0f);
+        REQUIRE(model.runPolicy().everyFrames == 1);
+        REQUIRE(model.runPolicy().maxRateHz == 0.0f);
+        REQUIRE(model.runPolicy().onNewFrame == true);
+        REQUIRE(model.runPolicy().changeThreshold == 1.0f);
+    }
+}
+
+TEST_CASE("ONNXModel stats", "[ml][stats]") {
+    ONNXModel model;
+
+    SECTION("empty before any inference") {
+        InferenceStats s = model.stats();
+        REQUIRE(s.inferences == 0);
+        REQUIRE(s.run.samples == 0);
+        REQUIRE(s.run.p95Ms == 0.0);
+        REQUIRE(model.profileFile().empty());
+        REQUIRE_FALSE(model.statsSummary().empty());
+    }
+
+    SECTION("load without a model path fails") {
+        REQUIRE(model.load() == false);
+        REQUIRE(model.isLoaded() == false);
+    }
+}
+
+TEST_CASE("ONNXModel session cache", "[ml]") {
+    SECTION("clearing an unused cache leaves it empty") {
+        ONNXModel::clearSessionCache();
+        REQUIRE(ONNXModel::cachedSessionCount() == 0);
+    }
+}
+
+// Records which frame each decoded result was prepared on
+class PipelineModel : public Harness<ONNXModel> {
+public:
+    std::vector<int64_t> results;
+
+    // Skip (but collect on) frames until count results arrived, or 5 s
+    bool waitResults(size_t count) {
+        runEvery(1000000);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (results.size() < count && std::chrono::steady_clock::now() < deadline) {
+            frame();
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return results.size() >= count;
+    }
+
+protected:
+    void processOutputTensor(const Tensor&) override { results.push_back(resultFrame()); }
+};
+
+TEST_CASE("ONNXModel async pipeline", "[ml][async]") {
+    std::atomic<int> runs{0};
+    PipelineModel model;
+    model.model("fake.onnx").backend(std::make_unique<FakeBackend>(&runs, 50));
+    REQUIRE(model.load());
+
+    SECTION("sync runs and decodes every frame in place") {
+        for (int i = 0; i < 3; i++) model.frame();
+        REQUIRE(runs == 3);
+        REQUIRE(model.results == std::vector<int64_t>{1, 2, 3});
+        REQUIRE(model.resultAgeFrames() == 0);
+        REQUIRE(model.framesDropped() == 0);
+    }
+
+    SECTION("depth 1 drops frames while the slow run is in flight") {
+        model.async(true).pipelineDepth(1);
+        for (int i = 0; i < 4; i++) model.frame();
+        REQUIRE(model.framesDropped() == 3);
+        REQUIRE(model.results.empty());
+
+        REQUIRE(model.waitResults(1));
+        REQUIRE(model.results == std::vector<int64_t>{1});
+        REQUIRE(runs == 1);
+        REQUIRE(model.framesDropped() == 3);
+        REQUIRE(model.framesSkipped() == static_cast<uint64_t>(model.submitted() - 4));
+        REQUIRE(model.resultAgeFrames() == model.submitted() - 1);
+        REQUIRE(model.resultAgeMs() >= 0.0);
+    }
+
+    SECTION("depth 3 keeps three frames in flight and decodes them in order") {
+        model.async(true).pipelineDepth(3);
+        for (int i = 0; i < 4; i++) model.frame();
+        REQUIRE(model.framesDropped() == 1);
+        REQUIRE(model.results.empty());
+
+        REQUIRE(model.waitResults(3));
+        REQUIRE(model.results == std::vector<int64_t>{1, 2, 3});
+        REQUIRE(runs == 3);
+        REQUIRE(model.framesDropped() == 1);
+        REQUIRE(model.resultAgeFrames() == model.submitted() - 3);
+        REQUIRE(model.stats().inferences == 3);
+    }
+}
+
 TEST_CASE("Tensor operations", "[ml][tensor]") {
     Tensor t;
     t.shape = {1, 192, 192, 3};  // MoveNet input shape (NHWC)
-    t.data.resize(t.size());
+    resizeStorage(t);
 
     SECTION("size calculation") {
         REQUIRE(t.size() == 1 * 192 * 192 * 3);
@@ -76,9 +246,119 @@ TEST_CASE("Tensor operations", "[ml][tensor]") {
     SECTION("fill with test pattern") {
         // Fill with gradient (simulating an image)
         for (size_t i = 0; i < t.size(); i++) {
-            t.data[i] = static_cast<float>(i % 256) / 255.0f;
+            t[i] = static_cast<float>(i % 256) / 255.0f;
         }
-        REQUIRE_THAT(t.data[0], WithinAbs(0.0f, 0.001f));
-        REQUIRE_THAT(t.data[255], WithinAbs(1.0f, 0.001f));
+        REQUIRE_THAT(t[0], WithinAbs(0.0f, 0.001f));
+        REQUIRE_THAT(t[255], WithinAbs(1.0f, 0.001f));
+    }
+}
+
+// Tracks runs in progress, and how many there were when profiling ended
+class ProfilingBackend : public FakeBackend {
+public:
+    ProfilingBackend(std::atomic<int>* runs, std::vector<int>* activeAtEnd)
+        : FakeBackend(runs, 10), m_activeAtEnd(activeAtEnd) {}
+    bool run(std::vector<Tensor>& inputs, std::vector<Tensor>& outputs) override {
+        m_active++;
+        const bool ok = FakeBackend::run(inputs, outputs);
+        m_active--;
+        return ok;
+    }
+    std::string endProfiling() override {
+        m_activeAtEnd->push_back(m_active);
+        return "fake-profile.json";
+    }
+
+private:
+    std::atomic<int> m_active{0};
+    std::vector<int>* m_activeAtEnd;
+};
+
+TEST_CASE("ONNXModel ends a pipelined profile once its runs drain", "[ml][async][stats]") {
+    std::atomic<int> runs{0};
+    std::vector<int> activeAtEnd;
+    PipelineModel model;
+    model.model("fake.onnx").backend(std::make_unique<ProfilingBackend>(&runs, &activeAtEnd));
+    model.async(true).pipelineDepth(3).profiling(5);
+    REQUIRE(model.load());
+
+    // Frames keep coming faster than the runs finish
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (model.profileFile().empty() && std::chrono::steady_clock::now() < deadline) {
+        model.frame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    REQUIRE(model.profileFile() == "fake-profile.json");
+    REQUIRE(activeAtEnd == std::vector<int>{0});
+    REQUIRE(runs == 5);
+    REQUIRE(model.stats().inferences == 5);
+
+    // Pipelining resumes after the window
+    while (model.stats().inferences < 10 && std::chrono::steady_clock::now() < deadline) {
+        model.frame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    REQUIRE(model.stats().inferences >= 10);
+    REQUIRE(activeAtEnd.size() == 1);
+}
+
+// Fails its first load(s), like a model file that is still being copied
+class FlakyBackend : public FakeBackend {
+public:
+    FlakyBackend(std::atomic<int>* runs, int failures) : FakeBackend(runs), m_failures(failures) {}
+    bool load(const BackendConfig& config) override {
+        if (m_failures > 0) {
+            m_failures--;
+            return false;
+        }
+        return FakeBackend::load(config);
+    }
+
+private:
+    int m_failures;
+};
+
+TEST_CASE("ONNXModel preload", "[ml]") {
+    ONNXModel model;
+
+    SECTION("warmup needs a loaded model") {
+        REQUIRE_FALSE(model.warmup(2));
+    }
+
+    SECTION("future reports a failed load") {
+        auto ready = model.preload(2);
+        REQUIRE(ready.valid());
+        REQUIRE(ready.get() == false);
+        REQUIRE(model.isPreloading() == false);
+        REQUIRE(model.isLoaded() == false);
+    }
+}
+
+TEST_CASE("ONNXModel init after a failed preload", "[ml]") {
+    std::atomic<int> runs{0};
+    Harness<ONNXModel> model;
+
+    SECTION("loads again and recovers") {
+        model.model("fake.onnx").backend(std::make_unique<FlakyBackend>(&runs, 1));
+        REQUIRE(model.preload(1).get() == false);
+        REQUIRE_FALSE(model.isLoaded());
+
+        model.initialize();
+        REQUIRE(model.isLoaded());
+        REQUIRE(model.inputShape(0) == std::vector<int64_t>{1, 192, 192, 3});
+    }
+
+    SECTION("reports a model that still fails, once") {
+        model.model("missing.onnx").backend(std::make_unique<FlakyBackend>(&runs, 2));
+        REQUIRE(model.preload(1).get() == false);
+
+        model.initialize();
+        REQUIRE_FALSE(model.isLoaded());
+        REQUIRE_FALSE(model.isPreloading());
+
+        // No retry loop: later frames just find no model
+        model.frame();
+        REQUIRE_FALSE(model.isLoaded());
+        REQUIRE(runs == 0);
     }
 }
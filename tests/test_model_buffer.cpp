@@ -0,0 +1,63 @@
+/**
+ * @file test_model_buffer.cpp
+ * @brief Unit tests for memory-mapped and in-memory model bytes
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <vivid/onnx/model_buffer.h>
+#include <vivid/onnx/onnx_model.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace vivid::onnx;
+namespace fs = std::filesystem;
+
+TEST_CASE("ModelBuffer", "[ml][model]") {
+    fs::path dir = fs::temp_directory_path() / "vivid-onnx-test-buffer";
+    fs::create_directories(dir);
+    const std::string contents = "fake model bytes";
+    const fs::path path = dir / "model.onnx";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << contents;
+    }
+
+    SECTION("maps a file read-only") {
+        auto bytes = ModelBuffer::map(path.string());
+        REQUIRE(bytes);
+        REQUIRE(bytes->isMapped());
+        REQUIRE(bytes->size() == contents.size());
+        REQUIRE(std::memcmp(bytes->data(), contents.data(), contents.size()) == 0);
+        REQUIRE_FALSE(bytes->isOrtFormat());
+    }
+
+    SECTION("missing and empty files don't map") {
+        REQUIRE_FALSE(ModelBuffer::map((dir / "missing.onnx").string()));
+        std::ofstream(dir / "empty.onnx", std::ios::binary).close();
+        REQUIRE_FALSE(ModelBuffer::map((dir / "empty.onnx").string()));
+    }
+
+    SECTION("wraps caller memory without copying") {
+        const char ort[] = "\x10\0\0\0ORTM....";
+        auto bytes = ModelBuffer::wrap(ort, sizeof(ort));
+        REQUIRE(bytes);
+        REQUIRE(bytes->data() == ort);
+        REQUIRE_FALSE(bytes->isMapped());
+        REQUIRE(bytes->isOrtFormat());
+        REQUIRE_FALSE(ModelBuffer::wrap(nullptr, 4));
+    }
+
+    SECTION("ONNXModel takes a buffer in place of a path") {
+        ONNXModel model;
+        model.modelData(contents.data(), contents.size(), "pose");
+        REQUIRE(model.modelPath() == "pose");
+
+        model.modelData(nullptr, 0);
+        REQUIRE(model.modelPath().empty());
+        REQUIRE_FALSE(model.load());
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file test_model_cache.cpp
+ * @brief Unit tests for the optimized-model cache keys and directories
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <vivid/onnx/model_cache.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace vivid::onnx;
+namespace fs = std::filesystem;
+
+static fs::path writeFile(const fs::path& path, const std::string& contents) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+    return path;
+}
+
+TEST_CASE("Model cache keys", "[ml][cache]") {
+    fs::path dir = fs::temp_directory_path() / "vivid-onnx-test-cache";
+    fs::remove_all(dir);
+    std::string model = writeFile(dir / "model.onnx", "fake model bytes").string();
+
+    SECTION("hash is stable and content based") {
+        uint64_t a = hashModelFile(model);
+        REQUIRE(a != 0);
+        REQUIRE(hashModelFile(model) == a);
+
+        writeFile(model, "changed model bytes");
+        REQUIRE(hashModelFile(model) != a);
+    }
+
+    SECTION("in-memory models hash like their files") {
+        const std::string bytes = "fake model bytes";
+        REQUIRE(hashModelBytes(bytes.data(), bytes.size()) == hashModelFile(model));
+
+        // Same size and buffer, other model: another hash
+        std::string other = bytes;
+        other[0] = 'F';
+        REQUIRE(hashModelBytes(other.data(), other.size()) != hashModelFile(model));
+    }
+
+    SECTION("missing file has no key") {
+        REQUIRE(hashModelFile((dir / "missing.onnx").string()) == 0);
+        REQUIRE(modelCacheKey((dir / "missing.onnx").string(), "1.19.2", "CPU").empty());
+    }
+
+    SECTION("key includes stem, ORT version and provider") {
+        std::string key = modelCacheKey(model, "1.19.2", "CUDA");
+        REQUIRE(key.rfind("model-", 0) == 0);
+        REQUIRE(key.find("-ort1.19.2-cuda-ext") != std::string::npos);
+        REQUIRE(key != modelCacheKey(model, "1.20.0", "CUDA"));
+        REQUIRE(key != modelCacheKey(model, "1.19.2", "CPU"));
+    }
+
+    SECTION("cache directory sits next to the model") {
+        fs::path cacheDir = modelCacheDirectory(model);
+        REQUIRE(cacheDir == fs::absolute(dir) / ".vivid-onnx-cache");
+        REQUIRE(fs::is_directory(cacheDir));
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file test_nms.cpp
+ * @brief Unit tests for greedy, weighted and soft non-max suppression
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/nms.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("IoU", "[ml][nms]") {
+    glm::vec4 a(0.0f, 0.0f, 1.0f, 1.0f);
+    REQUIRE_THAT(NonMaxSuppression::iou(a, a), WithinAbs(1.0f, 1e-6));
+    REQUIRE_THAT(NonMaxSuppression::iou(a, glm::vec4(0.5f, 0.0f, 1.0f, 1.0f)), WithinAbs(1.0f / 3.0f, 1e-6));
+    REQUIRE_THAT(NonMaxSuppression::iou(a, glm::vec4(2.0f, 2.0f, 1.0f, 1.0f)), WithinAbs(0.0f, 1e-6));
+    REQUIRE_THAT(NonMaxSuppression::iou(a, glm::vec4(0.0f)), WithinAbs(0.0f, 1e-6));
+}
+
+TEST_CASE("NonMaxSuppression modes", "[ml][nms]") {
+    NonMaxSuppression nms;
+    nms.attributeCount(1);
+
+    // Two overlapping boxes (IoU 0.82) and one on its own; enough boxes for
+    // the vectorized IoU path plus a scalar tail
+    auto fill = [&]() {
+        nms.clear();
+        float a0 = 1.0f, a1 = 3.0f, a2 = 5.0f;
+        nms.add(glm::vec4(0.0f, 0.0f, 0.2f, 0.2f), 0.6f, &a0);
+        nms.add(glm::vec4(0.02f, 0.0f, 0.2f, 0.2f), 0.9f, &a1);
+        nms.add(glm::vec4(0.6f, 0.6f, 0.2f, 0.2f), 0.7f, &a2);
+        for (int i = 0; i < 5; i++) {
+            nms.add(glm::vec4(0.05f * i, 0.9f, 0.01f, 0.01f), 0.1f);
+        }
+    };
+
+    SECTION("greedy keeps the best of each cluster, best first") {
+        fill();
+        REQUIRE(nms.run(10) == 7);
+        REQUIRE(nms.sourceIndex(0) == 1);
+        REQUIRE(nms.sourceIndex(1) == 2);
+        REQUIRE_THAT(nms.score(0), WithinAbs(0.9f, 1e-6));
+        REQUIRE_THAT(nms.attributes(0)[0], WithinAbs(3.0f, 1e-6));
+    }
+
+    SECTION("maxResults limits the output") {
+        fill();
+        REQUIRE(nms.run(2) == 2);
+    }
+
+    SECTION("weighted blends boxes and attributes by score") {
+        fill();
+        nms.mode(NmsMode::Weighted);
+        REQUIRE(nms.run(10) == 7);
+        REQUIRE_THAT(nms.score(0), WithinAbs(0.9f, 1e-6));
+        REQUIRE_THAT(nms.box(0).x, WithinAbs(0.02f * 0.9f / 1.5f, 1e-6));
+        REQUIRE_THAT(nms.attributes(0)[0], WithinAbs((0.6f + 2.7f) / 1.5f, 1e-5));
+    }
+
+    SECTION("soft decays overlapping scores instead of dropping them") {
+        fill();
+        nms.mode(NmsMode::Soft).softSigma(0.5f).minScore(0.01f);
+        REQUIRE(nms.run(10) == 8);
+        REQUIRE(nms.sourceIndex(0) == 1);
+        REQUIRE(nms.sourceIndex(1) == 2);
+
+        // The overlapped box survives with a lower score
+        bool found = false;
+        for (size_t i = 0; i < nms.resultCount(); i++) {
+            if (nms.sourceIndex(i) == 0) {
+                found = true;
+                REQUIRE(nms.score(i) < 0.6f);
+            }
+        }
+        REQUIRE(found);
+    }
+
+    SECTION("empty input") {
+        nms.clear();
+        REQUIRE(nms.run(10) == 0);
+        REQUIRE(nms.resultCount() == 0);
+    }
+}
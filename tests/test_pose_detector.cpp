@@ -6,8 +6,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <vivid/onnx/pose_detector.h>
+#include "fake_backend.h"
+#include "harness.h"
+#include <map>
 
 using namespace vivid::onnx;
+using vivid::onnx::test::FakeBackend;
+using vivid::onnx::test::Harness;
 using Catch::Matchers::WithinAbs;
 
 TEST_CASE("PoseDetector defaults", "[ml][pose]") {
@@ -165,3 +170,228 @@ TEST_CASE("PoseDetector keypoints array access", "[ml][pose]") {
         }
     }
 }
+
+TEST_CASE("PoseDetector multiple sources", "[ml][pose]") {
+    PoseDetector detector;
+    std::vector<vivid::Operator*> sources = {nullptr, nullptr, nullptr};
+
+    SECTION("inputs returns self and sets the source count") {
+        PoseDetector& ref = detector.inputs(sources);
+        REQUIRE(&ref == &detector);
+        REQUIRE(detector.sourceCount() == 3);
+    }
+
+    SECTION("not batched before a model is loaded") {
+        detector.inputs(sources);
+        REQUIRE(detector.isBatched() == false);
+    }
+
+    SECTION("per-source results start empty") {
+        detector.inputs(sources);
+        for (size_t s = 0; s < 3; s++) {
+            REQUIRE(detector.detected(s) == false);
+            REQUIRE_THAT(detector.keypoints(s)[0].z, WithinAbs(0.0f, 0.001f));
+        }
+    }
+
+    SECTION("out-of-range source is not detected") {
+        detector.inputs(sources);
+        REQUIRE(detector.detected(7) == false);
+    }
+}
+
+TEST_CASE("PoseDetector ROI tracking", "[ml][pose]") {
+    PoseDetector detector;
+
+    SECTION("tracking returns self and is off by default") {
+        REQUIRE(detector.isTracking() == false);
+        PoseDetector& ref = detector.tracking(true);
+        REQUIRE(&ref == &detector);
+        REQUIRE(detector.isTracking() == true);
+    }
+
+    SECTION("crop region defaults to the full frame") {
+        REQUIRE(detector.cropRegion() == SourceRect{});
+    }
+
+    SECTION("no torso falls back to the full frame") {
+        std::array<glm::vec3, 17> keypoints{};
+        REQUIRE(PoseDetector::cropRegionFor(keypoints, 640, 480) == SourceRect{});
+    }
+
+    SECTION("small pose gets a square crop around the hips") {
+        // Figure in the left half of a 1280x720 frame, hips at (320, 400)
+        std::array<glm::vec3, 17> keypoints{};
+        auto set = [&](Keypoint kp, float px, float py) {
+            keypoints[static_cast<int>(kp)] = glm::vec3(px / 1280.0f, py / 720.0f, 0.9f);
+        };
+        set(Keypoint::LeftShoulder, 340, 300);
+        set(Keypoint::RightShoulder, 300, 300);
+        set(Keypoint::LeftHip, 335, 400);
+        set(Keypoint::RightHip, 305, 400);
+
+        SourceRect crop = PoseDetector::cropRegionFor(keypoints, 1280, 720);
+        // Torso range 100px * 1.9 -> 190px half-size
+        REQUIRE_THAT(crop.width * 1280.0f, WithinAbs(380.0f, 0.5f));
+        REQUIRE_THAT(crop.height * 720.0f, WithinAbs(380.0f, 0.5f));
+        REQUIRE_THAT(crop.x * 1280.0f, WithinAbs(130.0f, 0.5f));
+        REQUIRE_THAT(crop.y * 720.0f, WithinAbs(210.0f, 0.5f));
+    }
+}
+
+// MoveNet multipose record: 17 x (y, x, conf), then ymin, xmin, ymax, xmax, score
+static void setPerson(Tensor& t, int slot, float x, float y, float conf, float score) {
+    float* det = &t[slot * 56];
+    for (int i = 0; i < 17; i++) {
+        det[i * 3 + 0] = y + 0.01f * i;
+        det[i * 3 + 1] = x;
+        det[i * 3 + 2] = conf;
+    }
+    det[51] = y;
+    det[52] = x - 0.05f;
+    det[53] = y + 0.3f;
+    det[54] = x + 0.05f;
+    det[55] = score;
+}
+
+TEST_CASE("PoseDetector multi-person output", "[ml][pose]") {
+    Harness<PoseDetector> detector;
+
+    SECTION("multipose reports every person, best first") {
+        Tensor t;
+        t.shape = {1, 6, 56};
+        resizeStorage(t);
+        setPerson(t, 0, 0.2f, 0.1f, 0.8f, 0.6f);
+        setPerson(t, 3, 0.7f, 0.2f, 0.9f, 0.9f);
+        detector.decode(t);
+
+        REQUIRE(detector.poseCount() == 2);
+        REQUIRE_THAT(detector.pose(0).score, WithinAbs(0.9f, 1e-6));
+        REQUIRE_THAT(detector.pose(0).keypoints[0].x, WithinAbs(0.7f, 1e-6));
+        REQUIRE_THAT(detector.pose(0).bbox.x, WithinAbs(0.65f, 1e-6));
+        REQUIRE_THAT(detector.pose(0).bbox.w, WithinAbs(0.3f, 1e-6));
+        REQUIRE_THAT(detector.pose(1).score, WithinAbs(0.6f, 1e-6));
+
+        // Single-pose accessors report the best person
+        REQUIRE(detector.detected());
+        REQUIRE_THAT(detector.keypoint(Keypoint::Nose).x, WithinAbs(0.7f, 1e-6));
+    }
+
+    SECTION("singlepose reports at most one") {
+        Tensor t;
+        t.shape = {1, 1, 17, 3};
+        resizeStorage(t);
+        for (int i = 0; i < 17; i++) {
+            t[i * 3 + 0] = 0.5f;
+            t[i * 3 + 1] = 0.25f + 0.01f * i;
+            t[i * 3 + 2] = 0.9f;
+        }
+        detector.decode(t);
+
+        REQUIRE(detector.poseCount() == 1);
+        REQUIRE_THAT(detector.pose(0).score, WithinAbs(0.9f, 1e-5));
+        REQUIRE_THAT(detector.pose(0).bbox.x, WithinAbs(0.25f, 1e-6));
+        REQUIRE(detector.poses(5).empty());
+    }
+
+    SECTION("out-of-range pose is empty") {
+        REQUIRE(detector.poseCount() == 0);
+        REQUIRE_THAT(detector.pose(3).score, WithinAbs(0.0f, 1e-6));
+    }
+}
+
+TEST_CASE("PoseDetector smoothing", "[ml][pose]") {
+    Harness<PoseDetector> detector;
+    Tensor t;
+    t.shape = {1, 6, 56};
+    resizeStorage(t);
+    setPerson(t, 0, 0.2f, 0.1f, 0.8f, 0.6f);
+    setPerson(t, 1, 0.7f, 0.2f, 0.9f, 0.9f);
+
+    REQUIRE(&detector.smoothing(true) == &detector);
+    detector.decode(t);
+    REQUIRE(detector.poseCount() == 2);
+    int first = detector.pose(0).id;
+    int second = detector.pose(1).id;
+    REQUIRE(first != second);
+
+    // Scores swap, so the order does; IDs follow the people
+    t[0 * 56 + 55] = 0.95f;
+    detector.decode(t);
+    REQUIRE(detector.poseCount() == 2);
+    REQUIRE(detector.pose(0).id == second);
+    REQUIRE(detector.pose(1).id == first);
+}
+
+TEST_CASE("PoseDetector input resolution", "[ml][pose]") {
+    Harness<PoseDetector> detector;
+
+    SECTION("dynamic-size models default to 256x256") {
+        detector.fakeLoad({1, 1, 1, 3}, {1, 6, 56}, true);
+        REQUIRE(detector.inputWidth() == 256);
+        REQUIRE(detector.inputHeight() == 256);
+        REQUIRE(detector.inputShape(0) == std::vector<int64_t>{1, 256, 256, 3});
+    }
+
+    SECTION("requested size is rounded to multiples of 32") {
+        detector.inputResolution(300, 200);
+        detector.fakeLoad({1, 1, 1, 3}, {1, 6, 56}, true);
+        REQUIRE(detector.inputWidth() == 288);
+        REQUIRE(detector.inputHeight() == 192);
+
+        // Changes apply at runtime too
+        detector.inputResolution(480, 480);
+        REQUIRE(detector.inputWidth() == 480);
+        REQUIRE(detector.inputShape(0)[1] == 480);
+    }
+
+    SECTION("fixed-size models keep their own size") {
+        detector.inputResolution(320, 320).latencyBudget(5.0f);
+        detector.fakeLoad({1, 192, 192, 3}, {1, 6, 56}, false);
+        REQUIRE(detector.inputWidth() == 192);
+        detector.inputResolution(256, 256);
+        REQUIRE(detector.inputWidth() == 192);
+    }
+}
+
+TEST_CASE("PoseDetector maps pipelined results with their own frame's crop", "[ml][pose][async]") {
+    std::atomic<int> runs{0};
+    Harness<PoseDetector> detector;
+    detector.model("fake.onnx");
+    detector.backend(std::make_unique<FakeBackend>(&runs, 5));
+    detector.async(true).pipelineDepth(3);
+    REQUIRE(detector.load());
+
+    vivid::io::ImageData frame;
+    frame.width = 64;
+    frame.height = 48;
+    frame.pixels.assign(64 * 48 * 4, 128);
+
+    // The crop moves every frame, like tracking(true) following a person;
+    // the fake model always finds the keypoints at the input center
+    std::map<int64_t, SourceRect> crops;
+    int64_t lastResult = -1;
+    int checked = 0;
+    for (int i = 0; i < 400 && checked < 8; i++) {
+        SourceRect crop;
+        crop.x = 0.02f * static_cast<float>(i % 20);
+        crop.y = 0.01f * static_cast<float>(i % 10);
+        crop.width = 0.5f;
+        crop.height = 0.6f;
+        detector.step(frame, crop);
+        crops[detector.submitted()] = crop;
+
+        const int64_t result = detector.result();
+        if (result != lastResult) {
+            REQUIRE(result > lastResult);
+            const SourceRect& ran = crops.at(result);
+            REQUIRE(detector.cropRegion() == ran);
+            REQUIRE_THAT(detector.keypoint(0).x, WithinAbs(ran.x + 0.5f * ran.width, 1e-3f));
+            REQUIRE_THAT(detector.keypoint(0).y, WithinAbs(ran.y + 0.5f * ran.height, 1e-3f));
+            lastResult = result;
+            checked++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(checked == 8);
+}
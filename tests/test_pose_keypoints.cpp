@@ -0,0 +1,134 @@
+/**
+ * @file test_pose_keypoints.cpp
+ * @brief Unit tests for the keypoint buffer and the MoveNet keypoint decode
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/pose_keypoints.h>
+#include <vivid/onnx/pose_detector.h>
+#include "harness.h"
+
+using namespace vivid::onnx;
+using vivid::onnx::test::Harness;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+// 17 (y, x, confidence) triplets with distinct values per keypoint
+void fillTriplets(float* t) {
+    for (int i = 0; i < 17; i++) {
+        t[i * 3 + 0] = 0.02f + 0.05f * i;
+        t[i * 3 + 1] = 0.9f - 0.04f * i;
+        t[i * 3 + 2] = (i % 3 == 0) ? 0.1f : 0.2f + 0.04f * i;
+    }
+}
+
+} // namespace
+
+TEST_CASE("PoseKeypoints storage", "[ml][pose]") {
+    PoseKeypoints kps;
+    REQUIRE(kps.empty());
+
+    kps.reserve(6);
+    REQUIRE(kps.capacity() == 6);
+    REQUIRE(kps.count() == 0);
+
+    kps.resize(2);
+    REQUIRE(kps.count() == 2);
+    REQUIRE(kps.y(1) == kps.block(1) + PoseKeypoints::kStride);
+    REQUIRE(kps.confidence(1) == kps.block(1) + 2 * PoseKeypoints::kStride);
+
+    kps.block(1)[3] = 0.5f;
+    kps.block(1)[PoseKeypoints::kStride + 3] = 0.25f;
+    REQUIRE_THAT(kps.at(1, 3).x, WithinAbs(0.5f, 1e-6));
+    REQUIRE_THAT(kps.at(1, 3).y, WithinAbs(0.25f, 1e-6));
+
+    // Growing keeps existing blocks
+    kps.resize(9);
+    REQUIRE(kps.capacity() == 9);
+    REQUIRE_THAT(kps.at(1, 3).x, WithinAbs(0.5f, 1e-6));
+    REQUIRE_THAT(kps.at(8, 0).z, WithinAbs(0.0f, 1e-6));
+
+    kps.clear();
+    REQUIRE(kps.empty());
+    REQUIRE(kps.capacity() == 9);
+}
+
+TEST_CASE("MoveNet keypoint decode", "[ml][pose]") {
+    float triplets[51];
+    fillTriplets(triplets);
+    SourceRect region{0.1f, 0.2f, 0.5f, 0.25f};
+
+    float block[PoseKeypoints::kBlock];
+    for (float& v : block) v = -1.0f;
+
+    SECTION("matches the scalar mapping, count and sum") {
+        const float threshold = 0.5f;
+        KeypointSummary s = decodeMoveNetKeypoints(triplets, region, threshold, block);
+
+        int above = 0;
+        float sum = 0.0f;
+        for (int i = 0; i < 17; i++) {
+            REQUIRE_THAT(block[i], WithinAbs(0.1f + 0.5f * triplets[i * 3 + 1], 1e-6));
+            REQUIRE_THAT(block[PoseKeypoints::kStride + i], WithinAbs(0.2f + 0.25f * triplets[i * 3], 1e-6));
+            REQUIRE(block[2 * PoseKeypoints::kStride + i] == triplets[i * 3 + 2]);
+            above += triplets[i * 3 + 2] >= threshold ? 1 : 0;
+            sum += triplets[i * 3 + 2];
+        }
+        REQUIRE(s.aboveThreshold == above);
+        REQUIRE_THAT(s.confidenceSum, WithinAbs(sum, 1e-5));
+
+        // Padding is zeroed
+        for (int i = 17; i < PoseKeypoints::kStride; i++) {
+            REQUIRE(block[i] == 0.0f);
+            REQUIRE(block[PoseKeypoints::kStride + i] == 0.0f);
+            REQUIRE(block[2 * PoseKeypoints::kStride + i] == 0.0f);
+        }
+    }
+
+    SECTION("threshold bounds are inclusive") {
+        REQUIRE(decodeMoveNetKeypoints(triplets, region, 0.0f, block).aboveThreshold == 17);
+        REQUIRE(decodeMoveNetKeypoints(triplets, region, 2.0f, block).aboveThreshold == 0);
+        // Keypoint 16 (scalar tail) sits exactly on the threshold
+        REQUIRE(decodeMoveNetKeypoints(triplets, region, triplets[16 * 3 + 2], block).aboveThreshold == 1);
+    }
+}
+
+TEST_CASE("PoseDetector keypoint buffer", "[ml][pose]") {
+    Harness<PoseDetector> detector;
+    REQUIRE(detector.poseKeypoints().empty());
+    REQUIRE(detector.poseKeypoints(4).empty());
+
+    Tensor t;
+    t.shape = {1, 6, 56};
+    resizeStorage(t);
+    for (int slot : {1, 4}) {
+        float* det = &t[slot * 56];
+        for (int i = 0; i < 17; i++) {
+            det[i * 3 + 0] = 0.1f * slot + 0.01f * i;
+            det[i * 3 + 1] = 0.15f * slot;
+            det[i * 3 + 2] = 0.9f;
+        }
+        det[51] = 0.1f * slot;
+        det[52] = 0.15f * slot - 0.05f;
+        det[53] = 0.1f * slot + 0.3f;
+        det[54] = 0.15f * slot + 0.05f;
+        det[55] = 0.1f * slot;
+    }
+    detector.decode(t);
+
+    // Same people, same order as pose(i)
+    const PoseKeypoints& kps = detector.poseKeypoints();
+    REQUIRE(kps.count() == 2);
+    for (size_t p = 0; p < kps.count(); p++) {
+        const DetectedPose& person = detector.pose(static_cast<int>(p));
+        for (int i = 0; i < 17; i++) {
+            REQUIRE(kps.x(p)[i] == person.keypoints[i].x);
+            REQUIRE(kps.y(p)[i] == person.keypoints[i].y);
+            REQUIRE(kps.confidence(p)[i] == person.keypoints[i].z);
+        }
+    }
+    REQUIRE_THAT(kps.x(0)[0], WithinAbs(0.6f, 1e-6));
+    REQUIRE_THAT(kps.y(1)[2], WithinAbs(0.12f, 1e-6));
+}
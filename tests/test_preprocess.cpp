@@ -0,0 +1,255 @@
+/**
+ * @file test_preprocess.cpp
+ * @brief Unit tests for the fused resize/convert/normalize kernel
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/preprocess.h>
+#include <vivid/onnx/gpu_preprocess.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+// Solid BGRA image
+static vivid::io::ImageData makeSolid(int w, int h, uint8_t b, uint8_t g, uint8_t r, uint8_t a = 255) {
+    vivid::io::ImageData img;
+    img.width = w;
+    img.height = h;
+    img.channels = 4;
+    img.pixels.resize(static_cast<size_t>(w) * h * 4);
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        img.pixels[i + 0] = b;
+        img.pixels[i + 1] = g;
+        img.pixels[i + 2] = r;
+        img.pixels[i + 3] = a;
+    }
+    return img;
+}
+
+static Tensor makeTensor(std::vector<int64_t> shape, TensorType type) {
+    Tensor t;
+    t.shape = shape;
+    t.type = type;
+    resizeStorage(t);
+    return t;
+}
+
+TEST_CASE("Layout detection", "[ml][preprocess]") {
+    int channels = 0;
+
+    SECTION("NHWC") {
+        REQUIRE(detectLayout({1, 192, 192, 3}, &channels) == TensorLayout::NHWC);
+        REQUIRE(channels == 3);
+    }
+
+    SECTION("NCHW") {
+        REQUIRE(detectLayout({1, 3, 224, 224}, &channels) == TensorLayout::NCHW);
+        REQUIRE(channels == 3);
+    }
+
+    SECTION("tiny images prefer NHWC") {
+        REQUIRE(detectLayout({1, 1, 4, 3}, &channels) == TensorLayout::NHWC);
+        REQUIRE(channels == 3);
+    }
+}
+
+TEST_CASE("ImageResampler color conversion", "[ml][preprocess]") {
+    ImageResampler resampler;
+    auto img = makeSolid(64, 48, 10, 20, 30);  // B=10, G=20, R=30
+
+    SECTION("BGRA to RGB float NHWC with unit normalization") {
+        auto t = makeTensor({1, 8, 8, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 8, 8));
+        REQUIRE_THAT(t[0], WithinAbs(30.0f / 255.0f, 1e-5));
+        REQUIRE_THAT(t[1], WithinAbs(20.0f / 255.0f, 1e-5));
+        REQUIRE_THAT(t[2], WithinAbs(10.0f / 255.0f, 1e-5));
+    }
+
+    SECTION("NCHW writes channel planes") {
+        auto t = makeTensor({1, 3, 8, 8}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 8, 8, Normalization::raw()));
+        REQUIRE_THAT(t[0], WithinAbs(30.0f, 1e-4));
+        REQUIRE_THAT(t[64], WithinAbs(20.0f, 1e-4));
+        REQUIRE_THAT(t[128], WithinAbs(10.0f, 1e-4));
+    }
+
+    SECTION("signed unit normalization maps to [-1, 1]") {
+        auto black = makeSolid(16, 16, 0, 0, 0);
+        auto white = makeSolid(16, 16, 255, 255, 255);
+        auto t = makeTensor({1, 4, 4, 3}, TensorType::Float32);
+
+        REQUIRE(resampler.resample(black, t, 4, 4, Normalization::signedUnit()));
+        REQUIRE_THAT(t[0], WithinAbs(-1.0f, 1e-5));
+        REQUIRE(resampler.resample(white, t, 4, 4, Normalization::signedUnit()));
+        REQUIRE_THAT(t[0], WithinAbs(1.0f, 1e-5));
+    }
+
+    SECTION("integer tensors get raw values") {
+        auto u8 = makeTensor({1, 8, 8, 3}, TensorType::UInt8);
+        REQUIRE(resampler.resample(img, u8, 8, 8, Normalization::signedUnit()));
+        REQUIRE(u8.as<uint8_t>()[0] == 30);
+        REQUIRE(u8.as<uint8_t>()[2] == 10);
+
+        auto i32 = makeTensor({1, 8, 8, 3}, TensorType::Int32);
+        REQUIRE(resampler.resample(img, i32, 8, 8));
+        REQUIRE(i32.as<int32_t>()[1] == 20);
+
+        auto i64 = makeTensor({1, 8, 8, 3}, TensorType::Int64);
+        REQUIRE(resampler.resample(img, i64, 8, 8));
+        REQUIRE(i64.as<int64_t>()[0] == 30);
+    }
+
+    SECTION("int8 tensors are shifted by -128") {
+        auto i8 = makeTensor({1, 8, 8, 3}, TensorType::Int8);
+        REQUIRE(resampler.resample(img, i8, 8, 8));
+        REQUIRE(i8.as<int8_t>()[0] == 30 - 128);
+        REQUIRE(i8.as<int8_t>()[2] == 10 - 128);
+    }
+
+    SECTION("float16 tensors are normalized") {
+        auto f16 = makeTensor({1, 3, 8, 8}, TensorType::Float16);
+        REQUIRE(resampler.resample(img, f16, 8, 8, Normalization::signedUnit()));
+        REQUIRE_THAT(halfToFloat(f16.as<uint16_t>()[0]), WithinAbs(30.0f / 127.5f - 1.0f, 1e-3));
+        REQUIRE_THAT(halfToFloat(f16.as<uint16_t>()[128]), WithinAbs(10.0f / 127.5f - 1.0f, 1e-3));
+    }
+}
+
+TEST_CASE("ImageResampler bilinear resize", "[ml][preprocess]") {
+    ImageResampler resampler;
+
+    // 4x1 horizontal ramp, red channel 0, 100, 200, 250
+    vivid::io::ImageData img;
+    img.width = 4;
+    img.height = 1;
+    img.channels = 4;
+    img.pixels = {0, 0, 0, 255,  0, 0, 100, 255,  0, 0, 200, 255,  0, 0, 250, 255};
+
+    SECTION("same size is exact") {
+        auto t = makeTensor({1, 1, 4, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 4, 1, Normalization::raw()));
+        REQUIRE_THAT(t[0 * 3], WithinAbs(0.0f, 1e-4));
+        REQUIRE_THAT(t[1 * 3], WithinAbs(100.0f, 1e-4));
+        REQUIRE_THAT(t[3 * 3], WithinAbs(250.0f, 1e-4));
+    }
+
+    SECTION("2x downscale averages neighbours") {
+        auto t = makeTensor({1, 1, 2, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 2, 1, Normalization::raw()));
+        REQUIRE_THAT(t[0], WithinAbs(50.0f, 1e-4));
+        REQUIRE_THAT(t[3], WithinAbs(225.0f, 1e-4));
+    }
+
+    SECTION("3-channel source uses the generic path") {
+        vivid::io::ImageData bgr;
+        bgr.width = 2;
+        bgr.height = 1;
+        bgr.channels = 3;
+        bgr.pixels = {0, 0, 0,  0, 0, 200};
+        auto t = makeTensor({1, 1, 1, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(bgr, t, 1, 1, Normalization::raw()));
+        REQUIRE_THAT(t[0], WithinAbs(100.0f, 1e-4));
+    }
+
+    SECTION("undersized tensor is rejected") {
+        auto t = makeTensor({1, 1, 1, 3}, TensorType::Float32);
+        REQUIRE_FALSE(resampler.resample(img, t, 4, 1));
+    }
+}
+
+TEST_CASE("GpuResampler without a device", "[ml][preprocess]") {
+    GpuResampler gpu;
+    auto t = makeTensor({1, 8, 8, 3}, TensorType::Float32);
+
+    // No device/texture: caller must fall back to the CPU path
+    REQUIRE_FALSE(gpu.resample(nullptr, nullptr, nullptr, t, 8, 8));
+    REQUIRE_FALSE(gpu.failed());
+}
+
+TEST_CASE("ImageResampler source region", "[ml][preprocess]") {
+    ImageResampler resampler;
+
+    // 4x1 horizontal ramp, red channel 0, 100, 200, 250
+    vivid::io::ImageData img;
+    img.width = 4;
+    img.height = 1;
+    img.channels = 4;
+    img.pixels = {0, 0, 0, 255,  0, 0, 100, 255,  0, 0, 200, 255,  0, 0, 250, 255};
+
+    SECTION("right half crop samples only that half") {
+        SourceRect right;
+        right.x = 0.5f;
+        right.width = 0.5f;
+        auto t = makeTensor({1, 1, 2, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 2, 1, Normalization::raw(), right));
+        REQUIRE_THAT(t[0], WithinAbs(200.0f, 1e-4));
+        REQUIRE_THAT(t[3], WithinAbs(250.0f, 1e-4));
+    }
+
+    SECTION("region past the edge repeats border pixels") {
+        SourceRect past;
+        past.x = 1.0f;
+        past.width = 0.5f;
+        auto t = makeTensor({1, 1, 2, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 2, 1, Normalization::raw(), past));
+        REQUIRE_THAT(t[0], WithinAbs(250.0f, 1e-4));
+    }
+
+    SECTION("empty region is rejected") {
+        SourceRect empty;
+        empty.width = 0.0f;
+        auto t = makeTensor({1, 1, 2, 3}, TensorType::Float32);
+        REQUIRE_FALSE(resampler.resample(img, t, 2, 1, Normalization::raw(), empty));
+    }
+}
+
+TEST_CASE("ImageResampler aspect modes", "[ml][preprocess]") {
+    ImageResampler resampler;
+
+    SECTION("fit letterboxes a wide source") {
+        AspectLayout fit = aspectLayout(AspectMode::Fit, SourceRect{}, 8, 4, 4, 4);
+        REQUIRE(fit.contentX == 0);
+        REQUIRE(fit.contentY == 1);
+        REQUIRE(fit.contentWidth == 4);
+        REQUIRE(fit.contentHeight == 2);
+        REQUIRE_THAT(fit.region.y, WithinAbs(-0.5f, 1e-5));
+        REQUIRE_THAT(fit.region.height, WithinAbs(2.0f, 1e-5));
+    }
+
+    SECTION("fill crops a wide source") {
+        AspectLayout fill = aspectLayout(AspectMode::Fill, SourceRect{}, 8, 4, 4, 4);
+        REQUIRE(fill.contentWidth == 4);
+        REQUIRE(fill.contentHeight == 4);
+        REQUIRE_THAT(fill.region.x, WithinAbs(0.25f, 1e-5));
+        REQUIRE_THAT(fill.region.width, WithinAbs(0.5f, 1e-5));
+        REQUIRE_THAT(fill.region.height, WithinAbs(1.0f, 1e-5));
+    }
+
+    SECTION("fit pads with the normalized zero") {
+        auto img = makeSolid(8, 4, 0, 0, 200);
+        auto t = makeTensor({1, 4, 4, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 4, 4, Normalization::raw(), SourceRect{}, AspectMode::Fit));
+        REQUIRE_THAT(t[0], WithinAbs(0.0f, 1e-4));                 // row 0: padding
+        REQUIRE_THAT(t[(1 * 4 + 0) * 3], WithinAbs(200.0f, 1e-4));  // row 1: content
+        REQUIRE_THAT(t[(2 * 4 + 3) * 3], WithinAbs(200.0f, 1e-4));  // row 2: content
+        REQUIRE_THAT(t[(3 * 4 + 3) * 3], WithinAbs(0.0f, 1e-4));    // row 3: padding
+
+        REQUIRE(resampler.resample(img, t, 4, 4, Normalization::signedUnit(), SourceRect{}, AspectMode::Fit));
+        REQUIRE_THAT(t[0], WithinAbs(-1.0f, 1e-5));
+        REQUIRE(resampler.layout().contentY == 1);
+    }
+
+    SECTION("fill samples the center") {
+        // 4x2 ramp, red channel 0, 100, 200, 250 on both rows
+        vivid::io::ImageData img;
+        img.width = 4;
+        img.height = 2;
+        img.channels = 4;
+        img.pixels = {0, 0, 0, 255,  0, 0, 100, 255,  0, 0, 200, 255,  0, 0, 250, 255,
+                      0, 0, 0, 255,  0, 0, 100, 255,  0, 0, 200, 255,  0, 0, 250, 255};
+        auto t = makeTensor({1, 2, 2, 3}, TensorType::Float32);
+        REQUIRE(resampler.resample(img, t, 2, 2, Normalization::raw(), SourceRect{}, AspectMode::Fill));
+        REQUIRE_THAT(t[0], WithinAbs(100.0f, 1e-4));
+        REQUIRE_THAT(t[3], WithinAbs(200.0f, 1e-4));
+    }
+}
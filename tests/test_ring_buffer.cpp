@@ -0,0 +1,56 @@
+/**
+ * @file test_ring_buffer.cpp
+ * @brief Unit tests for SpscRing
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <vivid/onnx/ring_buffer.h>
+#include <thread>
+
+using namespace vivid::onnx;
+
+TEST_CASE("SpscRing", "[ml][pipeline]") {
+    SECTION("fifo up to capacity") {
+        SpscRing<int> ring(3);
+        REQUIRE(ring.capacity() == 3);
+        REQUIRE(ring.empty());
+
+        REQUIRE(ring.push(1));
+        REQUIRE(ring.push(2));
+        REQUIRE(ring.push(3));
+        REQUIRE_FALSE(ring.push(4));
+        REQUIRE(ring.size() == 3);
+
+        int value = 0;
+        REQUIRE(ring.pop(value));
+        REQUIRE(value == 1);
+        REQUIRE(ring.push(4));  // wraps around
+        for (int expected : {2, 3, 4}) {
+            REQUIRE(ring.pop(value));
+            REQUIRE(value == expected);
+        }
+        REQUIRE_FALSE(ring.pop(value));
+    }
+
+    SECTION("one producer and one consumer thread keep order") {
+        SpscRing<int> ring(4);
+        constexpr int kCount = 100000;
+
+        std::thread producer([&ring]() {
+            for (int i = 0; i < kCount; i++) {
+                while (!ring.push(i)) std::this_thread::yield();
+            }
+        });
+
+        bool ordered = true;
+        int value = 0;
+        for (int expected = 0; expected < kCount; expected++) {
+            while (!ring.pop(value)) std::this_thread::yield();
+            ordered = ordered && value == expected;
+        }
+        producer.join();
+
+        REQUIRE(ordered);
+        REQUIRE(ring.empty());
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file test_run_policy.cpp
+ * @brief Unit tests for new-frame and change detection used by the run policy
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/run_policy.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+static vivid::io::ImageData makeGray(int w, int h, uint8_t value) {
+    vivid::io::ImageData img;
+    img.width = w;
+    img.height = h;
+    img.channels = 4;
+    img.pixels.assign(static_cast<size_t>(w) * h * 4, value);
+    return img;
+}
+
+TEST_CASE("Frame signature", "[ml][schedule]") {
+    auto a = makeGray(64, 48, 100);
+    auto b = makeGray(64, 48, 100);
+
+    REQUIRE(FrameChangeDetector::signature(a) == FrameChangeDetector::signature(b));
+
+    b.pixels[(27 * 64 + 36) * 4] = 101;  // a sampled pixel
+    REQUIRE(FrameChangeDetector::signature(a) != FrameChangeDetector::signature(b));
+
+    REQUIRE(FrameChangeDetector::signature(makeGray(32, 48, 100)) != FrameChangeDetector::signature(a));
+}
+
+TEST_CASE("Frame change detection", "[ml][schedule]") {
+    FrameChangeDetector detector;
+    auto dark = makeGray(64, 48, 0);
+    auto bright = makeGray(64, 48, 255);
+
+    SECTION("no reference counts as fully changed") {
+        REQUIRE_THAT(detector.difference(dark), WithinAbs(1.0f, 1e-6));
+    }
+
+    SECTION("difference is measured against the committed frame") {
+        detector.difference(dark);
+        detector.commit();
+        REQUIRE_THAT(detector.difference(dark), WithinAbs(0.0f, 1e-6));
+        REQUIRE_THAT(detector.difference(bright), WithinAbs(1.0f, 1e-2));
+
+        // Not committed: the reference is still the dark frame
+        REQUIRE_THAT(detector.difference(dark), WithinAbs(0.0f, 1e-6));
+    }
+
+    SECTION("reset drops the reference") {
+        detector.difference(dark);
+        detector.commit();
+        detector.reset();
+        REQUIRE_THAT(detector.difference(dark), WithinAbs(1.0f, 1e-6));
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_scheduler.cpp
+ * @brief Tests for the shared inference scheduler
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <vivid/onnx/scheduler.h>
+#include <vivid/onnx/onnx_model.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace vivid::onnx;
+
+namespace {
+
+SchedulePolicy policy(int priority, float targetHz = 0.0f, float budgetMs = 0.0f) {
+    SchedulePolicy p;
+    p.priority = priority;
+    p.targetHz = targetHz;
+    p.latencyBudgetMs = budgetMs;
+    return p;
+}
+
+// Poll until the client has completed `count` runs (false on timeout)
+bool waitCompleted(const InferenceScheduler& scheduler, int client, uint64_t count) {
+    for (int i = 0; i < 2000; i++) {
+        if (scheduler.stats(client).completed >= count) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST_CASE("InferenceScheduler runs higher priorities first", "[ml][scheduler]") {
+    InferenceScheduler scheduler(1);
+    const int blocker = scheduler.registerClient("blocker", policy(0));
+    const int low = scheduler.registerClient("low", policy(0));
+    const int high = scheduler.registerClient("high", policy(10));
+
+    // Hold the only worker while both runs queue up
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    scheduler.submit(blocker, [released]() { released.wait(); });
+
+    std::mutex mutex;
+    std::vector<int> order;
+    scheduler.submit(low, [&]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(low); });
+    scheduler.submit(high, [&]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(high); });
+    release.set_value();
+
+    REQUIRE(waitCompleted(scheduler, low, 1));
+    REQUIRE(waitCompleted(scheduler, high, 1));
+    REQUIRE(order == std::vector<int>{high, low});
+}
+
+TEST_CASE("InferenceScheduler never overlaps runs of one client", "[ml][scheduler]") {
+    InferenceScheduler scheduler(4);
+    const int client = scheduler.registerClient("model", policy(0));
+
+    std::atomic<int> active{0};
+    std::atomic<int> maxActive{0};
+    for (int i = 0; i < 8; i++) {
+        scheduler.submit(client, [&]() {
+            int now = ++active;
+            maxActive = std::max(maxActive.load(), now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            --active;
+        });
+    }
+
+    REQUIRE(waitCompleted(scheduler, client, 8));
+    REQUIRE(maxActive == 1);
+    REQUIRE(scheduler.stats(client).submitted == 8);
+}
+
+TEST_CASE("InferenceScheduler spaces runs at the target rate", "[ml][scheduler]") {
+    InferenceScheduler scheduler(1);
+    const int client = scheduler.registerClient("model", policy(0, 10.0f));
+
+    REQUIRE(scheduler.admit(client) == Admission::Run);
+    scheduler.submit(client, []() {});
+    REQUIRE(scheduler.admit(client) == Admission::NotDue);
+
+    // Policy changes start a new schedule
+    scheduler.updatePolicy(client, policy(0));
+    REQUIRE(scheduler.admit(client) == Admission::Run);
+}
+
+TEST_CASE("InferenceScheduler sheds lower priorities while a budget is missed", "[ml][scheduler]") {
+    InferenceScheduler scheduler(1);
+    const int high = scheduler.registerClient("high", policy(10, 0.0f, 2.0f));
+    const int peer = scheduler.registerClient("peer", policy(10));
+    const int low = scheduler.registerClient("low", policy(0));
+
+    // A run far over the 2 ms budget
+    scheduler.submit(high, []() { std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+    REQUIRE(waitCompleted(scheduler, high, 1));
+
+    ScheduleStats s = scheduler.stats(high);
+    REQUIRE(s.overBudget);
+    REQUIRE(s.deadlineMisses == 1);
+    REQUIRE(scheduler.admit(low) == Admission::Shed);
+    REQUIRE(scheduler.admit(peer) == Admission::Run);   // same priority isn't shed
+    REQUIRE(scheduler.admit(high) == Admission::Run);
+
+    scheduler.countShed(low);
+    REQUIRE(scheduler.stats(low).shed == 1);
+
+    // Fast runs bring the smoothed latency back under budget
+    for (uint64_t i = 2; i < 40 && scheduler.stats(high).overBudget; i++) {
+        scheduler.submit(high, []() {});
+        REQUIRE(waitCompleted(scheduler, high, i));
+    }
+    REQUIRE_FALSE(scheduler.stats(high).overBudget);
+    REQUIRE(scheduler.admit(low) == Admission::Run);
+}
+
+TEST_CASE("InferenceScheduler stops shedding for a client that went idle", "[ml][scheduler]") {
+    InferenceScheduler scheduler(1);
+    const int high = scheduler.registerClient("high", policy(10, 0.0f, 2.0f));
+    const int low = scheduler.registerClient("low", policy(0));
+
+    scheduler.submit(high, []() { std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+    REQUIRE(waitCompleted(scheduler, high, 1));
+    REQUIRE(scheduler.admit(low) == Admission::Shed);
+
+    // No more runs from high: the stale flag must not shed low forever
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    REQUIRE_FALSE(scheduler.stats(high).overBudget);
+    REQUIRE(scheduler.admit(low) == Admission::Run);
+
+    // Coming back fast starts from a fresh average, not the old slow one
+    scheduler.submit(high, []() {});
+    REQUIRE(waitCompleted(scheduler, high, 2));
+    REQUIRE_FALSE(scheduler.stats(high).overBudget);
+    REQUIRE(scheduler.admit(low) == Admission::Run);
+}
+
+TEST_CASE("InferenceScheduler unregister drops waiting runs", "[ml][scheduler]") {
+    InferenceScheduler scheduler(1);
+    const int blocker = scheduler.registerClient("blocker", policy(0));
+    const int client = scheduler.registerClient("model", policy(0));
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    scheduler.submit(blocker, [released]() { released.wait(); });
+
+    std::atomic<bool> ran{false};
+    scheduler.submit(client, [&ran]() { ran = true; });
+    scheduler.unregisterClient(client);
+    REQUIRE(scheduler.clientCount() == 1);
+
+    release.set_value();
+    REQUIRE(waitCompleted(scheduler, blocker, 1));
+    REQUIRE_FALSE(ran);
+}
+
+TEST_CASE("ONNXModel schedule configuration", "[ml][scheduler]") {
+    ONNXModel model;
+    REQUIRE_FALSE(model.isScheduled());
+
+    ONNXModel& ref = model.schedule(5, 30.0f, -1.0f);
+    REQUIRE(&ref == &model);
+    REQUIRE(model.isScheduled());
+    REQUIRE(model.isAsync());
+    REQUIRE(model.schedulePolicy().priority == 5);
+    REQUIRE(model.schedulePolicy().targetHz == 30.0f);
+    REQUIRE(model.schedulePolicy().latencyBudgetMs == 0.0f);
+    REQUIRE(model.scheduleStats().submitted == 0);
+    REQUIRE(model.stats().framesShed == 0);
+
+    model.async(false);
+    REQUIRE_FALSE(model.isScheduled());
+}
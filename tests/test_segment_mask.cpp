@@ -0,0 +1,86 @@
+/**
+ * @file test_segment_mask.cpp
+ * @brief Unit tests for SegmentMask output decoding
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/segment_mask.h>
+#include "harness.h"
+#include <cmath>
+
+using namespace vivid::onnx;
+using vivid::onnx::test::Harness;
+using Catch::Matchers::WithinAbs;
+
+static Tensor makeOutput(const std::vector<int64_t>& shape, const std::vector<float>& values) {
+    Tensor t;
+    t.shape = shape;
+    resizeStorage(t);
+    for (size_t i = 0; i < values.size(); i++) t[i] = values[i];
+    return t;
+}
+
+TEST_CASE("SegmentMask defaults", "[ml][segment]") {
+    SegmentMask mask;
+    REQUIRE(mask.name() == "SegmentMask");
+    REQUIRE(mask.isLoaded() == false);
+    REQUIRE(mask.mask().empty());
+    REQUIRE(mask.outputView() == nullptr);
+    REQUIRE(mask.maskAt(0.5f, 0.5f) == 0.0f);
+
+    mask.channel(1).activation(MaskActivation::Sigmoid).threshold(0.5f).upsample(false).bilateral(2.0f, 0.05f);
+    REQUIRE(mask.textureWidth() == 0);
+}
+
+TEST_CASE("SegmentMask decoding", "[ml][segment]") {
+    Harness<SegmentMask> mask;
+
+    SECTION("single-channel NCHW probabilities") {
+        mask.decode(makeOutput({1, 1, 2, 2}, {0.0f, 1.0f, 0.25f, 0.75f}));
+        REQUIRE(mask.maskWidth() == 2);
+        REQUIRE(mask.maskHeight() == 2);
+        REQUIRE(mask.mask() == std::vector<float>{0.0f, 1.0f, 0.25f, 0.75f});
+
+        // Pixel centers, the middle (bilinear) and outside the frame
+        REQUIRE_THAT(mask.maskAt(0.75f, 0.25f), WithinAbs(1.0f, 1e-5f));
+        REQUIRE_THAT(mask.maskAt(0.5f, 0.5f), WithinAbs(0.5f, 1e-5f));
+        REQUIRE(mask.maskAt(1.5f, 0.5f) == 0.0f);
+        REQUIRE_THAT(mask.coverage(), WithinAbs(0.5f, 1e-5f));
+    }
+
+    SECTION("two-class NHWC logits, softmax of the last channel") {
+        const float l3 = std::log(3.0f);
+        mask.activation(MaskActivation::Softmax);
+        mask.decode(makeOutput({1, 3, 1, 2}, {0.0f, l3, l3, 0.0f, 0.0f, 0.0f}));
+        REQUIRE(mask.maskWidth() == 1);
+        REQUIRE(mask.maskHeight() == 3);
+        REQUIRE_THAT(mask.mask()[0], WithinAbs(0.75f, 1e-5f));
+        REQUIRE_THAT(mask.mask()[1], WithinAbs(0.25f, 1e-5f));
+        REQUIRE_THAT(mask.mask()[2], WithinAbs(0.5f, 1e-5f));
+
+        // Background class instead
+        mask.channel(0);
+        mask.decode(makeOutput({1, 3, 1, 2}, {0.0f, l3, l3, 0.0f, 0.0f, 0.0f}));
+        REQUIRE_THAT(mask.mask()[0], WithinAbs(0.25f, 1e-5f));
+    }
+
+    SECTION("sigmoid logits and threshold") {
+        mask.activation(MaskActivation::Sigmoid);
+        mask.decode(makeOutput({1, 2, 2}, {-8.0f, 0.0f, 8.0f, 1.0f}));
+        REQUIRE_THAT(mask.mask()[1], WithinAbs(0.5f, 1e-5f));
+
+        mask.threshold(0.6f, 0.01f);
+        REQUIRE_THAT(mask.maskAt(0.25f, 0.25f), WithinAbs(0.0f, 1e-5f));
+        REQUIRE_THAT(mask.maskAt(0.25f, 0.75f), WithinAbs(1.0f, 1e-5f));
+        REQUIRE_THAT(mask.maskAt(0.75f, 0.75f), WithinAbs(1.0f, 1e-5f));   // sigmoid(1) = 0.73
+        REQUIRE_THAT(mask.coverage(), WithinAbs(0.5f, 1e-5f));
+    }
+
+    SECTION("unsupported shapes keep the last mask") {
+        mask.decode(makeOutput({1, 1, 2, 2}, {1.0f, 1.0f, 1.0f, 1.0f}));
+        mask.decode(makeOutput({4}, {0.0f, 0.0f, 0.0f, 0.0f}));
+        REQUIRE(mask.maskWidth() == 2);
+        REQUIRE(mask.mask()[0] == 1.0f);
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_stats.cpp
+ * @brief Unit tests for rolling timing statistics
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/stats.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("RollingStats", "[ml][stats]") {
+    RollingStats stats(100);
+
+    SECTION("empty window reports zero") {
+        REQUIRE(stats.count() == 0);
+        REQUIRE(stats.average() == 0.0);
+        REQUIRE(stats.percentile(95.0) == 0.0);
+    }
+
+    SECTION("last, average and percentiles") {
+        for (int i = 100; i >= 1; i--) stats.add(static_cast<double>(i));
+
+        REQUIRE(stats.count() == 100);
+        REQUIRE(stats.last() == 1.0);
+        REQUIRE_THAT(stats.average(), WithinAbs(50.5, 1e-9));
+        REQUIRE(stats.percentile(50.0) == 50.0);
+        REQUIRE(stats.percentile(95.0) == 95.0);
+        REQUIRE(stats.percentile(99.0) == 99.0);
+        REQUIRE(stats.percentile(100.0) == 100.0);
+
+        StageTiming t = stats.timing();
+        REQUIRE(t.p95Ms == 95.0);
+        REQUIRE(t.samples == 100);
+    }
+
+    SECTION("window keeps the latest samples") {
+        for (int i = 0; i < 100; i++) stats.add(1000.0);
+        for (int i = 0; i < 100; i++) stats.add(2.0);
+
+        REQUIRE(stats.count() == 100);
+        REQUIRE(stats.percentile(99.0) == 2.0);
+        REQUIRE(stats.timing().samples == 200);
+    }
+
+    SECTION("reset") {
+        stats.add(5.0);
+        stats.reset();
+        REQUIRE(stats.count() == 0);
+        REQUIRE(stats.last() == 0.0);
+        REQUIRE(stats.timing().samples == 0);
+    }
+}
@@ -10,6 +10,22 @@
 using namespace vivid::onnx;
 using Catch::Matchers::WithinAbs;
 
+template <typename T>
+static std::vector<T> valuesOf(const Tensor& t) {
+    auto v = t.as<T>();
+    return {v.begin(), v.end()};
+}
+
+template <typename T>
+static Tensor makeTensor(TensorType type, std::vector<int64_t> shape, std::vector<T> values) {
+    Tensor t;
+    t.type = type;
+    t.shape = shape;
+    resizeStorage(t);
+    std::copy(values.begin(), values.end(), t.as<T>().begin());
+    return t;
+}
+
 TEST_CASE("Tensor size calculation", "[ml][tensor]") {
     Tensor tensor;
 
@@ -47,7 +63,7 @@ TEST_CASE("Tensor size calculation", "[ml][tensor]") {
 TEST_CASE("Tensor reshape", "[ml][tensor]") {
     Tensor tensor;
     tensor.shape = {2, 3, 4};
-    tensor.data.resize(tensor.size());
+    resizeStorage(tensor);
 
     SECTION("reshape to same total size succeeds") {
         tensor.reshape({4, 6});
@@ -78,22 +94,22 @@ TEST_CASE("Tensor reshape", "[ml][tensor]") {
 TEST_CASE("Tensor data access", "[ml][tensor]") {
     Tensor tensor;
     tensor.shape = {2, 3};
-    tensor.data.resize(tensor.size());
+    resizeStorage(tensor);
 
     SECTION("operator[] write") {
         tensor[0] = 1.0f;
         tensor[5] = 5.0f;
-        REQUIRE_THAT(tensor.data[0], WithinAbs(1.0f, 0.001f));
-        REQUIRE_THAT(tensor.data[5], WithinAbs(5.0f, 0.001f));
+        REQUIRE_THAT(tensor[0], WithinAbs(1.0f, 0.001f));
+        REQUIRE_THAT(tensor[5], WithinAbs(5.0f, 0.001f));
     }
 
     SECTION("operator[] read") {
-        tensor.data[2] = 3.14f;
+        tensor[2] = 3.14f;
         REQUIRE_THAT(tensor[2], WithinAbs(3.14f, 0.001f));
     }
 
     SECTION("const operator[]") {
-        tensor.data[0] = 42.0f;
+        tensor[0] = 42.0f;
         const Tensor& constRef = tensor;
         REQUIRE_THAT(constRef[0], WithinAbs(42.0f, 0.001f));
     }
@@ -109,14 +125,179 @@ TEST_CASE("Tensor types", "[ml][tensor]") {
     SECTION("UInt8 tensor") {
         tensor.type = TensorType::UInt8;
         tensor.shape = {1, 192, 192, 3};
-        tensor.dataU8.resize(tensor.size());
-        REQUIRE(tensor.dataU8.size() == 1 * 192 * 192 * 3);
+        resizeStorage(tensor);
+        REQUIRE(tensor.as<uint8_t>().size() == 1 * 192 * 192 * 3);
+        REQUIRE(tensor.buffer.size() == 1 * 192 * 192 * 3);
     }
 
     SECTION("Int32 tensor") {
         tensor.type = TensorType::Int32;
         tensor.shape = {1, 192, 192, 3};
-        tensor.dataI32.resize(tensor.size());
-        REQUIRE(tensor.dataI32.size() == 1 * 192 * 192 * 3);
+        resizeStorage(tensor);
+        REQUIRE(tensor.as<int32_t>().size() == 1 * 192 * 192 * 3);
+    }
+
+    SECTION("resizeStorage sizes the buffer for the type") {
+        tensor.shape = {2, 3};
+        tensor.type = TensorType::Int8;
+        resizeStorage(tensor);
+        REQUIRE(tensor.buffer.size() == 6);
+        tensor.type = TensorType::Float16;
+        resizeStorage(tensor);
+        REQUIRE(tensor.buffer.size() == 12);
+        tensor.type = TensorType::Int64;
+        resizeStorage(tensor);
+        REQUIRE(tensor.buffer.size() == 48);
+        REQUIRE(storageSize(tensor) == 6);
+        REQUIRE(tensor.as<int64_t>().size() == 6);
+    }
+}
+
+TEST_CASE("Tensor type conversion", "[ml][tensor]") {
+    SECTION("half round trip") {
+        REQUIRE(floatToHalf(1.0f) == 0x3c00);
+        REQUIRE(floatToHalf(-2.0f) == 0xc000);
+        REQUIRE(floatToHalf(65504.0f) == 0x7bff);
+        REQUIRE(floatToHalf(1e6f) == 0x7c00);       // overflow to inf
+        REQUIRE(floatToHalf(5.96e-8f) == 0x0001);   // smallest subnormal
+        REQUIRE_THAT(halfToFloat(0x3555), WithinAbs(0.33325195f, 1e-7));
+        for (float v : {0.0f, 0.5f, -0.75f, 3.140625f, 1024.0f, 6.1035156e-5f}) {
+            REQUIRE(halfToFloat(floatToHalf(v)) == v);
+        }
+    }
+
+    SECTION("integer storage rounds and saturates") {
+        Tensor tensor;
+        tensor.shape = {4};
+        tensor.type = TensorType::Int8;
+        resizeStorage(tensor);
+        const float values[] = {-300.0f, -1.4f, 2.6f, 300.0f};
+        assignFromFloat(tensor, values, 4);
+        REQUIRE(valuesOf<int8_t>(tensor) == std::vector<int8_t>{-128, -1, 3, 127});
+
+        fillTensor(tensor, 5.0f);
+        REQUIRE(tensor.as<int8_t>()[3] == 5);
+    }
+
+    SECTION("outputs convert to float") {
+        Tensor half = makeTensor<uint16_t>(TensorType::Float16, {3},
+                                           {floatToHalf(0.25f), floatToHalf(-1.5f), floatToHalf(8.0f)});
+        Tensor output;
+        convertToFloat(half, output);
+        REQUIRE(output.type == TensorType::Float32);
+        REQUIRE(output.shape == half.shape);
+        REQUIRE(valuesOf<float>(output) == std::vector<float>{0.25f, -1.5f, 8.0f});
+
+        convertToFloat(makeTensor<int64_t>(TensorType::Int64, {3}, {-7, 0, 42}), output);
+        REQUIRE(valuesOf<float>(output) == std::vector<float>{-7.0f, 0.0f, 42.0f});
+    }
+}
+
+TEST_CASE("Tensor batch packing", "[ml][tensor]") {
+    Tensor item;
+    item.type = TensorType::UInt8;
+    item.shape = {1, 2, 2, 3};
+    resizeStorage(item);
+    REQUIRE(item.buffer.size() == 12);
+
+    Tensor batch;
+    batch.type = TensorType::UInt8;
+    batch.shape = {3, 2, 2, 3};
+    resizeStorage(batch);
+
+    SECTION("items land in their slot") {
+        fillTensor(item, 7.0f);
+        packBatchItem(item, batch, 2);
+        REQUIRE(batch.as<uint8_t>()[23] == 0);
+        REQUIRE(batch.as<uint8_t>()[24] == 7);
+        REQUIRE(batch.as<uint8_t>()[35] == 7);
+    }
+
+    SECTION("outputs are sliced by the batch dimension") {
+        Tensor output = makeTensor<float>(TensorType::Float32, {3, 4},
+                                          {0, 1, 2, 3, 10, 11, 12, 13, 20, 21, 22, 23});
+
+        Tensor slice;
+        unpackBatchItem(output, 3, 1, slice);
+        REQUIRE(slice.shape == std::vector<int64_t>{1, 4});
+        REQUIRE(valuesOf<float>(slice) == std::vector<float>{10, 11, 12, 13});
+
+        // No batch dimension: passed through whole
+        unpackBatchItem(output, 2, 1, slice);
+        REQUIRE(slice.as<float>().size() == 12);
+    }
+}
+
+TEST_CASE("Tensor buffer", "[ml][tensor]") {
+    SECTION("storage is 64-byte aligned and zeroed") {
+        TensorBuffer buffer;
+        buffer.resize(100);
+        REQUIRE(reinterpret_cast<uintptr_t>(buffer.data()) % TensorPool::kAlignment == 0);
+        REQUIRE(buffer.capacity() >= 100);
+        REQUIRE(static_cast<const uint8_t*>(buffer.data())[99] == 0);
+    }
+
+    SECTION("shrinking and regrowing within capacity keeps the block") {
+        TensorBuffer buffer;
+        buffer.resize(256);
+        void* block = buffer.data();
+        buffer.resize(64);
+        buffer.resize(256);
+        REQUIRE(buffer.data() == block);
+    }
+
+    SECTION("pool recycles released blocks") {
+        auto pool = std::make_shared<TensorPool>();
+        void* block = nullptr;
+        {
+            TensorBuffer buffer(pool);
+            buffer.resize(4096);
+            block = buffer.data();
+        }
+        REQUIRE(pool->cachedBytes() == 4096);
+
+        TensorBuffer reuse(pool);
+        reuse.resize(3000);
+        REQUIRE(reuse.data() == block);
+        REQUIRE(pool->cachedBytes() == 0);
+
+        // Much smaller requests don't take a large block
+        reuse.reset();
+        TensorBuffer small(pool);
+        small.resize(64);
+        REQUIRE(small.data() != block);
+        REQUIRE(pool->cachedBytes() == 4096);
+    }
+
+    SECTION("wrapping external memory doesn't copy") {
+        std::vector<float> external = {1.0f, 2.0f, 3.0f};
+        Tensor t;
+        t.shape = {3};
+        t.buffer.wrap(external.data(), external.size() * sizeof(float));
+        REQUIRE(t.buffer.isExternal());
+        REQUIRE(t.as<float>().data() == external.data());
+        t[1] = 5.0f;
+        REQUIRE(external[1] == 5.0f);
+
+        // Copies own their storage
+        Tensor copy = t;
+        REQUIRE_FALSE(copy.buffer.isExternal());
+        REQUIRE(copy.as<float>().data() != external.data());
+        REQUIRE(valuesOf<float>(copy) == external);
+
+        // Growing past the external memory moves to owned storage
+        t.buffer.resize(64 * sizeof(float));
+        REQUIRE_FALSE(t.buffer.isExternal());
+        REQUIRE(t[2] == 3.0f);
+    }
+
+    SECTION("moves transfer the storage") {
+        TensorBuffer a;
+        a.resize(128);
+        void* block = a.data();
+        TensorBuffer b = std::move(a);
+        REQUIRE(b.data() == block);
+        REQUIRE(a.data() == nullptr);
+        REQUIRE(a.size() == 0);
     }
 }
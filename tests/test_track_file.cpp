@@ -0,0 +1,269 @@
+/**
+ * @file test_track_file.cpp
+ * @brief Unit tests for track file recording and detector replay
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/track_file.h>
+#include <vivid/onnx/pose_detector.h>
+#include <vivid/onnx/face_detector.h>
+#include "fake_backend.h"
+#include "harness.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace vivid::onnx;
+using vivid::onnx::test::Harness;
+using Catch::Matchers::WithinAbs;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path tempTrack(const char* name) {
+    return fs::temp_directory_path() / name;
+}
+
+TrackFrame makeFrame(int64_t index, int detections) {
+    TrackFrame frame;
+    frame.frame = index;
+    frame.timeMs = index * 33.3;
+    frame.valueCount = 2;
+    for (int d = 0; d < detections; d++) {
+        TrackDetection det;
+        det.source = d % 2;
+        det.id = 10 + d;
+        det.score = 0.5f + 0.1f * d;
+        det.box = glm::vec4(0.1f * d, 0.2f, 0.3f, 0.4f);
+        const float values[2] = {static_cast<float>(index), static_cast<float>(d)};
+        frame.add(det, values);
+    }
+    return frame;
+}
+
+} // namespace
+
+TEST_CASE("Track file round trip", "[ml][track]") {
+    const fs::path path = tempTrack("vivid-onnx-test.vtrk");
+    {
+        TrackWriter writer;
+        REQUIRE(writer.open(path.string(), "PoseDetector", 2, 2));
+        REQUIRE(writer.write(makeFrame(0, 3)));
+        REQUIRE(writer.write(makeFrame(2, 0)));   // frame 1 was skipped
+        REQUIRE(writer.write(makeFrame(3, 1)));
+
+        // Value count mismatch is refused
+        TrackFrame wrong = makeFrame(4, 1);
+        wrong.valueCount = 3;
+        REQUIRE_FALSE(writer.write(wrong));
+        REQUIRE(writer.framesWritten() == 3);
+    }
+
+    TrackReader reader;
+    REQUIRE(reader.open(path.string()));
+    REQUIRE(reader.kind() == "PoseDetector");
+    REQUIRE(reader.valueCount() == 2);
+    REQUIRE(reader.sourceCount() == 2);
+    REQUIRE(reader.frameCount() == 3);
+
+    const TrackFrame* first = reader.find(0);
+    REQUIRE(first != nullptr);
+    REQUIRE(first->detections.size() == 3);
+    REQUIRE(first->detections[2].id == 12);
+    REQUIRE(first->detections[1].source == 1);
+    REQUIRE_THAT(first->detections[2].score, WithinAbs(0.7f, 1e-6));
+    REQUIRE_THAT(first->detections[2].box.x, WithinAbs(0.2f, 1e-6));
+    REQUIRE_THAT(first->values(2)[1], WithinAbs(2.0f, 1e-6));
+
+    REQUIRE(reader.find(1) == nullptr);
+    REQUIRE(reader.find(2)->detections.empty());
+    REQUIRE_THAT(reader.find(3)->timeMs, WithinAbs(99.9, 1e-9));
+    REQUIRE(reader.find(7) == nullptr);
+
+    fs::remove(path);
+}
+
+TEST_CASE("Track file errors and JSONL", "[ml][track]") {
+    TrackReader reader;
+    REQUIRE_FALSE(reader.open(tempTrack("vivid-onnx-missing.vtrk").string()));
+
+    SECTION("JSONL is written but not read back") {
+        const fs::path path = tempTrack("vivid-onnx-test.jsonl");
+        {
+            TrackWriter writer;
+            REQUIRE(writer.open(path.string(), "FaceDetector", 2, 1, TrackFormat::Jsonl));
+            REQUIRE(writer.write(makeFrame(5, 1)));
+        }
+        std::ifstream file(path);
+        std::string header, line;
+        std::getline(file, header);
+        std::getline(file, line);
+        REQUIRE(header.find("\"kind\": \"FaceDetector\"") != std::string::npos);
+        REQUIRE(line.find("\"frame\": 5") != std::string::npos);
+        REQUIRE(line.find("\"id\": 10") != std::string::npos);
+        REQUIRE(line.find("\"values\": [5, 0]") != std::string::npos);
+        file.close();
+
+        REQUIRE_FALSE(reader.open(path.string()));
+        fs::remove(path);
+    }
+
+    SECTION("JSONL times keep sub-millisecond precision") {
+        const fs::path path = tempTrack("vivid-onnx-times.jsonl");
+        {
+            TrackWriter writer;
+            REQUIRE(writer.open(path.string(), "FaceDetector", 2, 1, TrackFormat::Jsonl));
+            TrackFrame frame = makeFrame(0, 1);
+            frame.timeMs = 361234567.891;
+            REQUIRE(writer.write(frame));
+        }
+        std::ifstream file(path);
+        std::string header, line;
+        std::getline(file, header);
+        std::getline(file, line);
+        REQUIRE(line.find("\"timeMs\": 361234567.891,") != std::string::npos);
+        REQUIRE(line.find("\"score\": 0.5,") != std::string::npos);   // values keep the default format
+        file.close();
+        fs::remove(path);
+    }
+
+    SECTION("truncated frames are dropped") {
+        const fs::path path = tempTrack("vivid-onnx-truncated.vtrk");
+        {
+            TrackWriter writer;
+            REQUIRE(writer.open(path.string(), "PoseDetector", 2, 1));
+            REQUIRE(writer.write(makeFrame(0, 2)));
+            REQUIRE(writer.write(makeFrame(1, 2)));
+        }
+        fs::resize_file(path, fs::file_size(path) - 4);
+        REQUIRE(reader.open(path.string()));
+        REQUIRE(reader.frameCount() == 1);
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("PoseDetector track hooks", "[ml][track]") {
+    Harness<PoseDetector> detector;
+    Tensor t;
+    t.shape = {1, 6, 56};
+    resizeStorage(t);
+    for (int slot : {0, 2}) {
+        float* det = &t[slot * 56];
+        for (int i = 0; i < 17; i++) {
+            det[i * 3 + 0] = 0.2f * slot + 0.01f * i;
+            det[i * 3 + 1] = 0.3f * slot;
+            det[i * 3 + 2] = 0.8f;
+        }
+        det[51] = 0.2f * slot;
+        det[52] = 0.3f * slot - 0.05f;
+        det[53] = 0.2f * slot + 0.3f;
+        det[54] = 0.3f * slot + 0.05f;
+        det[55] = 0.5f + 0.1f * slot;
+    }
+    detector.decode(t);
+    REQUIRE(detector.poseCount() == 2);
+
+    TrackFrame frame;
+    frame.valueCount = detector.values();
+    detector.append(frame);
+    REQUIRE(frame.detections.size() == 2);
+    REQUIRE_THAT(frame.detections[0].score, WithinAbs(0.7f, 1e-6));
+
+    // Replayed results match the decoded ones, arrays included
+    Harness<PoseDetector> replayed;
+    replayed.apply(frame);
+    REQUIRE(replayed.detected());
+    REQUIRE(replayed.poseCount() == 2);
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; i < 17; i++) {
+            REQUIRE(replayed.pose(p).keypoints[i].y == detector.pose(p).keypoints[i].y);
+            REQUIRE(replayed.poseKeypoints().x(p)[i] == detector.poseKeypoints().x(p)[i]);
+            REQUIRE(replayed.poseKeypoints().confidence(p)[i] == detector.poseKeypoints().confidence(p)[i]);
+        }
+        REQUIRE(replayed.pose(p).bbox.x == detector.pose(p).bbox.x);
+        REQUIRE(replayed.pose(p).bbox.w == detector.pose(p).bbox.w);
+    }
+    REQUIRE_THAT(replayed.keypoint(Keypoint::Nose).x, WithinAbs(0.6f, 1e-6));
+
+    // An empty record clears the results
+    frame.clear();
+    replayed.apply(frame);
+    REQUIRE_FALSE(replayed.detected());
+    REQUIRE(replayed.poseKeypoints().empty());
+}
+
+TEST_CASE("FaceDetector track hooks", "[ml][track]") {
+    TrackFrame frame;
+    frame.valueCount = 12;
+    TrackDetection det;
+    det.id = 4;
+    det.score = 0.9f;
+    det.box = glm::vec4(0.1f, 0.2f, 0.3f, 0.4f);
+    float landmarks[12];
+    for (int i = 0; i < 12; i++) landmarks[i] = 0.05f * i;
+    frame.add(det, landmarks);
+
+    Harness<FaceDetector> detector;
+    detector.apply(frame);
+    REQUIRE(detector.faceCount() == 1);
+    REQUIRE(detector.face(0).id == 4);
+    REQUIRE_THAT(detector.face(0).landmarks[2].y, WithinAbs(0.25f, 1e-6));
+
+    TrackFrame again;
+    again.valueCount = 12;
+    detector.append(again);
+    REQUIRE(again.detections.size() == 1);
+    REQUIRE(again.valueData == frame.valueData);
+}
+
+TEST_CASE("ONNXModel replay loads a track instead of a model", "[ml][track]") {
+    const fs::path path = tempTrack("vivid-onnx-replay.vtrk");
+    {
+        TrackWriter writer;
+        REQUIRE(writer.open(path.string(), "PoseDetector", 17 * 3, 1));
+    }
+
+    PoseDetector pose;
+    REQUIRE(&pose.replay(path.string()) == &pose);
+    REQUIRE(pose.isReplaying());
+    REQUIRE(pose.load());
+    REQUIRE(pose.isLoaded());
+
+    // Another detector's track is refused
+    FaceDetector faces;
+    faces.replay(path.string());
+    REQUIRE_FALSE(faces.load());
+    REQUIRE_FALSE(faces.isLoaded());
+
+    REQUIRE_FALSE(pose.isRecording());
+    REQUIRE(pose.record("out.vtrk").isRecording());
+    REQUIRE_FALSE(pose.record("").isRecording());
+
+    fs::remove(path);
+}
+
+TEST_CASE("ONNXModel live records are timed from the first one", "[ml][track]") {
+    const fs::path path = tempTrack("vivid-onnx-live.vtrk");
+    std::atomic<int> runs{0};
+    {
+        Harness<PoseDetector> pose;
+        pose.model("fake.onnx").backend(std::make_unique<test::FakeBackend>(&runs));
+        pose.record(path.string());
+        REQUIRE(pose.load());
+        for (int i = 0; i < 3; i++) {
+            pose.frame();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    REQUIRE(runs == 3);
+
+    TrackReader reader;
+    REQUIRE(reader.open(path.string()));
+    REQUIRE(reader.frameCount() == 3);
+    REQUIRE(reader.find(0)->timeMs == 0.0);
+    REQUIRE(reader.find(1)->timeMs > 0.0);
+    REQUIRE(reader.find(2)->timeMs > reader.find(1)->timeMs);
+    REQUIRE(reader.find(2)->timeMs < 10000.0);   // not steady_clock's epoch
+    fs::remove(path);
+}
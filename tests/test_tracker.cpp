@@ -0,0 +1,84 @@
+/**
+ * @file test_tracker.cpp
+ * @brief Unit tests for detection tracking and One-Euro smoothing
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vivid/onnx/tracker.h>
+
+using namespace vivid::onnx;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("OneEuroFilter", "[ml][tracker]") {
+    OneEuroFilter f;
+
+    SECTION("first sample passes through") {
+        REQUIRE_THAT(f.filter(0.5f, 1.0f / 60.0f), WithinAbs(0.5f, 1e-6));
+    }
+
+    SECTION("a step is smoothed, then followed") {
+        f.filter(0.0f, 1.0f / 60.0f);
+        float first = f.filter(1.0f, 1.0f / 60.0f);
+        REQUIRE(first > 0.0f);
+        REQUIRE(first < 1.0f);
+        for (int i = 0; i < 120; i++) f.filter(1.0f, 1.0f / 60.0f);
+        REQUIRE_THAT(f.value, WithinAbs(1.0f, 1e-3));
+    }
+}
+
+TEST_CASE("DetectionTracker", "[ml][tracker]") {
+    DetectionTracker tracker;
+    tracker.valueCount(2);
+    const float left[2] = {0.1f, 0.1f};
+    const float right[2] = {0.8f, 0.8f};
+
+    tracker.add(glm::vec4(0.1f, 0.1f, 0.2f, 0.2f), 0.9f, left);
+    tracker.add(glm::vec4(0.7f, 0.7f, 0.2f, 0.2f), 0.8f, right);
+    tracker.update(0.0);
+    REQUIRE(tracker.tracks().size() == 2);
+    const int leftId = tracker.tracks()[tracker.trackFor(0)].id;
+    const int rightId = tracker.tracks()[tracker.trackFor(1)].id;
+    REQUIRE(leftId != rightId);
+
+    SECTION("IDs are stable when detections come in another order") {
+        tracker.clear();
+        tracker.add(glm::vec4(0.71f, 0.7f, 0.2f, 0.2f), 0.8f, right);
+        tracker.add(glm::vec4(0.11f, 0.1f, 0.2f, 0.2f), 0.9f, left);
+        tracker.update(1.0 / 30.0);
+        REQUIRE(tracker.tracks().size() == 2);
+        REQUIRE(tracker.tracks()[tracker.trackFor(0)].id == rightId);
+        REQUIRE(tracker.tracks()[tracker.trackFor(1)].id == leftId);
+    }
+
+    SECTION("fast moves match by center distance") {
+        tracker.clear();
+        tracker.add(glm::vec4(0.17f, 0.1f, 0.2f, 0.2f), 0.9f, left);  // IoU below threshold
+        tracker.update(1.0 / 30.0);
+        REQUIRE(tracker.tracks()[tracker.trackFor(0)].id == leftId);
+    }
+
+    SECTION("unmatched tracks are dropped after maxMissed updates") {
+        tracker.maxMissed(1);
+        tracker.clear();
+        tracker.add(glm::vec4(0.1f, 0.1f, 0.2f, 0.2f), 0.9f, left);
+        tracker.update(1.0 / 30.0);
+        REQUIRE(tracker.tracks().size() == 2);
+        tracker.update(2.0 / 30.0);
+        REQUIRE(tracker.tracks().size() == 1);
+        REQUIRE(tracker.tracks()[0].id == leftId);
+    }
+
+    SECTION("predict extrapolates a moving track") {
+        for (int i = 1; i <= 10; i++) {
+            tracker.clear();
+            tracker.add(glm::vec4(0.1f + 0.01f * i, 0.1f, 0.2f, 0.2f), 0.9f, left);
+            tracker.update(i / 30.0);
+        }
+        const auto& track = tracker.tracks()[tracker.trackFor(0)];
+        const float updated = track.box.x;
+        tracker.predict(10.5 / 30.0);
+        REQUIRE(track.box.x > updated);
+        REQUIRE(track.box.x < 0.3f);
+    }
+}
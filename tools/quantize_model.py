@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Quantize an ONNX model for vivid-onnx.
+
+Modes:
+  dynamic  int8 weights, activations quantized at run time (no calibration)
+  static   int8 weights and activations (QDQ), calibrated on recorded frames
+  fp16     float16 weights and activations
+
+Calibration frames are the raw BGRA files written by bench/record_frames.sh,
+so the ranges come from our own footage. They are preprocessed like
+ImageResampler does: stretched to the model input, BGRA to RGB, then
+normalized (--norm). Quantized models keep float32 inputs and outputs unless
+--fp16-io is given; vivid-onnx handles either.
+
+Usage (needs onnx and onnxruntime; fp16 also needs onnxconverter-common):
+  tools/quantize_model.py static assets/models/blazeface/face_detection_front_128x128_float32.onnx \\
+      --norm signed --frames bench/frames --samples 200
+  tools/quantize_model.py fp16 assets/models/movenet/multipose-lightning.onnx
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+import numpy as np
+import onnx
+
+NORMALIZATIONS = {
+    "unit": (1.0 / 255.0, 0.0),     # [0, 1]
+    "raw": (1.0, 0.0),              # [0, 255]
+    "signed": (2.0 / 255.0, -1.0),  # [-1, 1]
+}
+
+FRAME_NAME = re.compile(r"_(\d+)x(\d+)\.bgra$")
+
+
+def input_layout(shape):
+    """(height, width, nchw) of a 4D image input, like detectLayout()"""
+    dims = [d if isinstance(d, int) and d > 0 else 1 for d in shape]
+    if len(dims) != 4:
+        raise SystemExit("expected a 4D image input, got shape %s" % (shape,))
+    if dims[1] <= 4 and dims[3] > 4:
+        return dims[2], dims[3], True
+    return dims[1], dims[2], False
+
+
+def load_frames(directory, limit):
+    """Yield HxWx4 uint8 frames from <name>_<w>x<h>.bgra files"""
+    files = sorted(glob.glob(os.path.join(directory, "*.bgra")))
+    if not files:
+        raise SystemExit("no .bgra frames in %s (run bench/record_frames.sh)" % directory)
+    per_file = max(1, limit // len(files))
+    for path in files:
+        match = FRAME_NAME.search(path)
+        if not match:
+            continue
+        width, height = int(match.group(1)), int(match.group(2))
+        data = np.fromfile(path, dtype=np.uint8)
+        frames = data[: data.size // (width * height * 4) * width * height * 4]
+        frames = frames.reshape(-1, height, width, 4)
+        step = max(1, len(frames) // per_file)
+        for frame in frames[::step][:per_file]:
+            yield frame
+
+
+def resize_bilinear(image, width, height):
+    """Half-pixel-center bilinear resize (matches ImageResampler)"""
+    src_h, src_w = image.shape[:2]
+    xs = np.clip((np.arange(width) + 0.5) * src_w / width - 0.5, 0, src_w - 1)
+    ys = np.clip((np.arange(height) + 0.5) * src_h / height - 0.5, 0, src_h - 1)
+    x0, y0 = np.floor(xs).astype(int), np.floor(ys).astype(int)
+    x1, y1 = np.minimum(x0 + 1, src_w - 1), np.minimum(y0 + 1, src_h - 1)
+    fx, fy = (xs - x0)[None, :, None], (ys - y0)[:, None, None]
+    image = image.astype(np.float32)
+    top = image[y0][:, x0] * (1 - fx) + image[y0][:, x1] * fx
+    bottom = image[y1][:, x0] * (1 - fx) + image[y1][:, x1] * fx
+    return top * (1 - fy) + bottom * fy
+
+
+class FrameReader:
+    """onnxruntime CalibrationDataReader over recorded frames"""
+
+    def __init__(self, model_path, frames, samples, norm):
+        model = onnx.load(model_path)
+        graph_input = model.graph.input[0]
+        shape = [d.dim_value or d.dim_param for d in graph_input.type.tensor_type.shape.dim]
+        self.name = graph_input.name
+        self.height, self.width, self.nchw = input_layout(shape)
+        self.channels = shape[1] if self.nchw else shape[3]
+        self.scale, self.bias = NORMALIZATIONS[norm]
+        self.frames = load_frames(frames, samples)
+
+    def get_next(self):
+        frame = next(self.frames, None)
+        if frame is None:
+            return None
+        rgb = resize_bilinear(frame, self.width, self.height)[:, :, [2, 1, 0]]
+        tensor = rgb[:, :, : self.channels] * self.scale + self.bias
+        if self.nchw:
+            tensor = tensor.transpose(2, 0, 1)
+        return {self.name: tensor[None].astype(np.float32)}
+
+    def rewind(self):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=["dynamic", "static", "fp16"])
+    parser.add_argument("model")
+    parser.add_argument("-o", "--output", help="default: <model>.<mode>.onnx")
+    parser.add_argument("--frames", default="bench/frames", help="directory of recorded .bgra frames")
+    parser.add_argument("--samples", type=int, default=100, help="calibration frames (static)")
+    parser.add_argument("--norm", choices=sorted(NORMALIZATIONS), default="unit",
+                        help="input normalization the model expects (static)")
+    parser.add_argument("--method", choices=["minmax", "entropy", "percentile"], default="minmax",
+                        help="calibration method (static)")
+    parser.add_argument("--per-channel", action="store_true", help="per-channel weight scales")
+    parser.add_argument("--fp16-io", action="store_true", help="float16 inputs and outputs too (fp16)")
+    args = parser.parse_args()
+
+    output = args.output or "%s.%s.onnx" % (os.path.splitext(args.model)[0], args.mode)
+
+    if args.mode == "fp16":
+        from onnxconverter_common import float16
+        model = float16.convert_float_to_float16(onnx.load(args.model), keep_io_types=not args.fp16_io)
+        onnx.save(model, output)
+    else:
+        from onnxruntime import quantization as q
+        # Shape inference and constant folding first, as ORT recommends
+        prepared = output + ".pre.onnx"
+        q.quant_pre_process(args.model, prepared)
+        try:
+            if args.mode == "dynamic":
+                q.quantize_dynamic(prepared, output, weight_type=q.QuantType.QInt8,
+                                   per_channel=args.per_channel)
+            else:
+                methods = {
+                    "minmax": q.CalibrationMethod.MinMax,
+                    "entropy": q.CalibrationMethod.Entropy,
+                    "percentile": q.CalibrationMethod.Percentile,
+                }
+                reader = FrameReader(prepared, args.frames, args.samples, args.norm)
+                q.quantize_static(prepared, output, reader, quant_format=q.QuantFormat.QDQ,
+                                  activation_type=q.QuantType.QInt8, weight_type=q.QuantType.QInt8,
+                                  per_channel=args.per_channel, calibrate_method=methods[args.method])
+        finally:
+            os.remove(prepared)
+
+    before = os.path.getsize(args.model) / 1e6
+    after = os.path.getsize(output) / 1e6
+    print("%s: %.1f MB -> %.1f MB" % (output, before, after))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())